@@ -0,0 +1,342 @@
+// astbench.c - AST benchmark: pointer tree (ast.h) versus flat arrays (fla.h)
+//
+// Generate a synthetic SubC program, of ordinary, shallow code, lex it, and
+// parse it (pseProg) into the usual tree of calloc'd nodes.  Then flatten
+// that tree into a Fla (flaNew).  Then parse it again, with hash-consing on
+// (see AstCons in ast.h), into a tree that shares identical Nams, Nums, Strs
+// and Exps.  Report, for each form:
+//
+//    memory : bytes allocated to hold it (from mallinfo2, so including
+//             malloc's own overhead), per AST node
+//    walk   : ns per AST node to visit every node, summing its contents,
+//             over 'reps' walks (mean and standard deviation)
+//
+// The lexemes belong to the Toks, not the tree, so they are not counted for
+// the pointer trees.  A Fla holds its own copy of each distinct name, which
+// is counted, as is the hash table for consing.  Every walk computes the same
+// checksum, which is checked.
+//
+// Usage: astbench [-size <KB>] [-reps <n>]
+//
+// Build (from this directory):
+//    clang -O2 -o astbench astbench.c -lm -lpthread
+
+#include <malloc.h>     // mallinfo2
+#include <math.h>       // sqrt
+#include <time.h>       // timespec_get
+
+#include "../P4 CodeGen/ast.c"
+#include "../P4 CodeGen/fla.c"
+#include "../P4 CodeGen/lex.c"
+#include "../P4 CodeGen/pin.c"
+#include "../P4 CodeGen/pse.c"
+#include "../P4 CodeGen/tok.c"
+#include "../P4 CodeGen/toks.c"
+#include "../P4 CodeGen/ut.c"
+
+typedef struct {
+  char* buf;
+  int   size;
+  int   cap;
+} Text;
+
+typedef struct {
+  long long sum;        // checksum of the contents
+  long long numNode;    // AST nodes visited (pointer tree only)
+} Walk;
+
+// ============================================================================
+// Append 's' onto 'text'
+// ============================================================================
+void textPut(Text* text, char* s) {
+  int len = strlen(s);
+  if (text->size + len + 1 > text->cap) {
+    text->cap = 2 * text->cap + len + 4096;
+    text->buf = realloc(text->buf, text->cap);
+  }
+  memcpy(text->buf + text->size, s, len + 1);
+  text->size += len;
+}
+
+// ============================================================================
+// Generate ordinary, shallow SubC of at least 'numByte' bytes (as psebench)
+// ============================================================================
+char* benchShallow(int numByte) {
+  Text text = { NULL, 0, 0 };
+  char line[200];
+  int fun = 0;
+  while (text.size < numByte) {
+    sprintf(line, "int f%d(int a, int b) {\n  int x;\n  int y;\n", fun++);
+    textPut(&text, line);
+    for (int s = 0; s < 40; ++s) {
+      textPut(&text, "  x = a + b;\n  y = f0(x, 7, b);\n");
+      if (s % 8 == 0) {
+        textPut(&text, "  if (x < 10) {\n    while (y > 0) {\n");
+        textPut(&text, "      if (y == 3) { x = x * 2; }\n      y = y - 1;\n");
+        textPut(&text, "    }\n  }\n");
+      }
+    }
+    textPut(&text, "  return x;\n}\n");
+  }
+  return text.buf;
+}
+
+// ============================================================================
+// Return the time now, in seconds
+// ============================================================================
+double benchNow() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ============================================================================
+// Return the bytes currently allocated by malloc: from the heap, plus those
+// of big blocks, which it maps separately
+// ============================================================================
+size_t benchHeap() {
+  struct mallinfo2 mi = mallinfo2();
+  return mi.uordblks + mi.hblkhd;
+}
+
+// ============================================================================
+// Add the contents of 'leaf', a Nam, Num or Str, of the pointer tree, to 'w'
+// ============================================================================
+void benchAstLeaf(Ast* leaf, Walk* w) {
+  ++w->numNode;
+  if (leaf->kind == ASTNUM) w->sum += ((AstNum*) leaf)->val;
+  else if (leaf->kind == ASTNAM) w->sum += ((AstNam*) leaf)->lex[0];
+  else w->sum += ((AstStr*) leaf)->txt[0];
+}
+
+// ============================================================================
+// Add the contents of 'exp', of the pointer tree, to 'w'
+// ============================================================================
+void benchAstExp(AstExp* exp, Walk* w) {
+  ++w->numNode;
+  w->sum += exp->bop;
+  benchAstLeaf(exp->lhs, w);
+  if (exp->bop != BOPNONE) benchAstLeaf(exp->rhs, w);
+}
+
+// ============================================================================
+// Walk every node of the pointer tree 'prog', following 'next' links, with a
+// heap-allocated stack of the Blocks still open, as visitStms does
+// ============================================================================
+Walk benchAstWalk(AstProg* prog) {
+  Walk w = { 0, 1 };                              // 1 for the Prog
+  int maxFrame = 16;
+  Ast** frame = malloc(maxFrame * sizeof(Ast*));
+
+  for (AstFun* fun = prog->funs; fun; fun = (AstFun*) fun->next) {
+    w.numNode += 3;                               // Fun, its Nam, and Body
+    w.sum += fun->nam->lex[0];
+    for (AstPar* par = fun->pars; par; par = (AstPar*) par->next) {
+      w.numNode += 2;
+      w.sum += par->nam->lex[0];
+    }
+    for (AstVar* var = fun->body->vars; var; var = (AstVar*) var->next) {
+      w.numNode += 2;
+      w.sum += var->nam->lex[0];
+    }
+
+    int hi = 0;
+    frame[0] = (Ast*) fun->body->stms;
+    for (;;) {
+      Ast* ast = frame[hi];
+      if (ast == NULL) {
+        if (hi == 0) break;
+        --hi;
+        continue;
+      }
+      frame[hi] = ast->next;
+      ++w.numNode;
+      w.sum += ast->kind;
+
+      if (ast->kind == ASTASG) {
+        AstAsg* asg = (AstAsg*) ast;
+        ++w.numNode;
+        w.sum += asg->nam->lex[0];
+        if (asg->eoc->kind == ASTEXP) {
+          benchAstExp((AstExp*) asg->eoc, &w);
+        } else {
+          AstCall* call = (AstCall*) asg->eoc;
+          w.numNode += 2;
+          w.sum += call->nam->lex[0];
+          for (AstArg* arg = call->args; arg; arg = (AstArg*) arg->next) {
+            ++w.numNode;
+            benchAstLeaf(arg->nns, &w);
+          }
+        }
+      } else if (ast->kind == ASTRET) {
+        benchAstExp(((AstRet*) ast)->exp, &w);
+      } else {                                    // If or While
+        AstExp* exp = ast->kind == ASTIF ? ((AstIf*) ast)->exp : ((AstWhile*) ast)->exp;
+        AstBlock* block = ast->kind == ASTIF ? ((AstIf*) ast)->block : ((AstWhile*) ast)->block;
+        benchAstExp(exp, &w);
+        ++w.numNode;                              // the Block
+        if (++hi == maxFrame) {
+          maxFrame *= 2;
+          frame = realloc(frame, maxFrame * sizeof(Ast*));
+        }
+        frame[hi] = (Ast*) block->stms;
+      }
+    }
+  }
+
+  free(frame);
+  return w;
+}
+
+// ============================================================================
+// Add the contents of 'leaf', a FlaRef to a Nam, Num or Str, to 'w'
+// ============================================================================
+void benchFlaLeaf(Fla* fla, FlaRef leaf, Walk* w) {
+  uint32_t i = FLAIDX(leaf);
+  if (FLAKIND(leaf) == ASTNUM) w->sum += fla->nums.val[i];
+  else w->sum += flaTxt(fla, i)[0];
+}
+
+// ============================================================================
+// Add the contents of Exp 'exp' of 'fla' to 'w'
+// ============================================================================
+void benchFlaExp(Fla* fla, uint32_t exp, Walk* w) {
+  BOP bop = fla->exp.bop[exp];
+  w->sum += bop;
+  benchFlaLeaf(fla, fla->exp.lhs[exp], w);
+  if (bop != BOPNONE) benchFlaLeaf(fla, fla->exp.rhs[exp], w);
+}
+
+// ============================================================================
+// Walk every node of 'fla', with a heap-allocated stack of the Blocks still
+// open, as flaVisitStms does
+// ============================================================================
+Walk benchFlaWalk(Fla* fla) {
+  Walk w = { 0, 0 };
+  int maxFrame = 16;
+  uint32_t* next = malloc(maxFrame * sizeof(uint32_t));
+  uint32_t* end = malloc(maxFrame * sizeof(uint32_t));
+
+  for (int f = 0; f < fla->fun.num; ++f) {
+    w.sum += flaTxt(fla, fla->fun.nam[f])[0];
+    uint32_t lo = fla->fun.parLo[f];
+    for (uint32_t i = lo; i < lo + fla->fun.numPar[f]; ++i) w.sum += flaTxt(fla, fla->ids[i])[0];
+    lo = fla->fun.varLo[f];
+    for (uint32_t i = lo; i < lo + fla->fun.numVar[f]; ++i) w.sum += flaTxt(fla, fla->ids[i])[0];
+
+    int hi = 0;
+    next[0] = fla->fun.stmLo[f];
+    end[0] = next[0] + fla->fun.numStm[f];
+    for (;;) {
+      if (next[hi] == end[hi]) {
+        if (hi == 0) break;
+        --hi;
+        continue;
+      }
+      FlaRef stm = fla->kids[next[hi]++];
+      uint32_t s = FLAIDX(stm);
+      w.sum += FLAKIND(stm);
+
+      if (FLAKIND(stm) == ASTASG) {
+        w.sum += flaTxt(fla, fla->asg.nam[s])[0];
+        FlaRef eoc = fla->asg.eoc[s];
+        if (FLAKIND(eoc) == ASTEXP) {
+          benchFlaExp(fla, FLAIDX(eoc), &w);
+        } else {
+          uint32_t c = FLAIDX(eoc);
+          w.sum += flaTxt(fla, fla->call.nam[c])[0];
+          lo = fla->call.argLo[c];
+          for (uint32_t a = lo; a < lo + fla->call.numArg[c]; ++a) {
+            benchFlaLeaf(fla, fla->kids[a], &w);
+          }
+        }
+      } else if (FLAKIND(stm) == ASTRET) {
+        benchFlaExp(fla, fla->ret.exp[s], &w);
+      } else {                                    // If or While
+        FlaConds* p = FLAKIND(stm) == ASTIF ? &fla->iff : &fla->whl;
+        benchFlaExp(fla, p->exp[s], &w);
+        if (++hi == maxFrame) {
+          maxFrame *= 2;
+          next = realloc(next, maxFrame * sizeof(uint32_t));
+          end = realloc(end, maxFrame * sizeof(uint32_t));
+        }
+        next[hi] = p->stmLo[s];
+        end[hi] = next[hi] + p->numStm[s];
+      }
+    }
+  }
+
+  free(next);
+  free(end);
+  return w;
+}
+
+// ============================================================================
+// Time 'reps' walks of 'prog' (if 'fla' is NULL), or else of 'fla'.  Report
+// ns per node, over 'numNode' nodes.  Return the mean
+// ============================================================================
+double benchWalk(char* name, AstProg* prog, Fla* fla, long long numNode, int reps, long long* sum) {
+  double tot = 0, tot2 = 0;
+  for (int r = 0; r < reps; ++r) {
+    double t0 = benchNow();
+    Walk w = fla ? benchFlaWalk(fla) : benchAstWalk(prog);
+    double ns = (benchNow() - t0) * 1e9 / numNode;
+    tot += ns;  tot2 += ns * ns;
+    *sum = w.sum;
+  }
+  double mean = tot / reps;
+  double sd = sqrt(fabs(tot2 / reps - mean * mean));
+  printf("  %-6s walk   %8.2f +- %5.2f ns/node \n", name, mean, sd);
+  return mean;
+}
+
+void usage() {
+  printf("\n\nUsage: astbench [-size <KB>] [-reps <n>] \n\n");
+}
+
+int main(int argc, char* argv[]) {
+  int kb = 2400;                            // about 1M AST nodes
+  int reps = 10;
+
+  for (int a = 1; a < argc; ++a) {
+    if (a + 1 == argc) { usage(); exit(-1); }
+    if (strcmp(argv[a], "-size") == 0) {
+      kb = atoi(argv[++a]);
+    } else if (strcmp(argv[a], "-reps") == 0) {
+      reps = atoi(argv[++a]);
+    } else {
+      usage(); exit(-1);
+    }
+  }
+  if (kb < 1 || reps < 1) { usage(); exit(-1); }
+
+  Toks* toks = lexAll(lexNew(benchShallow(kb * 1024)));
+  toksRewind(toks);
+
+  size_t h0 = benchHeap();
+  AstProg* prog = pseProg(toks);
+  size_t h1 = benchHeap();
+  Fla* fla = flaNew(prog);
+  size_t h2 = benchHeap();
+  toksRewind(toks);
+  g_astCons = astConsNew();
+  AstProg* cons = pseProg(toks);
+  size_t h3 = benchHeap();
+
+  long long numNode = benchAstWalk(prog).numNode;
+  printf("\nAST of %d KB of SubC: %lld nodes, %d repetitions \n", kb, numNode, reps);
+  printf("  tree   memory %10zu bytes  %6.1f bytes/node \n", h1 - h0, (double) (h1 - h0) / numNode);
+  printf("  flat   memory %10zu bytes  %6.1f bytes/node \n", h2 - h1, (double) (h2 - h1) / numNode);
+  printf("  cons   memory %10zu bytes  %6.1f bytes/node  (%d distinct, %d shared) \n",
+    h3 - h2, (double) (h3 - h2) / numNode, g_astCons->numBuilt, g_astCons->numShared);
+
+  long long sumAst = 0, sumFla = 0, sumCons = 0;
+  double nsAst = benchWalk("tree", prog, NULL, numNode, reps, &sumAst);
+  double nsFla = benchWalk("flat", prog, fla, numNode, reps, &sumFla);
+  benchWalk("cons", cons, NULL, numNode, reps, &sumCons);
+  int same = sumAst == sumFla && sumAst == sumCons;
+  printf("  flat/tree: %.2fx faster walk, %.2fx less memory%s \n",
+    nsAst / nsFla, (double) (h1 - h0) / (h2 - h1), same ? "" : "  CHECKSUM MISMATCH");
+  printf("  cons/tree: %.2fx less memory \n\n", (double) (h1 - h0) / (h3 - h2));
+  return same ? 0 : 1;
+}
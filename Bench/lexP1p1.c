@@ -0,0 +1,12 @@
+// lexP1p1.c - Lexer benchmark: the lexer in "P1 Lexer/p1"
+
+#define LEXPFX(nam) p1p1_##nam
+#define LEXLEXEME   lexeme
+#include "lexwrap.h"
+
+#include "../P1 Lexer/p1/lex.c"
+#include "../P1 Lexer/p1/tok.c"
+#include "../P1 Lexer/p1/toks.c"
+#include "../P1 Lexer/p1/ut.c"
+
+#include "lexadapt.h"
@@ -0,0 +1,12 @@
+// lexP1p2.c - Lexer benchmark: the lexer in "P1 Lexer/p2"
+
+#define LEXPFX(nam) p1p2_##nam
+#define LEXLEXEME   lexeme
+#include "lexwrap.h"
+
+#include "../P1 Lexer/p2/lex.c"
+#include "../P1 Lexer/p2/tok.c"
+#include "../P1 Lexer/p2/toks.c"
+#include "../P1 Lexer/p2/ut.c"
+
+#include "lexadapt.h"
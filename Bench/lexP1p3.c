@@ -0,0 +1,12 @@
+// lexP1p3.c - Lexer benchmark: the lexer in "P1 Lexer/p3"
+
+#define LEXPFX(nam) p1p3_##nam
+#define LEXLEXEME   lexeme
+#include "lexwrap.h"
+
+#include "../P1 Lexer/p3/lex.c"
+#include "../P1 Lexer/p3/tok.c"
+#include "../P1 Lexer/p3/toks.c"
+#include "../P1 Lexer/p3/ut.c"
+
+#include "lexadapt.h"
@@ -0,0 +1,12 @@
+// lexP1p4.c - Lexer benchmark: the lexer in "P1 Lexer/p4"
+
+#define LEXPFX(nam) p1p4_##nam
+#define LEXLEXEME   lexeme
+#include "lexwrap.h"
+
+#include "../P1 Lexer/p4/lex.c"
+#include "../P1 Lexer/p4/tok.c"
+#include "../P1 Lexer/p4/toks.c"
+#include "../P1 Lexer/p4/ut.c"
+
+#include "lexadapt.h"
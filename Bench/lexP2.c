@@ -0,0 +1,12 @@
+// lexP2.c - Lexer benchmark: the lexer in "P2 Recognizer"
+
+#define LEXPFX(nam) p2_##nam
+#define LEXLEXEME   lexeme
+#include "lexwrap.h"
+
+#include "../P2 Recognizer/lex.c"
+#include "../P2 Recognizer/tok.c"
+#include "../P2 Recognizer/toks.c"
+#include "../P2 Recognizer/ut.c"
+
+#include "lexadapt.h"
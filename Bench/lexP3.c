@@ -0,0 +1,12 @@
+// lexP3.c - Lexer benchmark: the lexer in "P3 Parser"
+
+#define LEXPFX(nam) p3_##nam
+#define LEXLEXEME   lex
+#include "lexwrap.h"
+
+#include "../P3 Parser/lex.c"
+#include "../P3 Parser/tok.c"
+#include "../P3 Parser/toks.c"
+#include "../P3 Parser/ut.c"
+
+#include "lexadapt.h"
@@ -0,0 +1,12 @@
+// lexP4.c - Lexer benchmark: the lexer in "P4 CodeGen"
+
+#define LEXPFX(nam) p4_##nam
+#define LEXLEXEME   lex
+#include "lexwrap.h"
+
+#include "../P4 CodeGen/lex.c"
+#include "../P4 CodeGen/tok.c"
+#include "../P4 CodeGen/toks.c"
+#include "../P4 CodeGen/ut.c"
+
+#include "lexadapt.h"
@@ -0,0 +1,27 @@
+// lexadapt.h - Export one SubC lexer to the benchmark (see lexbench.h)
+//
+// #included at the end of each lexer wrapper, after that lexer's sources
+
+#pragma once
+
+// ============================================================================
+// Lex all of 'text', returning the lexer's own Toks container
+// ============================================================================
+void* LEXPFX(benchLex)(char* text) {
+  Lex* lex = lexNew(text);
+  return lexAll(lex);
+}
+
+// ============================================================================
+// Copy the Toks in 'p' (from benchLex) into 'out'.  Return how many
+// ============================================================================
+int LEXPFX(benchGet)(void* p, BenchTok* out) {
+  Toks* toks = (Toks*) p;
+  int numTok = toks->hiTokNum + 1;
+  for (int t = 0; t < numTok; ++t) {
+    out[t].kind = tokStr(toks->tok[t].kind);
+    out[t].num  = toks->tok[t].num;
+    out[t].lex  = toks->tok[t].LEXLEXEME;
+  }
+  return numTok;
+}
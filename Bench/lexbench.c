@@ -0,0 +1,339 @@
+// lexbench.c - Lexer throughput benchmark for the SubC lexers
+//
+// Generate a synthetic SubC corpus of each flavor (identifier-heavy,
+// comment-heavy, string-heavy, number-heavy), run every lexer over it several
+// times, check that each produces the same token stream as the P4 lexer, and
+// report throughput in MB/s and millions of tokens/s, as mean and standard
+// deviation over the repetitions.
+//
+// Usage: lexbench [-size <KB>] [-reps <n>] [-seed <n>] [-corpus <flavor>]
+//
+// All but the P4 lexer hold Tokens in a fixed-size array (MAXTOKNUM = 999),
+// so the corpus is generated as a sequence of small functions, and each
+// function is lexed by its own call to lexAll.  Every lexer sees the same
+// sequence.
+
+#include <math.h>       // sqrt
+#include <setjmp.h>     // setjmp, longjmp
+#include <stdio.h>      // printf
+#include <stdlib.h>     // malloc
+#include <string.h>     // strcmp
+#include <time.h>       // timespec_get
+
+#include "lexbench.h"
+
+typedef enum { CORPIDENT, CORPCOMMENT, CORPSTRING, CORPNUMBER } CORP;
+
+typedef struct {
+  char* name;                               // eg: "P1 Lexer/p2"
+  void* (*lex)(char* text);
+  int   (*get)(void* toks, BenchTok* out);
+} BenchLexer;
+
+#define LEXER(v, name) { name, v##_benchLex, v##_benchGet }
+
+BenchLexer g_lexers[] = {                   // g_lexers[0] is the reference
+  LEXER(p4,   "P4 CodeGen"),
+  LEXER(p3,   "P3 Parser"),
+  LEXER(p2,   "P2 Recognizer"),
+  LEXER(p1p4, "P1 Lexer/p4"),
+  LEXER(p1p3, "P1 Lexer/p3"),
+  LEXER(p1p2, "P1 Lexer/p2"),
+  LEXER(p1p1, "P1 Lexer/p1"),
+};
+#define NUMLEXER (int) (sizeof(g_lexers) / sizeof(g_lexers[0]))
+
+typedef struct {
+  char* buf;              // all chunks, each terminated by '\0'
+  int   size;             // bytes used in 'buf'
+  int   cap;              // bytes allocated for 'buf'
+  int*  start;            // start[c] = offset in 'buf' of chunk 'c'
+  int   numChunk;
+  int   numByte;          // bytes of SubC text, excluding the '\0's
+} Corpus;
+
+#define MAXCHUNKTOK 1000  // > MAXTOKNUM in the older lexers
+#define MAXSTM      80    // statements per function, keeping below MAXTOKNUM
+
+// ============================================================================
+// Allocation hooks for the lexers.  See lexbench.h
+// ============================================================================
+void** g_allocs   = NULL;
+int    g_numAlloc = 0;
+int    g_maxAlloc = 0;
+
+void* benchRecord(void* p) {
+  if (g_numAlloc == g_maxAlloc) {
+    g_maxAlloc = g_maxAlloc ? 2 * g_maxAlloc : 4096;
+    g_allocs = realloc(g_allocs, g_maxAlloc * sizeof(void*));
+  }
+  g_allocs[g_numAlloc++] = p;
+  return p;
+}
+
+void* benchCalloc(size_t num, size_t size) { return benchRecord(calloc(num, size)); }
+void* benchMalloc(size_t size)             { return benchRecord(malloc(size)); }
+
+// A realloc may move 'p': so update its record, rather than add another
+void* benchRealloc(void* p, size_t size) {
+  void* q = realloc(p, size);
+  for (int i = g_numAlloc - 1; p && i >= 0; --i) {
+    if (g_allocs[i] == p) { g_allocs[i] = q; return q; }
+  }
+  return benchRecord(q);
+}
+
+void benchFreeAll() {
+  for (int i = 0; i < g_numAlloc; ++i) free(g_allocs[i]);
+  g_numAlloc = 0;
+}
+
+jmp_buf g_abort;                            // where benchExit returns to
+
+void benchExit(int code) { longjmp(g_abort, 1); }
+
+// ============================================================================
+// A small, deterministic random number generator, so that every run of the
+// benchmark, on every machine, sees the same corpus for a given seed
+// ============================================================================
+unsigned g_seed = 12345;
+
+int benchRand(int n) {
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (int) ((g_seed >> 8) % (unsigned) n);
+}
+
+// ============================================================================
+// Append text to the current chunk of 'corp', printf-style
+// ============================================================================
+void corpPut(Corpus* corp, char* fmt, char* s1, char* s2, char* s3) {
+  if (corp->size + 300 > corp->cap) {
+    corp->cap = 2 * corp->cap + 4096;
+    corp->buf = realloc(corp->buf, corp->cap);
+  }
+  corp->size += sprintf(corp->buf + corp->size, fmt, s1, s2, s3);
+}
+
+// ============================================================================
+// Random lexemes: a name of 'lo' to 'hi' alphanumeric chars, a number, and a
+// run of words (for comments and strings).  Each fills, and returns, 'buf'
+// ============================================================================
+char* corpNam(char* buf, int lo, int hi) {
+  static char* alpha = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  static char* alnum = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  int len = lo + benchRand(hi - lo + 1);
+  buf[0] = alpha[benchRand(52)];
+  for (int i = 1; i < len; ++i) buf[i] = alnum[benchRand(62)];
+  buf[len] = '\0';
+
+  // Avoid accidentally generating a keyword
+
+  if (strcmp(buf, "if") == 0 || strcmp(buf, "int") == 0) buf[0] = 'z';
+  return buf;
+}
+
+char* corpNum(char* buf) {
+  int digits = 1 + benchRand(9);
+  int val = 1 + benchRand(9);
+  for (int i = 1; i < digits; ++i) val = 10 * val + benchRand(10);
+  sprintf(buf, "%d", val);
+  return buf;
+}
+
+char* corpWords(char* buf, int numWord) {
+  static char* words[] = { "the", "quick", "brown", "fox", "jumps", "over",
+    "lazy", "dog", "compiler", "token", "stream", "parse", "frame", "while" };
+  buf[0] = '\0';
+  for (int i = 0; i < numWord; ++i) {
+    strcat(buf, words[benchRand(14)]);
+    strcat(buf, i < numWord - 1 ? " " : "");
+  }
+  return buf;
+}
+
+// ============================================================================
+// Append one statement, of flavor 'flavor', onto 'corp'
+// ============================================================================
+void corpStm(Corpus* corp, CORP flavor) {
+  char b1[64], b2[64], b3[400];
+  switch (flavor) {
+    case CORPIDENT:
+      corpPut(corp, "  %s = %s + ", corpNam(b1, 6, 24), corpNam(b2, 6, 24), "");
+      corpPut(corp, "%s;\n", corpNam(b1, 6, 24), "", "");
+      break;
+    case CORPCOMMENT:
+      corpPut(corp, "  // %s\n", corpWords(b3, 6 + benchRand(12)), "", "");
+      corpPut(corp, "  // %s\n", corpWords(b3, 6 + benchRand(12)), "", "");
+      corpPut(corp, "  x = x + 1;\n", "", "", "");
+      break;
+    case CORPSTRING:
+      corpPut(corp, "  i = says(\"%s\");\n", corpWords(b3, 4 + benchRand(16)), "", "");
+      break;
+    case CORPNUMBER:
+      corpPut(corp, "  x = %s * %s;\n", corpNum(b1), corpNum(b2), "");
+      break;
+  }
+}
+
+// ============================================================================
+// Generate a corpus of flavor 'flavor' holding at least 'numByte' bytes of
+// SubC text, as a sequence of functions - one per chunk
+// ============================================================================
+Corpus* corpNew(CORP flavor, int numByte) {
+  Corpus* corp = calloc(sizeof(Corpus), 1);
+  int maxChunk = 0;
+  char b1[64];
+
+  while (corp->numByte < numByte) {
+    if (corp->numChunk == maxChunk) {
+      maxChunk = 2 * maxChunk + 64;
+      corp->start = realloc(corp->start, maxChunk * sizeof(int));
+    }
+    int start = corp->size;
+    corp->start[corp->numChunk++] = start;
+
+    corpPut(corp, "int %s(int x, int y) {\n  int i;\n", corpNam(b1, 3, 12), "", "");
+    int numStm = 1 + benchRand(MAXSTM);
+    for (int s = 0; s < numStm; ++s) corpStm(corp, flavor);
+    corpPut(corp, "  while (x < 10) { x = x + 1; }\n  return x;\n}\n", "", "", "");
+
+    corp->numByte += corp->size - start;
+    corp->buf[corp->size++] = '\0';           // end of chunk
+  }
+  return corp;
+}
+
+// ============================================================================
+// Check that lexer 'lx' produces the same tokens as the reference lexer on
+// every chunk of 'corp'.  Return the total number of tokens, or -1 on a
+// mismatch (after describing it)
+// ============================================================================
+int benchVerify(BenchLexer* lx, Corpus* corp) {
+  static BenchTok want[MAXCHUNKTOK], got[MAXCHUNKTOK];
+  int total = 0;
+
+  for (int c = 0; c < corp->numChunk; ++c) {
+    char* text = corp->buf + corp->start[c];
+    int numWant = g_lexers[0].get(g_lexers[0].lex(text), want);
+    int numGot  = lx->get(lx->lex(text), got);
+
+    for (int t = 0; t < numWant && t < numGot; ++t) {
+      int same = strcmp(want[t].kind, got[t].kind) == 0 &&
+        want[t].num == got[t].num &&
+        (want[t].lex == got[t].lex ||
+         (want[t].lex && got[t].lex && strcmp(want[t].lex, got[t].lex) == 0));
+      if (!same) {
+        printf("MISMATCH at function %d, token %d: expected %s '%s', found %s '%s'\n",
+          c, t, want[t].kind, want[t].lex ? want[t].lex : "",
+          got[t].kind, got[t].lex ? got[t].lex : "");
+        benchFreeAll();
+        return -1;
+      }
+    }
+    if (numWant != numGot) {
+      printf("MISMATCH at function %d: expected %d tokens, found %d\n",
+        c, numWant, numGot);
+      benchFreeAll();
+      return -1;
+    }
+    total += numGot;
+    benchFreeAll();
+  }
+  return total;
+}
+
+// ============================================================================
+// Return the time now, in seconds
+// ============================================================================
+double benchNow() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ============================================================================
+// Time 'reps' runs of lexer 'lx' over 'corp', and report its throughput
+// ============================================================================
+void benchRun(BenchLexer* lx, Corpus* corp, int numTok, int reps) {
+  double sumMB = 0, sumMB2 = 0, sumTok = 0, sumTok2 = 0;
+
+  for (int r = 0; r < reps; ++r) {
+    double t0 = benchNow();
+    for (int c = 0; c < corp->numChunk; ++c) lx->lex(corp->buf + corp->start[c]);
+    double secs = benchNow() - t0;
+    benchFreeAll();
+
+    double mbs  = corp->numByte / secs / 1e6;
+    double toks = numTok / secs / 1e6;
+    sumMB  += mbs;   sumMB2  += mbs * mbs;
+    sumTok += toks;  sumTok2 += toks * toks;
+  }
+
+  double meanMB  = sumMB / reps;
+  double meanTok = sumTok / reps;
+  double sdMB    = sqrt(fabs(sumMB2  / reps - meanMB  * meanMB));
+  double sdTok   = sqrt(fabs(sumTok2 / reps - meanTok * meanTok));
+
+  printf("%8.2f +- %6.2f  %8.2f +- %6.2f\n", meanMB, sdMB, meanTok, sdTok);
+}
+
+void usage() {
+  printf("\n\nUsage: lexbench [-size <KB>] [-reps <n>] [-seed <n>] "
+         "[-corpus ident|comment|string|number|all] \n\n");
+}
+
+int main(int argc, char* argv[]) {
+  int kb = 1024;                            // corpus size
+  int reps = 5;                             // repetitions per lexer
+  int only = -1;                            // -1 => every corpus flavor
+
+  char* flavors[] = { "ident", "comment", "string", "number" };
+
+  for (int a = 1; a < argc; ++a) {
+    if (a + 1 == argc) { usage(); exit(-1); }
+    if (strcmp(argv[a], "-size") == 0) {
+      kb = atoi(argv[++a]);
+    } else if (strcmp(argv[a], "-reps") == 0) {
+      reps = atoi(argv[++a]);
+    } else if (strcmp(argv[a], "-seed") == 0) {
+      g_seed = atoi(argv[++a]);
+    } else if (strcmp(argv[a], "-corpus") == 0) {
+      ++a;
+      for (int f = 0; f < 4; ++f) if (strcmp(argv[a], flavors[f]) == 0) only = f;
+      if (only < 0 && strcmp(argv[a], "all") != 0) { usage(); exit(-1); }
+    } else {
+      usage(); exit(-1);
+    }
+  }
+  if (kb < 1 || reps < 1) { usage(); exit(-1); }
+
+  for (int f = 0; f < 4; ++f) {
+    if (only >= 0 && f != only) continue;
+    Corpus* corp = corpNew((CORP) f, kb * 1024);
+
+    printf("\nCorpus %-8s %d bytes in %d functions, %d repetitions\n",
+      flavors[f], corp->numByte, corp->numChunk, reps);
+    printf("  %-14s %8s %10s %20s\n", "Lexer", "Tokens", "MB/s", "Mtok/s");
+
+    for (int x = 0; x < NUMLEXER; ++x) {
+      BenchLexer* lx = &g_lexers[x];
+      printf("  %-14s ", lx->name);
+      fflush(stdout);
+      if (setjmp(g_abort)) {
+        benchFreeAll();
+        printf("FAILED: lexer reported an error\n");
+        continue;
+      }
+      int numTok = benchVerify(lx, corp);
+      if (numTok < 0) continue;
+      printf("%8d ", numTok);
+      benchRun(lx, corp, numTok, reps);
+    }
+
+    free(corp->buf);
+    free(corp->start);
+    free(corp);
+  }
+  printf("\n");
+  return 0;
+}
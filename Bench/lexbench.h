@@ -0,0 +1,53 @@
+// lexbench.h - Lexer throughput benchmark for the SubC lexers
+//
+// Every lexer in this repo - the four P1 stages, plus the copies in P2, P3
+// and P4 - defines the same global names (lexAll, tokNew, toksAdd, utPause,
+// and so on), and the same type names (Lex, Tok, Toks) with differing
+// layouts.  So each one is compiled in its own translation unit (lexP1p1.c,
+// lexP4.c, etc) which #includes that lexer's .c files, with every global
+// name prefixed by lexwrap.h.  Each such unit exports just the two functions
+// declared below via LEXFUNS, which is all that lexbench.c needs.
+//
+// Build (from this directory):
+//    clang -O2 -o lexbench lex*.c -lm
+
+#pragma once
+
+#include <stddef.h>     // size_t
+
+// A Token in a form common to all lexers, so their outputs can be compared
+
+typedef struct {
+  char* kind;           // eg: "TOKNUM" - the lexers number TokKind differently
+  long  num;            // eg: 123 for TOKNUM
+  char* lex;            // lexeme, or NULL
+} BenchTok;
+
+// Allocation hooks.  Every malloc/calloc/realloc made by a lexer is recorded,
+// so the driver can free it all between runs (the lexers never free anything)
+
+void* benchCalloc(size_t num, size_t size);
+void  benchFreeAll();
+void* benchMalloc(size_t size);
+void* benchRealloc(void* p, size_t size);
+
+// A lexer that meets an error calls utPause, which waits for a key and then
+// calls exit.  Instead, benchExit returns control to the driver.
+
+void  benchExit(int code);
+
+// Each lexer variant 'v' exports:
+//    void* v_benchLex(char* text)                   : lexNew + lexAll
+//    int   v_benchGet(void* toks, BenchTok* out)    : copy Toks out
+
+#define LEXFUNS(v)                                                  \
+  void* v##_benchLex(char* text);                                   \
+  int   v##_benchGet(void* toks, BenchTok* out);
+
+LEXFUNS(p1p1)
+LEXFUNS(p1p2)
+LEXFUNS(p1p3)
+LEXFUNS(p1p4)
+LEXFUNS(p2)
+LEXFUNS(p3)
+LEXFUNS(p4)
@@ -0,0 +1,77 @@
+// lexwrap.h - Prefix every global name of one SubC lexer (see lexbench.h)
+//
+// Usage, in a wrapper such as lexP1p1.c:
+//    #define LEXPFX(nam) p1p1_##nam        // prefix for this variant
+//    #define LEXLEXEME   lexeme            // name of the Tok lexeme field
+//    #include "lexwrap.h"
+//    #include "../P1 Lexer/p1/lex.c"       // ... and tok.c, toks.c, ut.c
+//    #include "lexadapt.h"
+
+#pragma once
+
+// Pull in the system headers first, so that the malloc/calloc/realloc macros
+// below only capture the calls made by the lexer itself.  Every block they
+// record is freed by benchFreeAll, so the lexer's own calls to free are dropped
+
+#include <ctype.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lexbench.h"
+
+#define malloc(size)        benchMalloc(size)
+#define calloc(num, size)   benchCalloc(num, size)
+#define realloc(p, size)    benchRealloc(p, size)
+#define free(p)             ((void) 0)
+#define exit(code)          benchExit(code)
+#define getchar()           ((void) 0)
+#define printf(...)         ((void) 0)
+
+#define lexAll              LEXPFX(lexAll)
+#define lexFill             LEXPFX(lexFill)
+#define lexKeyword          LEXPFX(lexKeyword)
+#define lexMove1            LEXPFX(lexMove1)
+#define lexNam              LEXPFX(lexNam)
+#define lexNew              LEXPFX(lexNew)
+#define lexNext             LEXPFX(lexNext)
+#define lexNum              LEXPFX(lexNum)
+#define lexPeek0            LEXPFX(lexPeek0)
+#define lexPeek1            LEXPFX(lexPeek1)
+#define lexPun              LEXPFX(lexPun)
+#define lexSkip             LEXPFX(lexSkip)
+#define lexSkipComment      LEXPFX(lexSkipComment)
+#define lexStr              LEXPFX(lexStr)
+#define lexStream           LEXPFX(lexStream)
+#define tokNew              LEXPFX(tokNew)
+#define tokSetStr           LEXPFX(tokSetStr)
+#define tokStr              LEXPFX(tokStr)
+#define toksAdd             LEXPFX(toksAdd)
+#define toksAtEnd           LEXPFX(toksAtEnd)
+#define toksCacheName       LEXPFX(toksCacheName)
+#define toksCurr            LEXPFX(toksCurr)
+#define toksDump            LEXPFX(toksDump)
+#define toksLoad            LEXPFX(toksLoad)
+#define toksNew             LEXPFX(toksNew)
+#define toksNewStream       LEXPFX(toksNewStream)
+#define toksNext            LEXPFX(toksNext)
+#define toksPeek            LEXPFX(toksPeek)
+#define toksPeek2           LEXPFX(toksPeek2)
+#define toksPrev            LEXPFX(toksPrev)
+#define toksRewind          LEXPFX(toksRewind)
+#define toksSave            LEXPFX(toksSave)
+#define utCacheName         LEXPFX(utCacheName)
+#define utDie2Str           LEXPFX(utDie2Str)
+#define utDie2StrCharLC     LEXPFX(utDie2StrCharLC)
+#define utDie2StrInt        LEXPFX(utDie2StrInt)
+#define utDie3Str           LEXPFX(utDie3Str)
+#define utDie4Str           LEXPFX(utDie4Str)
+#define utDie5Str           LEXPFX(utDie5Str)
+#define utDieStrTokStr      LEXPFX(utDieStrTokStr)
+#define utHash              LEXPFX(utHash)
+#define utMapFile           LEXPFX(utMapFile)
+#define utPause             LEXPFX(utPause)
+#define utReadFile          LEXPFX(utReadFile)
+#define utStrndup           LEXPFX(utStrndup)
@@ -0,0 +1,254 @@
+// psebench.c - Parser benchmark for the P4 SubC parser
+//
+// Generate a synthetic SubC program, lex it, then time 'reps' runs of each
+// parser over its Toks - pseProg (recursive descent), ll1Prog (table driven)
+// and jobProg (pseFun for each function, on a pool of 'threads' threads) -
+// reporting ns per token (mean and standard deviation over the
+// repetitions).  Two shapes of program are generated:
+//
+//    shallow : ordinary code - long runs of statements, with if and while
+//              blocks nested at most 3 deep
+//    deep    : a single function whose body is 'depth' nested while blocks,
+//              as found in machine-generated SubC
+//
+// Then compare the two ways of feeding Toks to the parser, end to end - read
+// the shallow program from a file, lex and parse it - each in a fresh process,
+// reporting elapsed time and peak resident set size (RSS):
+//
+//    twopass : lexAll into a Toks array, then pseProg
+//    stream  : pseProg over lexStream, which lexes each Tok on demand
+//    pipe    : pseProg over pipeStart, which lexes on a second thread,
+//              publishing 'batch' Toks at a time
+//
+// Usage: psebench [-size <KB>] [-depth <n>] [-reps <n>] [-batch <n>]
+//                 [-threads <n>]
+//
+// Build (from this directory):
+//    clang -O2 -o psebench psebench.c -lm -lpthread
+
+#include <math.h>       // sqrt
+#include <time.h>       // timespec_get
+#include <unistd.h>     // close, unlink, write
+
+#include "../P4 CodeGen/ast.c"
+#include "../P4 CodeGen/job.c"
+#include "../P4 CodeGen/lex.c"
+#include "../P4 CodeGen/ll1.c"
+#include "../P4 CodeGen/pipe.c"
+#include "../P4 CodeGen/pse.c"
+#include "../P4 CodeGen/tok.c"
+#include "../P4 CodeGen/toks.c"
+#include "../P4 CodeGen/ut.c"
+
+typedef struct {
+  char* buf;
+  int   size;
+  int   cap;
+} Text;
+
+// ============================================================================
+// Append 's' onto 'text'
+// ============================================================================
+void textPut(Text* text, char* s) {
+  int len = strlen(s);
+  if (text->size + len + 1 > text->cap) {
+    text->cap = 2 * text->cap + len + 4096;
+    text->buf = realloc(text->buf, text->cap);
+  }
+  memcpy(text->buf + text->size, s, len + 1);
+  text->size += len;
+}
+
+// ============================================================================
+// Generate ordinary, shallow SubC of at least 'numByte' bytes
+// ============================================================================
+char* benchShallow(int numByte) {
+  Text text = { NULL, 0, 0 };
+  char line[200];
+  int fun = 0;
+  while (text.size < numByte) {
+    sprintf(line, "int f%d(int a, int b) {\n  int x;\n  int y;\n", fun++);
+    textPut(&text, line);
+    for (int s = 0; s < 40; ++s) {
+      textPut(&text, "  x = a + b;\n  y = f0(x, 7, b);\n");
+      if (s % 8 == 0) {
+        textPut(&text, "  if (x < 10) {\n    while (y > 0) {\n");
+        textPut(&text, "      if (y == 3) { x = x * 2; }\n      y = y - 1;\n");
+        textPut(&text, "    }\n  }\n");
+      }
+    }
+    textPut(&text, "  return x;\n}\n");
+  }
+  return text.buf;
+}
+
+// ============================================================================
+// Generate a function whose body nests 'depth' while blocks
+// ============================================================================
+char* benchDeep(int depth) {
+  Text text = { NULL, 0, 0 };
+  textPut(&text, "int main() {\n  int x;\n");
+  for (int d = 0; d < depth; ++d) textPut(&text, "while (x < 10) {\n");
+  textPut(&text, "x = x + 1;\n");
+  for (int d = 0; d < depth; ++d) textPut(&text, "}\n");
+  textPut(&text, "  return x;\n}\n");
+  return text.buf;
+}
+
+// ============================================================================
+// Return the time now, in seconds
+// ============================================================================
+double benchNow() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int benchThreads = 4;                       // for benchJob
+
+// ============================================================================
+// Parse 'toks' with jobProg, on 'benchThreads' threads
+// ============================================================================
+AstProg* benchJob(Toks* toks) { return jobProg(toks, benchThreads); }
+
+// ============================================================================
+// Time 'reps' runs of 'parse' over 'toks', and report
+// ============================================================================
+void benchParse(char* name, AstProg* (*parse)(Toks*), Toks* toks, int reps) {
+  int numTok = toks->hiTokNum + 1;
+  double sum = 0, sum2 = 0;
+
+  for (int r = 0; r < reps; ++r) {
+    toksRewind(toks);
+    double t0 = benchNow();
+    parse(toks);
+    double ns = (benchNow() - t0) * 1e9 / numTok;
+    sum += ns;  sum2 += ns * ns;
+  }
+
+  double mean = sum / reps;
+  double sd = sqrt(fabs(sum2 / reps - mean * mean));
+  printf("  %-12s %10d tokens  %8.2f +- %5.2f ns/token\n", name, numTok, mean, sd);
+}
+
+// ============================================================================
+// Run a fresh copy of this program ('self'), as
+// "psebench -run <mode> <path> <batch>", 'reps' times.  Report its mean elapsed time, and its peak RSS, as reported
+// back by the child itself.  (Not by wait4: on Linux, the child's ru_maxrss
+// would include the pages of this, much bigger, parent, from before the exec)
+// ============================================================================
+void benchPipe(char* self, char* mode, char* path, int batch, int reps) {
+  char cmd[1000];
+  sprintf(cmd, "'%s' -run %s '%s' %d", self, mode, path, batch);
+
+  double sum = 0, sum2 = 0;
+  long maxHwm = 0;                                // KB
+
+  for (int r = 0; r < reps; ++r) {
+    double ms = 0;
+    long hwm = 0;
+    FILE* child = popen(cmd, "r");
+    int got = child ? fscanf(child, "%lf %ld", &ms, &hwm) : 0;
+    if (child == NULL || pclose(child) != 0 || got != 2) {
+      printf("  %-12s FAILED \n", mode);
+      return;
+    }
+    sum += ms;  sum2 += ms * ms;
+    if (hwm > maxHwm) maxHwm = hwm;
+  }
+
+  double mean = sum / reps;
+  double sd = sqrt(fabs(sum2 / reps - mean * mean));
+  printf("  %-12s %8.1f +- %5.1f ms  %8.1f MB peak RSS\n", mode, mean, sd, maxHwm / 1024.0);
+}
+
+// ============================================================================
+// The child side of benchPipe: read the file 'path', then lex and parse it,
+// in the way given by 'mode' (and 'batch').  Print the time taken, in ms, and the peak RSS
+// of this process, in KB (VmHWM, from /proc/self/status)
+// ============================================================================
+int benchRun(char* mode, char* path, int batch) {
+  double t0 = benchNow();
+  char* text = utReadFile(path);
+  Toks* toks;
+  if (strcmp(mode, "stream") == 0) {
+    toks = lexStream(lexNew(text));
+  } else if (strcmp(mode, "pipe") == 0) {
+    toks = pipeStart(lexNew(text), batch);
+  } else {
+    toks = lexAll(lexNew(text));
+    toksRewind(toks);
+  }
+  pseProg(toks);
+  double ms = (benchNow() - t0) * 1e3;
+
+  long hwm = 0;
+  char line[200];
+  FILE* fp = fopen("/proc/self/status", "r");
+  while (fp && fgets(line, sizeof(line), fp)) {
+    if (strncmp(line, "VmHWM:", 6) == 0) hwm = atol(line + 6);
+  }
+  if (fp) fclose(fp);
+
+  printf("%f %ld\n", ms, hwm);
+  return 0;
+}
+
+void usage() {
+  printf("\n\nUsage: psebench [-size <KB>] [-depth <n>] [-reps <n>] [-batch <n>] [-threads <n>] \n\n");
+}
+
+int main(int argc, char* argv[]) {
+  int kb = 4096;                            // size of the shallow program
+  int depth = 100000;                       // nesting of the deep program
+  int reps = 5;
+  int batch = PIPEBATCH;                    // Toks per publish, for "pipe"
+
+  if (argc == 5 && strcmp(argv[1], "-run") == 0) {
+    return benchRun(argv[2], argv[3], atoi(argv[4]));
+  }
+
+  for (int a = 1; a < argc; ++a) {
+    if (a + 1 == argc) { usage(); exit(-1); }
+    if (strcmp(argv[a], "-size") == 0) {
+      kb = atoi(argv[++a]);
+    } else if (strcmp(argv[a], "-depth") == 0) {
+      depth = atoi(argv[++a]);
+    } else if (strcmp(argv[a], "-reps") == 0) {
+      reps = atoi(argv[++a]);
+    } else if (strcmp(argv[a], "-batch") == 0) {
+      batch = atoi(argv[++a]);
+    } else if (strcmp(argv[a], "-threads") == 0) {
+      benchThreads = atoi(argv[++a]);
+    } else {
+      usage(); exit(-1);
+    }
+  }
+  if (kb < 1 || depth < 1 || reps < 1 || batch < 1 || benchThreads < 1) { usage(); exit(-1); }
+
+  printf("\nParser: %d repetitions\n", reps);
+  char* text = benchShallow(kb * 1024);
+  Toks* shallow = lexAll(lexNew(text));
+  Toks* deep = lexAll(lexNew(benchDeep(depth)));
+  benchParse("shallow pse", pseProg, shallow, reps);
+  benchParse("shallow ll1", ll1Prog, shallow, reps);
+  benchParse("shallow job", benchJob, shallow, reps);
+  benchParse("deep pse", pseProg, deep, reps);
+  benchParse("deep ll1", ll1Prog, deep, reps);
+
+  char path[] = "/tmp/psebenchXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0 || write(fd, text, strlen(text)) != (ssize_t) strlen(text)) {
+    printf("\nCannot write %s \n", path);
+    exit(-1);
+  }
+  close(fd);
+
+  printf("\nFront end, read + lex + parse %d KB, in a fresh process: %d repetitions\n", kb, reps);
+  benchPipe(argv[0], "twopass", path, batch, reps);
+  benchPipe(argv[0], "stream", path, batch, reps);
+  benchPipe(argv[0], "pipe", path, batch, reps);
+  unlink(path);
+  printf("\n");
+  return 0;
+}
@@ -0,0 +1,459 @@
+// ll1gen.c - LL(1) parse table generator for SubC
+//
+// Read a grammar (such as "P4 CodeGen/subc.grm") and write a C header of
+// static const tables that drive the table-driven parser in "P4 CodeGen/ll1.c":
+//
+//    llProd     : every production - its nonterminal, action and Syms
+//    llFirst    : FIRST set of each nonterminal, as a TokSet
+//    llFollow   : FOLLOW set of each nonterminal, as a TokSet
+//    llNullable : whether each nonterminal can match no Tokens
+//    llPredict  : for nonterminal 'nt' and current TokKind 'k', which
+//                 production to expand
+//
+// If the grammar is not LL(1) - two productions of one nonterminal predicted
+// by the same Token - report every such conflict, and write nothing.
+//
+// Terminals are written into the tables by name (eg: TOKNAM), so the tables
+// do not depend on how tok.h happens to number its TokKinds.
+//
+// Usage: ll1gen <grammar> <output>
+//
+// Build and run (from this directory):
+//    clang -O2 -o ll1gen ll1gen.c
+//    ./ll1gen "../P4 CodeGen/subc.grm" "../P4 CodeGen/ll1tab.h"
+
+#include <ctype.h>      // isalnum, isspace, toupper
+#include <stdio.h>      // fopen, fprintf
+#include <stdlib.h>     // exit
+#include <string.h>     // strcmp, strncmp
+
+#define MAXNAM   32     // longest name of a Sym or action
+#define MAXSYM   128    // most Syms (terminals + nonterminals)
+#define MAXPROD  256    // most productions
+#define MAXRHS   16     // most Syms on the right-hand side of a production
+#define MAXACT   64     // most distinct actions
+#define MAXLINE  1000   // longest line in the grammar file
+
+typedef unsigned long long Set;   // set of terminals: bit 't' for Sym 't'
+
+typedef struct {
+  char nam[MAXNAM];     // eg: "TOKNAM", "Stms"
+  int  term;            // 1 for a terminal, 0 for a nonterminal
+  int  defined;         // nonterminal: 1 once its rule has been seen
+  int  nt;              // nonterminal: number in order of definition
+  int  nullable;        // nonterminal: can derive no Tokens
+  Set  first;           // nonterminal: FIRST set
+  Set  follow;          // nonterminal: FOLLOW set
+} Sym;
+
+typedef struct {
+  int  lhs;             // Sym of the nonterminal defined
+  int  act;             // index into g_act, or 0 for none
+  int  len;             // number of Syms on the right-hand side ...
+  int  rhs[MAXRHS];     // ... and those Syms
+  int  lin;             // line number in the grammar file
+} Prod;
+
+Sym  g_sym[MAXSYM];    int g_numSym  = 0;
+Prod g_prod[MAXPROD];  int g_numProd = 0;
+char g_act[MAXACT][MAXNAM] = { "NONE" };   int g_numAct = 1;
+int  g_numNt = 0;       // number of nonterminals
+int  g_numTerm = 0;     // number of terminals - must fit in a Set
+int  g_pred[MAXSYM][MAXSYM];    // [nt][terminal Sym] = 1 + production
+
+void  genDie(int lin, char* msg, char* nam);
+int   genFindAct(char* nam, int lin);
+int   genFindSym(char* nam, int lin);
+void  genFirstFollow();
+Set   genFirstOf(int* syms, int num);
+char* genNtName(int s, char* buf);
+int   genNullable(int* syms, int num);
+int   genPredict();
+void  genRead(char* path);
+Prod* genStartProd(int lhs, int lin);
+void  genWrite(char* path, char* grmPath);
+void  genWriteSet(FILE* fp, Set set);
+
+// ============================================================================
+// Report an error at line 'lin' of the grammar, and quit
+// ============================================================================
+void genDie(int lin, char* msg, char* nam) {
+  fprintf(stderr, "ERROR: ll1gen: line %d: %s %s \n", lin, msg, nam);
+  exit(1);
+}
+
+// ============================================================================
+// Find the action called 'nam', adding it if new
+// ============================================================================
+int genFindAct(char* nam, int lin) {
+  for (int a = 1; a < g_numAct; ++a) {
+    if (strcmp(g_act[a], nam) == 0) return a;
+  }
+  if (g_numAct == MAXACT || strlen(nam) >= MAXNAM) genDie(lin, "Too many, or too long, actions at", nam);
+  strcpy(g_act[g_numAct], nam);
+  return g_numAct++;
+}
+
+// ============================================================================
+// Find the Sym called 'nam', adding it if new.  A name that starts "TOK" is a
+// terminal; any other name is a nonterminal
+// ============================================================================
+int genFindSym(char* nam, int lin) {
+  for (int s = 0; s < g_numSym; ++s) {
+    if (strcmp(g_sym[s].nam, nam) == 0) return s;
+  }
+  if (g_numSym == MAXSYM || strlen(nam) >= MAXNAM) genDie(lin, "Too many, or too long, Syms at", nam);
+  Sym* sym = &g_sym[g_numSym];
+  strcpy(sym->nam, nam);
+  sym->term = strncmp(nam, "TOK", 3) == 0;
+  return g_numSym++;
+}
+
+// ============================================================================
+// Calculate FIRST and FOLLOW sets, and nullability, for every nonterminal.
+// Iterate over all productions until nothing changes.
+// ============================================================================
+void genFirstFollow() {
+  int changed = 1;
+  while (changed) {
+    changed = 0;
+    for (int p = 0; p < g_numProd; ++p) {
+      Prod* prod = &g_prod[p];
+      Sym* lhs = &g_sym[prod->lhs];
+      Set first = genFirstOf(prod->rhs, prod->len);
+      if ((lhs->first | first) != lhs->first) { lhs->first |= first; changed = 1; }
+      if (!lhs->nullable && genNullable(prod->rhs, prod->len)) { lhs->nullable = 1; changed = 1; }
+    }
+  }
+
+  int eof = genFindSym("TOKEOF", 0);
+  g_sym[g_prod[0].lhs].follow = 1ull << eof;      // start symbol ends the Toks
+
+  changed = 1;
+  while (changed) {
+    changed = 0;
+    for (int p = 0; p < g_numProd; ++p) {
+      Prod* prod = &g_prod[p];
+      for (int r = 0; r < prod->len; ++r) {
+        Sym* sym = &g_sym[prod->rhs[r]];
+        if (sym->term) continue;
+        int* rest = &prod->rhs[r + 1];
+        int  numRest = prod->len - r - 1;
+        Set follow = genFirstOf(rest, numRest);
+        if (genNullable(rest, numRest)) follow |= g_sym[prod->lhs].follow;
+        if ((sym->follow | follow) != sym->follow) { sym->follow |= follow; changed = 1; }
+      }
+    }
+  }
+}
+
+// ============================================================================
+// Calculate the FIRST set of the string of 'num' Syms 'syms'
+// ============================================================================
+Set genFirstOf(int* syms, int num) {
+  Set first = 0;
+  for (int i = 0; i < num; ++i) {
+    Sym* sym = &g_sym[syms[i]];
+    if (sym->term) return first | (1ull << syms[i]);
+    first |= sym->first;
+    if (!sym->nullable) return first;
+  }
+  return first;
+}
+
+// ============================================================================
+// Write the name of the enum constant for Sym 's' (eg: "NTSTMS") into 'buf'
+// ============================================================================
+char* genNtName(int s, char* buf) {
+  strcpy(buf, "NT");
+  for (char* p = g_sym[s].nam; *p; ++p) {
+    int len = strlen(buf);
+    buf[len] = toupper(*p);  buf[len + 1] = '\0';
+  }
+  return buf;
+}
+
+// ============================================================================
+// Check whether the string of 'num' Syms 'syms' can derive no Tokens
+// ============================================================================
+int genNullable(int* syms, int num) {
+  for (int i = 0; i < num; ++i) {
+    Sym* sym = &g_sym[syms[i]];
+    if (sym->term || !sym->nullable) return 0;
+  }
+  return 1;
+}
+
+// ============================================================================
+// Build the predict table.  Return the number of LL(1) conflicts found.
+// ============================================================================
+int genPredict() {
+  int numConflict = 0;
+  for (int p = 0; p < g_numProd; ++p) {
+    Prod* prod = &g_prod[p];
+    Sym* lhs = &g_sym[prod->lhs];
+    Set set = genFirstOf(prod->rhs, prod->len);
+    if (genNullable(prod->rhs, prod->len)) set |= lhs->follow;
+    for (int t = 0; t < g_numSym; ++t) {
+      if ((set & (1ull << t)) == 0) continue;
+      int* pred = &g_pred[lhs->nt][t];
+      if (*pred != 0) {
+        fprintf(stderr, "ERROR: ll1gen: LL(1) conflict in %s on %s, between lines %d and %d \n",
+          lhs->nam, g_sym[t].nam, g_prod[*pred - 1].lin, prod->lin);
+        ++numConflict;
+      } else {
+        *pred = 1 + p;
+      }
+    }
+  }
+  return numConflict;
+}
+
+// ============================================================================
+// Read the grammar from file 'path'
+// ============================================================================
+void genRead(char* path) {
+  FILE* fp = fopen(path, "r");
+  if (fp == NULL) genDie(0, "Cannot open grammar file", path);
+
+  char line[MAXLINE];
+  int lin = 0;
+  int lhs = -1;                     // nonterminal of the current rule
+  Prod* prod = NULL;                // production being read
+
+  while (fgets(line, MAXLINE, fp)) {
+    ++lin;
+    char* cmt = strstr(line, "//");
+    if (cmt) *cmt = '\0';
+
+    char* p = line;
+    char  nam[MAXNAM];
+    int   numWord = 0;
+    for (;;) {
+      while (isspace(*p)) ++p;
+      if (*p == '\0') break;
+      int len = 0;
+      if (*p == '|' ) {
+        nam[len++] = *p++;
+      } else if (p[0] == '=' && p[1] == '>') {
+        nam[len++] = *p++;  nam[len++] = *p++;
+      } else {
+        while (*p == '@' || *p == '_' || isalnum(*p)) {
+          if (len == MAXNAM - 1) genDie(lin, "Name too long at", p);
+          nam[len++] = *p++;
+        }
+        if (len == 0) genDie(lin, "Unexpected character at", p);
+      }
+      nam[len] = '\0';
+      ++numWord;
+
+      if (strcmp(nam, "=>") == 0) {                 // "Name =>" starts a rule
+        if (numWord != 2 || prod == NULL || prod->len != 1) genDie(lin, "Misplaced", nam);
+        lhs = prod->rhs[0];
+        if (g_sym[lhs].term) genDie(lin, "Terminal on the left of =>:", g_sym[lhs].nam);
+        if (g_sym[lhs].defined) genDie(lin, "Rule defined twice:", g_sym[lhs].nam);
+        g_sym[lhs].defined = 1;
+        g_sym[lhs].nt = g_numNt++;
+        prod->lhs = lhs;
+        prod->len = 0;
+      } else if (strcmp(nam, "|") == 0) {           // next alternative
+        if (lhs < 0) genDie(lin, "Misplaced", nam);
+        prod = genStartProd(lhs, lin);
+      } else if (nam[0] == '@') {                   // action
+        if (prod == NULL || prod->act) genDie(lin, "Misplaced action", nam);
+        prod->act = genFindAct(nam + 1, lin);
+      } else {                                      // Sym
+        if (numWord == 1) prod = genStartProd(-1, lin);    // maybe a new rule
+        if (prod == NULL) genDie(lin, "Misplaced", nam);
+        if (prod->len == MAXRHS) genDie(lin, "Too many Syms at", nam);
+        prod->rhs[prod->len++] = genFindSym(nam, lin);
+      }
+    }
+  }
+  fclose(fp);
+
+  if (g_numProd == 0) genDie(lin, "No rules in", path);
+
+  for (int p = 0; p < g_numProd; ++p) {
+    if (g_prod[p].lhs < 0) genDie(g_prod[p].lin, "Expecting =>, after", g_sym[g_prod[p].rhs[0]].nam);
+  }
+
+  genFindSym("TOKEOF", lin);       // what follows the start symbol
+
+  for (int s = 0; s < g_numSym; ++s) {
+    if (g_sym[s].term) {
+      ++g_numTerm;
+    } else if (!g_sym[s].defined) {
+      genDie(0, "No rule defines", g_sym[s].nam);
+    }
+  }
+  if (g_numSym > 64) genDie(0, "Too many Syms for a Set in", path);
+}
+
+// ============================================================================
+// Start a new production for nonterminal 'lhs' (-1 if not yet known)
+// ============================================================================
+Prod* genStartProd(int lhs, int lin) {
+  if (g_numProd == MAXPROD) genDie(lin, "Too many productions", "");
+  Prod* prod = &g_prod[g_numProd++];
+  prod->lhs = lhs;
+  prod->lin = lin;
+  return prod;
+}
+
+// ============================================================================
+// Write all the tables, into file 'path'
+// ============================================================================
+void genWrite(char* path, char* grmPath) {
+  FILE* fp = fopen(path, "w");
+  if (fp == NULL) genDie(0, "Cannot create", path);
+
+  char buf[2 * MAXNAM];
+  int maxRhs = 1;
+  for (int p = 0; p < g_numProd; ++p) {
+    if (g_prod[p].len > maxRhs) maxRhs = g_prod[p].len;
+  }
+
+  fprintf(fp, "// ll1tab.h - LL(1) parse tables for SubC, generated by Gen/ll1gen from %s\n", grmPath);
+  fprintf(fp, "//\n");
+  fprintf(fp, "// DO NOT EDIT.  Change the grammar instead, then rebuild this file.  From the\n");
+  fprintf(fp, "// Gen directory:\n");
+  fprintf(fp, "//    clang -O2 -o ll1gen ll1gen.c\n");
+  fprintf(fp, "//    ./ll1gen \"../P4 CodeGen/subc.grm\" \"../P4 CodeGen/ll1tab.h\"\n\n");
+  fprintf(fp, "#pragma once\n\n");
+  fprintf(fp, "#include \"tok.h\"        // TokKind, TokSet\n\n");
+
+  fprintf(fp, "typedef enum {\n");
+  for (int s = 0; s < g_numSym; ++s) {
+    if (!g_sym[s].term) fprintf(fp, "  %s,\n", genNtName(s, buf));
+  }
+  fprintf(fp, "} LlNt;\n\n");
+
+  fprintf(fp, "typedef enum {\n");
+  for (int a = 0; a < g_numAct; ++a) {
+    strcpy(buf, "ACT");
+    for (char* p = g_act[a]; *p; ++p) { int len = strlen(buf); buf[len] = toupper(*p); buf[len + 1] = '\0'; }
+    fprintf(fp, "  %s,\n", buf);
+  }
+  fprintf(fp, "} LlAct;\n\n");
+
+  fprintf(fp, "#define LLNUMNT   %-4d     // number of nonterminals\n", g_numNt);
+  fprintf(fp, "#define LLNUMPROD %-4d     // number of productions\n", g_numProd);
+  fprintf(fp, "#define LLNUMTOK  32       // every TokKind fits in a TokSet, so is < 32\n");
+  fprintf(fp, "#define LLMAXRHS  %-4d     // most Syms on the right of any production\n", maxRhs);
+  fprintf(fp, "#define LLNT      LLNUMTOK // Sym 's' is a TokKind if s < LLNT, else nonterminal s - LLNT\n\n");
+
+  fprintf(fp, "typedef struct {\n");
+  fprintf(fp, "  short lhs;              // nonterminal defined, eg: NTIF\n");
+  fprintf(fp, "  short act;              // action that builds its value, eg: ACTIF\n");
+  fprintf(fp, "  short len;              // number of Syms on the right ...\n");
+  fprintf(fp, "  short rhs[LLMAXRHS];    // ... and those Syms\n");
+  fprintf(fp, "} LlProd;\n\n");
+
+  fprintf(fp, "static const LlProd llProd[LLNUMPROD] = {\n");
+  for (int p = 0; p < g_numProd; ++p) {
+    Prod* prod = &g_prod[p];
+    fprintf(fp, "  { %s, ACT", genNtName(prod->lhs, buf));
+    for (char* c = g_act[prod->act]; *c; ++c) fputc(toupper(*c), fp);
+    fprintf(fp, ", %d, {", prod->len);
+    if (prod->len == 0) fprintf(fp, " 0");
+    for (int r = 0; r < prod->len; ++r) {
+      int s = prod->rhs[r];
+      fprintf(fp, "%s ", r ? "," : "");
+      if (g_sym[s].term) {
+        fprintf(fp, "%s", g_sym[s].nam);
+      } else {
+        fprintf(fp, "LLNT + %s", genNtName(s, buf));
+      }
+    }
+    fprintf(fp, " } },    // %d: %s =>", p, g_sym[prod->lhs].nam);
+    for (int r = 0; r < prod->len; ++r) fprintf(fp, " %s", g_sym[prod->rhs[r]].nam);
+    fprintf(fp, "\n");
+  }
+  fprintf(fp, "};\n\n");
+
+  fprintf(fp, "static const char* llNtStr[LLNUMNT] = {\n");
+  for (int s = 0; s < g_numSym; ++s) {
+    if (!g_sym[s].term) fprintf(fp, "  \"%s\",\n", g_sym[s].nam);
+  }
+  fprintf(fp, "};\n\n");
+
+  fprintf(fp, "static const char llNullable[LLNUMNT] = {\n");
+  for (int s = 0; s < g_numSym; ++s) {
+    if (!g_sym[s].term) fprintf(fp, "  [%s] = %d,\n", genNtName(s, buf), g_sym[s].nullable);
+  }
+  fprintf(fp, "};\n\n");
+
+  fprintf(fp, "static const TokSet llFirst[LLNUMNT] = {\n");
+  for (int s = 0; s < g_numSym; ++s) {
+    if (g_sym[s].term) continue;
+    fprintf(fp, "  [%s] = ", genNtName(s, buf));
+    genWriteSet(fp, g_sym[s].first);
+    fprintf(fp, ",\n");
+  }
+  fprintf(fp, "};\n\n");
+
+  fprintf(fp, "static const TokSet llFollow[LLNUMNT] = {\n");
+  for (int s = 0; s < g_numSym; ++s) {
+    if (g_sym[s].term) continue;
+    fprintf(fp, "  [%s] = ", genNtName(s, buf));
+    genWriteSet(fp, g_sym[s].follow);
+    fprintf(fp, ",\n");
+  }
+  fprintf(fp, "};\n\n");
+
+  fprintf(fp, "// llPredict[nt][k] is 1 + the production that expands nonterminal 'nt' when\n");
+  fprintf(fp, "// the current Token has kind 'k'; or 0 if that Token is a syntax error\n\n");
+  fprintf(fp, "static const unsigned char llPredict[LLNUMNT][LLNUMTOK] = {\n");
+  for (int s = 0; s < g_numSym; ++s) {
+    if (g_sym[s].term) continue;
+    fprintf(fp, "  [%s] = {", genNtName(s, buf));
+    char* sep = " ";
+    for (int t = 0; t < g_numSym; ++t) {
+      int pred = g_pred[g_sym[s].nt][t];
+      if (pred == 0) continue;
+      fprintf(fp, "%s[%s] = %d", sep, g_sym[t].nam, pred);
+      sep = ", ";
+    }
+    fprintf(fp, " },\n");
+  }
+  fprintf(fp, "};\n");
+
+  fclose(fp);
+}
+
+// ============================================================================
+// Write 'set' as a C expression, eg: "TOKSET(TOKNAM) | TOKSET(TOKNUM)"
+// ============================================================================
+void genWriteSet(FILE* fp, Set set) {
+  if (set == 0) { fprintf(fp, "0"); return; }
+  char* sep = "";
+  for (int t = 0; t < g_numSym; ++t) {
+    if (set & (1ull << t)) {
+      fprintf(fp, "%sTOKSET(%s)", sep, g_sym[t].nam);
+      sep = " | ";
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    printf("\n\nUsage: ll1gen <grammar> <output> \n\n");
+    exit(1);
+  }
+
+  genRead(argv[1]);
+  genFirstFollow();
+  int numConflict = genPredict();
+  if (numConflict) {
+    fprintf(stderr, "ERROR: ll1gen: grammar is not LL(1) - %d conflicts \n", numConflict);
+    exit(1);
+  }
+
+  char* grmName = strrchr(argv[1], '/');
+  genWrite(argv[2], grmName ? grmName + 1 : argv[1]);
+
+  printf("ll1gen: %d nonterminals, %d terminals, %d productions \n",
+    g_numNt, g_numTerm, g_numProd);
+  return 0;
+}
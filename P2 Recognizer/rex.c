@@ -6,7 +6,7 @@
 // Arg => NamNum | Str
 // ============================================================================
 void rexArg(Toks* toks) {
-  rexMust3(toks, TOKNAM, TOKNUM, TOKSTR);
+  rexMust(toks, TOKSET(TOKNAM) | TOKSET(TOKNUM) | TOKSET(TOKSTR));
 }
 
 // ============================================================================
@@ -28,10 +28,10 @@ void rexArgs(Toks* toks) {
 // eg:    x = add2(y);
 // ============================================================================
 void rexAsg(Toks* toks) {
-  rexMust(toks, TOKNAM);      // eg: counter
-  rexMust(toks, TOKEQ);       // eg: =
-  rexAsgExp(toks);            // eg: 42, add2(x, 3)
-  rexMust(toks, TOKSEMI);     // eg: ;
+  rexMust(toks, TOKSET(TOKNAM));      // eg: counter
+  rexMust(toks, TOKSET(TOKEQ));       // eg: =
+  rexAsgExp(toks);                    // eg: 42, add2(x, 3)
+  rexMust(toks, TOKSET(TOKSEMI));     // eg: ;
 }
 
 // ============================================================================
@@ -41,12 +41,12 @@ void rexAsg(Toks* toks) {
 // ============================================================================
 void rexAsgExp(Toks* toks) {
   if (rexIsCall(toks)) {
-    rexMust(toks, TOKNAM);      // eg: add2
-    rexMust(toks, TOKLPAREN);   // eg: (
-    rexArgs(toks);              // eg: x, 3
-    rexMust(toks, TOKRPAREN);   // eg: )
+    rexMust(toks, TOKSET(TOKNAM));      // eg: add2
+    rexMust(toks, TOKSET(TOKLPAREN));   // eg: (
+    rexArgs(toks);                      // eg: x, 3
+    rexMust(toks, TOKSET(TOKRPAREN));   // eg: )
   } else {
-    rexExp(toks);               // eg: y + 42
+    rexExp(toks);                       // eg: y + 42
   }
 }
 
@@ -54,19 +54,19 @@ void rexAsgExp(Toks* toks) {
 // Block => "{" Stm+ "}"
 // ============================================================================
 void rexBlock(Toks* toks) {
-  rexMust(toks, TOKLBRACE);
+  rexMust(toks, TOKSET(TOKLBRACE));
   rexStms(toks);
-  rexMust(toks, TOKRBRACE);
+  rexMust(toks, TOKSET(TOKRBRACE));
 }
 
 // ============================================================================
 // Body => "{" Var* Stm+ "}"
 // ============================================================================
 void rexBody(Toks* toks) {
-  rexMust(toks, TOKLBRACE);
+  rexMust(toks, TOKSET(TOKLBRACE));
   rexVars(toks);
   rexStms(toks);
-  rexMust(toks, TOKRBRACE);
+  rexMust(toks, TOKSET(TOKRBRACE));
 }
 
 // ============================================================================
@@ -78,10 +78,10 @@ void rexBody(Toks* toks) {
 // the token for Nam
 // ============================================================================
 void rexCall(Toks* toks) {
-  // rexMust(toks, TOKNAM);                         // eg: "add3"
-  rexMust(toks, TOKLPAREN);                         // eg: "("
+  // rexMust(toks, TOKSET(TOKNAM));                 // eg: "add3"
+  rexMust(toks, TOKSET(TOKLPAREN));                 // eg: "("
   rexArgs(toks);                                    // eg: "x, 15, y"
-  rexMust(toks, TOKRPAREN);                         // eg: ")"
+  rexMust(toks, TOKSET(TOKRPAREN));                 // eg: ")"
 }
 
 // ============================================================================
@@ -90,7 +90,7 @@ void rexCall(Toks* toks) {
 // Eg: 42 | count | x + 23
 // ============================================================================
 void rexExp(Toks* toks) {
-  rexMust3(toks, TOKNAM, TOKNUM, TOKSTR);
+  rexMust(toks, TOKSET(TOKNAM) | TOKSET(TOKNUM) | TOKSET(TOKSTR));
   Tok* tok1 = toksPrev(toks);             // grab back NAM or NUM
 
   if (tok1->kind == TOKSTR) {             // eg: "hello"
@@ -103,7 +103,7 @@ void rexExp(Toks* toks) {
 
   if (rexIsBop(tok2->kind)) {             // eg: 23 +
     toksNext(toks);                       // eg: count
-    rexMust2(toks, TOKNAM, TOKNUM);
+    rexMust(toks, TOKSET(TOKNAM) | TOKSET(TOKNUM));
   }
 }
 
@@ -118,17 +118,17 @@ void rexExp(Toks* toks) {
 // ============================================================================
 void rexFun(Toks* toks) {
   rexType(toks);
-  rexMust(toks, TOKNAM);                    // eg: add
+  rexMust(toks, TOKSET(TOKNAM));            // eg: add
   Tok* tok = toksPrev(toks);                // retrieve TOKNAM
   if (strcmp(tok->lexeme, "main") == 0) {   // "main" function
     tok = toksNext(toks);                   // should be (
-    rexMust(toks, TOKLPAREN);               // (
-    rexMust(toks, TOKRPAREN);               // )
+    rexMust(toks, TOKSET(TOKLPAREN));       // (
+    rexMust(toks, TOKSET(TOKRPAREN));       // )
   } else {
     tok = toksNext(toks);                   // should be (
-    rexMust(toks, TOKLPAREN);               // (
+    rexMust(toks, TOKSET(TOKLPAREN));       // (
     rexPars(toks);                          // eg: int a, int b, int c
-    rexMust(toks, TOKRPAREN);               // )
+    rexMust(toks, TOKSET(TOKRPAREN));       // )
   }
   rexBody(toks);
 }
@@ -137,7 +137,7 @@ void rexFun(Toks* toks) {
 // Typ => "int"
 // ============================================================================
 void rexType(Toks* toks) {
-  rexMust(toks, TOKINT);
+  rexMust(toks, TOKSET(TOKINT));
 }
 
 // ============================================================================
@@ -145,13 +145,13 @@ void rexType(Toks* toks) {
 // ============================================================================
 void rexIf(Toks* toks) {
   // if 
-  rexMust(toks, TOKIF); 
+  rexMust(toks, TOKSET(TOKIF)); 
   // ( 
-  rexMust(toks, TOKLPAREN); 
+  rexMust(toks, TOKSET(TOKLPAREN)); 
   // exp 
   rexExp(toks); 
   // )
-  rexMust(toks, TOKRPAREN); 
+  rexMust(toks, TOKSET(TOKRPAREN)); 
   // Block 
   rexBlock(toks); 
 }
@@ -177,81 +177,28 @@ int rexIsCall(Toks* toks) {
 }
 
 // ============================================================================
-// Check that the kind of the current Token within 'toks' matches 'k1'.
-// If yes, advance to the next Token in 'toks'.  If not, abort the program.
-// ============================================================================
-void rexMust(Toks* toks, TokKind k1) {
-  Tok* tok = toksCurr(toks);              // current token
-  TokKind k = tok->kind;
-  if (k == k1) {                          // success!
-    toksNext(toks);                       // advance to next token
-    return;
-  }
-
-  char msg[150];
-  sprintf(msg, "but expecting {%s}", tokStr(k1));
-  utDieStrTokStr("rexMust", tok, msg);
-}
-
-
-// ============================================================================
-// Check that the kind of the current Token within 'toks' matches 'k1' or 'k2'.
-// If yes, advance to the next Token in 'toks'.  If not, abort the program.
-// ============================================================================
-void rexMust2(Toks* toks, TokKind k1, TokKind k2) {
-  Tok* tok = toksCurr(toks);              // current token
-  TokKind k = tok->kind;
-  if (k == k1 || k == k2) {               // success!
-    toksNext(toks);                       // advance to next token
-    return;
-  }
-
-  char msg[150];
-  sprintf(msg, "%s%s, %s}", "but expecting {", tokStr(k1), tokStr(k2));
-  utDieStrTokStr("rexMust", tok, msg);
-}
-
-// ============================================================================
-// Check that the kind of the current Token within 'toks' matches 'k1' or 'k2'
-// or 'k3'.  If yes, advance to the next Token in 'toks'.  If not, abort
-// the program.
+// Check that the kind of the current Token within 'toks' is a member of the
+// TokSet 'set'.  If yes, advance to the next Token in 'toks'.  If not, abort
+// the program.  The diagnostic is only built on that failure path.
+//
+// eg: rexMust(toks, TOKSET(TOKNAM) | TOKSET(TOKNUM))
 // ============================================================================
-void rexMust3(Toks* toks, TokKind k1, TokKind k2, TokKind k3) {
+void rexMust(Toks* toks, TokSet set) {
   Tok* tok = toksCurr(toks);              // current token
-  TokKind k = tok->kind;
-  if (k == k1 || k == k2 || k == k3) {    // success!
+  if (set & TOKSET(tok->kind)) {  // success!
     toksNext(toks);                       // advance to next token
     return;
   }
 
-  char msg[150];
-  sprintf(msg, "%s%s, %s, %s}", "but expecting {", tokStr(k1), tokStr(k2), tokStr(k3));
-  utDieStrTokStr("rexMust", tok, msg);
-}
-
-// ============================================================================
-// Check that the kind of the current Token within 'toks' matches 'k1' thru
-// 'k4'.  If yes, advance to the next Token in 'toks'.  If not, abort
-// the program.
-// ============================================================================
-void rexMust4(Toks* toks, TokKind k1, TokKind k2, TokKind k3, TokKind k4) {
-  Tok* tok = toksCurr(toks);                        // current token
-  TokKind k = tok->kind;
-  if (k == k1 || k == k2 || k == k3 || k == k4) {   // success!
-    toksNext(toks);                                 // advance to next token
-    return;
-  }
-
-  char msg[150];
-  sprintf(msg, "%s%s, %s, %s, %s}", "but expecting {", tokStr(k1), tokStr(k2), tokStr(k3), tokStr(k4));
-  utDieStrTokStr("rexMust", tok, msg);
+  char msg[300];
+  utDieStrTokStr("rexMust", tok, tokSetStr(set, msg));
 }
 
 // ============================================================================
 // NamNum => Nam | Num
 // ============================================================================
 void rexNamNum(Toks* toks) {
-  rexMust2(toks, TOKNAM, TOKNUM);
+  rexMust(toks, TOKSET(TOKNAM) | TOKSET(TOKNUM));
 }
 
 // ============================================================================
@@ -260,7 +207,7 @@ void rexNamNum(Toks* toks) {
 // ============================================================================
 void rexPar(Toks* toks) {
   rexType(toks);                    // eg: int
-  rexMust(toks, TOKNAM);            // eg: counter
+  rexMust(toks, TOKSET(TOKNAM));    // eg: counter
 }
 
 // ============================================================================
@@ -302,9 +249,9 @@ void rexRep(Toks* toks, char* s) {
 // Ret => "return" Exp ";"
 // ============================================================================
 void rexRet(Toks* toks) {
-  rexMust(toks, TOKRET);
+  rexMust(toks, TOKSET(TOKRET));
   rexExp(toks);
-  rexMust(toks, TOKSEMI);
+  rexMust(toks, TOKSET(TOKSEMI));
 }
 
 // ============================================================================
@@ -348,7 +295,7 @@ void rexStms(Toks* toks) {
 
 // ============================================================================
 void rexStr(Toks* toks) {
-  rexMust(toks, TOKSTR);
+  rexMust(toks, TOKSET(TOKSTR));
 }
 
 // ============================================================================
@@ -357,8 +304,8 @@ void rexStr(Toks* toks) {
 // ============================================================================
 void rexVar(Toks* toks) {
   rexType(toks);                        // eg: int
-  rexMust(toks, TOKNAM);                // eg: count
-  rexMust(toks, TOKSEMI);               // eg: ;
+  rexMust(toks, TOKSET(TOKNAM));        // eg: count
+  rexMust(toks, TOKSET(TOKSEMI));       // eg: ;
 }
 
 // ============================================================================
@@ -382,13 +329,13 @@ void rexVars(Toks* toks) {
 // ============================================================================
 void rexWhile(Toks* toks) {
   // while
-  rexMust(toks, TOKWHILE); 
+  rexMust(toks, TOKSET(TOKWHILE)); 
   // (
-  rexMust(toks, TOKLPAREN); 
+  rexMust(toks, TOKSET(TOKLPAREN)); 
   // Exp
   rexExp(toks); 
   // )
-  rexMust(toks, TOKRPAREN); 
+  rexMust(toks, TOKSET(TOKRPAREN)); 
   // Block 
   rexBlock(toks);
 }
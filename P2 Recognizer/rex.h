@@ -2,8 +2,6 @@
 
 #pragma once
 
-#include <stdarg.h>
-
 #include "toks.h"       // Toks
 
 void rexArg(Toks* toks);
@@ -18,10 +16,7 @@ void rexFun(Toks* toks);
 void rexIf(Toks* toks);
 int  rexIsBop(TokKind k);
 int  rexIsCall(Toks* toks);
-void rexMust(Toks* toks, TokKind k1);
-void rexMust2(Toks* toks, TokKind k1, TokKind k2);
-void rexMust3(Toks* toks, TokKind k1, TokKind k2, TokKind k3);
-void rexMust4(Toks* toks, TokKind k1, TokKind k2, TokKind k3, TokKind k4);
+void rexMust(Toks* toks, TokSet set);
 void rexNamNum(Toks* toks) ;
 void rexPar(Toks* toks);
 void rexPars(Toks* toks);
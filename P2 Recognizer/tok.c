@@ -12,6 +12,23 @@ Tok* tokNew(int kind, char* lexeme, long num, int linNum, int colNum) {
   return tok;
 }
 
+// ============================================================================
+// Render the TokKinds in 'set' into 'buf', as in "{TOKNAM, TOKNUM}", and
+// return 'buf'.  Only needed to build a diagnostic, so speed does not matter.
+// 'buf' must have room for every TokKind name
+// ============================================================================
+char* tokSetStr(TokSet set, char* buf) {
+  strcpy(buf, "{");
+  for (int k = TOKADD; k <= TOKWHILE; ++k) {
+    if (set & TOKSET(k)) {
+      if (buf[1]) strcat(buf, ", ");
+      strcat(buf, tokStr(k));
+    }
+  }
+  strcat(buf, "}");
+  return buf;
+}
+
 char* tokStr(TokKind kind) {
   switch(kind) {
     case TOKADD:      return "TOKADD";
@@ -14,6 +14,13 @@ typedef enum {
 
 char* tokStr(TokKind kind);
 
+// A TokSet is a set of TokKinds, held as a bitset: TokKind 'k' is a member
+// if bit 'k' is 1.  So a test for membership costs just one AND.  Build sets
+// at compile time, as in:  TOKSET(TOKNAM) | TOKSET(TOKNUM)
+
+typedef unsigned TokSet;
+#define TOKSET(k) (1u << (k))
+
 typedef struct _Tok {
   TokKind kind;       // eg: TOKNUM
   char*   lexeme;     // eg: "123" for TOKNUM; "hello" for TOKSTR
@@ -23,4 +30,5 @@ typedef struct _Tok {
 } Tok;
 
 Tok*  tokNew(int kind, char* lexeme, long num, int linNum, int colNum);
-char* tokStr(TokKind kind);
\ No newline at end of file
+char* tokSetStr(TokSet set, char* buf);
+char* tokStr(TokKind kind);
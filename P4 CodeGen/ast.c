@@ -1,205 +1,347 @@
-// ast.c - Abstract Syntax Tree - Jim Hogg, 2020
-
-#include "ast.h"
-
-// ============================================================================
-// 'astarg' is the head of the list of arguments in the call made to some
-// function.  This function counts how many arguments are in the list.
-//
-// (Clearly, the number of arguments (astCountArgs) should match the number of
-// parameters (astCountPars) in that function)
-// ============================================================================
-int astCountArgs(AstArg* astarg) {
-  int numarg = 0;
-  while (astarg) {
-    ++numarg;
-    astarg = (AstArg*) astarg->next;
-  }
-  return numarg;
-}
-
-// ============================================================================
-// 'astpar' is the head of the list of parameters in the definition of some
-// function.  This function counts how many parameters are in the list.
-// ============================================================================
-int astCountPars(AstPar* astpar) {
-  int numpar = 0;
-  while (astpar) {
-    ++numpar;
-    astpar = (AstPar*) astpar->next;
-  }
-  return numpar;
-}
-
-// ============================================================================
-// 'astvar' is the head of the list of local variables in the definition of
-// some function.  This function counts how many variables are in the list.
-// ============================================================================
-int astCountVars(AstVar* astvar) {
-  int numvar = 0;
-  while (astvar) {
-    ++numvar;
-    astvar = (AstVar*) astvar->next;
-  }
-  return numvar;
-}
-
-// ============================================================================
-// 'astarg' points at the first argument for a function.  Retrieve argument
-// number 'argnum' and return to caller (arguments are numbered 0 upwards).
-// If not found, abort.
-//
-// Note: this function is called to retrieve arguments in right-to-left order
-// when building the code for a function call.
-// ============================================================================
-AstArg* astFindArg(AstArg* astarg, int argnum) {
-  int curargnum = 1;
-  AstArg* curastarg = astarg;
-  while (curastarg) {
-    if (curargnum == argnum) return curastarg;
-    curastarg = (AstArg*) curastarg->next;
-    curargnum++;
-  }
-  utDie2StrInt("astFindArg", "Failed to find argument number", argnum);
-  return 0;                                   // pacify compiler
-}
-
-// ============================================================================
-// Search the program AST rooted at 'prog' looking for the function
-// called 'nam'.  If not found, return NULL
-// ============================================================================
-AstFun* astFindFun(AstProg* prog, char* lex) {
-  assert(prog->kind == ASTPROG);
-  AstFun* fun = prog->funs;
-  while (fun) {
-    if (strcmp(fun->nam->lex, lex) == 0) return fun;
-    fun = (AstFun*) fun->next;
-  }
-  return NULL;
-}
-
-AstArg* astNewArg(Ast* nns) {
-  AstArg* a = calloc(sizeof(AstArg), 1);
-  a->kind = ASTARG;
-  a->nns = nns;     // Nam, Num or Str
-  return a;
-}
-
-AstAsg* astNewAsg(AstNam* nam, Ast* eoc) {
-  AstAsg* a = calloc(sizeof(AstAsg), 1);
-  a->kind = ASTASG; a->nam = nam; a->eoc = eoc;
-  return a;
-}
-
-AstBlock* astNewBlock(AstStm* stms) {
-  AstBlock* a = calloc(sizeof(AstBlock), 1);
-  a->kind = ASTBLOCK; a->stms = stms;
-  return a;
-}
-
-AstBody* astNewBody(AstVar* vars, AstStm* stms) {
-  AstBody* a = calloc(sizeof(AstBody), 1);
-  a->kind = ASTBODY; a->vars = vars; a->stms = stms;
-  return a;
-}
-
-AstCall* astNewCall(AstNam* nam, AstArg* args) {
-  AstCall* a = calloc(sizeof(AstCall), 1);
-  a->kind = ASTCALL; a->nam = nam; a->args = args;
-  return a;
-}
-
-AstExp* astNewExp(Ast* lhs, BOP bop, Ast* rhs) {
-  AstExp* a = calloc(sizeof(AstExp), 1);
-  a->kind = ASTEXP; a->lhs = lhs; a->bop = bop; a->rhs = rhs;
-  return a;
-}
-
-AstFun* astNewFun(AstNam* nam, AstPar* pars, AstBody* body) {
-  AstFun* a = calloc(sizeof(AstFun), 1);
-  a->kind = ASTFUN; a->nam = nam; a->pars = pars; a->body = body;
-  return a;
-}
-
-AstIf* astNewIf(AstExp* exp, AstBlock* block) {
-  AstIf* a = calloc(sizeof(AstIf), 1);
-  a->kind = ASTIF; a->exp = exp; a->block = block;
-  return a;
-}
-
-AstNam* astNewNam(char* lex) {
-  AstNam* a = calloc(sizeof(AstNam), 1);
-  a->kind = ASTNAM; a->lex = lex;
-  return a;
-}
-
-AstNum* astNewNum(int val) {
-  AstNum* a = calloc(sizeof(AstNum), 1);
-  a->kind = ASTNUM; a->val = val;
-  return a;
-}
-
-AstPar* astNewPar(AstNam* nam) {
-  AstPar* a = calloc(sizeof(AstPar), 1);
-  a->kind = ASTPAR; a->next = 0; a->nam = nam;
-  return a;
-}
-
-AstProg* astNewProg(AstFun* funs) {
-  AstProg* a = calloc(sizeof(AstProg), 1);
-  a->kind = ASTPROG; a->funs = funs;
-  return a;
-}
-
-AstRet* astNewRet(AstExp* exp) {
-  AstRet* a = calloc(sizeof(AstRet), 1);
-  a->kind = ASTRET; a->exp = exp;
-  return a;
-}
-
-AstStr* astNewStr(char* txt) {
-  AstStr* a = calloc(sizeof(AstStr), 1);
-  a->kind = ASTSTR; a->txt = txt;
-  return a;
-}
-
-AstVar* astNewVar(AstNam* nam) {
-  AstVar* a = calloc(sizeof(AstVar), 1);
-  a->kind = ASTVAR; a->next = 0; a->nam = nam;
-  return a;
-}
-
-AstWhile* astNewWhile(AstExp* exp, AstBlock* block) {
-  AstWhile* a = calloc(sizeof(AstWhile), 1);
-  a->kind = ASTWHILE; a->exp = exp; a->block = block;
-  return a;
-}
-
-
-char* astBOPtoStr(BOP bop) {
-  switch(bop) {
-    case BOPADD:   return "BOPADD";
-    case BOPBAD:   return "BOPBAD";
-    case BOPEEQ:   return "BOPEEQ";
-    case BOPGE:    return "BOPGE";
-    case BOPGT:    return "BOPGT";
-    case BOPLE:    return "BOPLE";
-    case BOPLT:    return "BOPLT";
-    case BOPMUL:   return "BOPMUL";
-    case BOPNE:    return "BOPNE";
-    case BOPNONE:  return "BOPNONE";
-    case BOPSUB:   return "BOPSUB";
-    default:       return "BOPBAD";
-  }
-}
-
-char* astTYPtoStr(TYP typ) {
-  switch(typ) {
-    case TYPEND:   return "TYPEND";
-    case TYPFUN:   return "TYPFUN";
-    case TYPINT:   return "TYPINT";
-    case TYPSTR:   return "TYPSTR";
-    case TYPUNK:   return "TYPUNK";
-    default:       return "TYPUNK";
-  }
-}
+// ast.c - Abstract Syntax Tree - Jim Hogg, 2020
+
+#include "ast.h"
+
+AstCons* g_astCons = NULL;                // set, to share nodes (see ast.h)
+
+// ============================================================================
+// 'ast' is the head of a chain of Asts, linked via their 'next' pointers.
+// Copy the chain into a new array, and return it, with its length in '*num'.
+// The astNew* functions call this once per list, as the parser completes the
+// node that owns that list, so that later phases can count, and index into,
+// the list in O(1) time
+// ============================================================================
+Ast** astArray(Ast* ast, int* num) {
+  int n = 0;
+  for (Ast* a = ast; a; a = a->next) ++n;
+
+  Ast** arr = calloc(n + 1, sizeof(Ast*));          // +1 so never empty
+  if (arr == NULL) utDie2Str("astArray", "calloc failed");
+
+  n = 0;
+  for (Ast* a = ast; a; a = a->next) arr[n++] = a;
+
+  *num = n;
+  return arr;
+}
+
+// ============================================================================
+// Add 'ast', which astConsFind did not find, to the table of g_astCons.
+// Double the table when it becomes half full.
+// ============================================================================
+void astConsAdd(Ast* ast) {
+  AstCons* cons = g_astCons;
+  if (2 * (cons->num + 1) > cons->mask + 1) {
+    int numSlot = 2 * (cons->mask + 1);
+    Ast** slot = calloc(numSlot, sizeof(Ast*));
+    if (slot == NULL) utDie2Str("astConsAdd", "calloc failed");
+    for (int i = 0; i <= cons->mask; ++i) {
+      if (cons->slot[i] == NULL) continue;
+      int j = (int) astHash(cons->slot[i]) & (numSlot - 1);
+      while (slot[j]) j = (j + 1) & (numSlot - 1);
+      slot[j] = cons->slot[i];
+    }
+    free(cons->slot);
+    cons->slot = slot;
+    cons->mask = numSlot - 1;
+  }
+
+  int i = (int) astHash(ast) & cons->mask;
+  while (cons->slot[i]) i = (i + 1) & cons->mask;
+  cons->slot[i] = ast;
+  ++cons->num;
+  ++cons->numBuilt;
+}
+
+// ============================================================================
+// Empty the table of 'cons', so that no node built so far is shared with any
+// built from now on.  Keep the table's size.
+// ============================================================================
+void astConsClear(AstCons* cons) {
+  if (cons->num == 0) return;
+  memset(cons->slot, 0, (cons->mask + 1) * sizeof(Ast*));
+  cons->num = 0;
+}
+
+// ============================================================================
+// Find, in the table of g_astCons, a node structurally equal to 'key'.
+// Return NULL if there is none.
+// ============================================================================
+Ast* astConsFind(Ast* key) {
+  AstCons* cons = g_astCons;
+  for (int i = (int) astHash(key) & cons->mask; cons->slot[i]; i = (i + 1) & cons->mask) {
+    if (astEqual(cons->slot[i], key)) {
+      ++cons->numShared;
+      return cons->slot[i];
+    }
+  }
+  return NULL;
+}
+
+// ============================================================================
+// Create an empty table for hash-consing.  Set g_astCons to it to turn
+// hash-consing on (see ast.h)
+// ============================================================================
+AstCons* astConsNew() {
+  AstCons* cons = calloc(1, sizeof(AstCons));
+  if (cons == NULL) utDie2Str("astConsNew", "calloc failed");
+  cons->mask = 1023;
+  cons->slot = calloc(cons->mask + 1, sizeof(Ast*));
+  if (cons->slot == NULL) utDie2Str("astConsNew", "calloc failed");
+  return cons;
+}
+
+// ============================================================================
+// Count the number of arguments in the call 'astcall'.
+//
+// (Clearly, the number of arguments (astCountArgs) should match the number of
+// parameters (astCountPars) in that function)
+// ============================================================================
+int astCountArgs(AstCall* astcall) { return astcall->numarg; }
+
+// ============================================================================
+// Count the number of parameters in the definition of function 'astfun'
+// ============================================================================
+int astCountPars(AstFun* astfun) { return astfun->numpar; }
+
+// ============================================================================
+// Count the number of local variables in the function body 'astbody'
+// ============================================================================
+int astCountVars(AstBody* astbody) { return astbody->numvar; }
+
+// ============================================================================
+// Are 'a' and 'b', either of which may be NULL, structurally equal?  For
+// nodes shared by hash-consing, that means the same node, so we return at
+// once: on the first test, or on their hashes.
+// ============================================================================
+int astEqual(Ast* a, Ast* b) {
+  if (a == b) return 1;
+  if (a == NULL || b == NULL || a->kind != b->kind) return 0;
+  if (astHash(a) != astHash(b)) return 0;
+  switch (a->kind) {
+    case ASTNAM: return strcmp(((AstNam*) a)->lex, ((AstNam*) b)->lex) == 0;
+    case ASTNUM: return ((AstNum*) a)->val == ((AstNum*) b)->val;
+    case ASTSTR: return strcmp(((AstStr*) a)->txt, ((AstStr*) b)->txt) == 0;
+    case ASTEXP: {
+      AstExp* x = (AstExp*) a;
+      AstExp* y = (AstExp*) b;
+      return x->bop == y->bop && astEqual(x->lhs, y->lhs) && astEqual(x->rhs, y->rhs);
+    }
+    default:     return 0;                    // not hashed
+  }
+}
+
+// ============================================================================
+// Retrieve argument number 'argnum' of the call 'astcall' and return to
+// caller (arguments are numbered 1 upwards).  If not found, abort.
+//
+// Note: this function is called to retrieve arguments in right-to-left order
+// when building the code for a function call.
+// ============================================================================
+AstArg* astFindArg(AstCall* astcall, int argnum) {
+  if (argnum >= 1 && argnum <= astcall->numarg) return astcall->arg[argnum - 1];
+  utDie2StrInt("astFindArg", "Failed to find argument number", argnum);
+  return 0;                                   // pacify compiler
+}
+
+// ============================================================================
+// Search the program AST rooted at 'prog' looking for the function
+// called 'nam'.  If not found, return NULL
+// ============================================================================
+AstFun* astFindFun(AstProg* prog, char* lex) {
+  assert(prog->kind == ASTPROG);
+  AstFun* fun = prog->funs;
+  while (fun) {
+    if (strcmp(fun->nam->lex, lex) == 0) return fun;
+    fun = (AstFun*) fun->next;
+  }
+  return NULL;
+}
+
+// ============================================================================
+// Return the structural hash of 'ast', or 0 if it is not a Nam, Num, Str or
+// Exp
+// ============================================================================
+unsigned astHash(Ast* ast) {
+  switch (ast->kind) {
+    case ASTEXP: return ((AstExp*) ast)->hash;
+    case ASTNAM: return ((AstNam*) ast)->hash;
+    case ASTNUM: return ((AstNum*) ast)->hash;
+    case ASTSTR: return ((AstStr*) ast)->hash;
+    default:     return 0;
+  }
+}
+
+// ============================================================================
+// Hash the kind 'kind', and the string 's', using 32-bit FNV-1a
+// ============================================================================
+unsigned astHashStr(AST kind, char* s) {
+  unsigned h = astMix(2166136261u, kind);
+  for (char* c = s; c && *c; ++c) h = astMix(h, (unsigned char) *c);
+  return h;
+}
+
+// ============================================================================
+// Mix 'x' into the FNV-1a hash 'h'
+// ============================================================================
+unsigned astMix(unsigned h, unsigned x) { return (h ^ x) * 16777619u; }
+
+AstArg* astNewArg(Ast* nns) {
+  AstArg* a = calloc(sizeof(AstArg), 1);
+  a->kind = ASTARG;
+  a->nns = nns;     // Nam, Num or Str
+  return a;
+}
+
+AstAsg* astNewAsg(AstNam* nam, Ast* eoc) {
+  AstAsg* a = calloc(sizeof(AstAsg), 1);
+  a->kind = ASTASG; a->nam = nam; a->eoc = eoc;
+  return a;
+}
+
+AstBlock* astNewBlock(AstStm* stms) {
+  AstBlock* a = calloc(sizeof(AstBlock), 1);
+  a->kind = ASTBLOCK; a->stms = stms;
+  a->stm = (AstStm**) astArray((Ast*) stms, &a->numstm);
+  return a;
+}
+
+AstBody* astNewBody(AstVar* vars, AstStm* stms) {
+  AstBody* a = calloc(sizeof(AstBody), 1);
+  a->kind = ASTBODY; a->vars = vars; a->stms = stms;
+  a->var = (AstVar**) astArray((Ast*) vars, &a->numvar);
+  a->stm = (AstStm**) astArray((Ast*) stms, &a->numstm);
+  return a;
+}
+
+AstCall* astNewCall(AstNam* nam, AstArg* args) {
+  AstCall* a = calloc(sizeof(AstCall), 1);
+  a->kind = ASTCALL; a->nam = nam; a->args = args;
+  a->arg = (AstArg**) astArray((Ast*) args, &a->numarg);
+  return a;
+}
+
+AstExp* astNewExp(Ast* lhs, BOP bop, Ast* rhs) {
+  unsigned h = astMix(astMix(2166136261u, ASTEXP), bop);
+  h = astMix(astMix(h, lhs ? astHash(lhs) : 0), rhs ? astHash(rhs) : 0);
+  AstExp key = { .kind = ASTEXP, .hash = h,
+    .lhs = lhs, .bop = bop, .rhs = rhs };
+  if (g_astCons) {
+    AstExp* old = (AstExp*) astConsFind((Ast*) &key);
+    if (old) return old;
+  }
+  AstExp* a = calloc(sizeof(AstExp), 1);
+  *a = key;
+  if (g_astCons) astConsAdd((Ast*) a);
+  return a;
+}
+
+AstFun* astNewFun(AstNam* nam, AstPar* pars, AstBody* body) {
+  AstFun* a = calloc(sizeof(AstFun), 1);
+  a->kind = ASTFUN; a->nam = nam; a->pars = pars; a->body = body;
+  a->par = (AstPar**) astArray((Ast*) pars, &a->numpar);
+  if (g_astCons) astConsClear(g_astCons);   // share within a Fun (see ast.h)
+  return a;
+}
+
+AstIf* astNewIf(AstExp* exp, AstBlock* block) {
+  AstIf* a = calloc(sizeof(AstIf), 1);
+  a->kind = ASTIF; a->exp = exp; a->block = block;
+  return a;
+}
+
+AstNam* astNewNam(char* lex) {
+  AstNam key = { .kind = ASTNAM, .hash = astHashStr(ASTNAM, lex), .lex = lex };
+  if (g_astCons) {
+    AstNam* old = (AstNam*) astConsFind((Ast*) &key);
+    if (old) return old;
+  }
+  AstNam* a = calloc(sizeof(AstNam), 1);
+  *a = key;
+  if (g_astCons) astConsAdd((Ast*) a);
+  return a;
+}
+
+AstNum* astNewNum(int val) {
+  unsigned h = astMix(astMix(2166136261u, ASTNUM), val);
+  AstNum key = { .kind = ASTNUM, .hash = h, .val = val };
+  if (g_astCons) {
+    AstNum* old = (AstNum*) astConsFind((Ast*) &key);
+    if (old) return old;
+  }
+  AstNum* a = calloc(sizeof(AstNum), 1);
+  *a = key;
+  if (g_astCons) astConsAdd((Ast*) a);
+  return a;
+}
+
+AstPar* astNewPar(AstNam* nam) {
+  AstPar* a = calloc(sizeof(AstPar), 1);
+  a->kind = ASTPAR; a->next = 0; a->nam = nam;
+  return a;
+}
+
+AstProg* astNewProg(AstFun* funs) {
+  AstProg* a = calloc(sizeof(AstProg), 1);
+  a->kind = ASTPROG; a->funs = funs;
+  return a;
+}
+
+AstRet* astNewRet(AstExp* exp) {
+  AstRet* a = calloc(sizeof(AstRet), 1);
+  a->kind = ASTRET; a->exp = exp;
+  return a;
+}
+
+AstStr* astNewStr(char* txt) {
+  AstStr key = { .kind = ASTSTR, .hash = astHashStr(ASTSTR, txt), .txt = txt };
+  if (g_astCons) {
+    AstStr* old = (AstStr*) astConsFind((Ast*) &key);
+    if (old) return old;
+  }
+  AstStr* a = calloc(sizeof(AstStr), 1);
+  *a = key;
+  if (g_astCons) astConsAdd((Ast*) a);
+  return a;
+}
+
+AstVar* astNewVar(AstNam* nam) {
+  AstVar* a = calloc(sizeof(AstVar), 1);
+  a->kind = ASTVAR; a->next = 0; a->nam = nam;
+  return a;
+}
+
+AstWhile* astNewWhile(AstExp* exp, AstBlock* block) {
+  AstWhile* a = calloc(sizeof(AstWhile), 1);
+  a->kind = ASTWHILE; a->exp = exp; a->block = block;
+  return a;
+}
+
+
+char* astBOPtoStr(BOP bop) {
+  switch(bop) {
+    case BOPADD:   return "BOPADD";
+    case BOPBAD:   return "BOPBAD";
+    case BOPEEQ:   return "BOPEEQ";
+    case BOPGE:    return "BOPGE";
+    case BOPGT:    return "BOPGT";
+    case BOPLE:    return "BOPLE";
+    case BOPLT:    return "BOPLT";
+    case BOPMUL:   return "BOPMUL";
+    case BOPNE:    return "BOPNE";
+    case BOPNONE:  return "BOPNONE";
+    case BOPSUB:   return "BOPSUB";
+    default:       return "BOPBAD";
+  }
+}
+
+char* astTYPtoStr(TYP typ) {
+  switch(typ) {
+    case TYPEND:   return "TYPEND";
+    case TYPFUN:   return "TYPFUN";
+    case TYPINT:   return "TYPINT";
+    case TYPSTR:   return "TYPSTR";
+    case TYPUNK:   return "TYPUNK";
+    default:       return "TYPUNK";
+  }
+}
@@ -1,242 +1,301 @@
-// ast.h - Abstract Syntax Trees - Jim Hogg, 2020
-
-#pragma once
-
-#include <assert.h>         // assert
-#include <ctype.h>          // isspace, isalpha, isdigit, isalnum
-#include <stdio.h>          // printf
-#include <stdlib.h>         // calloc
-#include <string.h>         // strncpy
-
-#include "tok.h"            // TokKind
-#include "toks.h"           // Toks
-#include "ut.h"             // ut*
-
-// The TYP enum comprises constants for the type of variables,
-// paramemters and functions.
-
-typedef enum {
-  TYPEND = 1,   // last row for a function in the Lay struct
-  TYPFUN,       // first row for a function in the Lay struct
-  TYPINT,       // parameter, variable of function return of type "int"
-  TYPSTR,       // a literal string
-  TYPUNK,       // unknown type - an error condition
-} TYP;
-char* astTYPtoStr(TYP typ);
-
-#define BYTESPERINT 4
-
-typedef enum {                                          // Binary Operators
-  BOPADD = 1, BOPSUB, BOPMUL, BOPNONE, BOPBAD,          // Arithmetic
-  BOPLT, BOPLE, BOPNE, BOPEEQ, BOPGE, BOPGT             // Relational
-} BOP;
-char* astBOPtoStr(BOP bop);
-
-typedef enum {
-  ASTASG = 1, ASTARG, ASTBLOCK, ASTBODY, ASTCALL, ASTEXP, ASTFUN, ASTIF,
-  ASTNAM, ASTNUM, ASTPAR, ASTPROG, ASTRET, ASTSTR, ASTVAR, ASTWHILE
-} AST;
-
-// ============================================================================
-// Common 'super' struct for all ASTs
-// ============================================================================
-typedef struct Ast_ {
-  AST    kind;
-  struct Ast_* next;
-} Ast;
-
-struct AstCall_;    typedef struct AstCall_  AstCall;   // forward declaration
-struct AstExp_;     typedef struct AstExp_   AstExp;    // forward declaration
-struct AstNam_;     typedef struct AstNam_   AstNam;    // forward declaration
-struct AstNum_;     typedef struct AstNum_   AstNum;    // forward declaration
-struct AstPar_;     typedef struct AstPar_   AstPar;    // forward declaration
-struct AstStm_;     typedef struct AstStm_   AstStm;    // forward declaration
-struct AstStr_;     typedef struct AstStr_   AstStr;    // forward declaration
-struct AstVar_;     typedef struct AstVar_   AstVar;    // forward declaration
-
-// ============================================================================
-// Arg => Nam | Num | Str
-// ============================================================================
-typedef struct {
-  AST     kind;             // ASTARG
-  Ast*    next;
-  Ast*    nns;              // Nam, Num or Str
-} AstArg;
-AstArg* astNewArg(Ast* nns);
-
-// ============================================================================
-// Asg => Nam "=" (Exp | Call) ";"
-// ============================================================================
-typedef struct {
-  AST     kind;             // ASTASG
-  Ast*    next;
-  AstNam* nam;
-  Ast*    eoc;              // Exp or Call
-} AstAsg;
-AstAsg* astNewAsg(AstNam* nam, Ast* eoc);
-
-// ============================================================================
-// Block => "{" Stm+ "}"
-// ============================================================================
-typedef struct {
-  AST     kind;             // ASTBLOCK
-  Ast*    next;
-  AstStm* stms;
-} AstBlock;
-AstBlock* astNewBlock(AstStm* stms);
-
-// ============================================================================
-// Body => Var* Stm+
-// ============================================================================
-typedef struct {
-  AST     kind;             // ASTBODY
-  Ast*    next;
-  AstVar* vars;
-  AstStm* stms;
-} AstBody;
-AstBody* astNewBody(AstVar* vars, AstStm* stms);
-
-// ============================================================================
-// Call => Nam "(" Args ")"
-// ============================================================================
-typedef struct AstCall_ {
-  AST     kind;             // ASTCALL
-  Ast*    next;
-  AstNam* nam;
-  AstArg* args;
-} AstCall;
-AstCall* astNewCall(AstNam* nam, AstArg* args);
-
-// ============================================================================
-// Exp => NamNum | NamNum Bop NamNum
-// ============================================================================
-typedef struct AstExp_ {
-  AST  kind;                // ASTEXP
-  Ast* next;
-  Ast* lhs;
-  BOP  bop;
-  Ast* rhs;
-} AstExp;
-AstExp* astNewExp(Ast* lhs, BOP bop, Ast* rhs);
-
-// ============================================================================
-// Fun => "int" Nam "(" Pars ")" Body
-// ============================================================================
-typedef struct {
-  AST       kind;           // ASTFUN
-  Ast*      next;
-  AstNam*   nam;
-  AstPar*   pars;
-  AstBody*  body;
-} AstFun;
-AstFun* astNewFun(AstNam* nam, AstPar* pars, AstBody* body);
-
-// ============================================================================
-// If => "if" "(" Exp ")" Block
-// ============================================================================
-typedef struct {
-  AST       kind;           // ASTIF
-  Ast*      next;
-  AstExp*   exp;
-  AstBlock* block;
-} AstIf;
-AstIf* astNewIf(AstExp* exp, AstBlock* block);
-
-// ============================================================================
-// An AST node that represent a name.  Typically, this is a reference to some
-// variable, such as "counter" in the body of a function.  At that point, we
-// do not know its Type.
-// ============================================================================
-typedef struct AstNam_ {
-  AST   kind;               // ASTNAM
-  Ast*  next;
-  char* lex;                // lexeme
-} AstNam;
-AstNam* astNewNam(char* lex);
-
-// ============================================================================
-// An AST node that represent a simple, literal integer.  Eg: 42
-// ============================================================================
-typedef struct AstNum_ {
-  AST    kind;              // ASTNUM
-  Ast*   next;
-  int    val;
-} AstNum;
-AstNum* astNewNum(int val);
-
-// ============================================================================
-// Par => "int" Nam
-// ============================================================================
-typedef struct AstPar_ {
-  AST     kind;             // ASTPAR
-  Ast*    next;
-  AstNam* nam;
-} AstPar;
-AstPar* astNewPar(AstNam* nam);
-
-// ============================================================================
-// Prog => Fun+
-// ============================================================================
-typedef struct {
-  AST     kind;             // ASTPROG
-  Ast*    next;
-  AstFun* funs;
-} AstProg;
-AstProg* astNewProg(AstFun* funs);
-
-// ============================================================================
-// Ret => "return" Exp ";"
-// ============================================================================
-typedef struct {
-  AST     kind;             // ASTRET
-  Ast*    next;
-  AstExp* exp;
-} AstRet;
-AstRet* astNewRet(AstExp* exp);
-
-// ============================================================================
-// Stm => If | Asg | Ret | While
-// ============================================================================
-typedef struct AstStm_ {
-  AST  kind;                // ASTIF | ASTASG | ASTRET | ASTWHILE
-  Ast* next;
-  Ast* stm;
-} AstStm;
-AstStm* AstNewStm(Ast* stm);
-
-// ============================================================================
-// An AST node that represent a simple, literal string.  Eg: "hello world"
-// ============================================================================
-typedef struct AstStr_ {
-  AST   kind;               // ASTSTR
-  Ast*  next;
-  char* txt;
-} AstStr;
-AstStr* astNewStr(char* txt);
-
-// ============================================================================
-// Var => "int" Nam ";"
-// ============================================================================
-typedef struct AstVar_ {
-  AST     kind;             // ASTVAR
-  Ast*    next;
-  AstNam* nam;
-} AstVar;
-AstVar* astNewVar(AstNam* nam);
-
-// ============================================================================
-// While => "while" "(" Exp ")" Block
-// ============================================================================
-typedef struct {
-  AST       kind;           // ASTWHILE
-  Ast*      next;
-  AstExp*   exp;
-  AstBlock* block;
-} AstWhile;
-AstWhile* astNewWhile(AstExp* exp, AstBlock* block);
-
-int astCountArgs(AstArg* astarg);
-int astCountPars(AstPar* astpar);
-int astCountVars(AstVar* astvar);
-AstArg* astFindArg(AstArg* astarg, int argnum);
-AstFun* astFindFunIdx(AstProg* astProg, char* funnam);
+// ast.h - Abstract Syntax Trees - Jim Hogg, 2020
+
+#pragma once
+
+#include <assert.h>         // assert
+#include <ctype.h>          // isspace, isalpha, isdigit, isalnum
+#include <stdio.h>          // printf
+#include <stdlib.h>         // calloc
+#include <string.h>         // strncpy
+
+#include "tok.h"            // TokKind
+#include "toks.h"           // Toks
+#include "ut.h"             // ut*
+
+// The TYP enum comprises constants for the type of variables,
+// paramemters and functions.
+
+typedef enum {
+  TYPEND = 1,   // last row for a function in the Lay struct
+  TYPFUN,       // first row for a function in the Lay struct
+  TYPINT,       // parameter, variable of function return of type "int"
+  TYPSTR,       // a literal string
+  TYPUNK,       // unknown type - an error condition
+} TYP;
+char* astTYPtoStr(TYP typ);
+
+#define BYTESPERINT 4
+
+typedef enum {                                          // Binary Operators
+  BOPADD = 1, BOPSUB, BOPMUL, BOPNONE, BOPBAD,          // Arithmetic
+  BOPLT, BOPLE, BOPNE, BOPEEQ, BOPGE, BOPGT             // Relational
+} BOP;
+char* astBOPtoStr(BOP bop);
+
+typedef enum {
+  ASTASG = 1, ASTARG, ASTBLOCK, ASTBODY, ASTCALL, ASTEXP, ASTFUN, ASTIF,
+  ASTNAM, ASTNUM, ASTPAR, ASTPROG, ASTRET, ASTSTR, ASTVAR, ASTWHILE
+} AST;
+
+// ============================================================================
+// Common 'super' struct for all ASTs
+// ============================================================================
+typedef struct Ast_ {
+  AST    kind;
+  struct Ast_* next;
+} Ast;
+
+struct AstCall_;    typedef struct AstCall_  AstCall;   // forward declaration
+struct AstExp_;     typedef struct AstExp_   AstExp;    // forward declaration
+struct AstNam_;     typedef struct AstNam_   AstNam;    // forward declaration
+struct AstNum_;     typedef struct AstNum_   AstNum;    // forward declaration
+struct AstPar_;     typedef struct AstPar_   AstPar;    // forward declaration
+struct AstStm_;     typedef struct AstStm_   AstStm;    // forward declaration
+struct AstStr_;     typedef struct AstStr_   AstStr;    // forward declaration
+struct AstVar_;     typedef struct AstVar_   AstVar;    // forward declaration
+
+// ============================================================================
+// Arg => Nam | Num | Str
+// ============================================================================
+typedef struct {
+  AST     kind;             // ASTARG
+  Ast*    next;
+  Ast*    nns;              // Nam, Num or Str
+} AstArg;
+AstArg* astNewArg(Ast* nns);
+
+// ============================================================================
+// Asg => Nam "=" (Exp | Call) ";"
+// ============================================================================
+typedef struct {
+  AST     kind;             // ASTASG
+  Ast*    next;
+  AstNam* nam;
+  Ast*    eoc;              // Exp or Call
+} AstAsg;
+AstAsg* astNewAsg(AstNam* nam, Ast* eoc);
+
+// ============================================================================
+// Block => "{" Stm+ "}"
+// ============================================================================
+typedef struct {
+  AST      kind;            // ASTBLOCK
+  Ast*     next;
+  AstStm*  stms;
+  int      numstm;          // number of statements in 'stms' ...
+  AstStm** stm;             // ... and an array of them, stm[0] to stm[numstm-1]
+} AstBlock;
+AstBlock* astNewBlock(AstStm* stms);
+
+// ============================================================================
+// Body => Var* Stm+
+// ============================================================================
+typedef struct {
+  AST      kind;            // ASTBODY
+  Ast*     next;
+  AstVar*  vars;
+  AstStm*  stms;
+  int      numvar;          // number of variables in 'vars' ...
+  AstVar** var;             // ... and an array of them
+  int      numstm;          // number of statements in 'stms' ...
+  AstStm** stm;             // ... and an array of them
+} AstBody;
+AstBody* astNewBody(AstVar* vars, AstStm* stms);
+
+// ============================================================================
+// Call => Nam "(" Args ")"
+// ============================================================================
+typedef struct AstCall_ {
+  AST      kind;            // ASTCALL
+  Ast*     next;
+  AstNam*  nam;
+  AstArg*  args;
+  int      numarg;          // number of arguments in 'args' ...
+  AstArg** arg;             // ... and an array of them
+} AstCall;
+AstCall* astNewCall(AstNam* nam, AstArg* args);
+
+// ============================================================================
+// Exp => NamNum | NamNum Bop NamNum
+// ============================================================================
+typedef struct AstExp_ {
+  AST  kind;                // ASTEXP
+  unsigned hash;            // structural hash (see AstCons) - fills padding
+  Ast* next;
+  Ast* lhs;
+  BOP  bop;
+  Ast* rhs;
+} AstExp;
+AstExp* astNewExp(Ast* lhs, BOP bop, Ast* rhs);
+
+// ============================================================================
+// Fun => "int" Nam "(" Pars ")" Body
+// ============================================================================
+typedef struct {
+  AST       kind;           // ASTFUN
+  Ast*      next;
+  AstNam*   nam;
+  AstPar*   pars;
+  AstBody*  body;
+  int       numpar;         // number of parameters in 'pars' ...
+  AstPar**  par;            // ... and an array of them
+  int       id;             // stable identity, set by incProg (see inc.h)
+} AstFun;
+AstFun* astNewFun(AstNam* nam, AstPar* pars, AstBody* body);
+
+// ============================================================================
+// If => "if" "(" Exp ")" Block
+// ============================================================================
+typedef struct {
+  AST       kind;           // ASTIF
+  Ast*      next;
+  AstExp*   exp;
+  AstBlock* block;
+} AstIf;
+AstIf* astNewIf(AstExp* exp, AstBlock* block);
+
+// ============================================================================
+// An AST node that represent a name.  Typically, this is a reference to some
+// variable, such as "counter" in the body of a function.  At that point, we
+// do not know its Type.
+// ============================================================================
+typedef struct AstNam_ {
+  AST   kind;               // ASTNAM
+  unsigned hash;            // structural hash (see AstCons) - fills padding
+  Ast*  next;
+  char* lex;                // lexeme
+  AstFun* fun;              // for a Par or Var: the Fun that declares it ...
+  int   slot;               // ... its number there, from 0, Pars first ...
+  int   off;                // ... and its offset from FP (see resProg)
+} AstNam;
+AstNam* astNewNam(char* lex);
+
+// ============================================================================
+// An AST node that represent a simple, literal integer.  Eg: 42
+// ============================================================================
+typedef struct AstNum_ {
+  AST    kind;              // ASTNUM
+  unsigned hash;            // structural hash (see AstCons) - fills padding
+  Ast*   next;
+  int    val;
+} AstNum;
+AstNum* astNewNum(int val);
+
+// ============================================================================
+// Par => "int" Nam
+// ============================================================================
+typedef struct AstPar_ {
+  AST     kind;             // ASTPAR
+  Ast*    next;
+  AstNam* nam;
+} AstPar;
+AstPar* astNewPar(AstNam* nam);
+
+// ============================================================================
+// Prog => Fun+
+// ============================================================================
+typedef struct {
+  AST     kind;             // ASTPROG
+  Ast*    next;
+  AstFun* funs;
+} AstProg;
+AstProg* astNewProg(AstFun* funs);
+
+// ============================================================================
+// Ret => "return" Exp ";"
+// ============================================================================
+typedef struct {
+  AST     kind;             // ASTRET
+  Ast*    next;
+  AstExp* exp;
+} AstRet;
+AstRet* astNewRet(AstExp* exp);
+
+// ============================================================================
+// Stm => If | Asg | Ret | While
+// ============================================================================
+typedef struct AstStm_ {
+  AST  kind;                // ASTIF | ASTASG | ASTRET | ASTWHILE
+  Ast* next;
+  Ast* stm;
+} AstStm;
+AstStm* AstNewStm(Ast* stm);
+
+// ============================================================================
+// An AST node that represent a simple, literal string.  Eg: "hello world"
+// ============================================================================
+typedef struct AstStr_ {
+  AST   kind;               // ASTSTR
+  unsigned hash;            // structural hash (see AstCons) - fills padding
+  Ast*  next;
+  char* txt;
+} AstStr;
+AstStr* astNewStr(char* txt);
+
+// ============================================================================
+// Var => "int" Nam ";"
+// ============================================================================
+typedef struct AstVar_ {
+  AST     kind;             // ASTVAR
+  Ast*    next;
+  AstNam* nam;
+} AstVar;
+AstVar* astNewVar(AstNam* nam);
+
+// ============================================================================
+// While => "while" "(" Exp ")" Block
+// ============================================================================
+typedef struct {
+  AST       kind;           // ASTWHILE
+  Ast*      next;
+  AstExp*   exp;
+  AstBlock* block;
+} AstWhile;
+AstWhile* astNewWhile(AstExp* exp, AstBlock* block);
+
+// ============================================================================
+// Hash-consing.  A program repeats the same names, numbers and expressions -
+// "n", "1", "n + 1" - over and over.  While g_astCons is set, astNewNam,
+// astNewNum, astNewStr and astNewExp first look for an existing node that is
+// structurally identical to the one asked for, and return that instead of a
+// new one.  So each distinct leaf or Exp is built, and stored, just once.
+//
+// Every such node carries a structural hash, set as it is built: of its
+// kind, and its lexeme, value, or operator and operands.  It sits between
+// 'kind' and 'next', in what would otherwise be padding, so 'next' stays
+// where Ast has it, and the node is no bigger.  Since the operands
+// of a shared Exp are shared too, two shared nodes are structurally equal
+// exactly when they are the same node: astEqual is O(1).
+//
+// A shared node may hang off many parents, so must never be changed, and its
+// 'next' is never used.  (The parser links Args, not the Nam, Num or Str
+// inside them.)  The one exception is the binding that resProg gives a Nam:
+// the same name is a different Par or Var in each function, so nodes are
+// shared only within one function - astNewFun empties the table (see
+// astConsClear).  The table is not thread-safe, so it cannot be combined with
+// -j.
+// ============================================================================
+typedef struct {
+  Ast**    slot;            // hash table, by linear probing: NULL = empty
+  int      mask;            // ... which has mask + 1 slots
+  int      num;             // distinct nodes in the table
+  int      numBuilt;        // distinct nodes built, over all functions
+  int      numShared;       // requests answered with an existing node
+} AstCons;
+
+extern AstCons* g_astCons;
+
+Ast**    astArray(Ast* ast, int* num);
+void     astConsAdd(Ast* ast);
+void     astConsClear(AstCons* cons);
+Ast*     astConsFind(Ast* key);
+AstCons* astConsNew();
+int      astCountArgs(AstCall* astcall);
+int      astCountPars(AstFun* astfun);
+int      astCountVars(AstBody* astbody);
+int      astEqual(Ast* a, Ast* b);
+AstArg*  astFindArg(AstCall* astcall, int argnum);
+AstFun*  astFindFun(AstProg* astProg, char* funnam);
+unsigned astHash(Ast* ast);
+unsigned astHashStr(AST kind, char* s);
+unsigned astMix(unsigned h, unsigned x);
@@ -0,0 +1,279 @@
+// cfg.c - Control-Flow Graph, and Unreachable-Code Elimination
+//
+// See cfg.h
+
+#include "cfg.h"
+
+// ============================================================================
+// Rebuild 'fun' with only the blocks marked in 'reach', and only the
+// instructions not removed (op 0), re-numbering the blocks, and re-targeting
+// the branches, and phi args, to match.  A phi keeps only the args of blocks
+// that still branch to it.  Add what went to 'stats'.
+// ============================================================================
+void cfgCompact(IrFun* fun, char* reach, CfgStats* stats) {
+  int* newNum = malloc((fun->numBlk + 1) * sizeof(int));
+  IrIns* ins = malloc((fun->numIns + 1) * sizeof(IrIns));
+  IrBlk* blk = malloc((fun->numBlk + 1) * sizeof(IrBlk));
+  if (!newNum || !ins || !blk) utDie2Str("cfgCompact", "malloc failed");
+
+  int numBlk = 0;
+  for (int b = 0; b < fun->numBlk; ++b) newNum[b] = reach[b] ? numBlk++ : -1;
+
+  int numIns = 0;
+  for (int b = 0; b < fun->numBlk; ++b) {
+    if (!reach[b]) continue;
+    int lo = numIns;
+    for (int i = fun->blk[b].lo; i < fun->blk[b].lo + fun->blk[b].num; ++i) {
+      if (fun->ins[i].op == 0) continue;
+      ins[numIns] = fun->ins[i];
+      for (int t = 0; t < 2; ++t) {
+        if (ins[numIns].blk[t] >= 0) ins[numIns].blk[t] = newNum[ins[numIns].blk[t]];
+      }
+      if (ins[numIns].op == IRPHI) {
+        int lo = ins[numIns].num, num = 0;
+        for (int g = lo; g < lo + ins[numIns].numArg; ++g) {
+          int p = fun->arg[g].blk;
+          IrIns* term = &fun->ins[fun->blk[p].lo + fun->blk[p].num - 1];
+          if (!reach[p] || (term->blk[0] != b && term->blk[1] != b)) continue;
+          fun->arg[lo + num].blk = newNum[p];
+          fun->arg[lo + num++].v = fun->arg[g].v;
+        }
+        ins[numIns].numArg = num;
+      }
+      ++numIns;
+    }
+    blk[newNum[b]].lo = lo;
+    blk[newNum[b]].num = numIns - lo;
+  }
+
+  stats->numBlk += fun->numBlk - numBlk;
+  stats->numIns += fun->numIns - numIns;
+  memcpy(fun->ins, ins, numIns * sizeof(IrIns));
+  memcpy(fun->blk, blk, numBlk * sizeof(IrBlk));
+  fun->numIns = numIns;
+  fun->numBlk = numBlk;
+
+  free(blk);
+  free(ins);
+  free(newNum);
+}
+
+// ============================================================================
+// If vreg 'v' of 'fun' always holds the same value - it is a const, or a bin
+// of consts - set *val to it, and return 1.  Else return 0.  'defAt' gives
+// the instruction that defines each vreg.
+// ============================================================================
+int cfgConst(IrFun* fun, int* defAt, int v, int* val) {
+  IrIns* ins = &fun->ins[defAt[v]];
+  if (ins->op == IRCONST) {
+    *val = ins->num;
+    return 1;
+  }
+  int a, b;
+  if (ins->op != IRBIN || !cfgConst(fun, defAt, ins->a, &a) ||
+    !cfgConst(fun, defAt, ins->b, &b)) return 0;
+
+  switch (ins->bop) {                           // wrap, as ARM does
+    case BOPADD: *val = (int) ((unsigned) a + (unsigned) b); break;
+    case BOPSUB: *val = (int) ((unsigned) a - (unsigned) b); break;
+    case BOPMUL: *val = (int) ((unsigned) a * (unsigned) b); break;
+    case BOPLT:  *val = a <  b; break;
+    case BOPLE:  *val = a <= b; break;
+    case BOPNE:  *val = a != b; break;
+    case BOPEEQ: *val = a == b; break;
+    case BOPGE:  *val = a >= b; break;
+    case BOPGT:  *val = a >  b; break;
+    default:     return 0;
+  }
+  return 1;
+}
+
+// ============================================================================
+// Remove (make op 0) each instruction, in the blocks marked in 'reach',
+// that only computes a value, which nothing uses.  Removing one may leave
+// its operands unused too: a worklist of such instructions finds them all,
+// in time linear in the size of 'fun'.
+// ============================================================================
+void cfgDead(IrFun* fun, char* reach) {
+  int* numUse  = calloc(fun->numVreg + 1, sizeof(int));
+  int* defAt   = malloc((fun->numVreg + 1) * sizeof(int));   // first def of each vreg ...
+  int* nextDef = malloc((fun->numIns + 1) * sizeof(int));    // ... and the next, after copies
+  int* work    = malloc((fun->numIns + 1) * sizeof(int));
+  if (!numUse || !defAt || !nextDef || !work) utDie2Str("cfgDead", "alloc failed");
+
+  for (int v = 0; v < fun->numVreg; ++v) defAt[v] = -1;
+  for (int b = 0; b < fun->numBlk; ++b) {
+    if (!reach[b]) continue;
+    for (int i = fun->blk[b].lo; i < fun->blk[b].lo + fun->blk[b].num; ++i) {
+      IrIns* ins = &fun->ins[i];
+      if (ins->a >= 0) ++numUse[ins->a];
+      if (ins->b >= 0) ++numUse[ins->b];
+      if (ins->op == IRPHI) {
+        for (int g = ins->num; g < ins->num + ins->numArg; ++g) ++numUse[fun->arg[g].v];
+      }
+      if (ins->dst >= 0) {
+        nextDef[i] = defAt[ins->dst];
+        defAt[ins->dst] = i;
+      }
+    }
+  }
+
+  int numWork = 0;                              // each is pushed at most once
+  for (int b = 0; b < fun->numBlk; ++b) {
+    if (!reach[b]) continue;
+    for (int i = fun->blk[b].lo; i < fun->blk[b].lo + fun->blk[b].num; ++i) {
+      if (cfgPure(fun->ins[i].op) && numUse[fun->ins[i].dst] == 0) work[numWork++] = i;
+    }
+  }
+
+  while (numWork) {
+    IrIns* ins = &fun->ins[work[--numWork]];
+    int lo = ins->op == IRPHI ? ins->num : 0;
+    int hi = ins->op == IRPHI ? ins->num + ins->numArg : 0;
+    int uses[2] = { ins->a, ins->b };
+    for (int u = -2; u < hi - lo; ++u) {
+      int v = u < 0 ? uses[u + 2] : fun->arg[lo + u].v;
+      if (v < 0 || --numUse[v]) continue;
+      for (int d = defAt[v]; d >= 0; d = nextDef[d]) {
+        if (cfgPure(fun->ins[d].op)) work[numWork++] = d;
+      }
+    }
+    ins->op = 0;                                // removed (see cfgCompact)
+  }
+
+  free(work);
+  free(nextDef);
+  free(defAt);
+  free(numUse);
+}
+
+// ============================================================================
+// Make each cbr of 'fun' whose test is a constant into a br to the block it
+// must take
+// ============================================================================
+void cfgFold(IrFun* fun, CfgStats* stats) {
+  int* defAt = malloc((fun->numVreg + 1) * sizeof(int));
+  if (defAt == NULL) utDie2Str("cfgFold", "malloc failed");
+  for (int i = 0; i < fun->numIns; ++i) {
+    if (fun->ins[i].dst >= 0) defAt[fun->ins[i].dst] = i;
+  }
+
+  for (int b = 0; b < fun->numBlk; ++b) {
+    IrIns* ins = &fun->ins[fun->blk[b].lo + fun->blk[b].num - 1];
+    int val;
+    if (ins->op != IRCBR || !cfgConst(fun, defAt, ins->a, &val)) continue;
+    ins->op = IRBR;
+    ins->blk[0] = val ? ins->blk[0] : ins->blk[1];
+    ins->blk[1] = -1;
+    ins->a = -1;
+    ++stats->numFold;
+  }
+
+  free(defAt);
+}
+
+// ============================================================================
+// Free 'cfg'
+// ============================================================================
+void cfgFree(Cfg* cfg) {
+  free(cfg->succLo);
+  free(cfg->succ);
+  free(cfg->predLo);
+  free(cfg->pred);
+  free(cfg);
+}
+
+// ============================================================================
+// Clean 'fun' (see cfg.h), adding what was removed to 'stats'
+// ============================================================================
+void cfgFun(IrFun* fun, CfgStats* stats) {
+  cfgFold(fun, stats);
+  Cfg* cfg = cfgNew(fun);
+  char* reach = cfgReach(cfg);
+  cfgDead(fun, reach);
+  cfgCompact(fun, reach, stats);
+  free(reach);
+  cfgFree(cfg);
+}
+
+// ============================================================================
+// Build the Cfg of 'fun', from the terminator of each of its blocks
+// ============================================================================
+Cfg* cfgNew(IrFun* fun) {
+  int numBlk = fun->numBlk;
+  Cfg* cfg = calloc(1, sizeof(Cfg));
+  if (cfg == NULL) utDie2Str("cfgNew", "calloc failed");
+  cfg->numBlk = numBlk;
+  cfg->succLo = calloc(numBlk + 1, sizeof(int));
+  cfg->succ   = malloc((2 * numBlk + 1) * sizeof(int));
+  cfg->predLo = calloc(numBlk + 2, sizeof(int));
+  cfg->pred   = malloc((2 * numBlk + 1) * sizeof(int));
+  if (!cfg->succLo || !cfg->succ || !cfg->predLo || !cfg->pred) {
+    utDie2Str("cfgNew", "alloc failed");
+  }
+
+  int numSucc = 0;
+  for (int b = 0; b < numBlk; ++b) {
+    IrIns* ins = &fun->ins[fun->blk[b].lo + fun->blk[b].num - 1];
+    cfg->succLo[b] = numSucc;
+    if (ins->op == IRBR || ins->op == IRCBR) cfg->succ[numSucc++] = ins->blk[0];
+    if (ins->op == IRCBR && ins->blk[1] != ins->blk[0]) cfg->succ[numSucc++] = ins->blk[1];
+  }
+  cfg->succLo[numBlk] = numSucc;
+
+  for (int s = 0; s < numSucc; ++s) ++cfg->predLo[cfg->succ[s] + 2];
+  for (int b = 0; b < numBlk; ++b) cfg->predLo[b + 2] += cfg->predLo[b + 1];
+  for (int b = 0; b < numBlk; ++b) {            // predLo[x + 1] is the fill
+    for (int s = cfg->succLo[b]; s < cfg->succLo[b + 1]; ++s) {
+      cfg->pred[cfg->predLo[cfg->succ[s] + 1]++] = b;
+    }
+  }
+  return cfg;
+}
+
+// ============================================================================
+// Does 'op' only compute a value, so that it may go if the value is unused?
+// ============================================================================
+int cfgPure(IROP op) {
+  return op == IRBIN || op == IRCONST || op == IRCOPY || op == IRLOAD ||
+    op == IRPHI || op == IRSTR;
+}
+
+// ============================================================================
+// Clean every function of 'ir' (see cfg.h).  With --stats, report what was
+// removed.
+// ============================================================================
+void cfgProg(Ir* ir) {
+  CfgStats stats = { 0, 0, 0 };
+  for (int n = 0; n < ir->numFun; ++n) cfgFun(ir->fun[n], &stats);
+  if (g_irStats) {
+    printf("INFO: cfg: %d constant branches folded, %d unreachable blocks, "
+      "%d instructions removed \n", stats.numFold, stats.numBlk, stats.numIns);
+  }
+}
+
+// ============================================================================
+// Return, for each block of 'cfg', whether it can be reached from the entry
+// block, 0.  The walk keeps its own stack.
+// ============================================================================
+char* cfgReach(Cfg* cfg) {
+  char* reach = calloc(cfg->numBlk + 1, 1);
+  int* stack = malloc((cfg->numBlk + 1) * sizeof(int));
+  if (reach == NULL || stack == NULL) utDie2Str("cfgReach", "alloc failed");
+  if (cfg->numBlk == 0) { free(stack); return reach; }
+
+  int numStack = 0;
+  reach[0] = 1;
+  stack[numStack++] = 0;
+  while (numStack) {
+    int b = stack[--numStack];
+    for (int s = cfg->succLo[b]; s < cfg->succLo[b + 1]; ++s) {
+      if (reach[cfg->succ[s]]) continue;
+      reach[cfg->succ[s]] = 1;
+      stack[numStack++] = cfg->succ[s];
+    }
+  }
+
+  free(stack);
+  return reach;
+}
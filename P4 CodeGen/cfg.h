@@ -0,0 +1,48 @@
+// cfg.h - Control-Flow Graph, and Unreachable-Code Elimination
+
+#pragma once
+
+#include "ir.h"             // IrFun
+
+// A Cfg holds the successors and predecessors of each block of an IrFun, as
+// its terminators give them: none for a ret, one for a br, and two for a
+// cbr (just one, if both go to the same block).  Each list is a slice of one
+// array, in CSR form: the successors of block b are succ[succLo[b]] thru
+// succ[succLo[b + 1] - 1]; likewise its predecessors.  cfgNew builds it; a
+// pass that changes the blocks must build it afresh.
+//
+// cfgProg, run on the IR before codegen, cleans each function:
+//
+//    - a cbr whose test is a constant - "while (0)", "if (1 < 2)" - becomes
+//      a br to the block it must take
+//    - every block that cannot be reached from the entry block is removed:
+//      code after a return, the body of a loop that never runs, and so on
+//    - an instruction that only computes a value (const, load, str, bin,
+//      copy, phi) which is no longer used is removed, such as a folded test
+//
+// --stats reports how many of each it found.
+
+typedef struct {
+  int   numBlk;
+  int*  succLo;             // successors of block b are succ[succLo[b]] ...
+  int*  succ;               // ... thru succ[succLo[b + 1] - 1]
+  int*  predLo;             // predecessors, likewise
+  int*  pred;
+} Cfg;
+
+typedef struct {            // what cfgProg did, summed over all functions
+  int   numFold;            // cbrs made into brs
+  int   numBlk;             // blocks removed
+  int   numIns;             // instructions removed, in all
+} CfgStats;
+
+void  cfgCompact(IrFun* fun, char* reach, CfgStats* stats);
+int   cfgConst  (IrFun* fun, int* defAt, int v, int* val);
+void  cfgDead   (IrFun* fun, char* reach);
+void  cfgFold   (IrFun* fun, CfgStats* stats);
+void  cfgFree   (Cfg* cfg);
+void  cfgFun    (IrFun* fun, CfgStats* stats);
+Cfg*  cfgNew    (IrFun* fun);
+void  cfgProg   (Ir* ir);
+int   cfgPure   (IROP op);
+char* cfgReach  (Cfg* cfg);
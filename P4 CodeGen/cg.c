@@ -1,548 +1,514 @@
-// cg.c - Code Generator for SubC ASTs - Jim Hogg, 2022
-
-#include "cg.h"
-
-// ============================================================================
-// Asg        => Nam "=" (Exp | Call) ";"
-// Exp        => NamNum | NamNum Bop NamNum
-// NamNum     => Nam | Num
-// Nam        => Alpha AlphaNum*
-// Num        => [0-9]+
-// Bop        => "+" | "-" | "*" | "<" | "<=" | "!=" | "==" | ">=" | ">"
-//
-// Generate code to copy the value in R0 to the variable called 'varnam'.
-// eg:  STR R0, [FP, #@varnam]
-// ============================================================================
-void cgAsg(Cg* cg, char* funnam, char* varnam) {
-  char line[LINESIZE];
-
-  int varidx = layFindVarParIdx(cg->lay, funnam, varnam);
-  assert (varidx != 0);
-
-  int varoff = cg->lay->row[varidx].off;
-
-  sprintf(line, "\t STR \t R0, [FP, #%d]", varoff);
-  emitCode(cg->emit, line);
-}
-
-// ============================================================================
-// Block => "{" Stm+ "}"
-// ============================================================================
-void cgBlock(Cg* cg, char* funnam, AstBlock* astblock) {
-  AstStm* aststm = astblock->stms;
-  while(aststm) {
-    cgStm(cg, funnam, aststm);
-    aststm = (AstStm*)aststm->next;
-  }
-}
-
-// ============================================================================
-// Body => "{" Var* Stm+ "}"
-// ============================================================================
-void cgBody(Cg* cg, char* funnam, AstBody* astbody) {
-  cgStms(cg, funnam, astbody->stms);
-}
-
-// ============================================================================
-// Generate code for the operation (bop) connecting R0 and R1.  If 'bop' is an
-// arithmetic operator (+ - * /) then the answer is generated into R0.
-// For example, "a + b" generates:
-//
-//    LDR  R0, [FP, #@a]
-//    LDR  R1, [FP, #@b]
-//    ADD  R0, R0, R1
-//
-// If 'bop' is a comparison operator (< <= == != >= >), R0 will be left
-// holding 1 for TRUE and 0 for FALSE.  For example, "a < 5" generates:
-//
-//      LDR  R0, [FP, #@a]
-//      LDR  R1, =5
-//      CMP  R0, R1
-//      BLT  L20
-//      LDR  R0, #0         ; false
-//      B    L30
-// L20: LDR  R0, #1         ; true
-// L30:
-//
-// ============================================================================
-void cgBop(Cg* cg, BOP bop) {
-  char line[LINESIZE];
-
-  // First process Arithmetic operators
-
-  if (bop == BOPADD) {
-    sprintf(line, "\t ADD \t R0, R0, R1");
-    emitCode(cg->emit, line);
-    return;
-  } else if (bop == BOPMUL) {
-    sprintf(line, "\t MUL \t R0, R0, R1");
-    emitCode(cg->emit, line);
-    return;
-  } else if (bop == BOPSUB) {
-    sprintf(line, "\t SUB \t R0, R0, R1");
-    emitCode(cg->emit, line);
-    return;
-  }
-
-  // Now process the Boolean operators.
-
-  sprintf(line, "\t CMP \t R0, R1");
-  emitCode(cg->emit, line);
-
-  if (bop == BOPLT) {
-    cgBranch(cg, "BLT");
-  } else if (bop == BOPLE) {
-    cgBranch(cg, "BLE");
-  } else if (bop == BOPEEQ) {
-    cgBranch(cg, "BEQ");
-  } else if (bop == BOPNE) {
-    cgBranch(cg, "BNE");
-  } else if (bop == BOPGE) {
-    cgBranch(cg, "BGE");
-  } else if (bop == BOPGT) {
-    cgBranch(cg, "BGT");
-  }
-
-}
-
-// ============================================================================
-// Generate a conditional branch.
-//
-// 'cond' is a conditional branch instruction such as "BNE" or "BGT".
-//
-// 'bop' is a comparison operator (< <= == != >= >).  Make R0 hold 1 for
-// TRUE and 0 for FALSE.  For example, "BLE" generates:
-//
-//        BLE     L10
-//        LDR     R0, =0  ; false
-//        B       L20
-//  L10:  LDR     R0, =1  ; true
-//  L20:
-// ============================================================================
-void cgBranch(Cg* cg, char* cond) {
-  char line[LINESIZE];
-
-  char* truelabel = cgLabel();
-  sprintf(line, "\t %s \t %s", cond, truelabel);      // eg: L10
-  emitCode(cg->emit, line);
-
-  sprintf(line, "\t %s \t %s", "LDR", "R0, =0");      // FALSE
-  emitCode(cg->emit, line);
-
-  char* exitlabel = cgLabel();                        // eg: L20
-  sprintf(line, "\t %s \t %s", "B", exitlabel);
-  emitCode(cg->emit, line);
-
-  sprintf(line, "%s:", truelabel);                    // eg: L10:
-  emitCode(cg->emit, line);
-
-  sprintf(line, "\t %s \t %s", "LDR", "R0, =1");      // TRUE
-  emitCode(cg->emit, line);
-
-  sprintf(line, "%s:", exitlabel);                    // eg: L20:
-  emitCode(cg->emit, line);
-}
-
-// ============================================================================
-// Call => Nam "(" Args ")"
-//
-// Emit code to push arguments (right to left), and to BL to the target
-// function.  For example:
-//
-//    int add2(int a, int b) { ... }
-//    int main() { int mx; int my; int ms; ... ms = add2(mx, my); ... }
-//
-//    caller  =  "main" = caller function name
-//    callee  =  "add2" = callee function name
-//    argname =  "my"   = name of argument #2 in caller function 'main'
-//            => "mx"   = name of argument #1 in caller function 'main'
-//    numarg  =  2      = number of arguments to push (mx and my)
-//    argnum  =  2      = argument number for "my"
-//            => 1      = argument number for "mx"
-//
-// Needless to say, the number of arguments supplied by "main" in the
-// call to "add2" must match the number of parameters in the definition
-// of function "add2".  This version of the SubC compiler does NOT include
-// any check for this.
-//
-// "funnam" is the name of the current function - the one that emits the BSR.
-//
-// For the call ms = add2(mx, my), cgAsg will generate the ARM code:
-//
-//   MOV  R0, [FP, #@my]  ; load my
-//   PUSH {R0}
-//   MOV  R0 [FP, #@mx]   ; load mx
-//   PUSH {R0}
-//   BX   add2            ; call add2
-//
-// In the above code, "@mx" represents the offset, in bytes, of argument "mx"
-// from its Frame Pointer
-// ============================================================================
-void cgCall(Cg* cg, char* funnam, AstCall* astcall) {
-  char line[LINESIZE];
-  Lay* lay = cg->lay;                                     // alias
-
-  char* callee = astcall->nam->lex;                       // eg: "add2"
-
-  int numarg = astCountArgs(astcall->args);               // eg: 2
-
-  for (int argnum = numarg; argnum >= 1; --argnum) {
-    AstArg* astarg = astFindArg(astcall->args, argnum);
-    assert(astarg);
-
-    // What kind of argument is this?  Nam, Num or Str?
-
-    if (astarg->nns->kind == ASTNAM) {                      // var|par
-      AstNam* astnam = (AstNam*) astarg->nns;
-      char* lex = astnam->lex;                              // eg: "my"
-
-      int argidx = layFindVarParIdx(lay, funnam, lex);      // eg: "main", "my"
-      assert (argidx != 0);
-
-      int argoff = lay->row[argidx].off;
-
-      sprintf(line, "\t LDR \t R0, \t [FP, #%d]", argoff);  // eg: LDR R0, [FP, #12]
-      emitCode(cg->emit, line);
-
-      sprintf(line, "\t PUSH \t {R0}");                     // eg PUSH {R0}
-      emitCode(cg->emit, line);
-    } else if (astarg->nns->kind == ASTNUM) {               // literal number
-      AstNum* num = (AstNum*) astarg->nns;
-      int val = num->val;                                   // eg: 42
-      sprintf(line, "\t MOV \t R0, #%d", val);              // eg: LDR R0, #42
-      emitCode(cg->emit, line);
-      sprintf(line, "\t PUSH \t {R0}");                     // PUSH {R0}
-      emitCode(cg->emit, line);
-    } else if (astarg->nns->kind == ASTSTR) {               // literal string
-      char* datalabel = cgLabel();
-      sprintf(line, "%s:", datalabel);                      // eg: L50:
-      emitData(cg->emit, line);
-
-      AstStr* str = (AstStr*) astarg->nns;
-      char*   txt = str->txt;
-      sprintf(line, "\t .ASCIZ \t \"%s\" ", txt);           // eg: .ASCIZ "hello"
-      emitData(cg->emit, line);
-
-      sprintf(line, "\t LDR \t R0, =%s", datalabel);
-      emitCode(cg->emit, line);
-
-      sprintf(line, "\t PUSH \t {R0}");
-      emitCode(cg->emit, line);
-    }
-  }
-
-  sprintf(line, "\t BL \t %s", callee);                 // eg: "BL add2"
-  emitCode(cg->emit, line);
-
-  // Remember to remove the arguments previously pushed onto the stack.
-  // Because each stack slot in ARM is a WORD, the number of bytes
-  // (numb) to remove is simply 4 * numarg
-
-  int numb = 4 * numarg;
-
-  sprintf(line, "\t ADD \t SP, SP, #%d", numb);
-  emitCode(cg->emit, line);
-
-}
-
-// ============================================================================
-// Generate the Epilog for the function called 'funnam'
-// ============================================================================
-void cgEpilog(Cg* cg, char* funnam) {
-
-  Emit* emit = cg->emit;                // alias
-
-  char line[LINESIZE];
-
-  // Remove the stack space previously reserved for local variables
-
-  sprintf(line, "\t MOV \t SP, FP");
-  emitCode(emit, line);
-
-  // Pop FP and LR from the stack
-
-  sprintf(line, "\t POP \t {FP, LR}");
-  emitCode(emit, line);
-
-  // Return to caller
-
-  sprintf(line, "\t BX \t LR");
-  emitCode(emit, line);
-
-}
-
-// ============================================================================
-// Exp => NamNum | NamNum Bop NamNum
-//
-// Suppose Exp = a - 7.  Then cgExp will generate the following arm code:
-//
-//   MOV R0, [FP, #@a]
-//   LDR R1, =7
-//   SUB R0, R0, R1
-//
-// 'funnam' is the name of the function in which this expression occurs.
-// ============================================================================
-void cgExp(Cg* cg, char* funnam, AstExp* astexp) {
-
-  if (astexp->lhs == NULL) return;
-
-  if (astexp->lhs->kind == ASTNAM) {
-    AstNam* astnam = (AstNam*) (astexp->lhs);
-    cgNam(cg, funnam, astnam, "R0");
-  } else if (astexp->lhs->kind == ASTNUM) {
-    AstNum* astnum = (AstNum*) (astexp->lhs);
-    cgNum(cg, astnum, "R0");
-  }
-
-  if (astexp->rhs == NULL) return;
-
-  if (astexp->rhs->kind == ASTNAM) {
-    AstNam* astnam = (AstNam*) (astexp->rhs);
-    cgNam(cg, funnam, astnam, "R1");
-  } else if (astexp->rhs->kind == ASTNUM) {
-    AstNum* astnum = (AstNum*) (astexp->rhs);
-    cgNum(cg, astnum, "R1");
-  }
-
-  cgBop(cg, astexp->bop);
-
-}
-
-// ============================================================================
-// Fun => "int"   Nam     "(" Pars ")" Body
-//      | "int"   "main"  "("      ")" Body
-//
-// Note that we need to devise the frame Layout in order to know where to find
-// each Argument and local Variable in the Stack Frame.
-// ============================================================================
-void cgFun(Cg* cg, AstFun* astfun) {
-  layBuild(cg->lay, astfun);                // build layout (par/var offsets)
-  char* funnam = astfun->nam->lex;          // name of current function
-
-  // Emit the label that marks the start location of this function.  For
-  // example, if 'funnam' = "add2" then emit the line: "add2: "
-
-  char line[LINESIZE];
-  sprintf(line, "%s:", funnam);
-  emitCode(cg->emit, line);
-
-  // Emit the Prolog code
-
-  cgProlog(cg, funnam);
-
-  // Now generate code for the body of the function
-
-  cgBody(cg, funnam, astfun->body);         // generate code for body
-
-}
-
-// ============================================================================
-// If => "if" "(" Exp ")" Block
-// ============================================================================
-void cgIf(Cg* cg, char* funnam, AstIf* astif) {
-  
-  // Note that cgExp returns its answer in R0: 0 for FALSE, 1 for TRUE
-  char line[LINESIZE];
-
-  char* exitlabel = cgLabel();  // Generate a label for the exit of the if block
-
-  // Evaluate the expression inside the if statement
-  cgExp(cg, funnam, astif->exp); 
-
-  // Check the result of the evaluation (in R0)
-  sprintf(line, "\t CMP \t R0, #0"); // Check if the condition is false
-  emitCode(cg->emit, line);
-
-  // If the condition is false, jump to the exit label
-  sprintf(line, "\t BEQ \t %s", exitlabel);
-  emitCode(cg->emit, line);
-
-  // Generate code for the if block
-  cgBlock(cg, funnam, astif->block);
-
-  // Label for the exit of the if block
-  sprintf(line, "%s:", exitlabel);
-  emitCode(cg->emit, line);
-}
-
-// ============================================================================
-// Generate a fresh label.  The sequence generated is L10, L20, L30, etc
-// ============================================================================
-char* cgLabel() {
-  #define LABELINC 10;
-  static int labnum = 10;
-
-  char* line = calloc(LINESIZE, 1);
-  assert(line);
-
-  labnum += LABELINC;
-  sprintf(line, "L%d", labnum);
-  return line;
-}
-
-// ============================================================================
-// Nam => Alpha AlphaNum*
-//
-// Suppose astnam->nam = "x" and reg = "R1".  Then lookup the offset, from FP,
-// of parameter or local variable "x".  If found with offset = 12, for example,
-// then emit code: "LDR R1, [FP, #12]
-// ============================================================================
-void cgNam(Cg* cg, char* funnam, AstNam* astnam, char* reg) {
-
-  char line[LINESIZE];
-
-  int idx = layFindVarParIdx(cg->lay, funnam, astnam->lex);
-
-  int off = cg->lay->row[idx].off;
-  if (off == 0) utDie5Str("cgNam", "cgFind failed, looking for symbol",
-    astnam->lex, "in function", funnam);
-
-  sprintf(line, "\t LDR \t %s, [FP, #%d]", reg, off);
-  emitCode(cg->emit, line);
-}
-
-// ============================================================================
-// Build a new Cg (CodeGen) struct
-// ============================================================================
-Cg* cgNew() {
-  Cg* cg = calloc(sizeof(Cg), 1);
-  assert(cg);
-
-  cg->lay = layNew(LAYMAX);
-  cg->emit = emitNew();
-
-  return cg;
-}
-
-// ============================================================================
-// Num => [0-9]+
-//
-// Suppose astnum->num = 42, and reg = "R1".  Then emit: "LDR R1, =42"
-// ============================================================================
-void cgNum(Cg* cg, AstNum* astnum, char* reg) {
-  char line[LINESIZE];
-  sprintf(line, "\t LDR \t %s, =%d", reg, astnum->val);
-  emitCode(cg->emit, line);
-}
-
-// ============================================================================
-// Prog => Fun+
-// ============================================================================
-void cgProg(Cg* cg, AstProg* astprog) {
-  AstFun* astfun = astprog->funs;
-
-  // Pre-populate the Layout with intrinsics says, sayn and sayl
-
-  layBuildIntrinsics(cg->lay);
-
-  // Generate code for each function we encounter (in lexical order)
-  // in the SubC source file
-
-  while (astfun) {
-    cgFun(cg, astfun);
-    astfun = (AstFun*) (astfun->next);
-  }
-}
-
-// ============================================================================
-// Emit Prolog code for a function.  For example:
-//
-//    int add2(int a, int b) { ... }
-//    int main() { int mx; int my; int ms; ... ms = add2(mx, my); ... }
-//
-// 'funnam' is the name of the current function
-// ============================================================================
-void cgProlog(Cg* cg, char* funnam) {
- 
-  Emit* emit = cg->emit; // Alias for emitting code
-  char line[LINESIZE];   // Line buffer for code generation
-
-  // Save the Frame Pointer (FP) and Link Register (LR) to the stack
-  sprintf(line, "\t PUSH \t {FP, LR}");
-  emitCode(emit, line);
-
-  // Set up the new Frame Pointer (FP) to point to the current Stack Pointer (SP)
-  sprintf(line, "\t MOV \t FP, SP");
-  emitCode(emit, line);
-
-  // Allocate space for local variables on the stack
-  int localVarSpace = 32; 
-  sprintf(line, "\t SUB \t SP, SP, #%d", localVarSpace);
-  emitCode(emit, line);
-
-  // Emit the label for the start of the function
-  sprintf(line, "%s:", funnam); 
-  emitCode(emit, line);
-}
-
-// ============================================================================
-// Stm => If | Asg | Ret | While
-// ============================================================================
-void cgStm(Cg* cg, char* funnam, AstStm* aststm) {
-  switch(aststm->kind) {
-    case ASTIF:     { AstIf* astif = (AstIf*) aststm;
-                      cgIf(cg, funnam, astif);
-                      break;
-                    }
-    case ASTASG:    { AstAsg* astasg = (AstAsg*) aststm;
-                      if (astasg->eoc->kind == ASTCALL) {             // Call
-                        AstCall* astcall = (AstCall*) astasg->eoc;
-                        cgCall(cg, funnam, astcall);
-                      } else {                                        // Exp
-                        AstExp* astexp = (AstExp*) astasg->eoc;
-                        cgExp(cg, funnam, astexp);
-                      }
-                      cgAsg(cg, funnam, astasg->nam->lex);
-                      break;
-                    }
-    case ASTRET:    { AstRet* astret = (AstRet*) aststm;
-                      cgExp(cg, funnam, astret->exp);
-                      cgEpilog(cg, funnam);
-                      break;
-                    }
-    case ASTWHILE:  { AstWhile* astwhile = (AstWhile*) aststm;
-                      cgWhile(cg, funnam, astwhile);
-                      break;
-                    }
-    default:        { utDie2Str("cgStm", "Invalid aststm->kind"); }
-  }
-}
-
-// ============================================================================
-// Stms = Stm+
-// ============================================================================
-void cgStms(Cg* cg, char* funnam, AstStm* aststm) {
-  while (aststm) {
-    cgStm(cg, funnam, aststm);
-    aststm = (AstStm*) aststm->next;
-  }
-}
-
-// ============================================================================
-// While => "while" "(" Exp ")" Block
-// ============================================================================
-void cgWhile (Cg* cg, char* funnam, AstWhile* astwhile) {
-  char line[LINESIZE];
-
-  char* startlabel = cgLabel();                     // eg: "L20"
-  sprintf(line, "%s:", startlabel);                 // eg: "L20:"
-  emitCode(cg->emit, line);
-
-  char* exitlabel = cgLabel();                      // eg: "L30"
-
-  cgExp(cg, funnam, astwhile->exp);                 // result in R0
-
-  sprintf(line, "\t CMP \t R0, #0");                // is test false?
-  emitCode(cg->emit, line);
-
-  sprintf(line, "\t BEQ \t %s", exitlabel);         // eg: BEQ L30
-  emitCode(cg->emit, line);
-
-  cgBlock(cg, funnam, astwhile->block);
-
-  sprintf(line, "\t B \t %s", startlabel);          // eg: B L20
-  emitCode(cg->emit, line);
-
-  sprintf(line, "%s:", exitlabel);                  // eg: L30:
-  emitCode(cg->emit, line);
-}
+// cg.c - Code Generator for SubC ASTs - Jim Hogg, 2022
+
+#include "cg.h"
+
+static char* g_cgReg[] = { "R0", "R1", "R2" };  // by register number
+
+// ============================================================================
+// Give each vreg of 'fun' a home (see cg.h), in cg->loc, and note, in
+// cg->target, which blocks are branched to.  Return the size of the frame:
+// the Vars, and then the spill slots, kept 8-byte aligned.
+//
+// A vreg lives from its definition to its last use.  Walking the
+// instructions in order, we free the register of each vreg at its last use,
+// and give a register to each vreg as it is defined: R0 for the result of a
+// call, if it can, else the lowest free.  A vreg that lives across a call
+// (which may clobber R0 thru R3), or beyond its block, is spilled.  So is one
+// defined by several copies (see ir.h): each def then stores to its one slot.
+// ============================================================================
+int cgAlloc(Cg* cg, IrFun* fun) {
+  int numVreg = fun->numVreg;
+  cg->loc    = realloc(cg->loc,    (numVreg + 1) * sizeof(int));
+  cg->last   = realloc(cg->last,   (numVreg + 1) * sizeof(int));
+  cg->label  = realloc(cg->label,  (fun->numBlk + 1) * sizeof(char*));
+  cg->target = realloc(cg->target, fun->numBlk + 1);
+  int* defAt = malloc((numVreg + 1) * sizeof(int));
+  char* cross = calloc(numVreg + 1, 1);
+  int* numCall = malloc((fun->numIns + 1) * sizeof(int));   // calls before
+  if (!cg->loc || !cg->last || !cg->label || !cg->target || !defAt || !cross ||
+    !numCall) {
+    utDie2Str("cgAlloc", "alloc failed");
+  }
+  memset(cg->label, 0, fun->numBlk * sizeof(char*));
+  memset(cg->target, 0, fun->numBlk);
+  for (int v = 0; v < numVreg; ++v) cg->loc[v] = defAt[v] = cg->last[v] = -1;
+
+  numCall[0] = 0;
+  for (int b = 0; b < fun->numBlk; ++b) {
+    int hi = fun->blk[b].lo + fun->blk[b].num;
+    for (int i = fun->blk[b].lo; i < hi; ++i) {
+      IrIns* ins = &fun->ins[i];
+      numCall[i + 1] = numCall[i] + (ins->op == IRCALL);
+      int uses[2] = { ins->a, ins->b };
+      for (int u = 0; u < 2; ++u) {
+        int v = uses[u];
+        if (v < 0) continue;
+        if (defAt[v] < fun->blk[b].lo) cross[v] = 1;        // from another block
+        cg->last[v] = i;
+      }
+      if (ins->dst >= 0) {
+        defAt[ins->dst] = i;
+        if (cg->last[ins->dst] >= 0) cross[ins->dst] = 1;   // used above
+        cg->last[ins->dst] = i;
+      }
+      if (ins->op == IRBR && ins->blk[0] != b + 1) cg->target[ins->blk[0]] = 1;
+      if (ins->op == IRCBR) {
+        cg->target[ins->blk[1]] = 1;
+        if (ins->blk[0] != b + 1) cg->target[ins->blk[0]] = 1;
+      }
+    }
+  }
+
+  int numSpill = 0;
+  int busy = 0;                                 // bit r set: register r holds a vreg
+  for (int i = 0; i < fun->numIns; ++i) {
+    IrIns* ins = &fun->ins[i];
+    int uses[2] = { ins->a, ins->b };
+    for (int u = 0; u < 2; ++u) {
+      int v = uses[u];
+      if (v >= 0 && cg->last[v] == i && cg->loc[v] >= 0) busy &= ~(1 << cg->loc[v]);
+    }
+
+    int d = ins->dst;
+    if (d < 0 || cg->loc[d] != -1) continue;    // no value, or placed already
+    if (numCall[cg->last[d]] - numCall[i + 1] > 0) cross[d] = 1;
+
+    int r = -1;
+    if (!cross[d]) {
+      if (ins->op == IRCALL && !(busy & 1)) r = 0;
+      for (int k = 0; r < 0 && k < CGNUMREG; ++k) if (!(busy & (1 << k))) r = k;
+    }
+    if (r >= 0) {
+      cg->loc[d] = r;
+      if (cg->last[d] > i) busy |= 1 << r;      // else, never used
+    } else {
+      cg->loc[d] = -(fun->frame + BYTESPERINT * ++numSpill);
+    }
+  }
+
+  free(numCall);
+  free(cross);
+  free(defAt);
+  return (fun->frame + BYTESPERINT * numSpill + 7) & ~7;
+}
+
+// ============================================================================
+// Generate code for 'ins', an IRARG: push its value.  The intrinsics says
+// and sayn in io.s take their argument in R0, not from the stack, so the
+// first argument - the last one pushed, just before the IRCALL - goes by way
+// of R0.  That holds whatever register the allocator gave it: nothing in R0
+// lives across the call, so R0 is free to take it.  For sayn(x):
+//
+//   MOV  R0, R1          ; x, in R1 (or LDR R0, [FP, #-8], if spilled)
+//   PUSH {R0}
+//
+// ============================================================================
+void cgArg(Cg* cg, IrIns* ins) {
+  char line[LINESIZE];
+  char* reg;
+  if (ins[1].op != IRCALL) {
+    reg = cgUse(cg, ins->a, "R3");
+  } else {
+    reg = cgUse(cg, ins->a, "R0");
+    if (strcmp(reg, "R0") != 0) {
+      sprintf(line, "\t MOV \t R0, %s", reg);
+      emitCode(cg->emit, line);
+      reg = "R0";
+    }
+  }
+  sprintf(line, "\t PUSH \t {%s}", reg);
+  emitCode(cg->emit, line);
+}
+
+// ============================================================================
+// Generate code for 'ins', an IRBIN, applying its operator (bop) to its two
+// operands.  If 'bop' is an arithmetic operator (+ - *) then the answer is
+// generated into the destination.  For example, "v2 = v0 + v1", with its
+// operands in R0 and R1, and its answer to go in R0, generates:
+//
+//    ADD  R0, R0, R1
+//
+// If 'bop' is a comparison operator (< <= == != >= >), the destination will
+// be left holding 1 for TRUE and 0 for FALSE.  For example, "v2 = v0 < v1"
+// generates:
+//
+//      CMP  R0, R1
+//      BLT  L20
+//      LDR  R0, =0         ; false
+//      B    L30
+// L20: LDR  R0, =1         ; true
+// L30:
+//
+// ============================================================================
+void cgBin(Cg* cg, IrIns* ins) {
+  char line[LINESIZE];
+
+  char* a = cgUse(cg, ins->a, "R3");
+  char* b = cgUse(cg, ins->b, "R12");
+  char* d = cgDst(cg, ins->dst);
+
+  // First process Arithmetic operators
+
+  char* op = ins->bop == BOPADD ? "ADD" : ins->bop == BOPMUL ? "MUL"
+    : ins->bop == BOPSUB ? "SUB" : NULL;
+  if (op) {
+    sprintf(line, "\t %s \t %s, %s, %s", op, d, a, b);
+    emitCode(cg->emit, line);
+    cgDstEnd(cg, ins->dst);
+    return;
+  }
+
+  // Now process the Boolean operators.
+
+  sprintf(line, "\t CMP \t %s, %s", a, b);
+  emitCode(cg->emit, line);
+
+  if (ins->bop == BOPLT) {
+    cgBranch(cg, "BLT", d);
+  } else if (ins->bop == BOPLE) {
+    cgBranch(cg, "BLE", d);
+  } else if (ins->bop == BOPEEQ) {
+    cgBranch(cg, "BEQ", d);
+  } else if (ins->bop == BOPNE) {
+    cgBranch(cg, "BNE", d);
+  } else if (ins->bop == BOPGE) {
+    cgBranch(cg, "BGE", d);
+  } else if (ins->bop == BOPGT) {
+    cgBranch(cg, "BGT", d);
+  }
+  cgDstEnd(cg, ins->dst);
+}
+
+// ============================================================================
+// Return the label of block 'blk' of the current function, making it, if
+// this is the first time it is asked for
+// ============================================================================
+char* cgBlkLabel(Cg* cg, int blk) {
+  if (cg->label[blk] == NULL) cg->label[blk] = cgLabel(cg);
+  return cg->label[blk];
+}
+
+// ============================================================================
+// Generate a conditional branch.
+//
+// 'cond' is a conditional branch instruction such as "BNE" or "BGT".
+//
+// Make 'reg' hold 1 for TRUE and 0 for FALSE.  For example, "BLE" generates:
+//
+//        BLE     L10
+//        LDR     R0, =0  ; false
+//        B       L20
+//  L10:  LDR     R0, =1  ; true
+//  L20:
+// ============================================================================
+void cgBranch(Cg* cg, char* cond, char* reg) {
+  char line[LINESIZE];
+
+  char* truelabel = cgLabel(cg);
+  sprintf(line, "\t %s \t %s", cond, truelabel);      // eg: L10
+  emitCode(cg->emit, line);
+
+  sprintf(line, "\t LDR \t %s, =0", reg);             // FALSE
+  emitCode(cg->emit, line);
+
+  char* exitlabel = cgLabel(cg);                      // eg: L20
+  sprintf(line, "\t %s \t %s", "B", exitlabel);
+  emitCode(cg->emit, line);
+
+  sprintf(line, "%s:", truelabel);                    // eg: L10:
+  emitCode(cg->emit, line);
+
+  sprintf(line, "\t LDR \t %s, =1", reg);             // TRUE
+  emitCode(cg->emit, line);
+
+  sprintf(line, "%s:", exitlabel);                    // eg: L20:
+  emitCode(cg->emit, line);
+}
+
+// ============================================================================
+// Generate code for 'ins', an IRCALL.  Its IRARGs have pushed its arguments,
+// right to left, and left the first of them in R0 as well (see cgArg).  So
+// BL to the target function, then pop them.  For the call ms = add2(mx, my):
+//
+//   BL   add2            ; call add2
+//   ADD  SP, SP, #8      ; pop mx and my
+//
+// The callee leaves its result in R0: move it, if 'ms' lives elsewhere.
+// ============================================================================
+void cgCall(Cg* cg, IrIns* ins) {
+  char line[LINESIZE];
+
+  sprintf(line, "\t BL \t %s", ins->sym);               // eg: "BL add2"
+  emitCode(cg->emit, line);
+
+  // Remember to remove the arguments previously pushed onto the stack.
+  // Because each stack slot in ARM is a WORD, the number of bytes
+  // (numb) to remove is simply 4 * numarg
+
+  int numb = 4 * ins->num;
+
+  sprintf(line, "\t ADD \t SP, SP, #%d", numb);
+  emitCode(cg->emit, line);
+
+  int loc = cg->loc[ins->dst];
+  if (loc > 0) {
+    sprintf(line, "\t MOV \t %s, R0", g_cgReg[loc]);
+    emitCode(cg->emit, line);
+  } else if (loc < 0) {
+    sprintf(line, "\t STR \t R0, [FP, #%d]", loc);
+    emitCode(cg->emit, line);
+  }
+}
+
+// ============================================================================
+// Return the register in which to compute vreg 'v': its own, or scratch R3,
+// if it is spilled (see cgDstEnd)
+// ============================================================================
+char* cgDst(Cg* cg, int v) {
+  return cg->loc[v] >= 0 ? g_cgReg[cg->loc[v]] : "R3";
+}
+
+// ============================================================================
+// Once vreg 'v' is computed, into the register given by cgDst, store it to
+// its spill slot, if it has one
+// ============================================================================
+void cgDstEnd(Cg* cg, int v) {
+  if (cg->loc[v] >= 0) return;
+  char line[LINESIZE];
+  sprintf(line, "\t STR \t R3, [FP, #%d]", cg->loc[v]);
+  emitCode(cg->emit, line);
+}
+
+// ============================================================================
+// Generate the Epilog for the current function
+// ============================================================================
+void cgEpilog(Cg* cg) {
+
+  Emit* emit = cg->emit;                // alias
+
+  char line[LINESIZE];
+
+  // Remove the stack space previously reserved for local variables
+
+  sprintf(line, "\t MOV \t SP, FP");
+  emitCode(emit, line);
+
+  // Pop FP and LR from the stack
+
+  sprintf(line, "\t POP \t {FP, LR}");
+  emitCode(emit, line);
+
+  // Return to caller
+
+  sprintf(line, "\t BX \t LR");
+  emitCode(emit, line);
+
+}
+
+// ============================================================================
+// Fun => "int"   Nam     "(" Pars ")" Body
+//      | "int"   "main"  "("      ")" Body
+//
+// Generate code for 'fun': its label and Prolog, then its blocks, in order.
+// Each block that is branched to gets a label.
+// ============================================================================
+void cgFun(Cg* cg, IrFun* fun) {
+  cg->fun = fun;
+  int size = cgAlloc(cg, fun);
+
+  // Emit the label that marks the start location of this function.  For
+  // example, if 'fun->nam' = "add2" then emit the line: "add2: "
+
+  char line[LINESIZE];
+  sprintf(line, "%s:", fun->nam);
+  emitCode(cg->emit, line);
+
+  // Emit the Prolog code
+
+  cgProlog(cg, fun->nam, size);
+
+  for (int b = 0; b < fun->numBlk; ++b) {
+    if (cg->target[b]) {
+      sprintf(line, "%s:", cgBlkLabel(cg, b));        // eg: L30:
+      emitCode(cg->emit, line);
+    }
+    for (int i = fun->blk[b].lo; i < fun->blk[b].lo + fun->blk[b].num; ++i) {
+      cgIns(cg, b, &fun->ins[i]);
+    }
+  }
+}
+
+// ============================================================================
+// Generate code for 'ins', in block 'blk' of the current function.  A branch
+// to the next block is left out: control falls through to it.
+// ============================================================================
+void cgIns(Cg* cg, int blk, IrIns* ins) {
+  char line[LINESIZE];
+  switch (ins->op) {
+    case IRARG:   { cgArg(cg, ins); break; }
+    case IRBIN:   { cgBin(cg, ins); break; }
+    case IRBR:    { if (ins->blk[0] == blk + 1) break;
+                    sprintf(line, "\t B \t %s", cgBlkLabel(cg, ins->blk[0]));
+                    emitCode(cg->emit, line);
+                    break;
+                  }
+    case IRCALL:  { cgCall(cg, ins); break; }
+    case IRCBR:   { sprintf(line, "\t CMP \t %s, #0", cgUse(cg, ins->a, "R3"));
+                    emitCode(cg->emit, line);         // is test false?
+                    sprintf(line, "\t BEQ \t %s", cgBlkLabel(cg, ins->blk[1]));
+                    emitCode(cg->emit, line);
+                    if (ins->blk[0] == blk + 1) break;
+                    sprintf(line, "\t B \t %s", cgBlkLabel(cg, ins->blk[0]));
+                    emitCode(cg->emit, line);
+                    break;
+                  }
+    case IRCONST: { sprintf(line, "\t LDR \t %s, =%d", cgDst(cg, ins->dst), ins->num);
+                    emitCode(cg->emit, line);
+                    cgDstEnd(cg, ins->dst);
+                    break;
+                  }
+    case IRCOPY:  { char* a = cgUse(cg, ins->a, "R3");
+                    char* d = cgDst(cg, ins->dst);
+                    if (strcmp(a, d)) {
+                      sprintf(line, "\t MOV \t %s, %s", d, a);
+                      emitCode(cg->emit, line);
+                    }
+                    cgDstEnd(cg, ins->dst);
+                    break;
+                  }
+    case IRLOAD:  { sprintf(line, "\t LDR \t %s, [FP, #%d]", cgDst(cg, ins->dst), ins->num);
+                    emitCode(cg->emit, line);
+                    cgDstEnd(cg, ins->dst);
+                    break;
+                  }
+    case IRRET:   { if (ins->a >= 0 && cg->loc[ins->a] < 0) {
+                      sprintf(line, "\t LDR \t R0, [FP, #%d]", cg->loc[ins->a]);
+                      emitCode(cg->emit, line);
+                    } else if (ins->a >= 0 && cg->loc[ins->a] > 0) {
+                      sprintf(line, "\t MOV \t R0, %s", g_cgReg[cg->loc[ins->a]]);
+                      emitCode(cg->emit, line);
+                    }
+                    cgEpilog(cg);
+                    break;
+                  }
+    case IRSTORE: { sprintf(line, "\t STR \t %s, [FP, #%d]", cgUse(cg, ins->a, "R3"), ins->num);
+                    emitCode(cg->emit, line);
+                    break;
+                  }
+    case IRSTR:   { char* datalabel = cgLabel(cg);
+                    sprintf(line, "%s:", datalabel);                  // eg: L50:
+                    emitData(cg->emit, line);
+                    sprintf(line, "\t .ASCIZ \t \"%s\" ", ins->sym);  // eg: .ASCIZ "hello"
+                    emitData(cg->emit, line);
+                    sprintf(line, "\t LDR \t %s, =%s", cgDst(cg, ins->dst), datalabel);
+                    emitCode(cg->emit, line);
+                    cgDstEnd(cg, ins->dst);
+                    break;
+                  }
+    default:      { utDie2Str("cgIns", "Invalid ins->op"); }
+  }
+}
+
+// ============================================================================
+// Can 'val' be an ARM data-processing immediate: an 8-bit value, rotated
+// right by an even number of bits?
+// ============================================================================
+int cgIsImm(unsigned val) {
+  for (int rot = 0; rot < 32; rot += 2) {
+    unsigned v = (val << rot) | (val >> ((32 - rot) & 31));
+    if (v <= 0xFF) return 1;
+  }
+  return 0;
+}
+
+// ============================================================================
+// Generate a fresh label.  The sequence generated is L20, L30, L40, etc,
+// starting afresh for each new Cg
+// ============================================================================
+char* cgLabel(Cg* cg) {
+  #define LABELINC 10;
+
+  char* line = calloc(LINESIZE, 1);
+  assert(line);
+
+  cg->labnum += LABELINC;
+  sprintf(line, "L%d", cg->labnum);
+  return line;
+}
+
+// ============================================================================
+// Build a new Cg (CodeGen) struct
+// ============================================================================
+Cg* cgNew() {
+  Cg* cg = calloc(sizeof(Cg), 1);
+  assert(cg);
+
+  cg->lay = layNew();
+  cg->emit = emitNew();
+  cg->labnum = 10;
+
+  return cg;
+}
+
+// ============================================================================
+// Prog => Fun+
+//
+// Generate code for each function of 'ir', in lexical order, in the SubC
+// source file.  irProg built 'ir' from the AST, once resProg had resolved
+// it into cg->lay.
+// ============================================================================
+void cgProg(Cg* cg, Ir* ir) {
+  for (int n = 0; n < ir->numFun; ++n) cgFun(cg, ir->fun[n]);
+}
+
+// ============================================================================
+// Emit Prolog code for a function.  For example:
+//
+//    int add2(int a, int b) { ... }
+//    int main() { int mx; int my; int ms; ... ms = add2(mx, my); ... }
+//
+// 'funnam' is the name of the current function.  'size' is the size of its
+// frame, below FP (see cgAlloc).
+// ============================================================================
+void cgProlog(Cg* cg, char* funnam, int size) {
+
+  Emit* emit = cg->emit; // Alias for emitting code
+  char line[LINESIZE];   // Line buffer for code generation
+
+  // Save the Frame Pointer (FP) and Link Register (LR) to the stack
+  sprintf(line, "\t PUSH \t {FP, LR}");
+  emitCode(emit, line);
+
+  // Set up the new Frame Pointer (FP) to point to the current Stack Pointer (SP)
+  sprintf(line, "\t MOV \t FP, SP");
+  emitCode(emit, line);
+
+  // Allocate space for local variables, and spilled vregs, on the stack:
+  // 'size' is kept 8-byte aligned.  None, if there are none.  A size too
+  // big for an ARM immediate goes via R12 (IP)
+  if (size > 0 && cgIsImm(size)) {
+    sprintf(line, "\t SUB \t SP, SP, #%d", size);
+    emitCode(emit, line);
+  } else if (size > 0) {
+    sprintf(line, "\t LDR \t R12, =%d", size);
+    emitCode(emit, line);
+    sprintf(line, "\t SUB \t SP, SP, R12");
+    emitCode(emit, line);
+  }
+
+  // Emit the label for the start of the function
+  sprintf(line, "%s:", funnam);
+  emitCode(emit, line);
+}
+
+// ============================================================================
+// Return the register that holds vreg 'v': its own, or else 'scratch', into
+// which we load it from its spill slot
+// ============================================================================
+char* cgUse(Cg* cg, int v, char* scratch) {
+  if (cg->loc[v] >= 0) return g_cgReg[cg->loc[v]];
+  char line[LINESIZE];
+  sprintf(line, "\t LDR \t %s, [FP, #%d]", scratch, cg->loc[v]);
+  emitCode(cg->emit, line);
+  return scratch;
+}
@@ -1,39 +1,53 @@
-// cg.h - Code Generator - Jim Hogg, 2020
-
-#pragma once
-
-#include <assert.h>     // assert
-
-#include "ast.h"        // Ast*
-#include "emit.h"       // Emit Buffer
-#include "lay.h"        // Layout of stack frames
-#include "ut.h"         // ut*
-
-////#define LINESIZE 100
-
-typedef struct {
-  Lay*  lay;
-  Emit* emit;
-} Cg;
-
-void  cgAsg   (Cg* cg, char* funnam, char* varnam);
-void  cgAsgExp(Cg* cg, char* funnam, AstExp* astexp);
-void  cgBlock (Cg* cg, char* funnam, AstBlock* astblock);
-void  cgBody  (Cg* cg, char* funnam, AstBody* astbody);
-void  cgBop   (Cg* cg, BOP bop);
-void  cgBranch(Cg* cg, char* cond);
-void  cgCall  (Cg* cg, char* funnam, AstCall* astcall);
-void  cgEpilog(Cg* cg, char* funnam);
-void  cgExp   (Cg* cg, char* funnam, AstExp* astexp);
-void  cgFun   (Cg* cg, AstFun* astfun);
-void  cgIf    (Cg* cg, char* funnam, AstIf* astif);
-char* cgLabel();
-void  cgNam   (Cg* cg, char* funnam, AstNam* astnam, char* reg);
-Cg*   cgNew();
-void  cgNum   (Cg* cg, AstNum* astnum, char* reg);
-void  cgPar   (Cg* cg, AstPar* par);
-void  cgProg  (Cg* cg, AstProg* astprog);
-void  cgProlog(Cg* cg, char* funnam);
-void  cgStm   (Cg* cg, char* funnam, AstStm* aststm);
-void  cgStms  (Cg* cg, char* funnam, AstStm* aststm);
-void  cgWhile (Cg* cg, char* funnam, AstWhile* astwhile);
+// cg.h - Code Generator - Jim Hogg, 2020
+
+#pragma once
+
+#include <assert.h>     // assert
+
+#include "ast.h"        // Ast*
+#include "cgr.h"        // Call Graph
+#include "emit.h"       // Emit Buffer
+#include "ir.h"         // IR, which cg lowers to ARM
+#include "lay.h"        // Layout of stack frames
+#include "ut.h"         // ut*
+#include "walk.h"       // walkRun
+
+////#define LINESIZE 100
+
+// cgProg lowers each IrFun (see ir.h) to ARM.  Each vreg is given a home,
+// by cgAlloc, before any code for its function is emitted: one of the
+// registers R0 thru R2, or, if it lives across a call, or past the end of
+// its block, or there is no register free, a spill slot in the frame, below
+// the Vars.  R3 and R12 are scratch, to load and store spilled vregs.
+
+#define CGNUMREG 3      // R0 thru R2 hold vregs
+
+typedef struct {
+  Lay*     lay;
+  Cgr*     cgr;         // call graph (see compile)
+  Emit*    emit;
+  int      labnum;      // number of the last label made by cgLabel
+  IrFun*   fun;         // function being generated
+  int*     loc;         // by vreg: its register, or (< 0) its spill slot
+  int*     last;        // by vreg: the instruction that last uses it
+  char**   label;       // by block: its label, once made
+  char*    target;      // by block: is it branched to?
+} Cg;
+
+int   cgAlloc (Cg* cg, IrFun* fun);
+void  cgArg   (Cg* cg, IrIns* ins);
+void  cgBin   (Cg* cg, IrIns* ins);
+char* cgBlkLabel(Cg* cg, int blk);
+void  cgBranch(Cg* cg, char* cond, char* reg);
+void  cgCall  (Cg* cg, IrIns* ins);
+char* cgDst   (Cg* cg, int v);
+void  cgDstEnd(Cg* cg, int v);
+void  cgEpilog(Cg* cg);
+void  cgFun   (Cg* cg, IrFun* fun);
+void  cgIns   (Cg* cg, int blk, IrIns* ins);
+int   cgIsImm (unsigned val);
+char* cgLabel (Cg* cg);
+Cg*   cgNew();
+void  cgProg  (Cg* cg, Ir* ir);
+void  cgProlog(Cg* cg, char* funnam, int size);
+char* cgUse   (Cg* cg, int v, char* scratch);
@@ -0,0 +1,231 @@
+// cgr.c - Call Graph
+//
+// See cgr.h
+
+#include "cgr.h"
+
+// ============================================================================
+// Pre hook for Call: note an edge from the current function to the one it
+// calls.  resProg has checked that it exists.
+// ============================================================================
+WALK cgrCall(Walk* walk, Ast* ast) {
+  Cgr* cgr = walk->ctx;
+  int to = cgrNode(cgr, ((AstCall*) ast)->nam->lex);
+  if (to < 0) return WALKSKIP;
+  if (cgr->numRaw == cgr->maxRaw) {
+    cgr->maxRaw *= 2;
+    cgr->edge = realloc(cgr->edge, cgr->maxRaw * sizeof(CgrEdge));
+    if (cgr->edge == NULL) utDie2Str("cgrCall", "realloc failed");
+  }
+  cgr->edge[cgr->numRaw].from = cgr->cur;
+  cgr->edge[cgr->numRaw].to   = to;
+  ++cgr->numRaw;
+  return WALKSKIP;                                // Args call nothing
+}
+
+// ============================================================================
+// Free 'cgr'.  The Funs it points to belong to the AST.
+// ============================================================================
+void cgrFree(Cgr* cgr) {
+  free(cgr->nam);
+  free(cgr->fun);
+  free(cgr->node);
+  free(cgr->calleeLo);
+  free(cgr->callee);
+  free(cgr->edge);
+  free(cgr->reach);
+  free(cgr->scc);
+  free(cgr->rec);
+  free(cgr->order);
+  free(cgr);
+}
+
+// ============================================================================
+// Pre hook for Fun: make it the caller of the Calls within it
+// ============================================================================
+WALK cgrFun(Walk* walk, Ast* ast) {
+  Cgr* cgr = walk->ctx;
+  AstFun* fun = (AstFun*) ast;
+  cgr->cur = cgrNode(cgr, fun->nam->lex);
+  if (cgr->fun[cgr->cur] == NULL) cgr->fun[cgr->cur] = fun;
+  return WALKGO;
+}
+
+// ============================================================================
+// Return the node of the function called 'nam', or -1 if there is none
+// ============================================================================
+int cgrNode(Cgr* cgr, char* nam) {
+  int idx = layFunIdx(cgr->lay, nam);
+  return idx < 0 ? -1 : cgr->node[idx];
+}
+
+// ============================================================================
+// Build the call graph of 'prog', which resProg has laid out in 'lay', and
+// find which functions main reaches (see cgr.h)
+// ============================================================================
+Cgr* cgrProg(Lay* lay, AstProg* prog) {
+  Cgr* cgr = calloc(1, sizeof(Cgr));
+  if (cgr == NULL) utDie2Str("cgrProg", "calloc failed");
+  cgr->lay = lay;
+
+  int numRow = lay->hiIdx + 1;
+  cgr->node = malloc((numRow + 1) * sizeof(int));
+  if (cgr->node == NULL) utDie2Str("cgrProg", "malloc failed");
+  for (int r = 0; r < numRow; ++r) {
+    cgr->node[r] = lay->row[r].role == ROLEFUN ? cgr->numFun++ : -1;
+  }
+
+  int numFun = cgr->numFun;
+  cgr->nam      = malloc(numFun * sizeof(char*));
+  cgr->fun      = calloc(numFun, sizeof(AstFun*));
+  cgr->calleeLo = calloc(numFun + 1, sizeof(int));
+  cgr->reach    = calloc(numFun, 1);
+  cgr->scc      = malloc(numFun * sizeof(int));
+  cgr->rec      = calloc(numFun, 1);
+  cgr->order    = malloc(numFun * sizeof(int));
+  cgr->maxRaw   = 64;
+  cgr->edge     = malloc(cgr->maxRaw * sizeof(CgrEdge));
+  if (!cgr->nam || !cgr->fun || !cgr->calleeLo || !cgr->reach || !cgr->scc ||
+      !cgr->rec || !cgr->order || !cgr->edge) {
+    utDie2Str("cgrProg", "alloc failed");
+  }
+  for (int r = 0; r < numRow; ++r) {
+    if (cgr->node[r] >= 0) cgr->nam[cgr->node[r]] = lay->row[r].nam;
+  }
+
+  Walk* walk = walkNew(cgr);
+  walkOn(walk, ASTCALL, cgrCall, NULL);
+  walkOn(walk, ASTEXP,  walkSkip, NULL);
+  walkOn(walk, ASTFUN,  cgrFun, NULL);
+  walkOn(walk, ASTPAR,  walkSkip, NULL);
+  walkOn(walk, ASTVAR,  walkSkip, NULL);
+  walkRun(walk, (Ast*) prog);
+  walkFree(walk);
+
+  // Sort the edges by caller (a counting sort), dropping repeats: 'last'
+  // holds, for each callee, the caller that last added an edge to it
+
+  cgr->callee = malloc((cgr->numRaw + 1) * sizeof(int));
+  int* fill = malloc((numFun + 1) * sizeof(int));
+  int* last = malloc(numFun * sizeof(int));
+  if (!cgr->callee || !fill || !last) utDie2Str("cgrProg", "malloc failed");
+
+  for (int e = 0; e < cgr->numRaw; ++e) ++cgr->calleeLo[cgr->edge[e].from + 1];
+  for (int f = 0; f < numFun; ++f) cgr->calleeLo[f + 1] += cgr->calleeLo[f];
+  memcpy(fill, cgr->calleeLo, (numFun + 1) * sizeof(int));
+  int* raw = malloc((cgr->numRaw + 1) * sizeof(int));
+  if (raw == NULL) utDie2Str("cgrProg", "malloc failed");
+  for (int e = 0; e < cgr->numRaw; ++e) raw[fill[cgr->edge[e].from]++] = cgr->edge[e].to;
+
+  for (int f = 0; f < numFun; ++f) last[f] = -1;
+  int numEdge = 0;
+  for (int f = 0; f < numFun; ++f) {
+    int lo = cgr->calleeLo[f];
+    cgr->calleeLo[f] = numEdge;
+    for (int e = lo; e < fill[f]; ++e) {
+      int to = raw[e];
+      if (last[to] == f) continue;
+      last[to] = f;
+      cgr->callee[numEdge++] = to;
+      if (to == f) cgr->rec[f] = 1;             // calls itself
+    }
+  }
+  cgr->calleeLo[numFun] = numEdge;
+  cgr->numEdge = numEdge;
+  free(raw);
+  free(last);
+  free(fill);
+
+  cgr->main = cgrNode(cgr, "main");
+  cgrScc(cgr);
+  return cgr;
+}
+
+// ============================================================================
+// Unlink, from 'prog', every Fun that main cannot reach.  Leave 'prog' be if
+// it has no main.
+// ============================================================================
+void cgrPrune(Cgr* cgr, AstProg* prog) {
+  if (cgr->main < 0) return;
+  Ast** link = (Ast**) &prog->funs;
+  while (*link) {
+    AstFun* fun = (AstFun*) *link;
+    if (cgr->reach[cgrNode(cgr, fun->nam->lex)]) {
+      link = &fun->next;
+    } else {
+      *link = fun->next;
+      ++cgr->numDead;
+    }
+  }
+}
+
+// ============================================================================
+// Find the components of the graph reachable from main, by Tarjan's
+// algorithm, and, as each is completed, append its nodes to 'order'.
+//
+// 'stack' holds the nodes visited but not yet assigned a component.  'path'
+// replaces the recursion: path[p] is a node being visited, and next[p] the
+// index, in 'callee', of its next edge to follow.
+// ============================================================================
+void cgrScc(Cgr* cgr) {
+  int numFun = cgr->numFun;
+  for (int f = 0; f < numFun; ++f) cgr->scc[f] = -1;
+  if (cgr->main < 0) return;
+
+  int* index = malloc(numFun * sizeof(int));
+  int* low   = malloc(numFun * sizeof(int));
+  int* stack = malloc(numFun * sizeof(int));
+  int* path  = malloc(numFun * sizeof(int));
+  int* next  = malloc(numFun * sizeof(int));
+  if (!index || !low || !stack || !path || !next) {
+    utDie2Str("cgrScc", "malloc failed");
+  }
+  for (int f = 0; f < numFun; ++f) index[f] = -1;
+
+  int numIndex = 0, numStack = 0, numPath = 0, numScc = 0;
+  int m = cgr->main;
+  index[m] = low[m] = numIndex++;
+  stack[numStack++] = m;
+  cgr->reach[m] = 1;
+  path[numPath] = m;
+  next[numPath++] = cgr->calleeLo[m];
+
+  while (numPath) {
+    int v = path[numPath - 1];
+    if (next[numPath - 1] < cgr->calleeLo[v + 1]) {
+      int w = cgr->callee[next[numPath - 1]++];
+      if (index[w] < 0) {                         // visit w
+        index[w] = low[w] = numIndex++;
+        stack[numStack++] = w;
+        cgr->reach[w] = 1;
+        path[numPath] = w;
+        next[numPath++] = cgr->calleeLo[w];
+      } else if (cgr->scc[w] < 0 && index[w] < low[v]) {
+        low[v] = index[w];                        // w is on the stack
+      }
+      continue;
+    }
+
+    --numPath;                                    // done with v
+    if (low[v] == index[v]) {                     // v roots a component
+      int lo = numStack;
+      do cgr->scc[stack[--lo]] = numScc; while (stack[lo] != v);
+      if (numStack - lo > 1) {
+        for (int s = lo; s < numStack; ++s) cgr->rec[stack[s]] = 1;
+      }
+      for (int s = lo; s < numStack; ++s) cgr->order[cgr->numOrder++] = stack[s];
+      numStack = lo;
+      ++numScc;
+    }
+    if (numPath) {
+      int u = path[numPath - 1];
+      if (low[v] < low[u]) low[u] = low[v];
+    }
+  }
+
+  free(next);
+  free(path);
+  free(stack);
+  free(low);
+  free(index);
+}
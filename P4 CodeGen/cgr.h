@@ -0,0 +1,61 @@
+// cgr.h - Call Graph
+
+#pragma once
+
+#include "ast.h"            // Ast*
+#include "lay.h"            // Lay, layFunIdx
+#include "walk.h"           // walkRun
+
+// cgrProg, run after resProg, builds the call graph of a program.  It has a
+// node for each function in the Lay - the intrinsics says, sayn and sayl
+// first, then each Fun, in source order - and an edge from each function to
+// every function it calls (once, however many Calls name it).
+//
+// It then walks the graph from "main", by Tarjan's algorithm, kept on an
+// explicit stack so a long call chain costs heap, not C stack.  That one
+// walk yields:
+//
+//    - reach[f] : is f reachable from main?
+//    - scc[f]   : the strongly connected component of f.  f is recursive
+//                 (rec[f]) if it calls itself, or shares its component
+//    - order    : every reachable function, callees before their callers
+//                 (except within a component), so a pass that needs facts
+//                 about a function's callees - inlining, say - can take
+//                 them in this order
+//
+// cgrPrune then drops, from the program, every Fun that main cannot reach,
+// so codegen emits none of them.  A program with no main is left as it is.
+
+typedef struct {
+  int      from;            // an edge, before they are sorted
+  int      to;
+} CgrEdge;
+
+typedef struct {
+  Lay*     lay;
+  int      numFun;          // nodes
+  char**   nam;             // name of each node
+  AstFun** fun;             // its Fun, or NULL for an intrinsic
+  int*     node;            // by Lay row: node of a ROLEFUN row, else -1
+  int      main;            // node of main, or -1
+  int*     calleeLo;        // callees of node f are callee[calleeLo[f]] ...
+  int*     callee;          // ... thru callee[calleeLo[f + 1] - 1]
+  int      numEdge;
+  CgrEdge* edge;            // edges, as Calls are found
+  int      numRaw, maxRaw;
+  int      cur;             // node of the Fun being walked
+  char*    reach;           // reachable from main?
+  int*     scc;             // component of each node, or -1 if unreachable
+  char*    rec;             // recursive?
+  int*     order;           // reachable nodes, callees first
+  int      numOrder;
+  int      numDead;         // Funs removed by cgrPrune
+} Cgr;
+
+WALK  cgrCall (Walk* walk, Ast* ast);
+void  cgrFree (Cgr* cgr);
+WALK  cgrFun  (Walk* walk, Ast* ast);
+int   cgrNode (Cgr* cgr, char* nam);
+Cgr*  cgrProg (Lay* lay, AstProg* prog);
+void  cgrPrune(Cgr* cgr, AstProg* prog);
+void  cgrScc  (Cgr* cgr);
@@ -0,0 +1,887 @@
+// fla.c - Flat AST, in structure-of-arrays form
+//
+// See fla.h
+
+#include "fla.h"
+
+// ============================================================================
+// Re-build, from 'fla', the AST that flaNew flattened.  Its names and strings
+// point into the string table of 'fla', which must therefore outlive it
+// ============================================================================
+AstProg* flaAst(Fla* fla) {
+  AstFun* funs = NULL;
+  AstFun* last = NULL;
+  for (int f = 0; f < fla->fun.num; ++f) {
+    AstFun* fun = flaAstFun(fla, f);
+    if (last) last->next = (Ast*) fun; else funs = fun;
+    last = fun;
+  }
+  return astNewProg(funs);
+}
+
+// ============================================================================
+// Re-build the AstCall for Call 'call' of 'fla'
+// ============================================================================
+AstCall* flaAstCall(Fla* fla, uint32_t call) {
+  AstArg* args = NULL;
+  AstArg* last = NULL;
+  uint32_t lo = fla->call.argLo[call];
+  for (uint32_t a = lo; a < lo + fla->call.numArg[call]; ++a) {
+    AstArg* arg = astNewArg(flaAstLeaf(fla, fla->kids[a]));
+    if (last) last->next = (Ast*) arg; else args = arg;
+    last = arg;
+  }
+  return astNewCall(astNewNam(flaTxt(fla, fla->call.nam[call])), args);
+}
+
+// ============================================================================
+// Re-build the AstExp for Exp 'exp' of 'fla'
+// ============================================================================
+AstExp* flaAstExp(Fla* fla, uint32_t exp) {
+  BOP bop = fla->exp.bop[exp];
+  Ast* lhs = flaAstLeaf(fla, fla->exp.lhs[exp]);
+  Ast* rhs = bop == BOPNONE ? NULL : flaAstLeaf(fla, fla->exp.rhs[exp]);
+  return astNewExp(lhs, bop, rhs);
+}
+
+// ============================================================================
+// Re-build the AstFun for function 'fun' of 'fla'
+// ============================================================================
+AstFun* flaAstFun(Fla* fla, uint32_t fun) {
+  FlaFuns* p = &fla->fun;
+
+  AstPar* pars = NULL;
+  AstPar* lastPar = NULL;
+  for (uint32_t i = p->parLo[fun]; i < p->parLo[fun] + p->numPar[fun]; ++i) {
+    AstPar* par = astNewPar(astNewNam(flaTxt(fla, fla->ids[i])));
+    if (lastPar) lastPar->next = (Ast*) par; else pars = par;
+    lastPar = par;
+  }
+
+  AstVar* vars = NULL;
+  AstVar* lastVar = NULL;
+  for (uint32_t i = p->varLo[fun]; i < p->varLo[fun] + p->numVar[fun]; ++i) {
+    AstVar* var = astNewVar(astNewNam(flaTxt(fla, fla->ids[i])));
+    if (lastVar) lastVar->next = (Ast*) var; else vars = var;
+    lastVar = var;
+  }
+
+  AstStm* stms = flaAstStms(fla, p->stmLo[fun], p->numStm[fun]);
+  return astNewFun(astNewNam(flaTxt(fla, p->nam[fun])), pars, astNewBody(vars, stms));
+}
+
+// ============================================================================
+// Re-build the AstNam, AstNum or AstStr for 'ref'
+// ============================================================================
+Ast* flaAstLeaf(Fla* fla, FlaRef ref) {
+  uint32_t i = FLAIDX(ref);
+  switch (FLAKIND(ref)) {
+    case ASTNAM: return (Ast*) astNewNam(flaTxt(fla, i));
+    case ASTNUM: return (Ast*) astNewNum(fla->nums.val[i]);
+    default:     return (Ast*) astNewStr(flaTxt(fla, i));
+  }
+}
+
+// ============================================================================
+// Re-build the chain of 'numStm' Stms that start at kids[stmLo], and return
+// its head.  A Block can only be built once all of its Stms are, so keep a
+// heap-allocated stack of the Blocks still being re-built: frame[hi] is the
+// innermost.  When it is done, build its Block, and the If or While that owns
+// it, which is the next Stm of the Block below.
+// ============================================================================
+AstStm* flaAstStms(Fla* fla, uint32_t stmLo, uint32_t numStm) {
+  int maxFrame = 16;
+  FlaFrame* frame = malloc(maxFrame * sizeof(FlaFrame));
+  if (frame == NULL) utDie2Str("flaAstStms", "malloc failed");
+
+  int hi = 0;
+  frame[0] = (FlaFrame) { stmLo, stmLo + numStm, NULL, NULL, 0 };
+
+  for (;;) {
+    Ast* ast;
+    if (frame[hi].next == frame[hi].end) {        // Block is done
+      if (hi == 0) break;
+      FlaRef cond = frame[hi].cond;
+      AstBlock* block = astNewBlock((AstStm*) frame[hi].head);
+      --hi;
+      if (FLAKIND(cond) == ASTIF) {
+        ast = (Ast*) astNewIf(flaAstExp(fla, fla->iff.exp[FLAIDX(cond)]), block);
+      } else {
+        ast = (Ast*) astNewWhile(flaAstExp(fla, fla->whl.exp[FLAIDX(cond)]), block);
+      }
+    } else {
+      FlaRef stm = fla->kids[frame[hi].next++];
+      uint32_t s = FLAIDX(stm);
+      if (FLAKIND(stm) == ASTASG) {
+        FlaRef eoc = fla->asg.eoc[s];
+        Ast* rhs = FLAKIND(eoc) == ASTEXP
+          ? (Ast*) flaAstExp(fla, FLAIDX(eoc))
+          : (Ast*) flaAstCall(fla, FLAIDX(eoc));
+        ast = (Ast*) astNewAsg(astNewNam(flaTxt(fla, fla->asg.nam[s])), rhs);
+      } else if (FLAKIND(stm) == ASTRET) {
+        ast = (Ast*) astNewRet(flaAstExp(fla, fla->ret.exp[s]));
+      } else {                                    // If or While: open its Block
+        FlaConds* p = FLAKIND(stm) == ASTIF ? &fla->iff : &fla->whl;
+        if (++hi == maxFrame) {
+          maxFrame *= 2;
+          frame = realloc(frame, maxFrame * sizeof(FlaFrame));
+          if (frame == NULL) utDie2Str("flaAstStms", "realloc failed");
+        }
+        frame[hi] = (FlaFrame) { p->stmLo[s], p->stmLo[s] + p->numStm[s], NULL, NULL, stm };
+        continue;
+      }
+    }
+    if (frame[hi].tail) frame[hi].tail->next = ast; else frame[hi].head = ast;
+    frame[hi].tail = ast;
+  }
+
+  AstStm* stms = (AstStm*) frame[0].head;
+  free(frame);
+  return stms;
+}
+
+// ============================================================================
+// Return the number of bytes allocated for 'fla'
+// ============================================================================
+size_t flaBytes(Fla* fla) {
+  size_t n = sizeof(Fla);
+  n += (size_t) fla->fun.max  * 7 * sizeof(uint32_t);
+  n += (size_t) fla->iff.max  * 3 * sizeof(uint32_t);
+  n += (size_t) fla->whl.max  * 3 * sizeof(uint32_t);
+  n += (size_t) fla->asg.max  * 2 * sizeof(uint32_t);
+  n += (size_t) fla->ret.max  * sizeof(uint32_t);
+  n += (size_t) fla->call.max * 3 * sizeof(uint32_t);
+  n += (size_t) fla->exp.max  * (2 * sizeof(FlaRef) + sizeof(uint8_t));
+  n += (size_t) fla->nums.max * sizeof(int32_t);
+  n += (size_t) fla->str.max  * sizeof(uint32_t) + fla->str.cap;
+  n += (size_t) fla->maxId    * sizeof(uint32_t);
+  n += (size_t) fla->maxKid   * sizeof(FlaRef);
+  return n;
+}
+
+// ============================================================================
+// Add the Call 'call' to 'fla'.  Return its index
+// ============================================================================
+uint32_t flaCall(Fla* fla, AstCall* call) {
+  uint32_t lo = flaKids(fla, call->numarg);
+  for (int a = 0; a < call->numarg; ++a) {
+    FlaRef arg = flaLeaf(fla, call->arg[a]->nns);
+    fla->kids[lo + a] = arg;
+  }
+  return flaNewCall(fla, flaStr(fla, call->nam->lex), lo, call->numarg);
+}
+
+// ============================================================================
+// Check that every index in 'fla', as loaded from a file, is in range, so
+// that walking it cannot stray outside its arrays.  Return 1 if so, else 0
+// ============================================================================
+int flaCheck(Fla* fla) {
+  uint32_t numStr = fla->str.num;
+  if (numStr > 0 && (fla->str.size == 0 || fla->str.txt[fla->str.size - 1])) return 0;
+  for (uint32_t i = 0; i < numStr; ++i) {
+    if (fla->str.off[i] >= (uint32_t) fla->str.size) return 0;
+  }
+  for (int i = 0; i < fla->numId; ++i) if (fla->ids[i] >= numStr) return 0;
+
+  FlaFuns* f = &fla->fun;
+  for (int i = 0; i < f->num; ++i) {
+    if (f->nam[i] >= numStr) return 0;
+    if ((uint64_t) f->parLo[i] + f->numPar[i] > (uint64_t) fla->numId) return 0;
+    if ((uint64_t) f->varLo[i] + f->numVar[i] > (uint64_t) fla->numId) return 0;
+    if (!flaCheckStms(fla, f->stmLo[i], f->numStm[i])) return 0;
+  }
+
+  for (int w = 0; w < 2; ++w) {
+    FlaConds* p = w ? &fla->whl : &fla->iff;
+    for (int i = 0; i < p->num; ++i) {
+      if (p->exp[i] >= (uint32_t) fla->exp.num) return 0;
+      if (!flaCheckStms(fla, p->stmLo[i], p->numStm[i])) return 0;
+    }
+  }
+
+  for (int i = 0; i < fla->asg.num; ++i) {
+    FlaRef eoc = fla->asg.eoc[i];
+    if (fla->asg.nam[i] >= numStr) return 0;
+    if (FLAKIND(eoc) == ASTEXP && FLAIDX(eoc) < (uint32_t) fla->exp.num) continue;
+    if (FLAKIND(eoc) == ASTCALL && FLAIDX(eoc) < (uint32_t) fla->call.num) continue;
+    return 0;
+  }
+
+  for (int i = 0; i < fla->ret.num; ++i) {
+    if (fla->ret.exp[i] >= (uint32_t) fla->exp.num) return 0;
+  }
+
+  FlaCalls* c = &fla->call;
+  for (int i = 0; i < c->num; ++i) {
+    if (c->nam[i] >= numStr) return 0;
+    if ((uint64_t) c->argLo[i] + c->numArg[i] > (uint64_t) fla->numKid) return 0;
+    for (uint32_t a = c->argLo[i]; a < c->argLo[i] + c->numArg[i]; ++a) {
+      if (!flaCheckLeaf(fla, fla->kids[a])) return 0;
+    }
+  }
+
+  for (int i = 0; i < fla->exp.num; ++i) {
+    BOP bop = fla->exp.bop[i];
+    if (bop < BOPADD || bop > BOPGT || bop == BOPBAD) return 0;
+    if (!flaCheckLeaf(fla, fla->exp.lhs[i])) return 0;
+    if (bop != BOPNONE && !flaCheckLeaf(fla, fla->exp.rhs[i])) return 0;
+  }
+  return 1;
+}
+
+// ============================================================================
+// Check that 'ref' is a Nam, Num or Str that is in range.  Return 1 if so
+// ============================================================================
+int flaCheckLeaf(Fla* fla, FlaRef ref) {
+  switch (FLAKIND(ref)) {
+    case ASTNAM:
+    case ASTSTR: return FLAIDX(ref) < (uint32_t) fla->str.num;
+    case ASTNUM: return FLAIDX(ref) < (uint32_t) fla->nums.num;
+    default:     return 0;
+  }
+}
+
+// ============================================================================
+// Check that the 'numStm' Stms that start at kids[stmLo] are in range.  The
+// Block of an If or While must start after the If or While itself, as flaStms
+// lays them out: so no Block can contain itself, and every walk ends.
+// ============================================================================
+int flaCheckStms(Fla* fla, uint32_t stmLo, uint32_t numStm) {
+  if ((uint64_t) stmLo + numStm > (uint64_t) fla->numKid) return 0;
+  for (uint32_t k = stmLo; k < stmLo + numStm; ++k) {
+    FlaRef stm = fla->kids[k];
+    uint32_t s = FLAIDX(stm);
+    switch (FLAKIND(stm)) {
+      case ASTASG:   if (s >= (uint32_t) fla->asg.num) return 0;              break;
+      case ASTRET:   if (s >= (uint32_t) fla->ret.num) return 0;              break;
+      case ASTIF:    if (s >= (uint32_t) fla->iff.num
+                       || fla->iff.stmLo[s] <= k) return 0;
+                     break;
+      case ASTWHILE: if (s >= (uint32_t) fla->whl.num
+                       || fla->whl.stmLo[s] <= k) return 0;
+                     break;
+      default:       return 0;
+    }
+  }
+  return 1;
+}
+
+// ============================================================================
+// Add the Exp 'exp' to 'fla'.  Return its index
+// ============================================================================
+uint32_t flaExp(Fla* fla, AstExp* exp) {
+  FlaRef lhs = flaLeaf(fla, exp->lhs);
+  FlaRef rhs = exp->bop == BOPNONE ? 0 : flaLeaf(fla, exp->rhs);
+  return flaNewExp(fla, lhs, exp->bop, rhs);
+}
+
+// ============================================================================
+// Fill 'field' with the arrays of 'fla', in the order that they are stored in
+// a cache file, each with its number of elements.  Return how many there are
+// (FLANUMFIELD).  flaSave and flaLoad both work from this one list.
+// ============================================================================
+int flaFields(Fla* fla, FlaField* field) {
+  int n = 0;
+  field[n++] = (FlaField) { (void**) &fla->fun.nam,     fla->fun.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->fun.parLo,   fla->fun.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->fun.numPar,  fla->fun.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->fun.varLo,   fla->fun.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->fun.numVar,  fla->fun.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->fun.stmLo,   fla->fun.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->fun.numStm,  fla->fun.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->iff.exp,     fla->iff.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->iff.stmLo,   fla->iff.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->iff.numStm,  fla->iff.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->whl.exp,     fla->whl.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->whl.stmLo,   fla->whl.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->whl.numStm,  fla->whl.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->asg.nam,     fla->asg.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->asg.eoc,     fla->asg.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->ret.exp,     fla->ret.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->call.nam,    fla->call.num, 4 };
+  field[n++] = (FlaField) { (void**) &fla->call.argLo,  fla->call.num, 4 };
+  field[n++] = (FlaField) { (void**) &fla->call.numArg, fla->call.num, 4 };
+  field[n++] = (FlaField) { (void**) &fla->exp.lhs,     fla->exp.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->exp.rhs,     fla->exp.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->nums.val,    fla->nums.num, 4 };
+  field[n++] = (FlaField) { (void**) &fla->str.off,     fla->str.num,  4 };
+  field[n++] = (FlaField) { (void**) &fla->ids,         fla->numId,    4 };
+  field[n++] = (FlaField) { (void**) &fla->kids,        fla->numKid,   4 };
+  field[n++] = (FlaField) { (void**) &fla->exp.bop,     fla->exp.num,  1 };
+  field[n++] = (FlaField) { (void**) &fla->str.txt,     fla->str.size, 1 };
+  return n;
+}
+
+// ============================================================================
+// Add the function 'fun' to 'fla'
+// ============================================================================
+void flaFun(Fla* fla, AstFun* fun) {
+  uint32_t f = flaNewFun(fla, flaStr(fla, fun->nam->lex));
+
+  uint32_t lo = flaIds(fla, fun->numpar);
+  for (int p = 0; p < fun->numpar; ++p) {
+    uint32_t id = flaStr(fla, fun->par[p]->nam->lex);
+    fla->ids[lo + p] = id;
+  }
+  fla->fun.parLo[f] = lo;
+  fla->fun.numPar[f] = fun->numpar;
+
+  AstBody* body = fun->body;
+  lo = flaIds(fla, body->numvar);
+  for (int v = 0; v < body->numvar; ++v) {
+    uint32_t id = flaStr(fla, body->var[v]->nam->lex);
+    fla->ids[lo + v] = id;
+  }
+  fla->fun.varLo[f] = lo;
+  fla->fun.numVar[f] = body->numvar;
+
+  lo = flaStms(fla, body->stm, body->numstm);
+  fla->fun.stmLo[f] = lo;
+  fla->fun.numStm[f] = body->numstm;
+}
+
+// ============================================================================
+// Re-size the array 'arr', of elements each 'size' bytes, to hold 'max' of
+// them.  Abort if that is more than a FlaRef can index.
+// ============================================================================
+void* flaGrow(void* arr, int max, int size) {
+  if ((unsigned) max > FLAMAXIDX + 1u) utDie2Str("flaGrow", "Program too big");
+  arr = realloc(arr, (size_t) max * size);
+  if (arr == NULL) utDie2Str("flaGrow", "realloc failed");
+  return arr;
+}
+
+// ============================================================================
+// Reserve a range of 'num' entries in 'fla->ids'.  Return its first index
+// ============================================================================
+uint32_t flaIds(Fla* fla, int num) {
+  if (fla->numId + num > fla->maxId) {
+    fla->maxId = 2 * fla->maxId + num + 64;
+    fla->ids = flaGrow(fla->ids, fla->maxId, sizeof(uint32_t));
+  }
+  uint32_t lo = fla->numId;
+  fla->numId += num;
+  return lo;
+}
+
+// ============================================================================
+// Reserve a range of 'num' entries in 'fla->kids'.  Return its first index
+// ============================================================================
+uint32_t flaKids(Fla* fla, int num) {
+  if (fla->numKid + num > fla->maxKid) {
+    fla->maxKid = 2 * fla->maxKid + num + 64;
+    fla->kids = flaGrow(fla->kids, fla->maxKid, sizeof(FlaRef));
+  }
+  uint32_t lo = fla->numKid;
+  fla->numKid += num;
+  return lo;
+}
+
+// ============================================================================
+// Return the FlaRef for 'ast', a Nam, Num or Str
+// ============================================================================
+FlaRef flaLeaf(Fla* fla, Ast* ast) {
+  switch (ast->kind) {
+    case ASTNAM: return FLAREF(ASTNAM, flaStr(fla, ((AstNam*) ast)->lex));
+    case ASTNUM: return FLAREF(ASTNUM, flaNewNum(fla, ((AstNum*) ast)->val));
+    case ASTSTR: return FLAREF(ASTSTR, flaStr(fla, ((AstStr*) ast)->txt));
+    default:     utDie2Str("flaLeaf", "Invalid Nam, Num or Str");
+  }
+  return 0;                                   // pacify compiler
+}
+
+// ============================================================================
+// Re-load the Fla previously saved, by flaSave, into the binary cache file
+// 'filePath'.  We map the file into memory, and point each array of the Fla
+// at its place in the mapping (see fla.h), so nothing is copied.  If the file
+// is missing, damaged, from another version, or was built from a source text
+// other than 'src', return NULL: the caller should then parse 'src' afresh.
+// ============================================================================
+Fla* flaLoad(char* filePath, char* src) {
+  int size = 0;
+  char* buf = utMapFile(filePath, &size);
+  if (buf == NULL) return NULL;
+
+  FlaHdr* hdr = (FlaHdr*) buf;
+  int srcLen = strlen(src);
+  if (size < (int) sizeof(FlaHdr) || hdr->magic != FLAMAGIC
+    || hdr->version != FLAVERSION || hdr->srcLen != (unsigned) srcLen
+    || hdr->srcHash != utHash(src, srcLen)) {
+    utUnmapFile(buf, size);
+    return NULL;
+  }
+
+  Fla* fla = calloc(1, sizeof(Fla));
+  if (fla == NULL) utDie2Str("flaLoad", "calloc failed");
+  fla->fun.max  = fla->fun.num  = hdr->numFun;
+  fla->iff.max  = fla->iff.num  = hdr->numIf;
+  fla->whl.max  = fla->whl.num  = hdr->numWhile;
+  fla->asg.max  = fla->asg.num  = hdr->numAsg;
+  fla->ret.max  = fla->ret.num  = hdr->numRet;
+  fla->call.max = fla->call.num = hdr->numCall;
+  fla->exp.max  = fla->exp.num  = hdr->numExp;
+  fla->nums.max = fla->nums.num = hdr->numNum;
+  fla->str.max  = fla->str.num  = hdr->numStr;
+  fla->str.cap  = fla->str.size = hdr->strSize;
+  fla->maxId    = fla->numId    = hdr->numId;
+  fla->maxKid   = fla->numKid   = hdr->numKid;
+
+  FlaField field[FLANUMFIELD];
+  int numField = flaFields(fla, field);
+  uint64_t want = sizeof(FlaHdr);
+  for (int f = 0; f < numField; ++f) want += (uint64_t) field[f].num * field[f].size;
+
+  if (want == (uint64_t) size) {
+    char* at = buf + sizeof(FlaHdr);
+    for (int f = 0; f < numField; ++f) {
+      *field[f].arr = at;
+      at += (size_t) field[f].num * field[f].size;
+    }
+    if (flaCheck(fla)) return fla;
+  }
+
+  free(fla);
+  utUnmapFile(buf, size);
+  return NULL;
+}
+
+// ============================================================================
+// Flatten the AST 'prog' into a new Fla
+// ============================================================================
+Fla* flaNew(AstProg* prog) {
+  Fla* fla = calloc(1, sizeof(Fla));
+  if (fla == NULL) utDie2Str("flaNew", "calloc failed");
+
+  for (AstFun* fun = prog->funs; fun; fun = (AstFun*) fun->next) flaFun(fla, fun);
+
+  free(fla->str.slot);                        // only needed while building
+  fla->str.slot = NULL;
+  fla->str.mask = 0;
+  return fla;
+}
+
+// ============================================================================
+// Add an Asg node to 'fla'.  Return its index
+// ============================================================================
+uint32_t flaNewAsg(Fla* fla, uint32_t nam, FlaRef eoc) {
+  FlaAsgs* p = &fla->asg;
+  if (p->num == p->max) {
+    p->max = 2 * p->max + 64;
+    p->nam = flaGrow(p->nam, p->max, sizeof(uint32_t));
+    p->eoc = flaGrow(p->eoc, p->max, sizeof(FlaRef));
+  }
+  p->nam[p->num] = nam;
+  p->eoc[p->num] = eoc;
+  return p->num++;
+}
+
+// ============================================================================
+// Add a Call node to 'fla'.  Return its index
+// ============================================================================
+uint32_t flaNewCall(Fla* fla, uint32_t nam, uint32_t argLo, uint32_t numArg) {
+  FlaCalls* p = &fla->call;
+  if (p->num == p->max) {
+    p->max = 2 * p->max + 64;
+    p->nam    = flaGrow(p->nam,    p->max, sizeof(uint32_t));
+    p->argLo  = flaGrow(p->argLo,  p->max, sizeof(uint32_t));
+    p->numArg = flaGrow(p->numArg, p->max, sizeof(uint32_t));
+  }
+  p->nam[p->num] = nam;
+  p->argLo[p->num] = argLo;
+  p->numArg[p->num] = numArg;
+  return p->num++;
+}
+
+// ============================================================================
+// Add an If or While node to its pool 'p'.  Return its index
+// ============================================================================
+uint32_t flaNewCond(FlaConds* p, uint32_t exp, uint32_t stmLo, uint32_t numStm) {
+  if (p->num == p->max) {
+    p->max = 2 * p->max + 64;
+    p->exp    = flaGrow(p->exp,    p->max, sizeof(uint32_t));
+    p->stmLo  = flaGrow(p->stmLo,  p->max, sizeof(uint32_t));
+    p->numStm = flaGrow(p->numStm, p->max, sizeof(uint32_t));
+  }
+  p->exp[p->num] = exp;
+  p->stmLo[p->num] = stmLo;
+  p->numStm[p->num] = numStm;
+  return p->num++;
+}
+
+// ============================================================================
+// Add an Exp node to 'fla'.  Return its index
+// ============================================================================
+uint32_t flaNewExp(Fla* fla, FlaRef lhs, BOP bop, FlaRef rhs) {
+  FlaExps* p = &fla->exp;
+  if (p->num == p->max) {
+    p->max = 2 * p->max + 64;
+    p->lhs = flaGrow(p->lhs, p->max, sizeof(FlaRef));
+    p->rhs = flaGrow(p->rhs, p->max, sizeof(FlaRef));
+    p->bop = flaGrow(p->bop, p->max, sizeof(uint8_t));
+  }
+  p->lhs[p->num] = lhs;
+  p->rhs[p->num] = rhs;
+  p->bop[p->num] = (uint8_t) bop;
+  return p->num++;
+}
+
+// ============================================================================
+// Add a Fun node, called 'nam', to 'fla'.  Return its index.  The caller
+// fills in its lists
+// ============================================================================
+uint32_t flaNewFun(Fla* fla, uint32_t nam) {
+  FlaFuns* p = &fla->fun;
+  if (p->num == p->max) {
+    p->max = 2 * p->max + 64;
+    p->nam    = flaGrow(p->nam,    p->max, sizeof(uint32_t));
+    p->parLo  = flaGrow(p->parLo,  p->max, sizeof(uint32_t));
+    p->numPar = flaGrow(p->numPar, p->max, sizeof(uint32_t));
+    p->varLo  = flaGrow(p->varLo,  p->max, sizeof(uint32_t));
+    p->numVar = flaGrow(p->numVar, p->max, sizeof(uint32_t));
+    p->stmLo  = flaGrow(p->stmLo,  p->max, sizeof(uint32_t));
+    p->numStm = flaGrow(p->numStm, p->max, sizeof(uint32_t));
+  }
+  p->nam[p->num] = nam;
+  p->parLo[p->num] = p->numPar[p->num] = 0;
+  p->varLo[p->num] = p->numVar[p->num] = 0;
+  p->stmLo[p->num] = p->numStm[p->num] = 0;
+  return p->num++;
+}
+
+// ============================================================================
+// Add a Num node to 'fla'.  Return its index
+// ============================================================================
+uint32_t flaNewNum(Fla* fla, int val) {
+  FlaNums* p = &fla->nums;
+  if (p->num == p->max) {
+    p->max = 2 * p->max + 64;
+    p->val = flaGrow(p->val, p->max, sizeof(int32_t));
+  }
+  p->val[p->num] = val;
+  return p->num++;
+}
+
+// ============================================================================
+// Add a Ret node to 'fla'.  Return its index
+// ============================================================================
+uint32_t flaNewRet(Fla* fla, uint32_t exp) {
+  FlaRets* p = &fla->ret;
+  if (p->num == p->max) {
+    p->max = 2 * p->max + 64;
+    p->exp = flaGrow(p->exp, p->max, sizeof(uint32_t));
+  }
+  p->exp[p->num] = exp;
+  return p->num++;
+}
+
+// ============================================================================
+// Re-build the hash table of the string table 's', with twice as many slots
+// ============================================================================
+void flaRehash(FlaStrs* s) {
+  int numSlot = s->slot ? 2 * (s->mask + 1) : 1024;
+  free(s->slot);
+  s->slot = calloc(numSlot, sizeof(uint32_t));
+  if (s->slot == NULL) utDie2Str("flaRehash", "calloc failed");
+  s->mask = numSlot - 1;
+
+  for (int id = 0; id < s->num; ++id) {
+    char* txt = s->txt + s->off[id];
+    int i = (int) utHash(txt, strlen(txt)) & s->mask;
+    while (s->slot[i]) i = (i + 1) & s->mask;
+    s->slot[i] = id + 1;
+  }
+}
+
+// ============================================================================
+// Save 'fla', parsed from the source text 'src', to the binary cache file
+// 'filePath'.  (See fla.h for the layout).  Failure to save is not fatal -
+// we just lose the cache.
+// ============================================================================
+void flaSave(Fla* fla, char* filePath, char* src) {
+  FlaHdr hdr;
+  hdr.magic    = FLAMAGIC;
+  hdr.version  = FLAVERSION;
+  hdr.srcLen   = strlen(src);
+  hdr.srcHash  = utHash(src, hdr.srcLen);
+  hdr.numFun   = fla->fun.num;
+  hdr.numIf    = fla->iff.num;
+  hdr.numWhile = fla->whl.num;
+  hdr.numAsg   = fla->asg.num;
+  hdr.numRet   = fla->ret.num;
+  hdr.numCall  = fla->call.num;
+  hdr.numExp   = fla->exp.num;
+  hdr.numNum   = fla->nums.num;
+  hdr.numStr   = fla->str.num;
+  hdr.strSize  = fla->str.size;
+  hdr.numId    = fla->numId;
+  hdr.numKid   = fla->numKid;
+
+  FlaField field[FLANUMFIELD];
+  int numField = flaFields(fla, field);
+
+  FILE* file = fopen(filePath, "wb");
+  if (file == NULL) return;
+  fwrite(&hdr, sizeof(hdr), 1, file);
+  for (int f = 0; f < numField; ++f) {
+    if (field[f].num) fwrite(*field[f].arr, field[f].size, field[f].num, file);
+  }
+  fclose(file);
+}
+
+// ============================================================================
+// Add the Stm 'stm' to 'fla'.  Return its FlaRef.  For an If or While, just
+// reserve the range for the Stms of its Block, and push them onto the 'todo'
+// stack (which holds 'numTodo' of 'maxTodo'), for flaStms to fill in later
+// ============================================================================
+FlaRef flaStm(Fla* fla, Ast* stm, FlaTodo** todo, int* numTodo, int* maxTodo) {
+  switch (stm->kind) {
+    case ASTASG: {
+      AstAsg* asg = (AstAsg*) stm;
+      FlaRef eoc = asg->eoc->kind == ASTCALL
+        ? FLAREF(ASTCALL, flaCall(fla, (AstCall*) asg->eoc))
+        : FLAREF(ASTEXP, flaExp(fla, (AstExp*) asg->eoc));
+      return FLAREF(ASTASG, flaNewAsg(fla, flaStr(fla, asg->nam->lex), eoc));
+    }
+    case ASTRET:
+      return FLAREF(ASTRET, flaNewRet(fla, flaExp(fla, ((AstRet*) stm)->exp)));
+    case ASTIF:
+    case ASTWHILE: {
+      int isIf = stm->kind == ASTIF;
+      AstExp* exp = isIf ? ((AstIf*) stm)->exp : ((AstWhile*) stm)->exp;
+      AstBlock* block = isIf ? ((AstIf*) stm)->block : ((AstWhile*) stm)->block;
+      uint32_t e = flaExp(fla, exp);
+      uint32_t lo = flaKids(fla, block->numstm);
+      if (*numTodo == *maxTodo) {
+        *maxTodo *= 2;
+        *todo = realloc(*todo, *maxTodo * sizeof(FlaTodo));
+        if (*todo == NULL) utDie2Str("flaStm", "realloc failed");
+      }
+      (*todo)[(*numTodo)++] = (FlaTodo) { block->stm, block->numstm, lo };
+      uint32_t c = flaNewCond(isIf ? &fla->iff : &fla->whl, e, lo, block->numstm);
+      return FLAREF(stm->kind, c);
+    }
+    default:
+      utDie2Str("flaStm", "Invalid Stm");
+  }
+  return 0;                                   // pacify compiler
+}
+
+// ============================================================================
+// Add the list of 'num' Stms, stm[0] thru stm[num-1], to 'fla'.  Return the
+// index, in 'fla->kids', of the first.  Each nested Block is pushed onto a
+// heap-allocated stack (see flaStm), rather than recursed into, so nesting
+// depth is bounded only by memory.
+// ============================================================================
+uint32_t flaStms(Fla* fla, AstStm** stm, int num) {
+  int maxTodo = 16;
+  FlaTodo* todo = malloc(maxTodo * sizeof(FlaTodo));
+  if (todo == NULL) utDie2Str("flaStms", "malloc failed");
+
+  uint32_t lo = flaKids(fla, num);
+  int numTodo = 0;
+  todo[numTodo++] = (FlaTodo) { stm, num, lo };
+
+  while (numTodo > 0) {
+    FlaTodo t = todo[--numTodo];
+    for (int s = 0; s < t.num; ++s) {
+      FlaRef ref = flaStm(fla, (Ast*) t.stm[s], &todo, &numTodo, &maxTodo);
+      fla->kids[t.lo + s] = ref;
+    }
+  }
+
+  free(todo);
+  return lo;
+}
+
+// ============================================================================
+// Return the id of 'txt' in the string table of 'fla', adding it if new
+// ============================================================================
+uint32_t flaStr(Fla* fla, char* txt) {
+  FlaStrs* s = &fla->str;
+  if (2 * (s->num + 1) > s->mask + 1) flaRehash(s);   // keep half empty
+
+  int len = strlen(txt);
+  int i = (int) utHash(txt, len) & s->mask;
+  for (; s->slot[i]; i = (i + 1) & s->mask) {
+    uint32_t id = s->slot[i] - 1;
+    if (strcmp(s->txt + s->off[id], txt) == 0) return id;
+  }
+
+  if (s->num == s->max) {
+    s->max = 2 * s->max + 64;
+    s->off = flaGrow(s->off, s->max, sizeof(uint32_t));
+  }
+  if (s->size + len + 1 > s->cap) {
+    s->cap = 2 * s->cap + len + 1024;
+    s->txt = flaGrow(s->txt, s->cap, 1);
+  }
+  memcpy(s->txt + s->size, txt, len + 1);
+  s->off[s->num] = s->size;
+  s->size += len + 1;
+  s->slot[i] = s->num + 1;
+  return s->num++;
+}
+
+// ============================================================================
+// Return the text of string 'id'
+// ============================================================================
+char* flaTxt(Fla* fla, uint32_t id) { return fla->str.txt + fla->str.off[id]; }
+
+// ============================================================================
+// Call => Nam "(" Args ")"
+// ============================================================================
+void flaVisitCall(Fla* fla, uint32_t call) {
+  pin(); printf("Call \n"); pinMore();
+  pin(); printf("%s \n", flaTxt(fla, fla->call.nam[call]));
+  pin(); printf("Args \n"); pinMore();
+  uint32_t lo = fla->call.argLo[call];
+  uint32_t num = fla->call.numArg[call];
+  if (num == 0) {                             // as visitArgs
+    pin(); printf("Arg \n"); pinMore();
+    pin(); printf("str = NULL \n"); pinLess();
+  }
+  for (uint32_t a = lo; a < lo + num; ++a) {
+    pin(); printf("Arg \n"); pinMore();
+    flaVisitLeaf(fla, fla->kids[a]);
+    pinLess();
+  }
+  pinLess();
+  pinLess();
+}
+
+// ============================================================================
+// Exp => NamNum | NamNum Bop NamNum
+// ============================================================================
+void flaVisitExp(Fla* fla, uint32_t exp) {
+  pin(); printf("Exp \n"); pinMore();
+  flaVisitLeaf(fla, fla->exp.lhs[exp]);
+  BOP bop = fla->exp.bop[exp];
+  if (bop != BOPNONE) {
+    pin(); printf("Bop = %s \n", astBOPtoStr(bop));
+    flaVisitLeaf(fla, fla->exp.rhs[exp]);
+  }
+  pinLess();
+}
+
+// ============================================================================
+// Fun => "int" Nam "(" Pars ")" Body
+// ============================================================================
+void flaVisitFun(Fla* fla, uint32_t fun) {
+  FlaFuns* p = &fla->fun;
+  pin(); printf("Fun \n"); pinMore();
+  pin(); printf("nam = %s \n", flaTxt(fla, p->nam[fun]));
+  pin(); printf("typ = int \n");
+  for (uint32_t i = p->parLo[fun]; i < p->parLo[fun] + p->numPar[fun]; ++i) {
+    pin(); printf("Par \n"); pinMore();
+    pin(); printf("nam = %s \n", flaTxt(fla, fla->ids[i]));
+    pin(); printf("typ = int\n");
+    pinLess();
+  }
+
+  pin(); printf("Body \n"); pinMore();
+  if (p->numVar[fun] > 0) {
+    pin(); printf("Vars \n"); pinMore();
+    for (uint32_t i = p->varLo[fun]; i < p->varLo[fun] + p->numVar[fun]; ++i) {
+      pin(); printf("Var \n"); pinMore();
+      pin(); printf("nam = %s \n", flaTxt(fla, fla->ids[i]));
+      pin(); printf("typ = int \n");
+      pinLess();
+    }
+    pinLess();
+  }
+  flaVisitStms(fla, p->stmLo[fun], p->numStm[fun]);
+  pinLess();
+  pinLess();
+}
+
+// ============================================================================
+// Nam | Num | Str
+// ============================================================================
+void flaVisitLeaf(Fla* fla, FlaRef ref) {
+  uint32_t i = FLAIDX(ref);
+  switch (FLAKIND(ref)) {
+    case ASTNAM: pin(); printf("nam = %s \n", flaTxt(fla, i));       break;
+    case ASTNUM: pin(); printf("num = %d \n", fla->nums.val[i]);     break;
+    case ASTSTR: pin(); printf("str = \"%s\" \n", flaTxt(fla, i));   break;
+    default:                                                         break;
+  }
+}
+
+// ============================================================================
+// Prog => Fun+
+// ============================================================================
+void flaVisitProg(Fla* fla) {
+  pin(); printf("Prog \n"); pinMore();
+  for (int f = 0; f < fla->fun.num; ++f) flaVisitFun(fla, f);
+  pinLess();
+  printf("\n\n");
+}
+
+// ============================================================================
+// Visit the 'numStm' Stms that start at kids[stmLo].  As visitStms, keep a
+// heap-allocated stack of the Blocks still open: the next Stm to visit in the
+// innermost is kids[next[hi]], and it ends before kids[end[hi]]
+// ============================================================================
+void flaVisitStms(Fla* fla, uint32_t stmLo, uint32_t numStm) {
+  int maxFrame = 16;
+  uint32_t* next = malloc(maxFrame * sizeof(uint32_t));
+  uint32_t* end = malloc(maxFrame * sizeof(uint32_t));
+  if (next == NULL || end == NULL) utDie2Str("flaVisitStms", "malloc failed");
+
+  int hi = 0;
+  next[0] = stmLo;
+  end[0] = stmLo + numStm;
+
+  for (;;) {
+    if (next[hi] == end[hi]) {                    // Block is done
+      if (hi == 0) break;
+      --hi;
+      pinLess();                                  // end of Block ...
+      pinLess();                                  // ... and its If|While
+      continue;
+    }
+    FlaRef stm = fla->kids[next[hi]++];
+    uint32_t s = FLAIDX(stm);
+
+    switch (FLAKIND(stm)) {
+      case ASTASG: {
+        pin(); printf("Asg \n"); pinMore();
+        pin(); printf("nam = %s \n", flaTxt(fla, fla->asg.nam[s]));
+        FlaRef eoc = fla->asg.eoc[s];
+        if (FLAKIND(eoc) == ASTEXP) {
+          flaVisitExp(fla, FLAIDX(eoc));
+        } else {
+          flaVisitCall(fla, FLAIDX(eoc));
+        }
+        pinLess();
+        break;
+      }
+      case ASTRET:
+        pin(); printf("Ret \n"); pinMore();
+        flaVisitExp(fla, fla->ret.exp[s]);
+        pinLess();
+        break;
+      case ASTIF:
+      case ASTWHILE: {
+        FlaConds* p = FLAKIND(stm) == ASTIF ? &fla->iff : &fla->whl;
+        pin(); printf(FLAKIND(stm) == ASTIF ? "If \n" : "While \n"); pinMore();
+        flaVisitExp(fla, p->exp[s]);
+        pin(); printf("Block \n"); pinMore();
+        if (++hi == maxFrame) {
+          maxFrame *= 2;
+          next = realloc(next, maxFrame * sizeof(uint32_t));
+          end = realloc(end, maxFrame * sizeof(uint32_t));
+          if (next == NULL || end == NULL)
+            utDie2Str("flaVisitStms", "realloc failed");
+        }
+        next[hi] = p->stmLo[s];
+        end[hi] = p->stmLo[s] + p->numStm[s];
+        break;
+      }
+      default:                                    break;
+    }
+  }
+
+  free(next);
+  free(end);
+}
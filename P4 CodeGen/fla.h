@@ -0,0 +1,195 @@
+// fla.h - Flat AST, in structure-of-arrays form
+
+#pragma once
+
+#include <stdint.h>         // uint8_t, uint32_t
+
+#include "ast.h"            // AstProg
+#include "pin.h"            // pin*
+
+// The AST that the parser builds is a tree of separately calloc'd nodes,
+// linked by 8-byte pointers.  A Fla holds that same program, flattened (see
+// flaNew).  Each kind of node has a pool, with one dense array per field, and
+// a node is just its index into the pool for its kind.  So:
+//
+//    - a child that may be one of several kinds (the lhs of an Exp, an Arg,
+//      a Stm) is a FlaRef: its kind in the top 5 bits, its index in the
+//      low 27
+//    - a list of children is a range - its first index, and a count - into
+//      one of two shared arrays: 'ids' for the names of Pars and Vars, and
+//      'kids' for the FlaRefs of Stms and Args.  Each list is contiguous
+//    - a Nam or Str is not a node at all: its FlaRef holds the id of its text
+//      in the string table, where each distinct text is stored just once
+//    - Block, Body and Stm have no pools.  Their lists are held by the node
+//      that owns them - the If, While or Fun
+//
+// Every index is 32 bits, and nothing points anywhere: a Fla can be copied,
+// or written to a file, one array at a time.  flaVisitProg prints a Fla just
+// as visitProg prints the AST it came from.
+
+typedef uint32_t FlaRef;
+
+#define FLASHIFT  27                            // FlaRef = kind << FLASHIFT | index
+#define FLAMAXIDX ((1u << FLASHIFT) - 1)
+
+#define FLAREF(kind, idx) (((FlaRef) (kind) << FLASHIFT) | (uint32_t) (idx))
+#define FLAKIND(ref)      ((AST) ((ref) >> FLASHIFT))
+#define FLAIDX(ref)       ((ref) & FLAMAXIDX)
+
+typedef struct {            // Fun => "int" Nam "(" Pars ")" Body
+  int       num, max;
+  uint32_t* nam;            // string id
+  uint32_t* parLo;          // Pars are ids[parLo] thru ids[parLo + numPar - 1]
+  uint32_t* numPar;
+  uint32_t* varLo;          // Vars, likewise, in 'ids'
+  uint32_t* numVar;
+  uint32_t* stmLo;          // Stms are kids[stmLo] thru kids[stmLo + numStm - 1]
+  uint32_t* numStm;
+} FlaFuns;
+
+typedef struct {            // If | While => "if" | "while" "(" Exp ")" Block
+  int       num, max;
+  uint32_t* exp;            // index into the Exp pool
+  uint32_t* stmLo;          // Stms of the Block, in 'kids'
+  uint32_t* numStm;
+} FlaConds;
+
+typedef struct {            // Asg => Nam "=" (Exp | Call) ";"
+  int       num, max;
+  uint32_t* nam;            // string id
+  FlaRef*   eoc;            // Exp or Call
+} FlaAsgs;
+
+typedef struct {            // Call => Nam "(" Args ")"
+  int       num, max;
+  uint32_t* nam;            // string id
+  uint32_t* argLo;          // Args, in 'kids': each a Nam, Num or Str
+  uint32_t* numArg;
+} FlaCalls;
+
+typedef struct {            // Exp => NamNum | NamNum Bop NamNum
+  int       num, max;
+  FlaRef*   lhs;            // Nam or Num
+  FlaRef*   rhs;            // Nam or Num - unless bop is BOPNONE
+  uint8_t*  bop;
+} FlaExps;
+
+typedef struct {            // Num => [0-9]+
+  int       num, max;
+  int32_t*  val;
+} FlaNums;
+
+typedef struct {            // Ret => "return" Exp ";"
+  int       num, max;
+  uint32_t* exp;            // index into the Exp pool
+} FlaRets;
+
+typedef struct {            // String table: names and literal strings
+  int       num, max;
+  uint32_t* off;            // text of string 'id' starts at txt[off[id]]
+  char*     txt;            // each text, zero-terminated
+  int       size, cap;      // chars used, and allocated, in 'txt'
+  uint32_t* slot;           // while building: hash table of id + 1 (0 = empty)
+  int       mask;           // ... which has mask + 1 slots
+} FlaStrs;
+
+typedef struct {            // a Stm list whose range is reserved, but not filled
+  AstStm**  stm;
+  int       num;
+  uint32_t  lo;             // in 'kids'
+} FlaTodo;
+
+typedef struct {
+  FlaFuns   fun;
+  FlaConds  iff;            // If
+  FlaConds  whl;            // While
+  FlaAsgs   asg;
+  FlaRets   ret;
+  FlaCalls  call;
+  FlaExps   exp;
+  FlaNums   nums;
+  FlaStrs   str;
+  uint32_t* ids;            // names of Pars and Vars, as string ids
+  int       numId, maxId;
+  FlaRef*   kids;           // Stms and Args
+  int       numKid, maxKid;
+} Fla;
+
+// A Fla can be saved to a binary cache file (flaSave), and re-loaded from it
+// (flaLoad) by mapping the file into memory, and pointing each array of the
+// Fla straight at its place in the mapping: nothing is copied, or fixed up.
+// The file holds a fixed header, then the arrays, in the order listed by
+// flaFields: first those of 32-bit elements, then 'bop' and 'txt', so every
+// array is aligned, with no padding.  Each array holds 'num' elements, as
+// given in the header.  A loaded Fla is read-only: add nothing to it.  flaAst
+// re-builds, from a Fla, the AST that codegen walks, so a compile whose Fla
+// is cached need not lex, or parse (see main.c).
+
+#define FLAMAGIC    0x54534153            // "SAST"
+#define FLAVERSION  1
+#define FLANUMFIELD 27                    // arrays in a Fla (see flaFields)
+
+typedef struct {
+  unsigned magic;           // FLAMAGIC
+  unsigned version;         // FLAVERSION
+  unsigned srcLen;          // length of the source text that was parsed
+  unsigned srcHash;         // utHash of that source text
+  unsigned numFun, numIf, numWhile, numAsg, numRet, numCall, numExp, numNum;
+  unsigned numStr;          // strings in the string table ...
+  unsigned strSize;         // ... and their total chars, zero bytes included
+  unsigned numId;
+  unsigned numKid;
+} FlaHdr;
+
+typedef struct {            // one array of a Fla (see flaFields)
+  void**    arr;            // address of the Fla's pointer to the array
+  unsigned  num;            // elements in the array
+  int       size;           // bytes per element
+} FlaField;
+
+typedef struct {            // a Block being re-built by flaAstStms
+  uint32_t  next, end;      // its next Stm is kids[next]; it ends before kids[end]
+  Ast*      head;           // Stms re-built so far
+  Ast*      tail;
+  FlaRef    cond;           // the If or While that owns the Block
+} FlaFrame;
+
+AstProg* flaAst       (Fla* fla);
+AstCall* flaAstCall   (Fla* fla, uint32_t call);
+AstExp*  flaAstExp    (Fla* fla, uint32_t exp);
+AstFun*  flaAstFun    (Fla* fla, uint32_t fun);
+Ast*     flaAstLeaf   (Fla* fla, FlaRef ref);
+AstStm*  flaAstStms   (Fla* fla, uint32_t stmLo, uint32_t numStm);
+size_t   flaBytes     (Fla* fla);
+uint32_t flaCall      (Fla* fla, AstCall* call);
+int      flaCheck     (Fla* fla);
+int      flaCheckLeaf (Fla* fla, FlaRef ref);
+int      flaCheckStms (Fla* fla, uint32_t stmLo, uint32_t numStm);
+uint32_t flaExp       (Fla* fla, AstExp* exp);
+int      flaFields    (Fla* fla, FlaField* field);
+void     flaFun       (Fla* fla, AstFun* fun);
+void*    flaGrow      (void* arr, int max, int size);
+uint32_t flaIds       (Fla* fla, int num);
+uint32_t flaKids      (Fla* fla, int num);
+FlaRef   flaLeaf      (Fla* fla, Ast* ast);
+Fla*     flaLoad      (char* filePath, char* src);
+Fla*     flaNew       (AstProg* prog);
+uint32_t flaNewAsg    (Fla* fla, uint32_t nam, FlaRef eoc);
+uint32_t flaNewCall   (Fla* fla, uint32_t nam, uint32_t argLo, uint32_t numArg);
+uint32_t flaNewCond   (FlaConds* conds, uint32_t exp, uint32_t stmLo, uint32_t numStm);
+uint32_t flaNewExp    (Fla* fla, FlaRef lhs, BOP bop, FlaRef rhs);
+uint32_t flaNewFun    (Fla* fla, uint32_t nam);
+uint32_t flaNewNum    (Fla* fla, int val);
+uint32_t flaNewRet    (Fla* fla, uint32_t exp);
+void     flaRehash    (FlaStrs* s);
+void     flaSave      (Fla* fla, char* filePath, char* src);
+FlaRef   flaStm       (Fla* fla, Ast* stm, FlaTodo** todo, int* numTodo, int* maxTodo);
+uint32_t flaStms      (Fla* fla, AstStm** stm, int num);
+uint32_t flaStr       (Fla* fla, char* txt);
+char*    flaTxt       (Fla* fla, uint32_t id);
+void     flaVisitCall (Fla* fla, uint32_t call);
+void     flaVisitExp  (Fla* fla, uint32_t exp);
+void     flaVisitFun  (Fla* fla, uint32_t fun);
+void     flaVisitLeaf (Fla* fla, FlaRef ref);
+void     flaVisitProg (Fla* fla);
+void     flaVisitStms (Fla* fla, uint32_t stmLo, uint32_t numStm);
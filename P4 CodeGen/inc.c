@@ -0,0 +1,99 @@
+// inc.c - Incremental re-parse, one function at a time
+//
+// See inc.h
+
+#include "inc.h"
+
+// ============================================================================
+// Find, in the hash table 'table' of old IncFuns, one that has 'hash', and
+// has not been re-used already.  Return NULL if there is none.  'table' has
+// mask + 1 slots, and is filled by linear probing.
+// ============================================================================
+IncFun* incFind(IncFun** table, int mask, unsigned long long hash) {
+  for (int i = (int) hash & mask; table[i]; i = (i + 1) & mask) {
+    if (table[i]->hash == hash && !table[i]->used) return table[i];
+  }
+  return NULL;
+}
+
+// ============================================================================
+// FNV-1a hash, 64 bits, of Toks 'lo' thru 'hi' of 'toks'.  64 bits makes it
+// vanishingly unlikely that two different functions will collide.
+// ============================================================================
+unsigned long long incHash(Toks* toks, int lo, int hi) {
+  unsigned long long h = 14695981039346656037ull;
+  for (int t = lo; t <= hi; ++t) {
+    Tok* tok = &toks->tok[t];
+    h = (h ^ tok->kind) * 1099511628211ull;
+    h = (h ^ (unsigned) tok->num) * 1099511628211ull;
+    for (char* c = tok->lex; c && *c; ++c) h = (h ^ (unsigned char) *c) * 1099511628211ull;
+    h = (h ^ 0xFF) * 1099511628211ull;      // ends lexeme: "ab","c" != "a","bc"
+  }
+  return h;
+}
+
+// ============================================================================
+// Create an Inc that has seen no functions yet
+// ============================================================================
+Inc* incNew() {
+  Inc* inc = calloc(1, sizeof(Inc));
+  if (inc == NULL) utDie2Str("incNew", "calloc failed");
+  inc->nextId = 1;
+  return inc;
+}
+
+// ============================================================================
+// Prog => Fun+
+// Parse the whole of 'toks' (which must be an array, not a stream), re-using
+// the AstFuns of the last compile, as described in inc.h.  Then remember the
+// functions of this compile, for the next one.
+// ============================================================================
+AstProg* incProg(Inc* inc, Toks* toks) {
+  int numFun = 0;
+  int* start = jobScan(toks, &numFun);
+  if (start == NULL) return pseProg(toks);    // which reports the error
+
+  // Hash the old functions into a table, at most half full
+
+  int mask = 1;
+  while (mask + 1 < 2 * inc->numFun) mask = 2 * mask + 1;
+  IncFun** table = calloc(mask + 1, sizeof(IncFun*));
+  if (table == NULL) utDie2Str("incProg", "calloc failed");
+  for (int f = 0; f < inc->numFun; ++f) {
+    int i = (int) inc->funs[f].hash & mask;
+    while (table[i]) i = (i + 1) & mask;
+    table[i] = &inc->funs[f];
+  }
+
+  IncFun* funs = malloc(numFun * sizeof(IncFun));
+  if (funs == NULL) utDie2Str("incProg", "malloc failed");
+  inc->numReused = inc->numParsed = 0;
+
+  for (int f = 0; f < numFun; ++f) {
+    int hi = f + 1 < numFun ? start[f + 1] - 1 : toks->hiTokNum;
+    funs[f].hash = incHash(toks, start[f], hi);
+    funs[f].used = 0;
+    IncFun* old = incFind(table, mask, funs[f].hash);
+    if (old) {
+      old->used = 1;
+      funs[f].fun = old->fun;                 // keeps its id
+      ++inc->numReused;
+    } else {
+      funs[f].fun = jobParse(toks, start[f], hi);
+      funs[f].fun->id = inc->nextId++;
+      ++inc->numParsed;
+    }
+  }
+
+  for (int f = 0; f + 1 < numFun; ++f) funs[f].fun->next = (Ast*) funs[f + 1].fun;
+  funs[numFun - 1].fun->next = NULL;
+
+  free(inc->funs);
+  free(table);
+  free(start);
+  inc->funs = funs;
+  inc->numFun = numFun;
+
+  toks->tokNum = toks->hiTokNum + 1;          // as if pseProg had run
+  return astNewProg(funs[0].fun);
+}
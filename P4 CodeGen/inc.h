@@ -0,0 +1,41 @@
+// inc.h - Incremental re-parse, one function at a time
+
+#pragma once
+
+#include "ast.h"            // AstFun, AstProg
+#include "job.h"            // jobParse, jobScan
+#include "toks.h"           // Toks
+
+// When the same program is compiled over and over, as it is edited (see the
+// -watch option in main.c), most of its functions do not change between one
+// compile and the next.  So an Inc remembers, for each function of the last
+// compile, a hash of its Toks, together with its AstFun.  incProg splits the
+// new Toks into functions (see jobScan), and re-uses the AstFun of any whose
+// hash it has seen before, parsing only the others.
+//
+// The hash covers each Tok's kind, num and lexeme, but not its position:
+// the AST holds no line or column numbers, so a function that has merely
+// moved, because an earlier one grew, is re-used too.
+//
+// Each AstFun has an 'id', which incProg keeps as it re-uses that AstFun.
+// A re-parsed function gets a new id.  So a later phase that caches its work
+// by id knows that, if the id is the same, so is the function.
+
+typedef struct {
+  unsigned long long hash;  // of the function's Toks
+  AstFun*  fun;
+  int      used;            // re-used already, by this compile?
+} IncFun;
+
+typedef struct {
+  IncFun*  funs;            // one per function of the last compile
+  int      numFun;
+  int      nextId;          // id for the next AstFun we parse
+  int      numReused;       // in the last compile
+  int      numParsed;       // in the last compile
+} Inc;
+
+IncFun*  incFind(IncFun** table, int mask, unsigned long long hash);
+unsigned long long incHash(Toks* toks, int lo, int hi);
+Inc*     incNew();
+AstProg* incProg(Inc* inc, Toks* toks);
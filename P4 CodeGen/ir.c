@@ -0,0 +1,520 @@
+// ir.c - Three-Address Intermediate Representation
+//
+// See ir.h
+
+#include "ir.h"
+
+int g_irDump  = 0;                              // -ir : see irDump
+int g_irStats = 0;                              // --stats : see cfgProg, ssaProg
+
+// ============================================================================
+// Append an instruction 'op', which uses vregs 'a' and 'b' (or -1), to the
+// block being filled - starting a new block if the last one was terminated:
+// that block is unreachable, as is code after a return.  If 'op' defines a
+// value, give it a new vreg.  Return the instruction's index.
+// ============================================================================
+int irAdd(Ir* ir, IROP op, int a, int b) {
+  IrFun* fun = ir->fun[ir->numFun - 1];
+  if (ir->cur < 0) irStart(ir, irNewBlk(fun));
+
+  if (fun->numIns == fun->maxIns) {
+    fun->ins = irGrow(fun->ins, &fun->maxIns, sizeof(IrIns));
+  }
+  int i = fun->numIns++;
+  IrIns* ins = &fun->ins[i];
+  memset(ins, 0, sizeof(IrIns));
+  ins->op = op;
+  ins->dst = -1;
+  ins->a = a;
+  ins->b = b;
+  ins->blk[0] = ins->blk[1] = -1;
+
+  if (op == IRBIN || op == IRCALL || op == IRCONST || op == IRLOAD || op == IRSTR) {
+    ins->dst = irNewVreg(fun, op == IRSTR ? TYPSTR : TYPINT);
+  }
+
+  ++fun->blk[ir->cur].num;
+  if (irTerm(op)) ir->cur = -1;
+  return i;
+}
+
+// ============================================================================
+// Call => Nam "(" Args ")"
+//
+// Push the arguments, right to left, then call.  For ms = add2(mx, my):
+//
+//    v0 = load my [FP, #-8]
+//    arg v0
+//    v1 = load mx [FP, #-4]
+//    arg v1
+//    v2 = call add2, 2
+//
+// Return the vreg that holds the result.
+// ============================================================================
+int irCall(Ir* ir, AstCall* astcall) {
+  int numarg = astCountArgs(astcall);
+  for (int argnum = numarg; argnum >= 1; --argnum) {
+    AstArg* astarg = astFindArg(astcall, argnum);
+    assert(astarg);
+    irAdd(ir, IRARG, irNns(ir, astarg->nns), -1);
+  }
+  IrFun* fun = ir->fun[ir->numFun - 1];
+  int i = irAdd(ir, IRCALL, -1, -1);
+  fun->ins[i].sym = astcall->nam->lex;
+  fun->ins[i].num = numarg;
+  return fun->ins[i].dst;
+}
+
+// ============================================================================
+// Post hook for If and While.  Once its Block is built, branch to the
+// While's test, or, for an If, on to whatever follows it.  That is the exit
+// block, which we start.
+// ============================================================================
+WALK irClose(Walk* walk, Ast* ast) {
+  Ir* ir = walk->ctx;
+  IrOpen open = ir->open[--ir->numOpen];
+  IrFun* fun = ir->fun[ir->numFun - 1];
+  if (ir->cur >= 0) {
+    int i = irAdd(ir, IRBR, -1, -1);
+    fun->ins[i].blk[0] = open.head >= 0 ? open.head : open.exit;
+  }
+  irStart(ir, open.exit);
+  return WALKGO;
+}
+
+// ============================================================================
+// Dump the IR of every function to the file IrDump.txt
+// ============================================================================
+void irDump(Ir* ir) {
+  FILE* f = fopen("IrDump.txt", "w");
+  if (f == NULL) utDie2Str("irDump", "Cannot create IrDump.txt");
+  for (int n = 0; n < ir->numFun; ++n) irDumpFun(f, ir->fun[n]);
+  fclose(f);
+}
+
+// ============================================================================
+// Dump the IR of 'fun' to 'f', in the form shown in ir.h
+// ============================================================================
+void irDumpFun(FILE* f, IrFun* fun) {
+  static char* bops[] = { "?", "+", "-", "*", "?", "?", "<", "<=", "!=", "==", ">=", ">" };
+
+  fprintf(f, "fun %s  (frame %d, %d vregs) \n", fun->nam, fun->frame, fun->numVreg);
+  for (int b = 0; b < fun->numBlk; ++b) {
+    fprintf(f, "B%d: \n", b);
+    for (int i = fun->blk[b].lo; i < fun->blk[b].lo + fun->blk[b].num; ++i) {
+      IrIns* ins = &fun->ins[i];
+      fprintf(f, "\t ");
+      if (ins->dst >= 0) fprintf(f, "v%d = ", ins->dst);
+      switch (ins->op) {
+        case IRARG:   fprintf(f, "arg v%d", ins->a); break;
+        case IRBIN:   fprintf(f, "v%d %s v%d", ins->a,
+                        ins->bop <= BOPGT ? bops[ins->bop] : "?", ins->b); break;
+        case IRBR:    fprintf(f, "br B%d", ins->blk[0]); break;
+        case IRCALL:  fprintf(f, "call %s, %d", ins->sym, ins->num); break;
+        case IRCBR:   fprintf(f, "cbr v%d, B%d, B%d", ins->a, ins->blk[0], ins->blk[1]); break;
+        case IRCONST: fprintf(f, "const %d", ins->num); break;
+        case IRCOPY:  fprintf(f, "copy v%d", ins->a); break;
+        case IRLOAD:  fprintf(f, "load %s [FP, #%d]", ins->sym, ins->num); break;
+        case IRPHI:   fprintf(f, "phi");
+                      for (int g = ins->num; g < ins->num + ins->numArg; ++g) {
+                        fprintf(f, "%s [B%d: v%d]", g > ins->num ? "," : "",
+                          fun->arg[g].blk, fun->arg[g].v);
+                      }
+                      break;
+        case IRRET:   fprintf(f, ins->a >= 0 ? "ret v%d" : "ret", ins->a); break;
+        case IRSTORE: fprintf(f, "store %s [FP, #%d], v%d", ins->sym, ins->num, ins->a); break;
+        case IRSTR:   fprintf(f, "str \"%s\"", ins->sym); break;
+        default:      fprintf(f, "?%d", ins->op); break;
+      }
+      fprintf(f, " \n");
+    }
+  }
+  fprintf(f, "\n");
+}
+
+// ============================================================================
+// Exp => NamNum | NamNum Bop NamNum
+//
+// Return the vreg that holds the value of 'astexp'
+// ============================================================================
+int irExp(Ir* ir, AstExp* astexp) {
+  int a = irNns(ir, astexp->lhs);
+  if (astexp->rhs == NULL) return a;
+  int b = irNns(ir, astexp->rhs);
+  IrFun* fun = ir->fun[ir->numFun - 1];
+  int i = irAdd(ir, IRBIN, a, b);
+  fun->ins[i].bop = astexp->bop;
+  return fun->ins[i].dst;
+}
+
+// ============================================================================
+// Fun => "int"   Nam     "(" Pars ")" Body
+//      | "int"   "main"  "("      ")" Body
+//
+// Pre hook for Fun: start its IrFun, and its first block.  walkRun then
+// builds the rest from its Stms.
+// ============================================================================
+WALK irFun(Walk* walk, Ast* ast) {
+  Ir* ir = walk->ctx;
+  AstFun* astfun = (AstFun*) ast;
+  IrFun* fun = calloc(1, sizeof(IrFun));
+  if (fun == NULL) utDie2Str("irFun", "calloc failed");
+  fun->nam = astfun->nam->lex;
+  fun->fun = astfun;
+  fun->frame = layFrameSize(ir->lay, layFindFunIdx(ir->lay, fun->nam));
+
+  if (ir->numFun == ir->maxFun) {
+    ir->fun = irGrow(ir->fun, &ir->maxFun, sizeof(IrFun*));
+  }
+  ir->fun[ir->numFun++] = fun;
+  ir->numOpen = 0;
+  irStart(ir, irNewBlk(fun));
+  return WALKGO;
+}
+
+// ============================================================================
+// Post hook for Fun.  If control can reach its end, return (no value).  Then
+// put the blocks into layout order.
+// ============================================================================
+WALK irFunEnd(Walk* walk, Ast* ast) {
+  Ir* ir = walk->ctx;
+  if (ir->cur >= 0) irAdd(ir, IRRET, -1, -1);
+  irLayout(ir->fun[ir->numFun - 1]);
+  return WALKGO;
+}
+
+// ============================================================================
+// Make room for one more element in the array 'arr', of elements 'size'
+// bytes long, which holds '*max' of them, and is full.  Return the array,
+// which may have moved.
+// ============================================================================
+void* irGrow(void* arr, int* max, int size) {
+  *max = *max ? 2 * *max : 16;
+  arr = realloc(arr, (size_t) *max * size);
+  if (arr == NULL) utDie2Str("irGrow", "realloc failed");
+  return arr;
+}
+
+// ============================================================================
+// Blocks are numbered as they are made, but an If makes its exit block
+// before the blocks within it.  Re-number them in the order they were
+// started - which is the order of their instructions - and re-target the
+// branches to match.
+// ============================================================================
+void irLayout(IrFun* fun) {
+  int* byLo = malloc((fun->numIns + 1) * sizeof(int));
+  int* newNum = malloc((fun->numBlk + 1) * sizeof(int));
+  IrBlk* blk = malloc((fun->numBlk + 1) * sizeof(IrBlk));
+  if (!byLo || !newNum || !blk) utDie2Str("irLayout", "malloc failed");
+
+  for (int i = 0; i <= fun->numIns; ++i) byLo[i] = -1;
+  for (int b = 0; b < fun->numBlk; ++b) {
+    if (fun->blk[b].lo >= 0) byLo[fun->blk[b].lo] = b;
+  }
+  int num = 0;
+  for (int i = 0; i < fun->numIns; ++i) {
+    if (byLo[i] < 0) continue;
+    newNum[byLo[i]] = num;
+    blk[num++] = fun->blk[byLo[i]];
+  }
+
+  for (int i = 0; i < fun->numIns; ++i) {
+    IrIns* ins = &fun->ins[i];
+    for (int t = 0; t < 2; ++t) {
+      if (ins->blk[t] >= 0) ins->blk[t] = newNum[ins->blk[t]];
+    }
+  }
+  memcpy(fun->blk, blk, num * sizeof(IrBlk));
+  fun->numBlk = num;
+
+  free(blk);
+  free(newNum);
+  free(byLo);
+}
+
+// ============================================================================
+// Make a new, empty block in 'fun', not yet started.  Return its number.
+// ============================================================================
+int irNewBlk(IrFun* fun) {
+  if (fun->numBlk == fun->maxBlk) {
+    fun->blk = irGrow(fun->blk, &fun->maxBlk, sizeof(IrBlk));
+  }
+  fun->blk[fun->numBlk].lo = -1;
+  fun->blk[fun->numBlk].num = 0;
+  return fun->numBlk++;
+}
+
+// ============================================================================
+// Make a new vreg in 'fun', of type 'typ'.  Return its number.
+// ============================================================================
+int irNewVreg(IrFun* fun, TYP typ) {
+  if (fun->numVreg == fun->maxVreg) {
+    fun->typ = irGrow(fun->typ, &fun->maxVreg, sizeof(TYP));
+  }
+  fun->typ[fun->numVreg] = typ;
+  return fun->numVreg++;
+}
+
+// ============================================================================
+// NamNum => Nam | Num, or a Str as an Arg
+//
+// Return a vreg holding the value of 'nns'.  resProg has bound a Nam to the
+// frame slot of its Par or Var.
+// ============================================================================
+int irNns(Ir* ir, Ast* nns) {
+  IrFun* fun = ir->fun[ir->numFun - 1];
+  int i;
+  if (nns->kind == ASTNAM) {
+    AstNam* astnam = (AstNam*) nns;
+    if (astnam->fun == NULL) utDie5Str("irNns", "Unresolved symbol",
+      astnam->lex, "in function", fun->nam);
+    i = irAdd(ir, IRLOAD, -1, -1);
+    fun->ins[i].sym = astnam->lex;
+    fun->ins[i].num = astnam->off;
+  } else if (nns->kind == ASTNUM) {
+    i = irAdd(ir, IRCONST, -1, -1);
+    fun->ins[i].num = ((AstNum*) nns)->val;
+  } else {
+    i = irAdd(ir, IRSTR, -1, -1);
+    fun->ins[i].sym = ((AstStr*) nns)->txt;
+  }
+  return fun->ins[i].dst;
+}
+
+// ============================================================================
+// If    => "if" "(" Exp ")" Block
+// While => "while" "(" Exp ")" Block
+//
+// Pre hook for If and While.  Build the test, and branch on it: into the
+// Block, or past it, to the exit block.  A While's test gets a block of its
+// own, for the Block to branch back to.  Then start the Block; irClose ends
+// it.
+// ============================================================================
+WALK irOpen(Walk* walk, Ast* ast) {
+  Ir* ir = walk->ctx;
+  IrFun* fun = ir->fun[ir->numFun - 1];
+
+  if (ir->numOpen == ir->maxOpen) {
+    ir->open = irGrow(ir->open, &ir->maxOpen, sizeof(IrOpen));
+  }
+  IrOpen* open = &ir->open[ir->numOpen++];
+  open->head = -1;
+
+  AstExp* astexp;
+  if (ast->kind == ASTIF) {
+    astexp = ((AstIf*) ast)->exp;
+  } else {
+    astexp = ((AstWhile*) ast)->exp;
+    open->head = irNewBlk(fun);
+    if (ir->cur >= 0) {
+      int i = irAdd(ir, IRBR, -1, -1);
+      fun->ins[i].blk[0] = open->head;
+    }
+    irStart(ir, open->head);
+  }
+
+  int test = irExp(ir, astexp);
+  int body = irNewBlk(fun);
+  open->exit = irNewBlk(fun);
+  int i = irAdd(ir, IRCBR, test, -1);
+  fun->ins[i].blk[0] = body;
+  fun->ins[i].blk[1] = open->exit;
+  irStart(ir, body);
+  return WALKGO;
+}
+
+// ============================================================================
+// Lower each function of 'prog', which resProg has resolved into 'lay', to
+// IR (see ir.h)
+// ============================================================================
+Ir* irProg(Lay* lay, AstProg* prog) {
+  Ir* ir = calloc(1, sizeof(Ir));
+  if (ir == NULL) utDie2Str("irProg", "calloc failed");
+  ir->lay = lay;
+  ir->cur = -1;
+
+  Walk* walk = walkNew(ir);
+  walkOn(walk, ASTASG,   irStm,    NULL);
+  walkOn(walk, ASTEXP,   walkSkip, NULL);
+  walkOn(walk, ASTFUN,   irFun,    irFunEnd);
+  walkOn(walk, ASTIF,    irOpen,   irClose);
+  walkOn(walk, ASTPAR,   walkSkip, NULL);
+  walkOn(walk, ASTRET,   irStm,    NULL);
+  walkOn(walk, ASTVAR,   walkSkip, NULL);
+  walkOn(walk, ASTWHILE, irOpen,   irClose);
+  walkRun(walk, (Ast*) prog);
+  walkFree(walk);
+  return ir;
+}
+
+// ============================================================================
+// Start filling block 'blk', which is empty, of the current function
+// ============================================================================
+void irStart(Ir* ir, int blk) {
+  IrFun* fun = ir->fun[ir->numFun - 1];
+  fun->blk[blk].lo = fun->numIns;
+  ir->cur = blk;
+}
+
+// ============================================================================
+// Asg => Nam "=" (Exp | Call) ";"
+// Ret => "return" Exp ";"
+//
+// Pre hook for Asg and Ret, which builds all of their IR
+// ============================================================================
+WALK irStm(Walk* walk, Ast* ast) {
+  Ir* ir = walk->ctx;
+  IrFun* fun = ir->fun[ir->numFun - 1];
+  if (ast->kind == ASTASG) {
+    AstAsg* astasg = (AstAsg*) ast;
+    int v = astasg->eoc->kind == ASTCALL
+      ? irCall(ir, (AstCall*) astasg->eoc)
+      : irExp(ir, (AstExp*) astasg->eoc);
+    AstNam* astnam = astasg->nam;
+    if (astnam->fun == NULL) utDie5Str("irStm", "Unresolved symbol",
+      astnam->lex, "in function", fun->nam);
+    int i = irAdd(ir, IRSTORE, v, -1);
+    fun->ins[i].sym = astnam->lex;
+    fun->ins[i].num = astnam->off;
+  } else {
+    irAdd(ir, IRRET, irExp(ir, ((AstRet*) ast)->exp), -1);
+  }
+  return WALKSKIP;
+}
+
+// ============================================================================
+// Does 'op' end a block?
+// ============================================================================
+int irTerm(IROP op) {
+  return op == IRBR || op == IRCBR || op == IRRET;
+}
+
+// ============================================================================
+// Check that every function of 'ir' is well formed (see irVerifyFun)
+// ============================================================================
+void irVerify(Ir* ir) {
+  for (int n = 0; n < ir->numFun; ++n) irVerifyFun(ir->fun[n]);
+}
+
+// ============================================================================
+// Check that 'fun' is well formed, and stop the compile if not.  Its blocks
+// must tile its instructions, in order, each ending with its only
+// terminator, whose targets are blocks of 'fun'.  Each vreg must be defined
+// once - or only by copies - with the type its instruction gives, and used
+// only after its definition, if in the same block.  Phis must come first in
+// their block, each arg naming a block of 'fun'.  Each call must follow its
+// args, in its block.  An operator must be given operands of the right type.
+// ============================================================================
+void irVerifyFun(IrFun* fun) {
+  char msg[200];
+  int* defAt = malloc((fun->numVreg + 1) * sizeof(int));
+  if (defAt == NULL) utDie2Str("irVerifyFun", "malloc failed");
+
+  for (int v = 0; v < fun->numVreg; ++v) defAt[v] = -1;
+  for (int i = 0; i < fun->numIns; ++i) {
+    int d = fun->ins[i].dst;
+    int twice = d >= 0 && defAt[d] >= 0 &&
+      (fun->ins[i].op != IRCOPY || fun->ins[defAt[d]].op != IRCOPY);
+    if (d < -1 || d >= fun->numVreg || twice) {
+      snprintf(msg, sizeof msg, "%s: vreg v%d defined twice, or out of range", fun->nam, d);
+      utDie2Str("irVerifyFun", msg);
+    }
+    if (d >= 0) defAt[d] = i;
+  }
+
+  int next = 0;                                 // where the next block starts
+  for (int b = 0; b < fun->numBlk; ++b) {
+    IrBlk* blk = &fun->blk[b];
+    if (blk->lo != next || blk->num < 1) {
+      snprintf(msg, sizeof msg, "%s: block B%d out of place, or empty", fun->nam, b);
+      utDie2Str("irVerifyFun", msg);
+    }
+    next = blk->lo + blk->num;
+
+    int numArg = 0;                             // args pushed, not yet called
+    for (int i = blk->lo; i < next; ++i) {
+      IrIns* ins = &fun->ins[i];
+      char* err = NULL;
+
+      if (irTerm(ins->op) != (i == next - 1)) {
+        err = "terminator not last in its block";
+      }
+      for (int t = 0; t < 2; ++t) {
+        int want = ins->op == IRCBR || (ins->op == IRBR && t == 0);
+        if (want && (ins->blk[t] < 0 || ins->blk[t] >= fun->numBlk)) err = "bad target";
+        if (!want && ins->blk[t] != -1) err = "stray target";
+      }
+
+      int uses[2] = { ins->a, ins->b };
+      for (int u = 0; u < 2; ++u) {
+        int v = uses[u];
+        if (v < -1 || v >= fun->numVreg || (v >= 0 && defAt[v] < 0)) {
+          err = "use of undefined vreg";
+        } else if (v >= 0 && defAt[v] >= blk->lo && defAt[v] < next && defAt[v] >= i &&
+          fun->ins[defAt[v]].op != IRCOPY) {
+          err = "use before definition";
+        }
+      }
+      if (ins->op == IRPHI) {
+        if (i > blk->lo && fun->ins[i - 1].op != IRPHI) err = "phi not at top of its block";
+        if (ins->num < 0 || ins->numArg < 1 || ins->num + ins->numArg > fun->numArg) {
+          err = "bad phi args";
+        }
+        for (int g = ins->num; err == NULL && g < ins->num + ins->numArg; ++g) {
+          int v = fun->arg[g].v;
+          if (fun->arg[g].blk < 0 || fun->arg[g].blk >= fun->numBlk) err = "bad phi arg block";
+          else if (v < 0 || v >= fun->numVreg || defAt[v] < 0) err = "use of undefined vreg";
+          else if (fun->typ[v] != fun->typ[ins->dst]) err = "phi arg of wrong type";
+        }
+      }
+      if (err == NULL) {
+        int a = ins->a, bb = ins->b;
+        TYP ta = a >= 0 ? fun->typ[a] : TYPUNK;
+        TYP tb = bb >= 0 ? fun->typ[bb] : TYPUNK;
+        switch (ins->op) {
+          case IRARG:   if (a < 0) err = "arg needs a value"; ++numArg; break;
+          case IRBIN:   if (ta != TYPINT || tb != TYPINT) err = "bop needs ints";
+                        if (ins->bop < BOPADD || ins->bop > BOPGT ||
+                          ins->bop == BOPNONE || ins->bop == BOPBAD) err = "bad bop";
+                        break;
+          case IRCALL:  if (ins->num != numArg) err = "call after wrong number of args";
+                        else if (numArg > 0 && ins[-1].op != IRARG) {
+                          err = "call not just after its first arg";    // see cgArg
+                        }
+                        numArg = 0; break;
+          case IRCBR:   if (ta != TYPINT) err = "cbr needs an int"; break;
+          case IRRET:   if (a >= 0 && ta != TYPINT) err = "ret needs an int"; break;
+          case IRSTORE: if (ta != TYPINT) err = "store needs an int"; break;
+          case IRCOPY:  if (a < 0 || bb != -1) err = "copy needs one value";
+                        else if (ins->dst < 0 || fun->typ[ins->dst] != ta) err = "copy of wrong type";
+                        break;
+          case IRBR: case IRCONST: case IRLOAD: case IRPHI: case IRSTR: break;
+          default:      err = "unknown op"; break;
+        }
+        if (ins->op != IRARG && ins->op != IRBIN && ins->op != IRCBR && ins->op != IRCOPY &&
+          ins->op != IRRET && ins->op != IRSTORE && (a != -1 || bb != -1)) {
+          err = "stray operand";
+        }
+        int typed = ins->op != IRCOPY && ins->op != IRPHI;   // these take their args' type
+        if (typed && ins->dst >= 0 && fun->typ[ins->dst] != (ins->op == IRSTR ? TYPSTR : TYPINT)) {
+          err = "vreg of wrong type";
+        }
+        if ((ins->op == IRCOPY || ins->op == IRPHI) && ins->dst < 0) err = "no vreg defined";
+      }
+      if (err) {
+        snprintf(msg, sizeof msg, "%s: B%d, instruction %d: %s", fun->nam, b, i - blk->lo, err);
+        utDie2Str("irVerifyFun", msg);
+      }
+    }
+    if (numArg) {
+      snprintf(msg, sizeof msg, "%s: B%d: args with no call", fun->nam, b);
+      utDie2Str("irVerifyFun", msg);
+    }
+  }
+  if (next != fun->numIns) {
+    snprintf(msg, sizeof msg, "%s: instructions outside any block", fun->nam);
+    utDie2Str("irVerifyFun", msg);
+  }
+
+  free(defAt);
+}
@@ -0,0 +1,122 @@
+// ir.h - Three-Address Intermediate Representation
+
+#pragma once
+
+#include "ast.h"            // Ast*, BOP, TYP
+#include "lay.h"            // Lay, layFrameSize
+#include "walk.h"           // walkRun
+
+// irProg lowers the AST of each function into a list of basic blocks of
+// three-address instructions, which cgProg then lowers to ARM.  Between the
+// two, a pass may rewrite the IR freely, so long as irVerify still accepts it.
+//
+// Each value is held in a virtual register ('vreg'), numbered from 0 within
+// its function, and defined by exactly one instruction.  Its type is TYPINT,
+// or TYPSTR for the address of a literal string.  Pars and Vars are not
+// vregs: they live in frame slots, read and written only by IRLOAD and
+// IRSTORE, at their offset from FP.  So, for example:
+//
+//    x = a + 7;      =>    v0 = load a [FP, #8]
+//                          v1 = const 7
+//                          v2 = v0 + v1
+//                          store x [FP, #-4], v2
+//
+// A block is a run of instructions that ends with its only terminator - a
+// br, cbr or ret - and control enters it only at the top.  Blocks are kept,
+// and numbered, in layout order: cg falls through, rather than branch, from
+// a block to the next.  A function that ends without a return ends with a
+// 'ret' of no value.
+//
+// In SSA form (see ssa.h) a block may start with phis, and Pars and Vars
+// live in vregs, rather than in frame slots.  Leaving SSA turns each phi
+// into copies: so a vreg may then be defined by several copies, and by
+// nothing else.
+
+typedef enum {
+  IRARG = 1,        //      arg   a           push a, the next argument, right to left
+  IRBIN,            // d =  a bop b           + - *, or a comparison, giving 1 or 0
+  IRBR,             //      br    B           jump to block B
+  IRCALL,           // d =  call  sym, num    after 'num' IRARGs
+  IRCBR,            //      cbr   a, B, C     to B if a != 0, else to C
+  IRCONST,          // d =  const num
+  IRCOPY,           // d =  copy  a
+  IRLOAD,           // d =  load  sym [FP, #num]
+  IRPHI,            // d =  phi   [B: v], ...    one arg per predecessor
+  IRRET,            //      ret   a           a = -1 for none
+  IRSTORE,          //      store sym [FP, #num], a
+  IRSTR,            // d =  str   "sym"
+} IROP;
+
+typedef struct {
+  IROP  op;
+  BOP   bop;                // IRBIN: its operator
+  int   dst;                // vreg defined, or -1
+  int   a, b;               // vregs used, or -1
+  int   num;                // IRCONST value, IRLOAD/IRSTORE offset,
+                            // IRCALL argument count, or IRPHI first arg ...
+  int   numArg;             // ... IRPHI args are arg[num] thru arg[num + numArg - 1]
+  int   blk[2];             // IRBR, IRCBR: target blocks
+  char* sym;                // IRCALL callee, IRLOAD/IRSTORE Par or Var name,
+} IrIns;                    // or IRSTR text
+
+typedef struct {            // an arg of a phi
+  int   blk;                // the predecessor it comes from ...
+  int   v;                  // ... and the vreg it brings
+} IrArg;
+
+typedef struct {
+  int   lo;                 // instructions are ins[lo] ...
+  int   num;                // ... thru ins[lo + num - 1], the terminator
+} IrBlk;
+
+typedef struct {
+  char*   nam;
+  AstFun* fun;
+  int     frame;            // bytes of Vars, below FP (see layFrameSize)
+  IrIns*  ins;
+  int     numIns, maxIns;
+  IrBlk*  blk;              // blocks, in layout order
+  int     numBlk, maxBlk;
+  TYP*    typ;              // type of each vreg
+  int     numVreg, maxVreg;
+  IrArg*  arg;              // args of all phis
+  int     numArg, maxArg;
+} IrFun;
+
+typedef struct {            // an If or While whose Block is being built
+  int     head;             // block of a While's test; -1 for an If
+  int     exit;             // block just past it
+} IrOpen;
+
+typedef struct {
+  Lay*    lay;
+  IrFun** fun;              // one per function, in source order
+  int     numFun, maxFun;
+  int     cur;              // block being filled, or -1 after a terminator
+  IrOpen* open;             // If and While statements open: innermost last
+  int     numOpen, maxOpen;
+} Ir;
+
+extern int g_irDump;        // -ir : dump the IR to IrDump.txt
+extern int g_irStats;       // --stats : passes over the IR report what they do
+
+int     irAdd   (Ir* ir, IROP op, int a, int b);
+int     irCall  (Ir* ir, AstCall* astcall);
+WALK    irClose (Walk* walk, Ast* ast);
+void    irDump  (Ir* ir);
+void    irDumpFun(FILE* f, IrFun* fun);
+int     irExp   (Ir* ir, AstExp* astexp);
+WALK    irFun   (Walk* walk, Ast* ast);
+WALK    irFunEnd(Walk* walk, Ast* ast);
+void*   irGrow  (void* arr, int* max, int size);
+void    irLayout(IrFun* fun);
+int     irNewBlk(IrFun* fun);
+int     irNewVreg(IrFun* fun, TYP typ);
+int     irNns   (Ir* ir, Ast* nns);
+WALK    irOpen  (Walk* walk, Ast* ast);
+Ir*     irProg  (Lay* lay, AstProg* prog);
+void    irStart (Ir* ir, int blk);
+WALK    irStm   (Walk* walk, Ast* ast);
+int     irTerm  (IROP op);
+void    irVerify(Ir* ir);
+void    irVerifyFun(IrFun* fun);
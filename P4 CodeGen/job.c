@@ -0,0 +1,122 @@
+// job.c - Parse the functions of a program in parallel
+//
+// An alternative to pseProg, selected by the -j option, that builds the same
+// AST.  See job.h
+
+#include "job.h"
+
+// ============================================================================
+// A thread of the pool.  Parse functions, taking the next one in turn, until
+// none are left
+// ============================================================================
+void* jobFun(void* arg) {
+  Job* job = (Job*) arg;
+  for (;;) {
+    int f = atomic_fetch_add(&job->nextFun, 1);
+    if (f >= job->numFun) return NULL;
+    int hi = f + 1 < job->numFun ? job->start[f + 1] - 1 : job->toks->hiTokNum;
+    job->funs[f] = jobParse(job->toks, job->start[f], hi);
+  }
+}
+
+// ============================================================================
+// Parse the one Fun held in Toks 'lo' thru 'hi' of 'toks', via a Toks "view"
+// of just those Toks, with its own cursor.  So 'toks' itself is unchanged,
+// and other threads may parse other Funs of it at the same time.
+// ============================================================================
+AstFun* jobParse(Toks* toks, int lo, int hi) {
+  Toks view = *toks;                          // shares toks->tok
+  view.tokNum = lo;
+  view.hiTokNum = hi;
+  AstFun* fun = pseFun(&view);
+
+  // Any Toks left over would, for pseProg, start the next Fun.  So check
+  // them in the same way, in order to report the same error
+
+  if (!toksAtEnd(&view)) pseMust(&view, TOKSET(TOKINT));
+  return fun;
+}
+
+// ============================================================================
+// Prog => Fun+
+// Parse the whole of 'toks' (which must be an array, not a stream) on a pool
+// of 'numThread' threads.  Link the Funs in source order, as pseProg does.
+// If the braces do not match up, fall back to pseProg, which will find the
+// error, and report it.
+// ============================================================================
+AstProg* jobProg(Toks* toks, int numThread) {
+  int numFun = 0;
+  int* start = jobScan(toks, &numFun);
+  if (start == NULL) return pseProg(toks);
+
+  Job job;
+  job.toks = toks;
+  job.start = start;
+  job.funs = malloc(numFun * sizeof(AstFun*));
+  if (job.funs == NULL) utDie2Str("jobProg", "malloc failed");
+  job.numFun = numFun;
+  atomic_init(&job.nextFun, 0);
+
+  if (numThread > numFun) numThread = numFun;
+  pthread_t* thread = malloc(numThread * sizeof(pthread_t));
+  if (thread == NULL) utDie2Str("jobProg", "malloc failed");
+
+  // The calling thread is the first of the pool
+
+  for (int t = 1; t < numThread; ++t) {
+    if (pthread_create(&thread[t], NULL, jobFun, &job) != 0) {
+      utDie2Str("jobProg", "Cannot start parser thread");
+    }
+  }
+  jobFun(&job);
+  for (int t = 1; t < numThread; ++t) pthread_join(thread[t], NULL);
+
+  for (int f = 0; f + 1 < numFun; ++f) job.funs[f]->next = (Ast*) job.funs[f + 1];
+  AstProg* prog = astNewProg(job.funs[0]);
+
+  toks->tokNum = toks->hiTokNum + 1;          // as if pseProg had run
+  free(thread);
+  free(job.funs);
+  free(start);
+  return prog;
+}
+
+// ============================================================================
+// Find where each function in 'toks' starts: at the first Tok, at brace
+// depth 0, after the "}" that closes the previous function.  Return an array
+// of their Tok numbers, and set '*numFun' to its length.  Return NULL if the
+// braces do not balance, or if there are no functions.
+// ============================================================================
+int* jobScan(Toks* toks, int* numFun) {
+  int maxFun = 1024;
+  int* start = malloc(maxFun * sizeof(int));
+  if (start == NULL) utDie2Str("jobScan", "malloc failed");
+
+  int depth = 0;
+  int inFun = 0;                              // seen a Tok of this Fun?
+  *numFun = 0;
+  for (int t = 0; t <= toks->hiTokNum; ++t) {
+    TokKind kind = toks->tok[t].kind;
+    if (!inFun) {
+      if (*numFun == maxFun) {
+        maxFun *= 2;
+        start = realloc(start, maxFun * sizeof(int));
+        if (start == NULL) utDie2Str("jobScan", "realloc failed");
+      }
+      start[(*numFun)++] = t;
+      inFun = 1;
+    }
+    if (kind == TOKLBRACE) {
+      ++depth;
+    } else if (kind == TOKRBRACE) {
+      if (--depth < 0) break;
+      if (depth == 0) inFun = 0;              // end of this Fun
+    }
+  }
+
+  if (depth != 0 || inFun || *numFun == 0) {  // unbalanced, or truncated
+    free(start);
+    return NULL;
+  }
+  return start;
+}
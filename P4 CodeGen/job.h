@@ -0,0 +1,32 @@
+// job.h - Parse the functions of a program in parallel
+
+#pragma once
+
+#include <pthread.h>        // pthread_t
+#include <stdatomic.h>      // atomic_int
+
+#include "ast.h"            // AstFun, AstProg
+#include "pse.h"            // pseFun
+#include "toks.h"           // Toks
+
+// A SubC program is just a sequence of functions (Prog => Fun+), and no
+// function's parse depends upon any other.  So jobScan first finds where
+// each function starts and ends, by counting braces.  Then a pool of threads
+// parses the functions, each thread taking the next unparsed function in
+// turn, and pseFun-ing it from a Toks "view" that shares the program's Toks
+// array, but has its own cursor, and ends at that function's last Tok.
+// Fun f runs from Tok number start[f], up to the Tok before start[f + 1].
+// (The last Fun runs to the end of the program)
+
+typedef struct {
+  Toks*      toks;          // every Tok of the program
+  int*       start;         // start[f] = Tok number of the first Tok of Fun f
+  AstFun**   funs;          // funs[f] = AST of Fun f
+  int        numFun;
+  atomic_int nextFun;       // next Fun for a thread to take
+} Job;
+
+void*    jobFun (void* arg);
+AstFun*  jobParse(Toks* toks, int lo, int hi);
+AstProg* jobProg(Toks* toks, int numThread);
+int*     jobScan(Toks* toks, int* numFun);
@@ -1,199 +1,280 @@
-// lay.c - Layout of a function's Stack Frame - Jim Hogg, 2022
-
-#include "lay.h"
-
-// ============================================================================
-// Add a row to the Layout call 'lay'
-//
-// nam  : name of the par/var
-// typ  : type of the par/var (TYPINT|TYPSTR|TYPFUN)
-// role : ROLEPAR|ROLEVAR|ROLEFUN|ROLEEND
-// off  : byte offset from FP, in the runtime stack frame, for this par/var
-// ============================================================================
-void layAdd(Lay* lay, char* nam, TYP typ, ROLE role, int off) {
-  lay->hiIdx++;
-  assert(lay->hiIdx < LAYMAX);
-  lay->row[lay->hiIdx].nam  = nam;
-  lay->row[lay->hiIdx].typ  = typ;
-  lay->row[lay->hiIdx].role = role;
-  lay->row[lay->hiIdx].off  = off;
-}
-
-// ============================================================================
-// Build a Layout for the function defined by 'astfun'
-// ============================================================================
-void layBuild(Lay* lay, AstFun* astfun) {
-  layFun(lay, astfun);                          // ROLEFUN row
-  if (astfun->pars) {
-    layBuildPars(lay, astfun->pars);            // parameter rows
-  }
-  if (astfun->body && astfun->body->vars) {
-    layBuildVars(lay, astfun->body->vars);      // variable rows
-  }
-  layEnd(lay, astfun);                          // ROLEND row
-  layDump(lay);                                 // debug
-}
-
-// ============================================================================
-// Build the Layout for the intrinsic functions says, sayn and sayl
-// ============================================================================
-void layBuildIntrinsics(Lay* lay) {
-  AstNam* funnam = NULL;                        // says, sayn, sayl
-  AstNam* parnam = NULL;                        // parameter name
-  AstPar* par    = NULL;                        // parameter
-  AstFun* fun    = NULL;                        // function
-
-  funnam = astNewNam("says");
-  parnam = astNewNam("x");
-  par    = astNewPar(parnam);
-  fun    = astNewFun(funnam, par, NULL);
-  layBuild(lay, fun);
-
-  funnam = astNewNam("sayn");
-  parnam = astNewNam("x");
-  par    = astNewPar(parnam);
-  fun    = astNewFun(funnam, par, NULL);
-  layBuild(lay, fun);
-
-  funnam = astNewNam("sayl");
-  fun = astNewFun(funnam, NULL, NULL);
-  layBuild(lay, fun);
-}
-
-// ============================================================================
-// Add rows into 'lay' for the list of pars defined by 'astpar'
-// ============================================================================
-void layBuildPars(Lay* lay, AstPar* astpar) {
-  int off = 8;  // Offset for parameters
-
-  while (astpar) {
-    layAdd(lay, astpar->nam->lex, TYPINT, ROLEPAR, off);
-    off += 4;  // Assuming each parameter occupies 4 bytes
-    astpar = (AstPar*)astpar->next;
-  }
-}
-
-// ============================================================================
-// Add rows into 'lay' for the list of (local) variables defined by 'astvar'
-// ============================================================================
-void layBuildVars(Lay* lay, AstVar* astvar) {
-
-  if (astvar == NULL) return;       // function has no local variables
-
-  int off = -4;                     // offset from FP of first variable
-
-  while (astvar) {
-    layAdd(lay, astvar->nam->lex, TYPINT, ROLEVAR, off);
-    off -= 4;
-    astvar = (AstVar*) astvar->next;
-  }
-}
-
-// ============================================================================
-// Count the number of local variables.  'rownum' gives the index, within
-// the row[] array, of the ROLEFUN row for the function of interest.
-// ============================================================================
-int layCountVars(Lay* lay, int rownum) {
-  int numvars = 0;                            // # of local variables so far
-  ++rownum;                                   // row holding first local variable
-  while (lay->row[rownum].typ  != 0 &&        // end of row[] array
-         lay->row[rownum].role != ROLEEND) {  // end of this function's rows
-    if (lay->row[rownum].role  == ROLEVAR) {
-      ++numvars;
-    }
-    ++rownum;
-  }
-  return numvars;
-}
-
-// ============================================================================
-// Dump the contents of 'lay' to the console, for debugging
-// ============================================================================
-void layDump(Lay* lay) {
-  printf("Layout Table for test11.subc\n");
-  for (int i = 0; i <= lay->hiIdx; ++i) {
-    printf("[%d] %s %s %s %d\n", i, lay->row[i].nam, astTYPtoStr(lay->row[i].typ), layROLEtoStr(lay->row[i].role), lay->row[i].off);
-
-  }
-}
-
-// ============================================================================
-// End the current new function layout
-// ============================================================================
-void layEnd(Lay* lay, AstFun* astfun) {
-  layAdd(lay, astfun->nam->lex, TYPEND, ROLEEND, 0);
-}
-
-// ============================================================================
-// Search the rows of 'lay' for the function called 'funnam'.  Return the
-// index of the TYPFUN row that matches 'funnam'.  We use a simple, slow,
-// linear search.  Abort if not found.
-// ============================================================================
-int layFindFunIdx(Lay* lay, char* funnam) {
-  int rownum = 0;
-  while (lay->row[rownum].typ != 0) {                   // end of row[] array
-    if (lay->row[rownum].role == ROLEFUN) {             // start of function
-      if (strcmp(funnam, lay->row[rownum].nam) == 0) {
-        return rownum;
-      }
-    }
-    ++rownum;
-  }
-  utDie3Str("layFindFunIdx", "Cannot find function ", funnam);
-  return 0;                                             // pacify compiler
-}
-
-// ============================================================================
-// Search the rows of 'lay' for the variable or parameter ("varpar") called
-// 'nam', in the function called 'funnam'.  Return the index, within the
-// row[] array, of that entry.  Note that variables and parameters must be
-// unique in a valid SubC program (although the SubC compiler does not enforce
-// this condition).  We use a simple, slow, linear search.  Abort if not found
-// ============================================================================
-int layFindVarParIdx(Lay* lay, char* funnam, char* nam) {
-  int rownum = layFindFunIdx(lay, funnam);            // index of TYPFUN row
-
-  rownum++;                                           // first parvar
-
-  while (lay->row[rownum].typ != 0) {                 // end of row[]
-    while (lay->row[rownum].typ != TYPEND) {          // end of function
-      char* thisnam = lay->row[rownum].nam;
-      if (strcmp(nam, thisnam) == 0) {                // match!
-        return rownum;
-      }
-      ++rownum;
-    }
-  }
-  utDie5Str("layFindVarParIdx", "Cannot find varpar", nam, "in function", funnam);
-  return 0;                                           // pacify compiler
-}
-
-// ============================================================================
-// Start a new function layout
-// ============================================================================
-void layFun(Lay* lay, AstFun* astfun) {
-  layAdd(lay, astfun->nam->lex, TYPFUN, ROLEFUN, 0);
-}
-
-// ============================================================================
-// Build a new, empty Layout ('nrep' repeats of a Lay struct)
-// ============================================================================
-Lay* layNew(int nrep) {
-  Lay* lay = calloc(nrep * sizeof(Lay), 1);
-  lay->hiIdx = -1;                      // no rows
-  return lay;
-}
-
-// ============================================================================
-// Convert a member of the ROLE enum into its display string
-// ============================================================================
-char* layROLEtoStr(ROLE role) {
-  switch(role) {
-    case ROLENA:  return "ROLENA";
-    case ROLEEND: return "ROLEEND";
-    case ROLEFUN: return "ROLEFUN";
-    case ROLEPAR: return "ROLEPAR";
-    case ROLEVAR: return "ROLEVAR";
-    default:      return "ROLENA";
-  }
-}
+// lay.c - Layout of a function's Stack Frame - Jim Hogg, 2022
+
+#include "lay.h"
+
+// ============================================================================
+// Add a row to the Layout call 'lay'
+//
+// nam  : name of the par/var
+// typ  : type of the par/var (TYPINT|TYPSTR|TYPFUN)
+// role : ROLEPAR|ROLEVAR|ROLEFUN|ROLEEND
+// off  : byte offset from FP, in the runtime stack frame, for this par/var
+// ============================================================================
+void layAdd(Lay* lay, char* nam, TYP typ, ROLE role, int off) {
+  if (++lay->hiIdx == lay->maxRow) {
+    lay->maxRow *= 2;
+    lay->row = realloc(lay->row, lay->maxRow * sizeof(LayRow));
+    if (lay->row == NULL) utDie2Str("layAdd", "realloc failed");
+  }
+  lay->row[lay->hiIdx].nam  = nam;
+  lay->row[lay->hiIdx].typ  = typ;
+  lay->row[lay->hiIdx].role = role;
+  lay->row[lay->hiIdx].off  = off;
+  lay->row[lay->hiIdx].loc  = 0;
+
+  if (role == ROLEFUN) {                        // start a new table of locals
+    if (lay->numLoc == lay->maxLoc) {
+      lay->maxLoc = lay->maxLoc ? 2 * lay->maxLoc : 16;
+      lay->locs = realloc(lay->locs, lay->maxLoc * sizeof(LayMap));
+      if (lay->locs == NULL) utDie2Str("layAdd", "realloc failed");
+    }
+    layMapNew(&lay->locs[lay->numLoc], 8);
+    lay->row[lay->hiIdx].loc = lay->numLoc++;
+    layMapAdd(lay, &lay->funs, lay->hiIdx);
+  } else if (role == ROLEPAR || role == ROLEVAR) {
+    layMapAdd(lay, &lay->locs[lay->numLoc - 1], lay->hiIdx);
+  }
+}
+
+// ============================================================================
+// Build a Layout for the function defined by 'astfun'
+// ============================================================================
+void layBuild(Lay* lay, AstFun* astfun) {
+  layFun(lay, astfun);                          // ROLEFUN row
+  if (astfun->pars) {
+    layBuildPars(lay, astfun->pars);            // parameter rows
+  }
+  if (astfun->body && astfun->body->vars) {
+    layBuildVars(lay, astfun->body->vars);      // variable rows
+  }
+  layEnd(lay, astfun);                          // ROLEND row
+}
+
+// ============================================================================
+// Build the Layout for the intrinsic functions says, sayn and sayl
+// ============================================================================
+void layBuildIntrinsics(Lay* lay) {
+  AstNam* funnam = NULL;                        // says, sayn, sayl
+  AstNam* parnam = NULL;                        // parameter name
+  AstPar* par    = NULL;                        // parameter
+  AstFun* fun    = NULL;                        // function
+
+  funnam = astNewNam("says");
+  parnam = astNewNam("x");
+  par    = astNewPar(parnam);
+  fun    = astNewFun(funnam, par, NULL);
+  layBuild(lay, fun);
+
+  funnam = astNewNam("sayn");
+  parnam = astNewNam("x");
+  par    = astNewPar(parnam);
+  fun    = astNewFun(funnam, par, NULL);
+  layBuild(lay, fun);
+
+  funnam = astNewNam("sayl");
+  fun = astNewFun(funnam, NULL, NULL);
+  layBuild(lay, fun);
+}
+
+// ============================================================================
+// Add rows into 'lay' for the list of pars defined by 'astpar'
+// ============================================================================
+void layBuildPars(Lay* lay, AstPar* astpar) {
+  int off = 8;  // Offset for parameters
+
+  while (astpar) {
+    layAdd(lay, astpar->nam->lex, TYPINT, ROLEPAR, off);
+    off += 4;  // Assuming each parameter occupies 4 bytes
+    astpar = (AstPar*)astpar->next;
+  }
+}
+
+// ============================================================================
+// Add rows into 'lay' for the list of (local) variables defined by 'astvar'
+// ============================================================================
+void layBuildVars(Lay* lay, AstVar* astvar) {
+
+  if (astvar == NULL) return;       // function has no local variables
+
+  int off = -4;                     // offset from FP of first variable
+
+  while (astvar) {
+    layAdd(lay, astvar->nam->lex, TYPINT, ROLEVAR, off);
+    off -= 4;
+    astvar = (AstVar*) astvar->next;
+  }
+}
+
+// ============================================================================
+// Count the number of local variables.  'rownum' gives the index, within
+// the row[] array, of the ROLEFUN row for the function of interest.
+// ============================================================================
+int layCountVars(Lay* lay, int rownum) {
+  int numvars = 0;                            // # of local variables so far
+  ++rownum;                                   // row holding first local variable
+  while (rownum <= lay->hiIdx &&              // end of row[] array
+         lay->row[rownum].role != ROLEEND) {  // end of this function's rows
+    if (lay->row[rownum].role  == ROLEVAR) {
+      ++numvars;
+    }
+    ++rownum;
+  }
+  return numvars;
+}
+
+// ============================================================================
+// Dump the contents of 'lay' to the console, for debugging
+// ============================================================================
+void layDump(Lay* lay) {
+  printf("Layout Table\n");
+  for (int i = 0; i <= lay->hiIdx; ++i) {
+    printf("[%d] %s %s %s %d\n", i, lay->row[i].nam, astTYPtoStr(lay->row[i].typ), layROLEtoStr(lay->row[i].role), lay->row[i].off);
+
+  }
+}
+
+// ============================================================================
+// End the current new function layout
+// ============================================================================
+void layEnd(Lay* lay, AstFun* astfun) {
+  layAdd(lay, astfun->nam->lex, TYPEND, ROLEEND, 0);
+}
+
+// ============================================================================
+// Return the number of bytes that the function whose TYPFUN row is 'funidx'
+// needs, below FP, for its local variables: enough to reach the lowest of
+// their offsets, rounded up to a multiple of 8, so that SP stays 8-byte
+// aligned, as the AAPCS requires.  0 if it has none.
+// ============================================================================
+int layFrameSize(Lay* lay, int funidx) {
+  int low = 0;                                  // lowest offset so far
+  for (int rownum = funidx + 1;
+       rownum <= lay->hiIdx && lay->row[rownum].role != ROLEEND; ++rownum) {
+    if (lay->row[rownum].role == ROLEVAR && lay->row[rownum].off < low) {
+      low = lay->row[rownum].off;
+    }
+  }
+  return (-low + 7) & ~7;
+}
+
+// ============================================================================
+// Search the rows of 'lay' for the function called 'funnam'.  Return the
+// index of the TYPFUN row that matches 'funnam'.  Abort if not found.
+// ============================================================================
+int layFindFunIdx(Lay* lay, char* funnam) {
+  int rownum = layFunIdx(lay, funnam);
+  if (rownum < 0) utDie3Str("layFindFunIdx", "Cannot find function ", funnam);
+  return rownum;
+}
+
+// ============================================================================
+// Search the rows of 'lay' for the variable or parameter ("varpar") called
+// 'nam', in the function called 'funnam'.  Return the index, within the
+// row[] array, of that entry.  Note that variables and parameters must be
+// unique in a valid SubC program (although the SubC compiler does not enforce
+// this condition).  Abort if not found
+// ============================================================================
+int layFindVarParIdx(Lay* lay, char* funnam, char* nam) {
+  int rownum = layVarParIdx(lay, layFindFunIdx(lay, funnam), nam);
+  if (rownum < 0) {
+    utDie5Str("layFindVarParIdx", "Cannot find varpar", nam, "in function", funnam);
+  }
+  return rownum;
+}
+
+// ============================================================================
+// Start a new function layout
+// ============================================================================
+void layFun(Lay* lay, AstFun* astfun) {
+  layAdd(lay, astfun->nam->lex, TYPFUN, ROLEFUN, 0);
+}
+
+// ============================================================================
+// Look up the function called 'funnam'.  Return the index of its TYPFUN row,
+// or -1 if there is none.
+// ============================================================================
+int layFunIdx(Lay* lay, char* funnam) {
+  return layMapFind(lay, &lay->funs, funnam);
+}
+
+// ============================================================================
+// Add row 'rownum' of 'lay' to 'map', under its name, unless that name is
+// there already.  Double the table when it becomes half full.
+// ============================================================================
+void layMapAdd(Lay* lay, LayMap* map, int rownum) {
+  char* nam = lay->row[rownum].nam;
+  if (layMapFind(lay, map, nam) >= 0) return;     // first row wins
+
+  if (2 * (map->num + 1) > map->mask + 1) {
+    LayMap old = *map;
+    layMapNew(map, 2 * (old.mask + 1));
+    for (int i = 0; i <= old.mask; ++i) {
+      if (old.slot[i]) layMapAdd(lay, map, old.slot[i] - 1);
+    }
+    free(old.slot);
+  }
+
+  int i = (int) utHash(nam, strlen(nam)) & map->mask;
+  while (map->slot[i]) i = (i + 1) & map->mask;
+  map->slot[i] = rownum + 1;
+  ++map->num;
+}
+
+// ============================================================================
+// Look up 'nam' in 'map'.  Return the index of its row in 'lay', or -1 if it
+// is not there.
+// ============================================================================
+int layMapFind(Lay* lay, LayMap* map, char* nam) {
+  int i = (int) utHash(nam, strlen(nam)) & map->mask;
+  for (; map->slot[i]; i = (i + 1) & map->mask) {
+    int rownum = map->slot[i] - 1;
+    if (strcmp(nam, lay->row[rownum].nam) == 0) return rownum;
+  }
+  return -1;
+}
+
+// ============================================================================
+// Make 'map' an empty table of 'numSlot' slots - a power of 2
+// ============================================================================
+void layMapNew(LayMap* map, int numSlot) {
+  map->slot = calloc(numSlot, sizeof(int));
+  if (map->slot == NULL) utDie2Str("layMapNew", "calloc failed");
+  map->mask = numSlot - 1;
+  map->num = 0;
+}
+
+// ============================================================================
+// Build a new, empty Layout, with room for a few functions' rows, to start
+// ============================================================================
+Lay* layNew() {
+  Lay* lay = calloc(1, sizeof(Lay));
+  if (lay == NULL) utDie2Str("layNew", "calloc failed");
+  lay->maxRow = 64;
+  lay->row = malloc(lay->maxRow * sizeof(LayRow));
+  if (lay->row == NULL) utDie2Str("layNew", "malloc failed");
+  lay->hiIdx = -1;                      // no rows
+  layMapNew(&lay->funs, 64);
+  return lay;
+}
+
+// ============================================================================
+// Convert a member of the ROLE enum into its display string
+// ============================================================================
+char* layROLEtoStr(ROLE role) {
+  switch(role) {
+    case ROLENA:  return "ROLENA";
+    case ROLEEND: return "ROLEEND";
+    case ROLEFUN: return "ROLEFUN";
+    case ROLEPAR: return "ROLEPAR";
+    case ROLEVAR: return "ROLEVAR";
+    default:      return "ROLENA";
+  }
+}
+
+// ============================================================================
+// Look up the variable or parameter called 'nam' in the function whose TYPFUN
+// row is 'funidx'.  Return the index of its row, or -1 if there is none.
+// ============================================================================
+int layVarParIdx(Lay* lay, int funidx, char* nam) {
+  return layMapFind(lay, &lay->locs[lay->row[funidx].loc], nam);
+}
@@ -1,46 +1,73 @@
-// lay.h - Layout of function's Stack Frame - Jim Hogg, 2020
-
-#pragma once
-
-#include <assert.h>         // assert
-
-#include "ast.h"            // TYP
-#include "string.h"         // strcmp
-
-// The ROLE enum comprises constants for the role, played by different
-// identifiers in the Lay table (made up of individual rows)
-
-typedef enum {
-  ROLENA  = 0,  // where row.role does not apply
-  ROLEEND,      // last row for a function
-  ROLEFUN,      // first row for a function
-  ROLEPAR,      // identifier is a parameter (not a variable or function)
-  ROLEVAR,      // identifier is a variable  (not a parameter or function)
-} ROLE;
-char* layROLEtoStr(ROLE role);
-
-#define LAYMAX 500
-
-typedef struct {
-  int hiIdx;                // index in row[] of last entry so far
-  struct {
-    char* nam;              // name of parvar
-    TYP   typ;              // type of parvar - eg: TYPINT
-    ROLE  role;             // ROLEPAR | ROLEVAR | ROLEFUN | ROLEEND
-    int   off;              // offset from FP of parvar
-  } row[LAYMAX];
-} Lay;
-
-void layAdd(Lay* lay, char* nam, TYP typ, ROLE role, int off);
-void layBuild(Lay* lay, AstFun* astfun);
-void layBuildIntrinsics(Lay* lay);
-void layBuildPars(Lay* lay, AstPar* astpar);
-void layBuildVars(Lay* lay, AstVar* astvar);
-int  layCountVars(Lay* lay, int rownum);
-void layDump(Lay* lay);
-void layEnd(Lay* lay, AstFun* astfun);
-int  layFindFunIdx(Lay* lay, char* funnam);
-int  layFindVarParIdx(Lay* lay, char* funnam, char* nam);
-void layFun(Lay* lay, AstFun* astfun);
-Lay* layNew(int nrep);
-void layRem(Lay* lay);
+// lay.h - Layout of function's Stack Frame - Jim Hogg, 2020
+
+#pragma once
+
+#include <assert.h>         // assert
+
+#include "ast.h"            // TYP
+#include "string.h"         // strcmp
+#include "ut.h"             // utHash
+
+// The ROLE enum comprises constants for the role, played by different
+// identifiers in the Lay table (made up of individual rows)
+
+typedef enum {
+  ROLENA  = 0,  // where row.role does not apply
+  ROLEEND,      // last row for a function
+  ROLEFUN,      // first row for a function
+  ROLEPAR,      // identifier is a parameter (not a variable or function)
+  ROLEVAR,      // identifier is a variable  (not a parameter or function)
+} ROLE;
+char* layROLEtoStr(ROLE role);
+
+// The rows of a Lay are indexed by two kinds of hash table (LayMap), so that
+// no lookup need scan them: one, 'funs', holds the ROLEFUN row of every
+// function; and each function has its own, in 'locs', holding the rows of
+// its Pars and Vars.  layAdd fills them in, as it adds each row.  A name
+// that occurs twice maps to its first row, as a search of the rows would.
+
+typedef struct {            // hash table, by linear probing: name => row
+  int*  slot;               // row index + 1: 0 = empty
+  int   mask;               // ... which has mask + 1 slots
+  int   num;                // names in the table
+} LayMap;
+
+typedef struct {
+  char* nam;                // name of parvar
+  TYP   typ;                // type of parvar - eg: TYPINT
+  ROLE  role;               // ROLEPAR | ROLEVAR | ROLEFUN | ROLEEND
+  int   off;                // offset from FP of parvar
+  int   loc;                // for a ROLEFUN row: its table in 'locs'
+} LayRow;
+
+// The rows are a growable array: layAdd doubles it when full, so a Lay costs
+// memory in proportion to the program, with no limit on its size.
+
+typedef struct {
+  int     hiIdx;            // index in row[] of last entry so far
+  LayRow* row;
+  int     maxRow;           // rows allocated
+  LayMap  funs;             // ROLEFUN rows
+  LayMap* locs;             // ROLEPAR and ROLEVAR rows, one table per function
+  int     numLoc, maxLoc;
+} Lay;
+
+void layAdd(Lay* lay, char* nam, TYP typ, ROLE role, int off);
+void layBuild(Lay* lay, AstFun* astfun);
+void layBuildIntrinsics(Lay* lay);
+void layBuildPars(Lay* lay, AstPar* astpar);
+void layBuildVars(Lay* lay, AstVar* astvar);
+int  layCountVars(Lay* lay, int rownum);
+void layDump(Lay* lay);
+void layEnd(Lay* lay, AstFun* astfun);
+int  layFindFunIdx(Lay* lay, char* funnam);
+int  layFindVarParIdx(Lay* lay, char* funnam, char* nam);
+int  layFrameSize(Lay* lay, int funidx);
+void layFun(Lay* lay, AstFun* astfun);
+int  layFunIdx(Lay* lay, char* funnam);
+void layMapAdd(Lay* lay, LayMap* map, int rownum);
+int  layMapFind(Lay* lay, LayMap* map, char* nam);
+void layMapNew(LayMap* map, int numSlot);
+Lay* layNew();
+void layRem(Lay* lay);
+int  layVarParIdx(Lay* lay, int funidx, char* nam);
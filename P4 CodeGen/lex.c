@@ -2,50 +2,55 @@
 
 #include "lex.h"
 
-// ============================================================================
+// ============================================================================
 // Extract all tokens in lex->text, starting at position lex->pos
 // (invariably 0).  As each token is constructed, insert it into the 'toks'
 // array
 // ============================================================================
 Toks* lexAll(Lex* lex) {
   Toks* toks = toksNew();
+  Tok* tok = lexNext(lex);
+  while (tok) {                   // scan every char
+    toksAdd(toks, tok);           // copies 'tok' ...
+    free(tok);                    // ... so we are done with it
+    tok = lexNext(lex);
+  }
+  return toks;
+}
 
-  char c = lexSkip(lex);          // skip whitespace or comment
-  Tok* tok;
-
-  while (c) {                     // scan every char
-    if (isdigit(c)) {             // [0-9]
-      tok = lexNum(lex);
-    } else if (isalpha(c)) {      // [a-zA-Z]
-      tok = lexNam(lex);
-      lexKeyword(&tok);           // check if keyword (if, then, while, etc)
-    } else if (c == '"') {
-      tok = lexStr(lex);
-    } else {
-      tok = lexPun(lex);          // ( ) = < <= == >= > + - * / "
-    }
-
+// ============================================================================
+// Fill function for a stream of Toks (see lexStream).  Lex Toks from the Lex
+// in toks->src until half the ring lies ahead of the parser's cursor, or the
+// text runs out, in which case there is nothing more to fill
+// ============================================================================
+void lexFill(Toks* toks) {
+  Lex* lex = (Lex*) toks->src;
+  int hiWant = toks->tokNum + (toks->mask + 1) / 2;
+  while (toks->hiTokNum < hiWant) {
+    Tok* tok = lexNext(lex);
+    if (tok == NULL) {                        // end of text
+      toks->fill = NULL;
+      return;
+    }
     toksAdd(toks, tok);
-
-    c = lexSkip(lex);
+    free(tok);
   }
-  return toks;
 }
-
-// ============================================================================
-// Check whether the current Tok (of kind TOKNAM) is any of the keywords in
-// the SubC language.  If yes, adjust the Token kind accordingly
-// ============================================================================
-void lexKeyword(Tok** tok) {
-  Tok* p = *tok;                  // alias
-  char* s = p->lex;
-  if (strcmp(s, "if")       == 0) { p->kind = TOKIF;       return; }
-  if (strcmp(s, "int")      == 0) { p->kind = TOKINT;      return; }
-  if (strcmp(s, "return")   == 0) { p->kind = TOKRET;      return; }
-  if (strcmp(s, "while")    == 0) { p->kind = TOKWHILE;    return; }
-}
-
-// ============================================================================
+
+// ============================================================================
+// Check whether the current Tok (of kind TOKNAM) is any of the keywords in
+// the SubC language.  If yes, adjust the Token kind accordingly
+// ============================================================================
+void lexKeyword(Tok** tok) {
+  Tok* p = *tok;                  // alias
+  char* s = p->lex;
+  if (strcmp(s, "if")       == 0) { p->kind = TOKIF;       return; }
+  if (strcmp(s, "int")      == 0) { p->kind = TOKINT;      return; }
+  if (strcmp(s, "return")   == 0) { p->kind = TOKRET;      return; }
+  if (strcmp(s, "while")    == 0) { p->kind = TOKWHILE;    return; }
+}
+
+// ============================================================================
 // Move the cursor (lex->pos) forward by 1.  Return the char it then points at.
 // ============================================================================
 char lexMove1(Lex* lex) {
@@ -53,24 +58,24 @@ char lexMove1(Lex* lex) {
   ++lex->pos;
   return lex->text[lex->pos];
 }
-
-// ============================================================================
-// Extract the name (a string of alphanumeric chars), starting at
-// lex->text[lex->pos].  Eg: lex->text = " TotalSum = ", lex->pos = 1, will
-// return "TotalSum", and leave lex->pos = 9.  On entry, lex->pos is pointing
-// at the first (alphabetic char of the identifier's lexeme (eg: 'T').  On
-// exit, lex->pos is pointing at the char that is NOT part of the name
-// ============================================================================
-Tok* lexNam(Lex* lex) {
-  int start = lex->pos;                               // eg: 1
-  char c = lexMove1(lex);
-  while (isalnum(c)) c = lexMove1(lex);
-  int len = lex->pos - start;                         // eg: 8
-  char* nam = utStrndup(&lex->text[start], len);
-  return tokNew(TOKNAM, nam, 0, NULL, lex->linNum, lex->colNum);
+
+// ============================================================================
+// Extract the name (a string of alphanumeric chars), starting at
+// lex->text[lex->pos].  Eg: lex->text = " TotalSum = ", lex->pos = 1, will
+// return "TotalSum", and leave lex->pos = 9.  On entry, lex->pos is pointing
+// at the first (alphabetic char of the identifier's lexeme (eg: 'T').  On
+// exit, lex->pos is pointing at the char that is NOT part of the name
+// ============================================================================
+Tok* lexNam(Lex* lex) {
+  int start = lex->pos;                               // eg: 1
+  char c = lexMove1(lex);
+  while (isalnum(c)) c = lexMove1(lex);
+  int len = lex->pos - start;                         // eg: 8
+  char* nam = utStrndup(&lex->text[start], len);
+  return tokNew(TOKNAM, nam, 0, NULL, lex->linNum, lex->colNum);
 }
-
-// ============================================================================
+
+// ============================================================================
 // Create a new Lex object
 // ============================================================================
 Lex* lexNew(char* text) {
@@ -80,36 +85,58 @@ Lex* lexNew(char* text) {
   lex->linNum = lex->colNum = 1;
   return lex;
 }
-
-// ============================================================================
-// Extract the number (a string of digits), starting at lex->text[lex->pos].
-// Eg: lex->text = "x = 1234; ", lex->pos = 4, will return 1234, and leave
-// lex->pos = 8.  (Note: on entry, lex->pos points to the first digit in
-// the number)
-// ============================================================================
-Tok* lexNum(Lex* lex) {
-  int start = lex->pos;
-  int sum = lexPeek0(lex) - '0';                      // eg: 1
-  char c = lexMove1(lex);
-  while (isdigit(c)) {
-    sum = 10 * sum + (c - '0');                       // eg: 10 * 1 + 2
-    c = lexMove1(lex);
-  }
-
-  int len = lex->pos - start;
-  char* lexeme = utStrndup(&lex->text[start], len);
-  Tok* tok = tokNew(TOKNUM, lexeme, sum, NULL, lex->linNum, lex->colNum);
-  return tok;
+
+// ============================================================================
+// Extract the next token in lex->text, starting at position lex->pos.
+// Return NULL at the end of the text
+// ============================================================================
+Tok* lexNext(Lex* lex) {
+  char c = lexSkip(lex);          // skip whitespace or comment
+  if (c == '\0') return NULL;     // end of text
+
+  Tok* tok;
+  if (isdigit(c)) {               // [0-9]
+    tok = lexNum(lex);
+  } else if (isalpha(c)) {        // [a-zA-Z]
+    tok = lexNam(lex);
+    lexKeyword(&tok);             // check if keyword (if, then, while, etc)
+  } else if (c == '"') {
+    tok = lexStr(lex);
+  } else {
+    tok = lexPun(lex);            // ( ) = < <= == >= > + - * / "
+  }
+  return tok;
+}
+
+// ============================================================================
+// Extract the number (a string of digits), starting at lex->text[lex->pos].
+// Eg: lex->text = "x = 1234; ", lex->pos = 4, will return 1234, and leave
+// lex->pos = 8.  (Note: on entry, lex->pos points to the first digit in
+// the number)
+// ============================================================================
+Tok* lexNum(Lex* lex) {
+  int start = lex->pos;
+  int sum = lexPeek0(lex) - '0';                      // eg: 1
+  char c = lexMove1(lex);
+  while (isdigit(c)) {
+    sum = 10 * sum + (c - '0');                       // eg: 10 * 1 + 2
+    c = lexMove1(lex);
+  }
+
+  int len = lex->pos - start;
+  char* lexeme = utStrndup(&lex->text[start], len);
+  Tok* tok = tokNew(TOKNUM, lexeme, sum, NULL, lex->linNum, lex->colNum);
+  return tok;
 }
 
-// ============================================================================
+// ============================================================================
 // Return the current char in lex->text, located at position lex->pos.
 // This is a "peek" function that does not change the cursor (ie, lex->pos).
 // We name it as lexPeek0, because we are looking at varparoff 0 from lex->pos
 // ============================================================================
 char lexPeek0(Lex* lex) { return lex->text[lex->pos]; }
 
-// ============================================================================
+// ============================================================================
 // Return the next char in lex->text: the one located at position
 // lex->pos + 1.  This is a "peek" function that does not change the cursor
 // (ie, lex->pos).  We name it as lexPeek1, because we are looking at varparoff
@@ -117,96 +144,106 @@ char lexPeek0(Lex* lex) { return lex->text[lex->pos]; }
 // ============================================================================
 char lexPeek1(Lex* lex) { return lex->text[lex->pos + 1]; }
 
-// ============================================================================
-// Scan punctuation
-// ============================================================================
-Tok* lexPun(Lex* lex) {
-  char c0 = lexPeek0(lex);
-  char c1 = lexPeek1(lex);
-
-  // First check for two-letter tokens
-
-  if (c0 == '<' && c1 == '=') { lex->pos += 2; return tokNew(TOKLE,  "<=", 0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '=' && c1 == '=') { lex->pos += 2; return tokNew(TOKEEQ, "==", 0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '!' && c1 == '=') { lex->pos += 2; return tokNew(TOKNE,  "!=", 0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '>' && c1 == '=') { lex->pos += 2; return tokNew(TOKGE,  ">=", 0, NULL, lex->linNum, lex->colNum); }
-
-  // Next, check for single-letter tokens
-
-  if (c0 == '+')  { ++lex->pos;   return tokNew(TOKADD,    "+",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '-')  { ++lex->pos;   return tokNew(TOKSUB,    "-",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '*')  { ++lex->pos;   return tokNew(TOKMUL,    "*",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '=')  { ++lex->pos;   return tokNew(TOKEQ,     "=",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '<')  { ++lex->pos;   return tokNew(TOKLT,     "<",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '>')  { ++lex->pos;   return tokNew(TOKGT,     ">",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '(')  { ++lex->pos;   return tokNew(TOKLPAREN, "(",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == ')')  { ++lex->pos;   return tokNew(TOKRPAREN, ")",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '{')  { ++lex->pos;   return tokNew(TOKLBRACE, "{",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == '}')  { ++lex->pos;   return tokNew(TOKRBRACE, "}",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == ';')  { ++lex->pos;   return tokNew(TOKSEMI,   ";",  0, NULL, lex->linNum, lex->colNum); }
-  if (c0 == ',')  { ++lex->pos;   return tokNew(TOKCOMMA,  ",",  0, NULL, lex->linNum, lex->colNum); }
-
-  utDie2StrCharLC("lexPun", "unrecognized punctuation. c = ", c0, lex->linNum, lex->colNum);
-
-  return NULL;    // pacify the compiler
-
+// ============================================================================
+// Scan punctuation
+// ============================================================================
+Tok* lexPun(Lex* lex) {
+  char c0 = lexPeek0(lex);
+  char c1 = lexPeek1(lex);
+
+  // First check for two-letter tokens
+
+  if (c0 == '<' && c1 == '=') { lex->pos += 2; return tokNew(TOKLE,  "<=", 0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '=' && c1 == '=') { lex->pos += 2; return tokNew(TOKEEQ, "==", 0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '!' && c1 == '=') { lex->pos += 2; return tokNew(TOKNE,  "!=", 0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '>' && c1 == '=') { lex->pos += 2; return tokNew(TOKGE,  ">=", 0, NULL, lex->linNum, lex->colNum); }
+
+  // Next, check for single-letter tokens
+
+  if (c0 == '+')  { ++lex->pos;   return tokNew(TOKADD,    "+",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '-')  { ++lex->pos;   return tokNew(TOKSUB,    "-",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '*')  { ++lex->pos;   return tokNew(TOKMUL,    "*",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '=')  { ++lex->pos;   return tokNew(TOKEQ,     "=",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '<')  { ++lex->pos;   return tokNew(TOKLT,     "<",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '>')  { ++lex->pos;   return tokNew(TOKGT,     ">",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '(')  { ++lex->pos;   return tokNew(TOKLPAREN, "(",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == ')')  { ++lex->pos;   return tokNew(TOKRPAREN, ")",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '{')  { ++lex->pos;   return tokNew(TOKLBRACE, "{",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == '}')  { ++lex->pos;   return tokNew(TOKRBRACE, "}",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == ';')  { ++lex->pos;   return tokNew(TOKSEMI,   ";",  0, NULL, lex->linNum, lex->colNum); }
+  if (c0 == ',')  { ++lex->pos;   return tokNew(TOKCOMMA,  ",",  0, NULL, lex->linNum, lex->colNum); }
+
+  utDie2StrCharLC("lexPun", "unrecognized punctuation. c = ", c0, lex->linNum, lex->colNum);
+
+  return NULL;    // pacify the compiler
+
 }
-
-// ============================================================================
+
+// ============================================================================
 // Skip over whitespace: any ASCII control char from 0x01 (SOH) thru 0x1F (US),
 // as well as 0x20 (space).  This includes all those chars normally described
 // as "whitespace", such as tab and carriage-return.  If the char is a newline,
-// we additionally bump Lex's line number, and reset the column number.
+// we additionally bump Lex's line number, and reset the column number.
 // Also, skip // comments
 // ============================================================================
-char lexSkip(Lex* lex) {
-  char c = lexPeek0(lex);               // current char
-  if (c == '\0') return c;              // end of text
-
-  if (c == '\n') {                      // newline
-    lex->linNum++;  lex->colNum = 1;
-    lexMove1(lex);                      // skip newline
-    return lexSkip(lex);                // recurse!
-  } else if (c >= 0x01 && c <= 0x20) {  // whitespace
-    while (c >= 0x01 && c <= 0x20) {
-      c = lexMove1(lex);                // skip whitespace
-    }
-    return lexSkip(lex);                // recurse!
-  } else {
-    char c1 = lexPeek1(lex);
-    if (c1 == '/') {
-      c = lexSkipComment(lex);          // skip comment
-      return lexSkip(lex);              // recurse!
-    }
-  }
-  return c;
-}
-
-// ============================================================================
-// Blindly skip over the comment that starts at current (first) '/'
-// ============================================================================
-char lexSkipComment(Lex* lex) {
-  char c = lexPeek0(lex);           // re-grab current character, the 1st '/'
-  while (c != '\n') {               // move cursor to next newline
-    if (c == '\0') return c;        // end of text
-    c = lexMove1(lex);
-  }
-  lex->linNum++;
-  lex->colNum = 1;
-  return lexMove1(lex);             // skip '\n'
+char lexSkip(Lex* lex) {
+  char c = lexPeek0(lex);               // current char
+  if (c == '\0') return c;              // end of text
+
+  if (c == '\n') {                      // newline
+    lex->linNum++;  lex->colNum = 1;
+    lexMove1(lex);                      // skip newline
+    return lexSkip(lex);                // recurse!
+  } else if (c >= 0x01 && c <= 0x20) {  // whitespace
+    while (c >= 0x01 && c <= 0x20) {
+      c = lexMove1(lex);                // skip whitespace
+    }
+    return lexSkip(lex);                // recurse!
+  } else {
+    char c1 = lexPeek1(lex);
+    if (c1 == '/') {
+      c = lexSkipComment(lex);          // skip comment
+      return lexSkip(lex);              // recurse!
+    }
+  }
+  return c;
+}
+
+// ============================================================================
+// Blindly skip over the comment that starts at current (first) '/'
+// ============================================================================
+char lexSkipComment(Lex* lex) {
+  char c = lexPeek0(lex);           // re-grab current character, the 1st '/'
+  while (c != '\n') {               // move cursor to next newline
+    if (c == '\0') return c;        // end of text
+    c = lexMove1(lex);
+  }
+  lex->linNum++;
+  lex->colNum = 1;
+  return lexMove1(lex);             // skip '\n'
+}
+
+// ============================================================================
+// Scan a string.  On entry, lex->pos points at the opening ' char.
+// Eg: 'hello' will create a Token of kind TOKSTR, stripping out
+// the leading and trailing tick (')
+// ============================================================================
+Tok* lexStr(Lex* lex) {
+  char c = lexMove1(lex);                             // eg: h
+  int start = lex->pos;                               // eg: 60 => h
+  while (c != '"') c = lexMove1(lex);                 // scan to trailing "
+  int len = lex->pos - start;                         // eg: 65 - 60 = 5
+  char* str = utStrndup(&lex->text[start], len);      // eg: hello
+  c = lexMove1(lex);                                  // skip closing '
+  return tokNew(TOKSTR, str, 0, NULL, lex->linNum, lex->colNum);
+}
+
+// ============================================================================
+// Return a stream of the Toks in lex->text (see toks.h).  Rather than lexing
+// the whole text up front, as lexAll does, each Tok is lexed only when the
+// parser reaches it, and discarded soon after, so the Toks of the program
+// never all exist in memory at once
+// ============================================================================
+Toks* lexStream(Lex* lex) {
+  return toksNewStream(TOKSRING, lexFill, lex);
 }
-
-// ============================================================================
-// Scan a string.  On entry, lex->pos points at the opening ' char.
-// Eg: 'hello' will create a Token of kind TOKSTR, stripping out
-// the leading and trailing tick (')
-// ============================================================================
-Tok* lexStr(Lex* lex) {
-  char c = lexMove1(lex);                             // eg: h
-  int start = lex->pos;                               // eg: 60 => h
-  while (c != '"') c = lexMove1(lex);                 // scan to trailing "
-  int len = lex->pos - start;                         // eg: 65 - 60 = 5
-  char* str = utStrndup(&lex->text[start], len);      // eg: hello
-  c = lexMove1(lex);                                  // skip closing '
-  return tokNew(TOKSTR, str, 0, NULL, lex->linNum, lex->colNum);
-}
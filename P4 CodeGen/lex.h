@@ -19,15 +19,18 @@ typedef struct {
   int   colNum;       // current column number (starts at 1)
 } Lex;
 
-Toks* lexAll(Lex* lex);
+Toks* lexAll(Lex* lex);
+void  lexFill(Toks* toks);
 void  lexKeyword(Tok** tok);
 char  lexMove1(Lex* lex);
-Tok*  lexNam(Lex* lex);
-Lex*  lexNew(char* text);
+Tok*  lexNam(Lex* lex);
+Lex*  lexNew(char* text);
+Tok*  lexNext(Lex* lex);
 Tok*  lexNum(Lex* lex);
 char  lexPeek0(Lex* lex);
 char  lexPeek1(Lex* lex);
 Tok*  lexPun(Lex* lex);
-char  lexSkip(Lex* lex);
+char  lexSkip(Lex* lex);
 char  lexSkipComment(Lex* lex);
-Tok*  lexStr(Lex* lex);
+Tok*  lexStr(Lex* lex);
+Toks* lexStream(Lex* lex);
@@ -0,0 +1,337 @@
+// live.c - Liveness, and Stack Slot Coloring
+//
+// See live.h
+
+#include "live.h"
+
+// ============================================================================
+// Post hook for Asg, Ret, If and While.  Now that every node within the
+// statement is numbered, find its follower - the node that runs after it -
+// and make that its successor (an If or While's second one).  The follower
+// is the next statement, if there is one.  Else, at the end of a Block, it
+// is the While that owns the Block, or whatever follows the If that owns it.
+// At the end of the Body, it is the function's exit.
+// ============================================================================
+WALK liveClose(Walk* walk, Ast* ast) {
+  Live* live = walk->ctx;
+  int isCond = ast->kind == ASTIF || ast->kind == ASTWHILE;
+  int n = isCond ? live->open[--live->numOpen] : live->numNode - 1;
+
+  int follow = -1;                                  // exit
+  if (ast->next) {
+    follow = live->numNode;                         // next statement
+  } else if (walkParent(walk)->kind == ASTBLOCK) {
+    Ast* owner = walk->frame[walk->hi - 2].ast;     // If or While
+    int o = live->open[live->numOpen - 1];
+    follow = owner->kind == ASTWHILE ? o : -(o + 2);
+  }
+
+  if (ast->kind == ASTASG) live->node[n].succ[0] = follow;
+  if (isCond) {
+    live->node[n].succ[1] = follow;
+    if (live->numNode == n + 1) {                   // Block held no nodes
+      live->node[n].succ[0] = ast->kind == ASTWHILE ? n : follow;
+    }
+  }
+  return WALKGO;
+}
+
+// ============================================================================
+// Color the Vars of live->fun, whose live-in sets, one per node, are 'in'.
+// Return the slot given to each Var.
+// ============================================================================
+int* liveColor(Live* live, uint64_t* in) {
+  int numVar = live->numVar;
+  int words = live->words;
+  uint64_t* adj = calloc((size_t) numVar * words, sizeof(uint64_t));
+  int* slot = malloc(numVar * sizeof(int));
+  char* taken = calloc(numVar + 1, 1);
+  if (adj == NULL || slot == NULL || taken == NULL) {
+    utDie2Str("liveColor", "calloc failed");
+  }
+
+  liveInterfere(live, in, adj);
+
+  for (int v = 0; v < numVar; ++v) {
+    uint64_t* row = &adj[(size_t) v * words];
+    for (int u = 0; u < v; ++u) {                   // those colored already
+      if (row[u / 64] >> (u % 64) & 1) taken[slot[u]] = 1;
+    }
+    int s = 0;
+    while (taken[s]) ++s;
+    slot[v] = s;
+    for (int u = 0; u < v; ++u) taken[slot[u]] = 0;
+  }
+
+  free(taken);
+  free(adj);
+  return slot;
+}
+
+// ============================================================================
+// Pack the Vars of 'fun' into as few frame slots as possible (see live.h)
+// ============================================================================
+void liveFun(Live* live, AstFun* fun) {
+  int funIdx = layFindFunIdx(live->lay, fun->nam->lex);
+  live->fun = fun;
+  live->numPar = fun->numpar;
+  live->numVar = fun->body ? fun->body->numvar : 0;
+  live->numNode = live->numUse = live->numOpen = live->numNam = 0;
+  if (live->numVar < 2) return;                     // nothing to share
+  live->words = (live->numVar + 63) / 64;
+
+  Walk* walk = walkNew(live);
+  walkOn(walk, ASTASG,   liveStm,  liveClose);
+  walkOn(walk, ASTIF,    liveOpen, liveClose);
+  walkOn(walk, ASTNAM,   liveNam,  NULL);
+  walkOn(walk, ASTRET,   liveStm,  liveClose);
+  walkOn(walk, ASTWHILE, liveOpen, liveClose);
+  walkRun(walk, (Ast*) fun);
+  walkFree(walk);
+
+  uint64_t* in = liveSolve(live);
+  int* slot = liveColor(live, in);
+
+  Lay* lay = live->lay;
+  for (int v = 0; v < live->numVar; ++v) {
+    lay->row[funIdx + 1 + live->numPar + v].off = -BYTESPERINT * (slot[v] + 1);
+  }
+  for (int i = 0; i < live->numNam; ++i) {
+    AstNam* nam = live->nam[i];
+    if (nam->slot >= live->numPar) {
+      nam->off = -BYTESPERINT * (slot[nam->slot - live->numPar] + 1);
+    }
+  }
+
+  free(slot);
+  free(in);
+}
+
+// ============================================================================
+// Make room for one more element in the array 'arr', of elements 'size'
+// bytes long, which holds '*max' of them, and is full.  Return the array,
+// which may have moved.
+// ============================================================================
+void* liveGrow(void* arr, int* max, int size) {
+  *max = *max ? 2 * *max : 64;
+  arr = realloc(arr, (size_t) *max * size);
+  if (arr == NULL) utDie2Str("liveGrow", "realloc failed");
+  return arr;
+}
+
+// ============================================================================
+// Fill in the interference graph 'adj', a bitset of Vars per Var: the Var
+// that each Asg assigns interferes with every other Var live out of it.
+// ============================================================================
+void liveInterfere(Live* live, uint64_t* in, uint64_t* adj) {
+  int words = live->words;
+  uint64_t* out = malloc(words * sizeof(uint64_t));
+  if (out == NULL) utDie2Str("liveInterfere", "malloc failed");
+
+  for (int n = 0; n < live->numNode; ++n) {
+    int d = live->node[n].def;
+    if (d < 0) continue;
+    memset(out, 0, words * sizeof(uint64_t));
+    for (int s = 0; s < 2; ++s) {
+      int succ = live->node[n].succ[s];
+      if (succ < 0) continue;
+      for (int w = 0; w < words; ++w) out[w] |= in[(size_t) succ * words + w];
+    }
+    for (int v = 0; v < live->numVar; ++v) {
+      if (v == d || !(out[v / 64] >> (v % 64) & 1)) continue;
+      adj[(size_t) d * words + v / 64] |= (uint64_t) 1 << (v % 64);
+      adj[(size_t) v * words + d / 64] |= (uint64_t) 1 << (d % 64);
+    }
+  }
+
+  free(out);
+}
+
+// ============================================================================
+// Pre hook for Nam.  Note each one bound to a Par or Var of the function, so
+// its offset can be re-written once the Vars are colored.
+// ============================================================================
+WALK liveNam(Walk* walk, Ast* ast) {
+  Live* live = walk->ctx;
+  AstNam* nam = (AstNam*) ast;
+  if (nam->fun != live->fun) return WALKGO;         // a function's name
+  if (live->numNam == live->maxNam) {
+    live->nam = liveGrow(live->nam, &live->maxNam, sizeof(AstNam*));
+  }
+  live->nam[live->numNam++] = nam;
+  return WALKGO;
+}
+
+// ============================================================================
+// Add a node to the flow graph, which reads the Vars in 'eoc' - an Exp, or a
+// Call - and assigns the one named by 'def', unless NULL.  Return its number.
+// ============================================================================
+int liveNewNode(Live* live, Ast* eoc, AstNam* def) {
+  if (live->numNode == live->maxNode) {
+    live->node = liveGrow(live->node, &live->maxNode, sizeof(LiveNode));
+  }
+  int n = live->numNode++;
+  LiveNode* node = &live->node[n];
+  node->def = -1;
+  if (def && def->fun == live->fun && def->slot >= live->numPar) {
+    node->def = def->slot - live->numPar;
+  }
+  node->useLo = live->numUse;
+  node->succ[0] = node->succ[1] = -1;
+
+  if (eoc->kind == ASTEXP) {
+    AstExp* exp = (AstExp*) eoc;
+    liveUse(live, exp->lhs);
+    liveUse(live, exp->rhs);
+  } else {
+    for (AstArg* arg = ((AstCall*) eoc)->args; arg; arg = (AstArg*) arg->next) {
+      liveUse(live, arg->nns);
+    }
+  }
+  live->node[n].numUse = live->numUse - live->node[n].useLo;
+  return n;
+}
+
+// ============================================================================
+// Pre hook for If and While: add the node for its test, whose first
+// successor is the first statement of its Block.  liveClose adds the second.
+// ============================================================================
+WALK liveOpen(Walk* walk, Ast* ast) {
+  Live* live = walk->ctx;
+  AstExp* exp = ast->kind == ASTIF ? ((AstIf*) ast)->exp : ((AstWhile*) ast)->exp;
+  int n = liveNewNode(live, (Ast*) exp, NULL);
+  live->node[n].succ[0] = n + 1;                    // first in its Block
+  if (live->numOpen == live->maxOpen) {
+    live->open = liveGrow(live->open, &live->maxOpen, sizeof(int));
+  }
+  live->open[live->numOpen++] = n;
+  return WALKGO;
+}
+
+// ============================================================================
+// Pack the Vars of every function in 'prog', which resProg has laid out in
+// 'lay', and resolved
+// ============================================================================
+void liveProg(Lay* lay, AstProg* prog) {
+  Live live = { 0 };
+  live.lay = lay;
+  for (AstFun* fun = prog->funs; fun; fun = (AstFun*) fun->next) {
+    liveFun(&live, fun);
+  }
+  free(live.node);
+  free(live.use);
+  free(live.open);
+  free(live.nam);
+}
+
+// ============================================================================
+// Resolve each node's follower, then find the Vars live into each node.
+// Return them: a bitset of live->words words per node.
+//
+// We keep a worklist of nodes whose live-in may be out of date.  Taking one,
+// we re-compute its live-in from its successors' - uses, plus live-out less
+// the Var assigned - and, if it changed, add its predecessors.
+// ============================================================================
+uint64_t* liveSolve(Live* live) {
+  int numNode = live->numNode;
+  int words = live->words;
+  LiveNode* node = live->node;
+
+  for (int n = 0; n < numNode; ++n) {               // an If's follower is
+    for (int s = 0; s < 2; ++s) {                   // numbered before the
+      if (node[n].succ[s] <= -2) {                  // nodes within it
+        node[n].succ[s] = node[-(node[n].succ[s] + 2)].succ[1];
+      }
+    }
+  }
+
+  int* predLo = calloc(numNode + 1, sizeof(int));   // predecessors, by node
+  int* pred   = malloc((2 * numNode + 1) * sizeof(int));
+  int* work   = malloc(numNode * sizeof(int));
+  char* queued = malloc(numNode);
+  uint64_t* in = calloc((size_t) numNode * words, sizeof(uint64_t));
+  uint64_t* nin = malloc(words * sizeof(uint64_t));
+  if (!predLo || !pred || !work || !queued || !in || !nin) {
+    utDie2Str("liveSolve", "alloc failed");
+  }
+
+  for (int n = 0; n < numNode; ++n) {
+    for (int s = 0; s < 2; ++s) if (node[n].succ[s] >= 0) ++predLo[node[n].succ[s] + 1];
+  }
+  for (int n = 0; n < numNode; ++n) predLo[n + 1] += predLo[n];
+  int* fill = malloc((numNode + 1) * sizeof(int));
+  if (fill == NULL) utDie2Str("liveSolve", "malloc failed");
+  memcpy(fill, predLo, (numNode + 1) * sizeof(int));
+  for (int n = 0; n < numNode; ++n) {
+    for (int s = 0; s < 2; ++s) if (node[n].succ[s] >= 0) pred[fill[node[n].succ[s]]++] = n;
+  }
+  free(fill);
+
+  int numWork = 0;
+  for (int n = 0; n < numNode; ++n) {               // last node on top
+    work[numWork++] = n;
+    queued[n] = 1;
+  }
+
+  while (numWork) {
+    int n = work[--numWork];
+    queued[n] = 0;
+
+    memset(nin, 0, words * sizeof(uint64_t));       // live out ...
+    for (int s = 0; s < 2; ++s) {
+      int succ = node[n].succ[s];
+      if (succ < 0) continue;
+      for (int w = 0; w < words; ++w) nin[w] |= in[(size_t) succ * words + w];
+    }
+    int d = node[n].def;                            // ... less def, plus uses
+    if (d >= 0) nin[d / 64] &= ~((uint64_t) 1 << (d % 64));
+    for (int u = 0; u < node[n].numUse; ++u) {
+      int v = live->use[node[n].useLo + u];
+      nin[v / 64] |= (uint64_t) 1 << (v % 64);
+    }
+
+    uint64_t* old = &in[(size_t) n * words];
+    if (memcmp(old, nin, words * sizeof(uint64_t)) == 0) continue;
+    memcpy(old, nin, words * sizeof(uint64_t));
+    for (int p = predLo[n]; p < predLo[n + 1]; ++p) {
+      if (!queued[pred[p]]) {
+        queued[pred[p]] = 1;
+        work[numWork++] = pred[p];
+      }
+    }
+  }
+
+  free(nin);
+  free(queued);
+  free(work);
+  free(pred);
+  free(predLo);
+  return in;
+}
+
+// ============================================================================
+// Pre hook for Asg and Ret: add its node.  liveClose adds its successor.
+// ============================================================================
+WALK liveStm(Walk* walk, Ast* ast) {
+  Live* live = walk->ctx;
+  if (ast->kind == ASTASG) {
+    liveNewNode(live, ((AstAsg*) ast)->eoc, ((AstAsg*) ast)->nam);
+  } else {
+    liveNewNode(live, (Ast*) ((AstRet*) ast)->exp, NULL);
+  }
+  return WALKGO;
+}
+
+// ============================================================================
+// Note that the current node reads 'nns' - a Nam, Num or Str, or NULL - if
+// it is a Var
+// ============================================================================
+void liveUse(Live* live, Ast* nns) {
+  if (nns == NULL || nns->kind != ASTNAM) return;
+  AstNam* nam = (AstNam*) nns;
+  if (nam->fun != live->fun || nam->slot < live->numPar) return;
+  if (live->numUse == live->maxUse) {
+    live->use = liveGrow(live->use, &live->maxUse, sizeof(int));
+  }
+  live->use[live->numUse++] = nam->slot - live->numPar;
+}
@@ -0,0 +1,65 @@
+// live.h - Liveness, and Stack Slot Coloring
+
+#pragma once
+
+#include <stdint.h>         // uint64_t
+
+#include "ast.h"            // Ast*
+#include "lay.h"            // Lay
+#include "walk.h"           // walkRun
+
+// layBuildVars gives every Var of a function its own 4-byte slot.  But two
+// Vars that are never live at the same time - a scratch 'i', written and
+// never read, say - can share one.  liveProg, run after resProg, packs the
+// Vars of each function into as few slots as it can:
+//
+//    - it numbers the function's statements, in source order, as the nodes
+//      of a flow graph: one for each Asg and Ret, and one for the test of
+//      each If and While.  Each node records the Var it assigns, if any, the
+//      Vars it reads, and its successors (at most 2)
+//    - it finds the Vars live into each node (a bitset), by the usual
+//      backward dataflow, driven by a worklist, so each loop costs only as
+//      many passes as it needs
+//    - two Vars interfere if one is assigned where the other is live out
+//    - it colors that interference graph greedily: each Var, in order, takes
+//      the lowest slot that no Var it interferes with has taken
+//
+// It then rewrites the offset of each Var, in the Lay, and in every Nam
+// bound to it, so codegen, and layFrameSize, see the packed frame.  Pars
+// live in the caller's frame, so are left as they are.
+
+typedef struct {
+  int   def;                // Var assigned here, or -1
+  int   useLo;              // Vars read here are use[useLo] ...
+  int   numUse;             // ... thru use[useLo + numUse - 1]
+  int   succ[2];            // successors, or -1 for none.  <= -2 while being
+} LiveNode;                 // built: the follower of node -(succ + 2)
+
+typedef struct {
+  Lay*      lay;
+  AstFun*   fun;            // function being colored
+  int       numPar;         // Nams with slot < numPar are Pars
+  int       numVar;
+  int       words;          // uint64_t words in a bitset of Vars
+  LiveNode* node;           // the flow graph
+  int       numNode, maxNode;
+  int*      use;            // Vars read, for all nodes
+  int       numUse, maxUse;
+  int*      open;           // If and While nodes currently open
+  int       numOpen, maxOpen;
+  AstNam**  nam;            // every Nam bound to a Par or Var of 'fun'
+  int       numNam, maxNam;
+} Live;
+
+WALK      liveClose  (Walk* walk, Ast* ast);
+int*      liveColor  (Live* live, uint64_t* in);
+void      liveFun    (Live* live, AstFun* fun);
+void*     liveGrow   (void* arr, int* max, int size);
+void      liveInterfere(Live* live, uint64_t* in, uint64_t* adj);
+WALK      liveNam    (Walk* walk, Ast* ast);
+int       liveNewNode(Live* live, Ast* eoc, AstNam* def);
+WALK      liveOpen   (Walk* walk, Ast* ast);
+void      liveProg   (Lay* lay, AstProg* prog);
+uint64_t* liveSolve  (Live* live);
+WALK      liveStm    (Walk* walk, Ast* ast);
+void      liveUse    (Live* live, Ast* nns);
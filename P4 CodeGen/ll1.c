@@ -0,0 +1,170 @@
+// ll1.c - Table-driven LL(1) parser for SubC - converts tokens into AST
+//
+// An alternative to the recursive descent parser in pse.c, selected by the
+// -ll1 option, which builds the same AST.  It is driven by the tables in
+// ll1tab.h, which Gen/ll1gen builds from the grammar in subc.grm.  So to
+// extend the language, edit subc.grm, re-run ll1gen, and add any new actions
+// to ll1Act.
+//
+// The parse stack holds the Syms still to be matched, with a marker below the
+// Syms of each production being expanded.  Each time round the loop, we pop
+// the top of the parse stack:
+//
+//    a terminal    : must match the current Tok, which we push onto the
+//                    value stack, and move past
+//    a nonterminal : llPredict, indexed by the current TokKind, picks the
+//                    production to expand it by.  Push a marker for that
+//                    production, then its Syms, rightmost first
+//    a marker      : all the Syms of its production are parsed.  Replace
+//                    their values, on top of the value stack, with the one
+//                    value that the production's action builds (ll1Act).
+//                    A production such as Stm => If, that just passes on the
+//                    value of its one Sym, needs no marker
+//
+// Both stacks live on the heap, so (as with pseStms) nesting depth is bounded
+// only by memory.
+
+#include "ll1.h"
+#include "ll1tab.h"
+
+#define LLRED (LLNT + LLNUMNT)      // parse stack marker: LLRED + production
+
+// ============================================================================
+// Perform action 'act', for a production whose 'len' Syms have values val[0]
+// to val[len-1].  Return the value of the production.
+// ============================================================================
+LlVal ll1Act(int act, LlVal* val, int len) {
+  LlVal res = { 0 };
+  Ast* ast = NULL;
+  switch (act) {
+    case ACTNONE:                                 // value of first Sym, if any
+      if (len > 0) res = val[0];
+      return res;
+    case ACTLINK:                                 // X XRest
+      val[0].ast->next = val[1].ast;
+      return val[0];
+    case ACTLINK2:                                // "," X XRest
+      val[1].ast->next = val[2].ast;
+      return val[1];
+    case ACTBOP:                                  // Bop NamNum
+    case ACTCALLARGS:                             // "(" Args ")"
+      res.tok = val[0].tok;
+      res.ast = val[1].ast;
+      return res;
+
+    case ACTARG:    ast = (Ast*) astNewArg(val[0].ast);                   break;
+    case ACTASG:    ast = (Ast*) astNewAsg(astNewNam(val[0].tok.lex),
+                                           val[2].ast);                   break;
+    case ACTBLOCK:  ast = (Ast*) astNewBlock((AstStm*) val[1].ast);       break;
+    case ACTBODY:   ast = (Ast*) astNewBody((AstVar*) val[1].ast,
+                                            (AstStm*) val[2].ast);        break;
+    case ACTEXP:    ast = (Ast*) ll1Exp(val[0].ast, val[1]);              break;
+    case ACTFUN:    ast = (Ast*) astNewFun(astNewNam(val[1].tok.lex),
+                                           (AstPar*) val[3].ast,
+                                           (AstBody*) val[5].ast);        break;
+    case ACTIF:     ast = (Ast*) astNewIf((AstExp*) val[2].ast,
+                                          (AstBlock*) val[4].ast);        break;
+    case ACTNAM:    ast = (Ast*) astNewNam(val[0].tok.lex);              break;
+    case ACTNUM:    ast = (Ast*) astNewNum(val[0].tok.num);              break;
+    case ACTPAR:    ast = (Ast*) astNewPar(astNewNam(val[1].tok.lex));   break;
+    case ACTPROG:   val[0].ast->next = val[1].ast;
+                    ast = (Ast*) astNewProg((AstFun*) val[0].ast);        break;
+    case ACTRET:    ast = (Ast*) astNewRet((AstExp*) val[1].ast);         break;
+    case ACTRHSNAM: { AstNam* nam = astNewNam(val[0].tok.lex);
+                      if (val[1].tok.kind == TOKLPAREN) {  // Call
+                        ast = (Ast*) astNewCall(nam, (AstArg*) val[1].ast);
+                      } else {                                            // Exp
+                        ast = (Ast*) ll1Exp((Ast*) nam, val[1]);
+                      }
+                      break;
+                    }
+    case ACTSTR:    ast = (Ast*) astNewStr(val[0].tok.lex);              break;
+    case ACTVAR:    ast = (Ast*) astNewVar(astNewNam(val[1].tok.lex));   break;
+    case ACTWHILE:  ast = (Ast*) astNewWhile((AstExp*) val[2].ast,
+                                             (AstBlock*) val[4].ast);     break;
+    default:        utDie2Str("ll1Act", "Invalid action");
+  }
+  res.ast = ast;
+  return res;
+}
+
+// ============================================================================
+// Build the Exp whose left operand is 'lhs', and whose operator and right
+// operand, if any, are given by 'rest' - the value of an ExpRest
+// ============================================================================
+AstExp* ll1Exp(Ast* lhs, LlVal rest) {
+  BOP bop = rest.tok.kind ? pseTOKtoBOP(rest.tok.kind) : BOPNONE;
+  return astNewExp(lhs, bop, rest.ast);
+}
+
+// ============================================================================
+// Report that the current Token within 'toks' is not a member of 'set' - the
+// Tokens that 'func' could accept - and abort
+// ============================================================================
+void ll1Fail(Toks* toks, char* func, TokSet set) {
+  char msg[300];
+  tokSetStr(set, msg);
+  utDieStrTokStr(func, toksCurr(toks), msg);
+}
+
+// ============================================================================
+// Prog => Fun+
+// ============================================================================
+AstProg* ll1Prog(Toks* toks) {
+  int maxSym = 256;
+  int* sym = malloc(maxSym * sizeof(int));        // parse stack
+  if (sym == NULL) utDie2Str("ll1Prog", "malloc failed");
+  int hiSym = 0;
+  sym[0] = LLNT + NTPROG;
+
+  int maxVal = 256;
+  LlVal* val = malloc(maxVal * sizeof(LlVal));    // value stack
+  if (val == NULL) utDie2Str("ll1Prog", "malloc failed");
+  int numVal = 0;
+
+  while (hiSym >= 0) {
+    int s = sym[hiSym--];
+
+    if (s >= LLRED) {                             // production complete
+      const LlProd* prod = &llProd[s - LLRED];
+      numVal -= prod->len;
+      val[numVal] = ll1Act(prod->act, &val[numVal], prod->len);
+      if (++numVal == maxVal) {
+        maxVal *= 2;
+        val = realloc(val, maxVal * sizeof(LlVal));
+        if (val == NULL) utDie2Str("ll1Prog", "realloc failed");
+      }
+    } else if (s >= LLNT) {                       // nonterminal
+      int nt = s - LLNT;
+      int p = llPredict[nt][toksCurr(toks)->kind] - 1;
+      if (p < 0) ll1Fail(toks, (char*) llNtStr[nt],
+        llFirst[nt] | (llNullable[nt] ? llFollow[nt] : 0));
+      const LlProd* prod = &llProd[p];
+      if (hiSym + 2 + prod->len >= maxSym) {
+        maxSym *= 2;
+        sym = realloc(sym, maxSym * sizeof(int));
+        if (sym == NULL) utDie2Str("ll1Prog", "realloc failed");
+      }
+      if (prod->act != ACTNONE || prod->len != 1) {
+        sym[++hiSym] = LLRED + p;                 // not just a pass-through
+      }
+      for (int r = prod->len - 1; r >= 0; --r) sym[++hiSym] = prod->rhs[r];
+    } else {                                      // terminal
+      Tok* tok = toksCurr(toks);
+      if ((int) tok->kind != s) ll1Fail(toks, "ll1Prog", TOKSET(s));
+      val[numVal].tok = *tok;
+      val[numVal].ast = NULL;
+      if (++numVal == maxVal) {
+        maxVal *= 2;
+        val = realloc(val, maxVal * sizeof(LlVal));
+        if (val == NULL) utDie2Str("ll1Prog", "realloc failed");
+      }
+      toksNext(toks);
+    }
+  }
+
+  AstProg* prog = (AstProg*) val[0].ast;
+  free(sym);
+  free(val);
+  return prog;
+}
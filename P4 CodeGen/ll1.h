@@ -0,0 +1,23 @@
+// ll1.h - Table-driven LL(1) Parser
+
+#pragma once
+
+#include "ast.h"        // AstProg, etc
+#include "pse.h"        // pseTOKtoBOP
+#include "toks.h"       // Toks
+
+// The value of a parsed Sym.  A terminal yields its Tok; a nonterminal yields
+// the Ast built by its production's action.  ExpRest and RhsNam yield both:
+// the Tok that starts them (an operator, or "("), and their Nam, Num or Args.
+// The Tok is a copy, since a value may outlive the Tok in a stream of Toks.
+// tok.kind is 0 if there is no Tok
+
+typedef struct {
+  Tok  tok;
+  Ast* ast;
+} LlVal;
+
+LlVal    ll1Act (int act, LlVal* val, int len);
+AstExp*  ll1Exp (Ast* lhs, LlVal rest);
+void     ll1Fail(Toks* toks, char* func, TokSet set);
+AstProg* ll1Prog(Toks* toks);
@@ -0,0 +1,298 @@
+// ll1tab.h - LL(1) parse tables for SubC, generated by Gen/ll1gen from subc.grm
+//
+// DO NOT EDIT.  Change the grammar instead, then rebuild this file.  From the
+// Gen directory:
+//    clang -O2 -o ll1gen ll1gen.c
+//    ./ll1gen "../P4 CodeGen/subc.grm" "../P4 CodeGen/ll1tab.h"
+
+#pragma once
+
+#include "tok.h"        // TokKind, TokSet
+
+typedef enum {
+  NTPROG,
+  NTFUN,
+  NTFUNS,
+  NTPARS,
+  NTBODY,
+  NTPAR,
+  NTPARSREST,
+  NTVARS,
+  NTSTMS,
+  NTVAR,
+  NTSTM,
+  NTSTMSREST,
+  NTIF,
+  NTASG,
+  NTRET,
+  NTWHILE,
+  NTEXP,
+  NTBLOCK,
+  NTRHS,
+  NTNUM,
+  NTEXPREST,
+  NTRHSNAM,
+  NTARGS,
+  NTNAMNUM,
+  NTBOP,
+  NTNAM,
+  NTARG,
+  NTARGSREST,
+  NTSTR,
+} LlNt;
+
+typedef enum {
+  ACTNONE,
+  ACTPROG,
+  ACTLINK,
+  ACTFUN,
+  ACTLINK2,
+  ACTPAR,
+  ACTBODY,
+  ACTVAR,
+  ACTIF,
+  ACTASG,
+  ACTRET,
+  ACTWHILE,
+  ACTBLOCK,
+  ACTEXP,
+  ACTRHSNAM,
+  ACTCALLARGS,
+  ACTBOP,
+  ACTARG,
+  ACTNAM,
+  ACTNUM,
+  ACTSTR,
+} LlAct;
+
+#define LLNUMNT   29       // number of nonterminals
+#define LLNUMPROD 53       // number of productions
+#define LLNUMTOK  32       // every TokKind fits in a TokSet, so is < 32
+#define LLMAXRHS  6        // most Syms on the right of any production
+#define LLNT      LLNUMTOK // Sym 's' is a TokKind if s < LLNT, else nonterminal s - LLNT
+
+typedef struct {
+  short lhs;              // nonterminal defined, eg: NTIF
+  short act;              // action that builds its value, eg: ACTIF
+  short len;              // number of Syms on the right ...
+  short rhs[LLMAXRHS];    // ... and those Syms
+} LlProd;
+
+static const LlProd llProd[LLNUMPROD] = {
+  { NTPROG, ACTPROG, 2, { LLNT + NTFUN, LLNT + NTFUNS } },    // 0: Prog => Fun Funs
+  { NTFUNS, ACTLINK, 2, { LLNT + NTFUN, LLNT + NTFUNS } },    // 1: Funs => Fun Funs
+  { NTFUNS, ACTNONE, 0, { 0 } },    // 2: Funs =>
+  { NTFUN, ACTFUN, 6, { TOKINT, TOKNAM, TOKLPAREN, LLNT + NTPARS, TOKRPAREN, LLNT + NTBODY } },    // 3: Fun => TOKINT TOKNAM TOKLPAREN Pars TOKRPAREN Body
+  { NTPARS, ACTLINK, 2, { LLNT + NTPAR, LLNT + NTPARSREST } },    // 4: Pars => Par ParsRest
+  { NTPARS, ACTNONE, 0, { 0 } },    // 5: Pars =>
+  { NTPARSREST, ACTLINK2, 3, { TOKCOMMA, LLNT + NTPAR, LLNT + NTPARSREST } },    // 6: ParsRest => TOKCOMMA Par ParsRest
+  { NTPARSREST, ACTNONE, 0, { 0 } },    // 7: ParsRest =>
+  { NTPAR, ACTPAR, 2, { TOKINT, TOKNAM } },    // 8: Par => TOKINT TOKNAM
+  { NTBODY, ACTBODY, 4, { TOKLBRACE, LLNT + NTVARS, LLNT + NTSTMS, TOKRBRACE } },    // 9: Body => TOKLBRACE Vars Stms TOKRBRACE
+  { NTVARS, ACTLINK, 2, { LLNT + NTVAR, LLNT + NTVARS } },    // 10: Vars => Var Vars
+  { NTVARS, ACTNONE, 0, { 0 } },    // 11: Vars =>
+  { NTVAR, ACTVAR, 3, { TOKINT, TOKNAM, TOKSEMI } },    // 12: Var => TOKINT TOKNAM TOKSEMI
+  { NTSTMS, ACTLINK, 2, { LLNT + NTSTM, LLNT + NTSTMSREST } },    // 13: Stms => Stm StmsRest
+  { NTSTMSREST, ACTLINK, 2, { LLNT + NTSTM, LLNT + NTSTMSREST } },    // 14: StmsRest => Stm StmsRest
+  { NTSTMSREST, ACTNONE, 0, { 0 } },    // 15: StmsRest =>
+  { NTSTM, ACTNONE, 1, { LLNT + NTIF } },    // 16: Stm => If
+  { NTSTM, ACTNONE, 1, { LLNT + NTASG } },    // 17: Stm => Asg
+  { NTSTM, ACTNONE, 1, { LLNT + NTRET } },    // 18: Stm => Ret
+  { NTSTM, ACTNONE, 1, { LLNT + NTWHILE } },    // 19: Stm => While
+  { NTIF, ACTIF, 5, { TOKIF, TOKLPAREN, LLNT + NTEXP, TOKRPAREN, LLNT + NTBLOCK } },    // 20: If => TOKIF TOKLPAREN Exp TOKRPAREN Block
+  { NTASG, ACTASG, 4, { TOKNAM, TOKEQ, LLNT + NTRHS, TOKSEMI } },    // 21: Asg => TOKNAM TOKEQ Rhs TOKSEMI
+  { NTRET, ACTRET, 3, { TOKRET, LLNT + NTEXP, TOKSEMI } },    // 22: Ret => TOKRET Exp TOKSEMI
+  { NTWHILE, ACTWHILE, 5, { TOKWHILE, TOKLPAREN, LLNT + NTEXP, TOKRPAREN, LLNT + NTBLOCK } },    // 23: While => TOKWHILE TOKLPAREN Exp TOKRPAREN Block
+  { NTBLOCK, ACTBLOCK, 3, { TOKLBRACE, LLNT + NTSTMS, TOKRBRACE } },    // 24: Block => TOKLBRACE Stms TOKRBRACE
+  { NTRHS, ACTEXP, 2, { LLNT + NTNUM, LLNT + NTEXPREST } },    // 25: Rhs => Num ExpRest
+  { NTRHS, ACTRHSNAM, 2, { TOKNAM, LLNT + NTRHSNAM } },    // 26: Rhs => TOKNAM RhsNam
+  { NTRHSNAM, ACTCALLARGS, 3, { TOKLPAREN, LLNT + NTARGS, TOKRPAREN } },    // 27: RhsNam => TOKLPAREN Args TOKRPAREN
+  { NTRHSNAM, ACTNONE, 1, { LLNT + NTEXPREST } },    // 28: RhsNam => ExpRest
+  { NTEXP, ACTEXP, 2, { LLNT + NTNAMNUM, LLNT + NTEXPREST } },    // 29: Exp => NamNum ExpRest
+  { NTEXPREST, ACTBOP, 2, { LLNT + NTBOP, LLNT + NTNAMNUM } },    // 30: ExpRest => Bop NamNum
+  { NTEXPREST, ACTNONE, 0, { 0 } },    // 31: ExpRest =>
+  { NTNAMNUM, ACTNONE, 1, { LLNT + NTNAM } },    // 32: NamNum => Nam
+  { NTNAMNUM, ACTNONE, 1, { LLNT + NTNUM } },    // 33: NamNum => Num
+  { NTBOP, ACTNONE, 1, { TOKADD } },    // 34: Bop => TOKADD
+  { NTBOP, ACTNONE, 1, { TOKSUB } },    // 35: Bop => TOKSUB
+  { NTBOP, ACTNONE, 1, { TOKMUL } },    // 36: Bop => TOKMUL
+  { NTBOP, ACTNONE, 1, { TOKLT } },    // 37: Bop => TOKLT
+  { NTBOP, ACTNONE, 1, { TOKLE } },    // 38: Bop => TOKLE
+  { NTBOP, ACTNONE, 1, { TOKNE } },    // 39: Bop => TOKNE
+  { NTBOP, ACTNONE, 1, { TOKEEQ } },    // 40: Bop => TOKEEQ
+  { NTBOP, ACTNONE, 1, { TOKGE } },    // 41: Bop => TOKGE
+  { NTBOP, ACTNONE, 1, { TOKGT } },    // 42: Bop => TOKGT
+  { NTARGS, ACTLINK, 2, { LLNT + NTARG, LLNT + NTARGSREST } },    // 43: Args => Arg ArgsRest
+  { NTARGS, ACTNONE, 0, { 0 } },    // 44: Args =>
+  { NTARGSREST, ACTLINK2, 3, { TOKCOMMA, LLNT + NTARG, LLNT + NTARGSREST } },    // 45: ArgsRest => TOKCOMMA Arg ArgsRest
+  { NTARGSREST, ACTNONE, 0, { 0 } },    // 46: ArgsRest =>
+  { NTARG, ACTARG, 1, { LLNT + NTNAM } },    // 47: Arg => Nam
+  { NTARG, ACTARG, 1, { LLNT + NTNUM } },    // 48: Arg => Num
+  { NTARG, ACTARG, 1, { LLNT + NTSTR } },    // 49: Arg => Str
+  { NTNAM, ACTNAM, 1, { TOKNAM } },    // 50: Nam => TOKNAM
+  { NTNUM, ACTNUM, 1, { TOKNUM } },    // 51: Num => TOKNUM
+  { NTSTR, ACTSTR, 1, { TOKSTR } },    // 52: Str => TOKSTR
+};
+
+static const char* llNtStr[LLNUMNT] = {
+  "Prog",
+  "Fun",
+  "Funs",
+  "Pars",
+  "Body",
+  "Par",
+  "ParsRest",
+  "Vars",
+  "Stms",
+  "Var",
+  "Stm",
+  "StmsRest",
+  "If",
+  "Asg",
+  "Ret",
+  "While",
+  "Exp",
+  "Block",
+  "Rhs",
+  "Num",
+  "ExpRest",
+  "RhsNam",
+  "Args",
+  "NamNum",
+  "Bop",
+  "Nam",
+  "Arg",
+  "ArgsRest",
+  "Str",
+};
+
+static const char llNullable[LLNUMNT] = {
+  [NTPROG] = 0,
+  [NTFUN] = 0,
+  [NTFUNS] = 1,
+  [NTPARS] = 1,
+  [NTBODY] = 0,
+  [NTPAR] = 0,
+  [NTPARSREST] = 1,
+  [NTVARS] = 1,
+  [NTSTMS] = 0,
+  [NTVAR] = 0,
+  [NTSTM] = 0,
+  [NTSTMSREST] = 1,
+  [NTIF] = 0,
+  [NTASG] = 0,
+  [NTRET] = 0,
+  [NTWHILE] = 0,
+  [NTEXP] = 0,
+  [NTBLOCK] = 0,
+  [NTRHS] = 0,
+  [NTNUM] = 0,
+  [NTEXPREST] = 1,
+  [NTRHSNAM] = 1,
+  [NTARGS] = 1,
+  [NTNAMNUM] = 0,
+  [NTBOP] = 0,
+  [NTNAM] = 0,
+  [NTARG] = 0,
+  [NTARGSREST] = 1,
+  [NTSTR] = 0,
+};
+
+static const TokSet llFirst[LLNUMNT] = {
+  [NTPROG] = TOKSET(TOKINT),
+  [NTFUN] = TOKSET(TOKINT),
+  [NTFUNS] = TOKSET(TOKINT),
+  [NTPARS] = TOKSET(TOKINT),
+  [NTBODY] = TOKSET(TOKLBRACE),
+  [NTPAR] = TOKSET(TOKINT),
+  [NTPARSREST] = TOKSET(TOKCOMMA),
+  [NTVARS] = TOKSET(TOKINT),
+  [NTSTMS] = TOKSET(TOKNAM) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTVAR] = TOKSET(TOKINT),
+  [NTSTM] = TOKSET(TOKNAM) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTSTMSREST] = TOKSET(TOKNAM) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTIF] = TOKSET(TOKIF),
+  [NTASG] = TOKSET(TOKNAM),
+  [NTRET] = TOKSET(TOKRET),
+  [NTWHILE] = TOKSET(TOKWHILE),
+  [NTEXP] = TOKSET(TOKNAM) | TOKSET(TOKNUM),
+  [NTBLOCK] = TOKSET(TOKLBRACE),
+  [NTRHS] = TOKSET(TOKNAM) | TOKSET(TOKNUM),
+  [NTNUM] = TOKSET(TOKNUM),
+  [NTEXPREST] = TOKSET(TOKADD) | TOKSET(TOKSUB) | TOKSET(TOKMUL) | TOKSET(TOKLT) | TOKSET(TOKLE) | TOKSET(TOKNE) | TOKSET(TOKEEQ) | TOKSET(TOKGE) | TOKSET(TOKGT),
+  [NTRHSNAM] = TOKSET(TOKLPAREN) | TOKSET(TOKADD) | TOKSET(TOKSUB) | TOKSET(TOKMUL) | TOKSET(TOKLT) | TOKSET(TOKLE) | TOKSET(TOKNE) | TOKSET(TOKEEQ) | TOKSET(TOKGE) | TOKSET(TOKGT),
+  [NTARGS] = TOKSET(TOKNAM) | TOKSET(TOKNUM) | TOKSET(TOKSTR),
+  [NTNAMNUM] = TOKSET(TOKNAM) | TOKSET(TOKNUM),
+  [NTBOP] = TOKSET(TOKADD) | TOKSET(TOKSUB) | TOKSET(TOKMUL) | TOKSET(TOKLT) | TOKSET(TOKLE) | TOKSET(TOKNE) | TOKSET(TOKEEQ) | TOKSET(TOKGE) | TOKSET(TOKGT),
+  [NTNAM] = TOKSET(TOKNAM),
+  [NTARG] = TOKSET(TOKNAM) | TOKSET(TOKNUM) | TOKSET(TOKSTR),
+  [NTARGSREST] = TOKSET(TOKCOMMA),
+  [NTSTR] = TOKSET(TOKSTR),
+};
+
+static const TokSet llFollow[LLNUMNT] = {
+  [NTPROG] = TOKSET(TOKEOF),
+  [NTFUN] = TOKSET(TOKINT) | TOKSET(TOKEOF),
+  [NTFUNS] = TOKSET(TOKEOF),
+  [NTPARS] = TOKSET(TOKRPAREN),
+  [NTBODY] = TOKSET(TOKINT) | TOKSET(TOKEOF),
+  [NTPAR] = TOKSET(TOKRPAREN) | TOKSET(TOKCOMMA),
+  [NTPARSREST] = TOKSET(TOKRPAREN),
+  [NTVARS] = TOKSET(TOKNAM) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTSTMS] = TOKSET(TOKRBRACE),
+  [NTVAR] = TOKSET(TOKINT) | TOKSET(TOKNAM) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTSTM] = TOKSET(TOKNAM) | TOKSET(TOKRBRACE) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTSTMSREST] = TOKSET(TOKRBRACE),
+  [NTIF] = TOKSET(TOKNAM) | TOKSET(TOKRBRACE) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTASG] = TOKSET(TOKNAM) | TOKSET(TOKRBRACE) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTRET] = TOKSET(TOKNAM) | TOKSET(TOKRBRACE) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTWHILE] = TOKSET(TOKNAM) | TOKSET(TOKRBRACE) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTEXP] = TOKSET(TOKRPAREN) | TOKSET(TOKSEMI),
+  [NTBLOCK] = TOKSET(TOKNAM) | TOKSET(TOKRBRACE) | TOKSET(TOKIF) | TOKSET(TOKRET) | TOKSET(TOKWHILE),
+  [NTRHS] = TOKSET(TOKSEMI),
+  [NTNUM] = TOKSET(TOKRPAREN) | TOKSET(TOKCOMMA) | TOKSET(TOKSEMI) | TOKSET(TOKADD) | TOKSET(TOKSUB) | TOKSET(TOKMUL) | TOKSET(TOKLT) | TOKSET(TOKLE) | TOKSET(TOKNE) | TOKSET(TOKEEQ) | TOKSET(TOKGE) | TOKSET(TOKGT),
+  [NTEXPREST] = TOKSET(TOKRPAREN) | TOKSET(TOKSEMI),
+  [NTRHSNAM] = TOKSET(TOKSEMI),
+  [NTARGS] = TOKSET(TOKRPAREN),
+  [NTNAMNUM] = TOKSET(TOKRPAREN) | TOKSET(TOKSEMI) | TOKSET(TOKADD) | TOKSET(TOKSUB) | TOKSET(TOKMUL) | TOKSET(TOKLT) | TOKSET(TOKLE) | TOKSET(TOKNE) | TOKSET(TOKEEQ) | TOKSET(TOKGE) | TOKSET(TOKGT),
+  [NTBOP] = TOKSET(TOKNAM) | TOKSET(TOKNUM),
+  [NTNAM] = TOKSET(TOKRPAREN) | TOKSET(TOKCOMMA) | TOKSET(TOKSEMI) | TOKSET(TOKADD) | TOKSET(TOKSUB) | TOKSET(TOKMUL) | TOKSET(TOKLT) | TOKSET(TOKLE) | TOKSET(TOKNE) | TOKSET(TOKEEQ) | TOKSET(TOKGE) | TOKSET(TOKGT),
+  [NTARG] = TOKSET(TOKRPAREN) | TOKSET(TOKCOMMA),
+  [NTARGSREST] = TOKSET(TOKRPAREN),
+  [NTSTR] = TOKSET(TOKRPAREN) | TOKSET(TOKCOMMA),
+};
+
+// llPredict[nt][k] is 1 + the production that expands nonterminal 'nt' when
+// the current Token has kind 'k'; or 0 if that Token is a syntax error
+
+static const unsigned char llPredict[LLNUMNT][LLNUMTOK] = {
+  [NTPROG] = { [TOKINT] = 1 },
+  [NTFUN] = { [TOKINT] = 4 },
+  [NTFUNS] = { [TOKINT] = 2, [TOKEOF] = 3 },
+  [NTPARS] = { [TOKINT] = 5, [TOKRPAREN] = 6 },
+  [NTBODY] = { [TOKLBRACE] = 10 },
+  [NTPAR] = { [TOKINT] = 9 },
+  [NTPARSREST] = { [TOKRPAREN] = 8, [TOKCOMMA] = 7 },
+  [NTVARS] = { [TOKINT] = 11, [TOKNAM] = 12, [TOKIF] = 12, [TOKRET] = 12, [TOKWHILE] = 12 },
+  [NTSTMS] = { [TOKNAM] = 14, [TOKIF] = 14, [TOKRET] = 14, [TOKWHILE] = 14 },
+  [NTVAR] = { [TOKINT] = 13 },
+  [NTSTM] = { [TOKNAM] = 18, [TOKIF] = 17, [TOKRET] = 19, [TOKWHILE] = 20 },
+  [NTSTMSREST] = { [TOKNAM] = 15, [TOKRBRACE] = 16, [TOKIF] = 15, [TOKRET] = 15, [TOKWHILE] = 15 },
+  [NTIF] = { [TOKIF] = 21 },
+  [NTASG] = { [TOKNAM] = 22 },
+  [NTRET] = { [TOKRET] = 23 },
+  [NTWHILE] = { [TOKWHILE] = 24 },
+  [NTEXP] = { [TOKNAM] = 30, [TOKNUM] = 30 },
+  [NTBLOCK] = { [TOKLBRACE] = 25 },
+  [NTRHS] = { [TOKNAM] = 27, [TOKNUM] = 26 },
+  [NTNUM] = { [TOKNUM] = 52 },
+  [NTEXPREST] = { [TOKRPAREN] = 32, [TOKSEMI] = 32, [TOKADD] = 31, [TOKSUB] = 31, [TOKMUL] = 31, [TOKLT] = 31, [TOKLE] = 31, [TOKNE] = 31, [TOKEEQ] = 31, [TOKGE] = 31, [TOKGT] = 31 },
+  [NTRHSNAM] = { [TOKLPAREN] = 28, [TOKSEMI] = 29, [TOKADD] = 29, [TOKSUB] = 29, [TOKMUL] = 29, [TOKLT] = 29, [TOKLE] = 29, [TOKNE] = 29, [TOKEEQ] = 29, [TOKGE] = 29, [TOKGT] = 29 },
+  [NTARGS] = { [TOKNAM] = 44, [TOKRPAREN] = 45, [TOKNUM] = 44, [TOKSTR] = 44 },
+  [NTNAMNUM] = { [TOKNAM] = 33, [TOKNUM] = 34 },
+  [NTBOP] = { [TOKADD] = 35, [TOKSUB] = 36, [TOKMUL] = 37, [TOKLT] = 38, [TOKLE] = 39, [TOKNE] = 40, [TOKEEQ] = 41, [TOKGE] = 42, [TOKGT] = 43 },
+  [NTNAM] = { [TOKNAM] = 51 },
+  [NTARG] = { [TOKNAM] = 48, [TOKNUM] = 49, [TOKSTR] = 50 },
+  [NTARGSREST] = { [TOKRPAREN] = 47, [TOKCOMMA] = 46 },
+  [NTSTR] = { [TOKSTR] = 53 },
+};
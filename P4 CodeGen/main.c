@@ -1,73 +1,269 @@
-// main.c - SubC Compiler - Jim Hogg, 2020
-//
-// Prog       => Fun+
-// Fun        => "int"   Nam     "(" Pars ")" Body
-//             | "int"   "main"  "("      ")" Body
-// Pars       => ( Par ( "," Par )* ) ?
-// Par        => "int" Nam
-//
-// Body       => "{" Var* Stm+ "}"
-// Var        => "int" Nam ";"
-// Stm        => If | Asg | Ret | While
-// If         => "if" "(" Exp ")" Block
-// Asg        => Nam "=" (Exp | Call) ";"
-// Ret        => "return" Exp ";"
-// While      => "while" "(" Exp ")" Block
-// Block      => "{" Stm+ "}"
-//
-// NamNum     => Nam | Num
-// Exp        => NamNum | NamNum Bop NamNum
-// Bop        => "+" | "-" | "*" | "<" | "<=" | "!=" | "==" | ">=" | ">"
-//
-// Call       => Nam "(" Args ")"
-// Args       => ( Arg ( "," Arg )* ) ?
-// Arg        => Nam | Num | Str
-//
-// Num        => [0-9]+
-// Str        => "\"" NonQuotes "\""
-// Nam        => Alpha AlphaNum*
-// Alpha      => [a-zA-Z]
-// AlphaNum   => [a-zA-Z0-9]
-//
-// Execution starts with the function "main".
-// Type 'int' is a 32-bit C int
-
-#include "main.h"
-
-void usage() { printf("\n\nUsage: subc <file.subc> \n\n"); }
-
-int main(int argc, char* argv[]) {
-  if (argc < 2) { usage(); exit(-1); }
-
-  char* prog = utReadFile(argv[1]);       // raw chars
-
-  Lex* lex = lexNew(prog);
-  Toks* toks = lexAll(lex);
-  toksDump(toks);                         // DEBUG: dump Tokens to TokenDump.txt
-  toksRewind(toks);
-  AstProg* astProg = pseProg(toks);       // parse tokens, build AST
-  ///visitProg(astProg);                  // DEBUG: dump AST to console
-
-  Cg* cg = cgNew();                       // new CodeGen
-
-  emitCodeDirective(cg->emit);
-  emitDataDirective(cg->emit);
-
-  cgProg(cg, astProg);                    // codegen the program
-
-  char* io = utReadFile("io.s");          // read IO support code from "io.s"
-  emitCode(cg->emit, io);                 // emit to buffer
-
-  // Decide what to call the output assembly file.  So, if input source
-  // file is "c:\Users\jimhh\OneDrive\UW\CSS-448-Hogg-Au22\Tests\test01.subc"
-  // then name the output file "test01.s"
-
-  char* path = emitNewName(argv[1]);
-
-  // Save the generated assembler data and code to the output file
-
-  emitSave(cg->emit, path);
-
-  utPause();
-  return 0;
-}
+// main.c - SubC Compiler - Jim Hogg, 2020
+//
+// Prog       => Fun+
+// Fun        => "int"   Nam     "(" Pars ")" Body
+//             | "int"   "main"  "("      ")" Body
+// Pars       => ( Par ( "," Par )* ) ?
+// Par        => "int" Nam
+//
+// Body       => "{" Var* Stm+ "}"
+// Var        => "int" Nam ";"
+// Stm        => If | Asg | Ret | While
+// If         => "if" "(" Exp ")" Block
+// Asg        => Nam "=" (Exp | Call) ";"
+// Ret        => "return" Exp ";"
+// While      => "while" "(" Exp ")" Block
+// Block      => "{" Stm+ "}"
+//
+// NamNum     => Nam | Num
+// Exp        => NamNum | NamNum Bop NamNum
+// Bop        => "+" | "-" | "*" | "<" | "<=" | "!=" | "==" | ">=" | ">"
+//
+// Call       => Nam "(" Args ")"
+// Args       => ( Arg ( "," Arg )* ) ?
+// Arg        => Nam | Num | Str
+//
+// Num        => [0-9]+
+// Str        => "\"" NonQuotes "\""
+// Nam        => Alpha AlphaNum*
+// Alpha      => [a-zA-Z]
+// AlphaNum   => [a-zA-Z0-9]
+//
+// subc.grm holds this same grammar, rewritten into LL(1) form, from which
+// Gen/ll1gen builds the tables for the table-driven parser (-ll1) in ll1.c
+//
+// Execution starts with the function "main".
+// Type 'int' is a 32-bit C int
+
+#include "main.h"
+
+// ============================================================================
+// Generate code for 'astProg', and save it to the assembly file named after
+// 'srcPath'
+// ============================================================================
+void compile(AstProg* astProg, char* srcPath) {
+  Cg* cg = cgNew();                       // new CodeGen
+  resProg(cg->lay, astProg);              // bind every name, before codegen
+
+  cg->cgr = cgrProg(cg->lay, astProg);    // call graph (see cgr.h)
+  cgrPrune(cg->cgr, astProg);             // drop Funs that main cannot reach
+  if (cg->cgr->numDead) {
+    printf("INFO: Removed %d functions unreachable from main \n", cg->cgr->numDead);
+  }
+
+  liveProg(cg->lay, astProg);             // share frame slots (see live.h)
+
+  emitCodeDirective(cg->emit);
+  emitDataDirective(cg->emit);
+
+  Ir* ir = irProg(cg->lay, astProg);      // lower to IR (see ir.h)
+  irVerify(ir);
+  cfgProg(ir);                            // drop unreachable code (see cfg.h)
+  irVerify(ir);
+  if (g_ssa) {                            // -ssa : into SSA and out (see ssa.h)
+    ssaProg(ir);
+    irVerify(ir);
+  }
+  if (g_irDump) irDump(ir);               // -ir : dump it to IrDump.txt
+
+  cgProg(cg, ir);                         // codegen the program
+
+  char* io = utReadFile("io.s");          // read IO support code from "io.s"
+  emitCode(cg->emit, io);                 // emit to buffer
+
+  // Decide what to call the output assembly file.  So, if input source
+  // file is "c:\Users\jimhh\OneDrive\UW\CSS-448-Hogg-Au22\Tests\test01.subc"
+  // then name the output file "test01.s"
+
+  char* path = emitNewName(srcPath);
+
+  // Save the generated assembler data and code to the output file
+
+  emitSave(cg->emit, path);
+}
+
+// ============================================================================
+// Compile 'srcPath', then compile it again each time it changes, for ever.
+// Re-use, from one compile to the next, the AST of every function that has
+// not changed (see inc.h).  Report, for each compile, how many were re-used.
+// ============================================================================
+void watch(char* srcPath) {
+  Inc* inc = incNew();
+  unsigned lastHash = 0;
+  int first = 1;
+  printf("Watching %s - hit Ctrl-C to stop \n", srcPath);
+
+  for (;;) {
+    char* prog = utReadFile(srcPath);
+    unsigned hash = utHash(prog, strlen(prog));
+    if (first || hash != lastHash) {
+      first = 0;
+      lastHash = hash;
+
+      Toks* toks = lexAll(lexNew(prog));
+      toksRewind(toks);
+      AstProg* astProg = incProg(inc, toks);
+      compile(astProg, srcPath);
+      printf("%s: %d functions re-used, %d re-parsed \n",
+        srcPath, inc->numReused, inc->numParsed);
+      fflush(stdout);
+
+      free(toks->tok);                    // lexemes live on, in the AST
+      free(toks);
+    }
+    free(prog);
+    utSleep(WATCHMS);
+  }
+}
+
+// ============================================================================
+// --syntax-only : check the syntax of every file named in 'argv', reporting
+// every error in each (see rex.h).  Exit with 1 if there were any, else 0
+// ============================================================================
+int syntaxOnly(int argc, char* argv[]) {
+  int numFile = 0;
+  int numErr = 0;
+  for (int a = 1; a < argc; ++a) {
+    if (strcmp(argv[a], "--syntax-only") == 0) continue;
+    numErr += rexCheck(argv[a]);
+    ++numFile;
+  }
+  printf("INFO: Syntax check: %d files, %d errors \n", numFile, numErr);
+  return numErr ? 1 : 0;
+}
+
+void usage() {
+  printf("\n\nUsage: subc <file.subc> [-toks] [-ll1] [-stream | -pipe [-batch <n>] | -j <n> | -watch] \n");
+  printf("       [-maxerr <n>] [-cons] [-ir] [-ssa] [--stats] \n");
+  printf("       subc --syntax-only <file.subc> ... \n\n");
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) { usage(); exit(-1); }
+
+  for (int a = 1; a < argc; ++a) {
+    if (strcmp(argv[a], "--syntax-only") == 0) return syntaxOnly(argc, argv);
+  }
+
+  int dumpToks = 0;                       // -toks : dump Tokens to ToksDump.txt
+  int useLl1 = 0;                         // -ll1  : use the table-driven parser
+  int stream = 0;                         // -stream : lex as the parser goes
+  int usePipe = 0;                        // -pipe  : lex on a second thread
+  int batch = PIPEBATCH;                  // -batch <n> : Toks per publish
+  int numThread = 0;                      // -j <n> : parse on 'n' threads
+  int useWatch = 0;                       // -watch : re-compile on each edit
+  int maxErr = 0;                         // -maxerr <n> : recover from errors
+  int useCons = 0;                        // -cons : share identical nodes
+  int showStats = 0;                      // --stats : report counts, per pass
+  for (int a = 2; a < argc; ++a) {
+    if (strcmp(argv[a], "-toks") == 0) {
+      dumpToks = 1;
+    } else if (strcmp(argv[a], "-ll1") == 0) {
+      useLl1 = 1;
+    } else if (strcmp(argv[a], "-stream") == 0) {
+      stream = 1;
+    } else if (strcmp(argv[a], "-pipe") == 0) {
+      usePipe = 1;
+    } else if (strcmp(argv[a], "-batch") == 0 && a + 1 < argc) {
+      batch = atoi(argv[++a]);
+    } else if (strcmp(argv[a], "-watch") == 0) {
+      useWatch = 1;
+    } else if (strcmp(argv[a], "-maxerr") == 0 && a + 1 < argc) {
+      maxErr = atoi(argv[++a]);
+      if (maxErr < 1) { usage(); exit(-1); }
+    } else if (strcmp(argv[a], "-cons") == 0) {
+      useCons = 1;
+    } else if (strcmp(argv[a], "-ir") == 0) {
+      g_irDump = 1;                       // -ir : dump the IR, see irDump
+    } else if (strcmp(argv[a], "-ssa") == 0) {
+      g_ssa = 1;                          // -ssa : see ssaProg
+    } else if (strcmp(argv[a], "--stats") == 0) {
+      showStats = 1;
+      g_irStats = 1;                      // --stats : see also cfgProg, ssaProg
+    } else if (strcmp(argv[a], "-j") == 0 && a + 1 < argc) {
+      numThread = atoi(argv[++a]);
+      if (numThread < 1) { usage(); exit(-1); }
+    } else {
+      usage(); exit(-1);
+    }
+  }
+
+  if ((stream || usePipe) && dumpToks) { usage(); exit(-1); }
+  if (stream && usePipe) { usage(); exit(-1); }
+  if (numThread && (stream || usePipe || useLl1)) { usage(); exit(-1); }
+  if (useWatch && argc > 3) { usage(); exit(-1); }
+  if (maxErr && (stream || usePipe || useLl1 || numThread)) { usage(); exit(-1); }
+  if (useCons && numThread) { usage(); exit(-1); }
+  if (maxErr) g_pseErrs = pseErrsNew(maxErr);
+  if (useCons) g_astCons = astConsNew();  // see AstCons in ast.h
+
+  if (useWatch) watch(argv[1]);           // never returns
+
+  char* prog = utReadFile(argv[1]);       // raw chars
+
+  // Re-use the AST cached by a previous compile of this same source text, if
+  // there is one: then there is nothing to lex, or parse (see flaLoad).  Only
+  // for the default lexer and parser, since the options that pick another are
+  // there to exercise it.
+
+  int useAstCache = !stream && !usePipe && !useLl1 && !numThread && !dumpToks;
+  char* astPath = utCacheName(argv[1], ".ast"); // eg: "test01.ast"
+  Fla* fla = useAstCache ? flaLoad(astPath, prog) : NULL;
+  AstProg* astProg = fla ? flaAst(fla) : NULL;
+
+  Toks* toks = NULL;
+  if (astProg) {
+    // already parsed
+  } else if (stream) {
+
+    // Lex each Token only when the parser reaches it (see lexStream).  The
+    // Tokens never exist all at once, so there is nothing to cache, or dump
+
+    toks = lexStream(lexNew(prog));
+  } else if (usePipe) {
+
+    // Lex on a second thread, which runs ahead of the parser (see pipe.h)
+
+    toks = pipeStart(lexNew(prog), batch);
+  } else {
+
+    // Re-use the Tokens cached by a previous compile of this same source
+    // text, if there is one.  Otherwise, lex the source, and cache its Tokens.
+
+    char* tokPath = toksCacheName(argv[1]); // eg: "test01.tok"
+    toks = toksLoad(tokPath, prog);
+    if (toks == NULL) {
+      Lex* lex = lexNew(prog);
+      toks = lexAll(lex);
+      toksSave(toks, tokPath, prog);
+    }
+    if (dumpToks) toksDump(toks);         // DEBUG: dump Tokens to ToksDump.txt
+    toksRewind(toks);
+  }
+
+  if (astProg == NULL) {                  // parse tokens, build AST
+    astProg = useLl1
+      ? ll1Prog(toks)
+      : numThread
+      ? jobProg(toks, numThread)
+      : pseProg(toks);
+  }
+  ///visitProg(astProg);                  // DEBUG: dump AST to console
+
+  if (g_pseErrs && g_pseErrs->numErr) {   // -maxerr: report all, then stop
+    pseErrsReport();
+    utPause();
+  }
+
+  if (showStats && g_astCons) {           // --stats, with -cons
+    printf("INFO: cons: %d distinct nodes, %d requests shared \n",
+      g_astCons->numBuilt, g_astCons->numShared);
+  }
+
+  if (useAstCache && fla == NULL) flaSave(flaNew(astProg), astPath, prog);
+
+  compile(astProg, argv[1]);              // codegen, and save
+
+  utPause();
+  return 0;
+}
@@ -1,17 +1,32 @@
 // main.h - SubC Compiler - Jim Hogg, 2020
 
-#pragma once
-
-#include <stdio.h>      // printf, FILE
-#include <stdlib.h>     // exit
-
-#include "ast.h"        // AstProg
-#include "cg.h"         // CodeGen
+#pragma once
+
+#include <stdio.h>      // printf, FILE
+#include <stdlib.h>     // exit
+
+#include "ast.h"        // AstProg
+#include "cfg.h"        // cfgProg
+#include "cg.h"         // CodeGen
 #include "emit.h"       // code emission
+#include "fla.h"        // flaLoad, flaSave
+#include "inc.h"        // incProg
+#include "job.h"        // jobProg
 #include "lex.h"        // Lex
-#include "pse.h"        // parProg
-#include "ut.h"         // ut* utility functions
-#include "visit.h"      // visit* functions
-
-int main(int argc, char* argv[]);
-void usage();
\ No newline at end of file
+#include "live.h"       // liveProg
+#include "ll1.h"        // ll1Prog
+#include "pipe.h"       // pipeStart
+#include "pse.h"        // parProg
+#include "res.h"        // resProg
+#include "rex.h"        // rexCheck
+#include "ssa.h"        // ssaProg
+#include "ut.h"         // ut* utility functions
+#include "visit.h"      // visit* functions
+
+#define WATCHMS 300     // -watch : how often to check for edits, in ms
+
+void compile(AstProg* astProg, char* srcPath);
+int  main(int argc, char* argv[]);
+int  syntaxOnly(int argc, char* argv[]);
+void usage();
+void watch(char* srcPath);
\ No newline at end of file
@@ -1,9 +1,9 @@
 // pin.h - Indentation - Jim Hogg, 2020
 
-#pragma once
-
-#define INDENT 3
-
-void pin    ();
-void pinLess();
-void pinMore();
+#pragma once
+
+#define INDENT 3
+
+void pin    ();
+void pinLess();
+void pinMore();
@@ -0,0 +1,102 @@
+// pipe.c - Lexer thread that feeds Toks to the parser thread
+//
+// An alternative to lexStream, selected by the -pipe option: rather than lex
+// each Tok only when the parser needs it, lex the whole program on a second
+// thread, running ahead of the parser.  See pipe.h for how the two threads
+// share the ring.
+
+#include <sched.h>          // sched_yield
+
+#include "pipe.h"
+
+// ============================================================================
+// The 'fill' of the Toks stream made by pipeStart.  Called on the parser's
+// thread, when the parser has used up every Tok in 'toks'.  Wait until the
+// lexer has published more, then copy in as many as we can - up to half of
+// the Toks ring, as in lexFill.  Once the lexer is done, and we have taken
+// its last Tok, join its thread, and end the stream.
+// ============================================================================
+void pipeFill(Toks* toks) {
+  Pipe* pipe = (Pipe*) toks->src;
+  int tail = atomic_load_explicit(&pipe->tail, memory_order_relaxed);
+
+  int head;
+  for (;;) {
+    int done = atomic_load_explicit(&pipe->done, memory_order_acquire);
+    head = atomic_load_explicit(&pipe->head, memory_order_acquire);
+    if (head != tail) break;
+    if (done) {
+      pthread_join(pipe->thread, NULL);
+      free(pipe);
+      toks->fill = NULL;
+      return;
+    }
+    sched_yield();                            // lexer is behind: let it run
+  }
+
+  int hiWant = toks->tokNum + (toks->mask + 1) / 2;
+  while (tail != head && toks->hiTokNum < hiWant) {
+    toksAdd(toks, &pipe->ring[tail & (PIPERING - 1)]);
+    ++tail;
+  }
+  atomic_store_explicit(&pipe->tail, tail, memory_order_release);
+}
+
+// ============================================================================
+// The lexer thread.  Lex every Tok of the program into the ring, publishing
+// them a batch at a time, and waiting whenever the ring is full.
+// ============================================================================
+void* pipeLex(void* arg) {
+  Pipe* pipe = (Pipe*) arg;
+  int head = 0;                               // Toks written
+  int pub = 0;                                // Toks published
+
+  for (;;) {
+    Tok* tok = lexNext(pipe->lex);
+    if (tok == NULL) break;                   // end of text
+
+    while (head - atomic_load_explicit(&pipe->tail, memory_order_acquire) == PIPERING) {
+      if (pub != head) {                      // parser may be waiting on us
+        atomic_store_explicit(&pipe->head, head, memory_order_release);
+        pub = head;
+      }
+      sched_yield();                          // ring full: let parser run
+    }
+
+    pipe->ring[head & (PIPERING - 1)] = *tok;
+    free(tok);
+    ++head;
+
+    if (head - pub >= pipe->batch) {
+      atomic_store_explicit(&pipe->head, head, memory_order_release);
+      pub = head;
+    }
+  }
+
+  atomic_store_explicit(&pipe->head, head, memory_order_release);
+  atomic_store_explicit(&pipe->done, 1, memory_order_release);
+  return NULL;
+}
+
+// ============================================================================
+// Start a thread that lexes 'lex', and return the stream of Toks that it
+// feeds.  The thread publishes its Toks 'batch' at a time.
+// ============================================================================
+Toks* pipeStart(Lex* lex, int batch) {
+  if (batch < 1 || batch > PIPERING) {
+    utDie2StrInt("pipeStart", "Batch size must be from 1 to", PIPERING);
+  }
+
+  Pipe* pipe = aligned_alloc(64, sizeof(Pipe));   // see _Alignas in pipe.h
+  if (pipe == NULL) utDie2Str("pipeStart", "aligned_alloc failed");
+  atomic_init(&pipe->head, 0);
+  atomic_init(&pipe->tail, 0);
+  atomic_init(&pipe->done, 0);
+  pipe->batch = batch;
+  pipe->lex = lex;
+
+  if (pthread_create(&pipe->thread, NULL, pipeLex, pipe) != 0) {
+    utDie2Str("pipeStart", "Cannot start lexer thread");
+  }
+  return toksNewStream(TOKSRING, pipeFill, pipe);
+}
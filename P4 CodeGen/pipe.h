@@ -0,0 +1,42 @@
+// pipe.h - Lexer thread that feeds Toks to the parser thread
+
+#pragma once
+
+#include <pthread.h>        // pthread_t
+#include <stdatomic.h>      // atomic_int
+
+#include "lex.h"            // Lex
+#include "toks.h"           // Toks
+
+// A Pipe is a lock-free ring of Toks, with a single producer - a thread that
+// runs the lexer - and a single consumer - the parser, reading a stream of
+// Toks (see toksNewStream) whose 'fill' is pipeFill.  So lexing overlaps with
+// parsing.
+//
+// Each side owns one counter, and only reads the other's.  The lexer writes
+// Tok number 'n' into ring[n & mask], then, once every 'batch' Toks, makes
+// the whole batch visible to the parser by storing 'head' (release).  The
+// parser copies out every Tok below 'head' (acquire), then hands their slots
+// back by storing 'tail'.  When the ring is full (head - tail == PIPERING),
+// the lexer waits for the parser to catch up.  That is the backpressure.
+//
+// A Tok is 40 bytes, so the default batch, of 8 Toks, is 5 whole cache lines.
+// 'head' and 'tail' each have a cache line of their own, so that storing one
+// does not steal the other from the other core.
+
+#define PIPERING  4096      // Toks; must be a power of 2
+#define PIPEBATCH 8         // Toks published at a time (see -batch in main.c)
+
+typedef struct {
+  _Alignas(64) atomic_int head;     // Toks published, by the lexer
+  _Alignas(64) atomic_int tail;     // Toks taken, by the parser
+  _Alignas(64) atomic_int done;     // 1 once 'head' counts every Tok
+  int       batch;                  // Toks per publish
+  Lex*      lex;
+  pthread_t thread;                 // runs pipeLex
+  Tok       ring[PIPERING];
+} Pipe;
+
+void  pipeFill(Toks* toks);
+void* pipeLex(void* arg);
+Toks* pipeStart(Lex* lex, int batch);
@@ -2,182 +2,279 @@
 
 #include "pse.h"
 
-// ============================================================================
-// Append Ast 'a' onto the chain of Asts 'as', linked via the 'next'
-// pointer in the Ast struct
-// ============================================================================
-void pseAppend(Ast* as, Ast* a) {
-  Ast** p = &as->next;              // p is alias
-  while (*p) p = &((*p)->next);
-  *p = a;
-}
-
-// ============================================================================
-// Arg => Nam | Num | Str
-// ============================================================================
-AstArg* pseArg(Toks* toks) {
-
-  Tok* tok = toksCurr(toks);
-  if (tok->kind == TOKRPAREN) return NULL;    // eg: sayl();
-
-  tok = pseMust(toks, 3, TOKNAM, TOKNUM, TOKSTR);
-  if (tok->kind == TOKNAM) {
-    AstNam* nam = astNewNam(tok->lex);
-    return astNewArg((Ast*) nam);
-  } else if (tok->kind == TOKNUM) {
-    AstNum* num = astNewNum(tok->num);
-    return astNewArg((Ast*) num);
-  } else if (tok->kind == TOKSTR) {
-    AstStr* str = astNewStr(tok->lex);
-    return astNewArg((Ast*) str);
-  } else {
-    return astNewArg(NULL);
-  }
-}
-
-// ============================================================================
+PseErrs* g_pseErrs = NULL;
+
+// ============================================================================
+// Append Ast 'a' onto the chain of Asts, linked via the 'next' pointer in the
+// Ast struct, whose last entry is '*tail'.  Then make 'a' the new tail.
+// Each parse function that builds a list keeps its own tail pointer, so that
+// appending is O(1), rather than a walk along the whole chain
+// ============================================================================
+void pseAppend(Ast** tail, Ast* a) {
+  (*tail)->next = a;
+  *tail = a;
+}
+
+// ============================================================================
+// Arg => Nam | Num | Str
+// ============================================================================
+AstArg* pseArg(Toks* toks) {
+
+  Tok* tok = toksCurr(toks);
+  if (tok->kind == TOKRPAREN) return NULL;    // eg: sayl();
+
+  tok = pseMust(toks, TOKSET(TOKNAM) | TOKSET(TOKNUM) | TOKSET(TOKSTR));
+  if (tok->kind == TOKNAM) {
+    AstNam* nam = astNewNam(tok->lex);
+    return astNewArg((Ast*) nam);
+  } else if (tok->kind == TOKNUM) {
+    AstNum* num = astNewNum(tok->num);
+    return astNewArg((Ast*) num);
+  } else if (tok->kind == TOKSTR) {
+    AstStr* str = astNewStr(tok->lex);
+    return astNewArg((Ast*) str);
+  } else {
+    return astNewArg(NULL);
+  }
+}
+
+// ============================================================================
 // Args => ( Arg ( "," Arg )* ) ?
 // ============================================================================
-AstArg* pseArgs(Toks* toks) {
-  AstArg* args = pseArg(toks);
-  if (args == NULL) return args;      // eg: sayl();
-
-  Tok* tok = toksCurr(toks);
-  while (tok->kind == TOKCOMMA) {
-    tok = toksNext(toks);             // eat TOKCOMMA
-    AstArg* arg = pseArg(toks);
-    pseAppend((Ast*) args, (Ast*) arg);
-    tok = toksCurr(toks);
-  }
-  return args;
-}
-
-// ============================================================================
-// Asg => Nam "=" (Exp | Call) ";"
-// ============================================================================
-AstAsg* pseAsg(Toks* toks) {
-  Tok* tok = pseMust(toks, 1, TOKNAM);            // eg: x
-  pseMust(toks, 1, TOKEQ);                        // eg: =
-  Ast* eoc = NULL;                                // Exp or Call
-  if (pseIsCall(toks)) {
-    eoc = (Ast*) pseCall(toks);
-  } else {
-    eoc = (Ast*) pseExp(toks);
-  }
-  AstNam* nam = astNewNam(tok->lex);
-  pseMust(toks, 1, TOKSEMI);                      // ;
-  return astNewAsg(nam, eoc);
-}
-
-// ============================================================================
+AstArg* pseArgs(Toks* toks) {
+  AstArg* args = pseArg(toks);
+  if (args == NULL) return args;      // eg: sayl();
+
+  Ast* tail = (Ast*) args;
+  Tok* tok = toksCurr(toks);
+  while (tok->kind == TOKCOMMA) {
+    tok = toksNext(toks);             // eat TOKCOMMA
+    AstArg* arg = pseArg(toks);
+    pseAppend(&tail, (Ast*) arg);
+    tok = toksCurr(toks);
+  }
+  return args;
+}
+
+// ============================================================================
+// Asg => Nam "=" (Exp | Call) ";"
+// ============================================================================
+AstAsg* pseAsg(Toks* toks) {
+  Tok* tok = pseMust(toks, TOKSET(TOKNAM));       // eg: x
+  AstNam* nam = astNewNam(tok->lex);              // before 'tok' goes stale
+  pseMust(toks, TOKSET(TOKEQ));                   // eg: =
+  Ast* eoc = NULL;                                // Exp or Call
+  if (pseIsCall(toks)) {
+    eoc = (Ast*) pseCall(toks);
+  } else {
+    eoc = (Ast*) pseExp(toks);
+  }
+  pseMust(toks, TOKSET(TOKSEMI));                 // ;
+  return astNewAsg(nam, eoc);
+}
+
+// ============================================================================
 // Block => "{" Stm+ "}"
 // ============================================================================
 AstBlock* pseBlock(Toks* toks) {
-  pseMust(toks, 1, TOKLBRACE);
-  AstStm* stms = pseStms(toks);
-  pseMust(toks, 1, TOKRBRACE);
+  pseMust(toks, TOKSET(TOKLBRACE));
+  AstStm* stms = pseStms(toks);
+  pseMust(toks, TOKSET(TOKRBRACE));
   return astNewBlock(stms);
-}
-
-// ============================================================================
+}
+
+// ============================================================================
 // Body => "{" Var* Stm+ "}"
 // ============================================================================
-AstBody* pseBody(Toks* toks) {
-  pseMust(toks, 1, TOKLBRACE);
-  AstVar* vars = pseVars(toks);
+AstBody* pseBody(Toks* toks) {
+  pseMust(toks, TOKSET(TOKLBRACE));
+  AstVar* vars = pseVars(toks);
   AstStm* stms = pseStms(toks);
-  pseMust(toks, 1, TOKRBRACE);
+  pseMust(toks, TOKSET(TOKRBRACE));
   return astNewBody(vars, stms);
-}
-
-// ============================================================================
-// Call => Nam "(" Args ")"
-//
-// Eg: add3(x, 15, y)
-// ============================================================================
-AstCall* pseCall(Toks* toks) {
-  Tok* tok = pseMust(toks, 1, TOKNAM);      // eg: "add3"
-  AstNam* nam = astNewNam(tok->lex);
-  pseMust(toks, 1, TOKLPAREN);              // eg: "("
-  AstArg* args = pseArgs(toks);             // eg: "x, 15, y"
-  pseMust(toks, 1, TOKRPAREN);              // eg: ")"
-  return astNewCall(nam, args);
-}
-
-// ============================================================================
-// Exp => NamNum | NamNum Bop NamNum
-// ============================================================================
-AstExp* pseExp(Toks* toks) {
-  AstExp* exp = astNewExp(NULL, BOPNONE, NULL);
-
-  Tok* tok = toksCurr(toks);
-
-  if (tok->kind == TOKNUM) {                  // eg: 42
-    exp->lhs = (Ast*) pseNum(toks);
-  } else if (tok->kind == TOKNAM) {           // eg: abc
-    exp->lhs = (Ast*) pseNam(toks);
-  } else {
-    utDie2Str("pseExp", "Invalid expression");
-  }
-
-  tok = toksCurr(toks);
-  if (tok->kind == TOKSEMI) return exp;
-
-  if (pseIsBop(tok->kind)) {                  // eg: +
-    exp->bop = pseTOKtoBOP(tok->kind);
-    tok = toksNext(toks);
-    if (tok->kind == TOKNUM) {                // eg: 99
-      exp->rhs = (Ast*) pseNum(toks);
-    } else if (tok->kind == TOKNAM) {         // eg: xyz
-      exp->rhs = (Ast*) pseNam(toks);
-    } else {
-      utDie2Str("pseExp", "Invalid expression");
-    }
-  }
-
-  return exp;
-}
-
-// ============================================================================
-// Fun => "int" Nam "(" Pars ")" Body
-// ============================================================================
-AstFun* pseFun(Toks* toks) {
-  pseMust(toks, 1, TOKINT);                             // "int"
-  Tok* tok = pseMust(toks, 1, TOKNAM);                  // eg: cat
-  AstNam* astnam = astNewNam(tok->lex);
-
-  pseMust(toks, 1, TOKLPAREN);
-  AstPar* pars = psePars(toks);                         // eg: int a, int b
-  pseMust(toks, 1, TOKRPAREN);
-
-  AstBody* body = pseBody(toks);
-
-  return astNewFun(astnam, pars, body);
-}
-
-// ============================================================================
-// If => "if" "(" Exp ")" Block
-// ============================================================================
-AstIf* pseIf(Toks* toks) {
-  pseMust(toks, 1, TOKIF);
-  pseMust(toks, 1, TOKLPAREN);
-  AstExp* exp = pseExp(toks);
-  pseMust(toks, 1, TOKRPAREN);
-  AstBlock* block = pseBlock(toks);
-  return astNewIf(exp, block);
-}
-
-// ============================================================================
-// Check whether the current name token (TOKNAM) is the start of an
-// assignment: Asg => Nam "=" Exp ";"
+}
+
+// ============================================================================
+// Call => Nam "(" Args ")"
+//
+// Eg: add3(x, 15, y)
+// ============================================================================
+AstCall* pseCall(Toks* toks) {
+  Tok* tok = pseMust(toks, TOKSET(TOKNAM));   // eg: "add3"
+  AstNam* nam = astNewNam(tok->lex);
+  pseMust(toks, TOKSET(TOKLPAREN));           // eg: "("
+  AstArg* args = pseArgs(toks);               // eg: "x, 15, y"
+  pseMust(toks, TOKSET(TOKRPAREN));           // eg: ")"
+  return astNewCall(nam, args);
+}
+
+// ============================================================================
+// Cond => ( "if" | "while" ) "(" Exp ")"
+//
+// The head of an If or While, whose keyword is given by 'kind'
+// ============================================================================
+AstExp* pseCond(Toks* toks, TokKind kind) {
+  pseMust(toks, TOKSET(kind));
+  pseMust(toks, TOKSET(TOKLPAREN));
+  AstExp* exp = pseExp(toks);
+  pseMust(toks, TOKSET(TOKRPAREN));
+  return exp;
+}
+
+// ============================================================================
+// Add the syntax error found by parse function 'func' at Tok 'tok' - where we
+// were expecting 'msg' - to the list in g_pseErrs.  If that fills the list,
+// report them all, and stop.  Otherwise, if 'jump', resume parsing at the
+// last recovery point (see PseErrs in pse.h)
+// ============================================================================
+void pseErr(Tok* tok, char* func, char* msg, int jump) {
+  PseErrs* errs = g_pseErrs;
+  char line[400];
+  sprintf(line, "ERROR: %s: Found %s but expecting %s at (%d, %d)",
+    func, tokStr(tok->kind), msg, tok->linNum, tok->colNum);
+  int len = strlen(line);
+  char* copy = malloc(len + 1);
+  if (copy == NULL) utDie2Str("pseErr", "malloc failed");
+  memcpy(copy, line, len + 1);                    // with its NUL
+  errs->msg[errs->numErr++] = copy;
+
+  if (errs->numErr == errs->maxErr) {
+    pseErrsReport();
+    printf("Stopped after %d errors (see -maxerr) \n\n", errs->maxErr);
+    utPause();
+  }
+  if (jump) longjmp(errs->inStms ? errs->stm : errs->fun, 1);
+}
+
+// ============================================================================
+// Create a PseErrs, for a parse that stops after 'maxErr' errors
+// ============================================================================
+PseErrs* pseErrsNew(int maxErr) {
+  PseErrs* errs = calloc(1, sizeof(PseErrs));
+  if (errs == NULL) utDie2Str("pseErrsNew", "calloc failed");
+  errs->maxErr = maxErr;
+  errs->msg = calloc(maxErr, sizeof(char*));
+  if (errs->msg == NULL) utDie2Str("pseErrsNew", "calloc failed");
+  return errs;
+}
+
+// ============================================================================
+// Print every error listed in g_pseErrs
+// ============================================================================
+void pseErrsReport() {
+  printf("\n\n");
+  for (int e = 0; e < g_pseErrs->numErr; ++e) printf("%s \n", g_pseErrs->msg[e]);
+  printf("\n");
+}
+
+// ============================================================================
+// Exp => NamNum | NamNum Bop NamNum
+// ============================================================================
+AstExp* pseExp(Toks* toks) {
+  Ast* lhs = NULL;                            // build the AstExp only once its
+  BOP  bop = BOPNONE;                         // parts are known, since it may
+  Ast* rhs = NULL;                            // be shared (see AstCons)
+
+  Tok* tok = toksCurr(toks);
+
+  if (tok->kind == TOKNUM) {                  // eg: 42
+    lhs = (Ast*) pseNum(toks);
+  } else if (tok->kind == TOKNAM) {           // eg: abc
+    lhs = (Ast*) pseNam(toks);
+  } else {
+    if (g_pseErrs == NULL) utDie2Str("pseExp", "Invalid expression");
+    pseErr(tok, "pseExp", "an expression", 1);
+  }
+
+  tok = toksCurr(toks);
+  if (tok->kind == TOKSEMI) return astNewExp(lhs, bop, rhs);
+
+  if (pseIsBop(tok->kind)) {                  // eg: +
+    bop = pseTOKtoBOP(tok->kind);
+    tok = toksNext(toks);
+    if (tok->kind == TOKNUM) {                // eg: 99
+      rhs = (Ast*) pseNum(toks);
+    } else if (tok->kind == TOKNAM) {         // eg: xyz
+      rhs = (Ast*) pseNam(toks);
+    } else {
+      if (g_pseErrs == NULL) utDie2Str("pseExp", "Invalid expression");
+      pseErr(tok, "pseExp", "an expression", 1);
+    }
+  }
+
+  return astNewExp(lhs, bop, rhs);
+}
+
+// ============================================================================
+// Append 'stm' onto the list of statements collected so far in 'frame'
+// ============================================================================
+void pseFrameAdd(PseFrame* frame, AstStm* stm) {
+  if (frame->stms == NULL) {
+    frame->stms = stm;
+    frame->tail = (Ast*) stm;
+  } else {
+    pseAppend(&frame->tail, (Ast*) stm);
+  }
+}
+
+// ============================================================================
+// Fun => "int" Nam "(" Pars ")" Body
+// ============================================================================
+AstFun* pseFun(Toks* toks) {
+  pseMust(toks, TOKSET(TOKINT));                        // "int"
+  Tok* tok = pseMust(toks, TOKSET(TOKNAM));             // eg: cat
+  AstNam* astnam = astNewNam(tok->lex);
+
+  pseMust(toks, TOKSET(TOKLPAREN));
+  AstPar* pars = psePars(toks);                         // eg: int a, int b
+  pseMust(toks, TOKSET(TOKRPAREN));
+
+  AstBody* body = pseBody(toks);
+
+  return astNewFun(astnam, pars, body);
+}
+
+// ============================================================================
+// pseFun, for a parse that recovers from errors (see PseErrs in pse.h).  If
+// there is an error outside any Stm, return NULL, after skipping the rest of
+// the function.  Except that, after an error in its head, we skip only to its
+// Body, which we parse, so as to report any errors in there too.  ('inBody'
+// is volatile since it changes after the setjmp; 'start' does not)
+// ============================================================================
+AstFun* pseFunRecover(Toks* toks) {
+  int start = toks->tokNum;
+  volatile int inBody = 0;
+  g_pseErrs->inStms = 0;
+  if (setjmp(g_pseErrs->fun)) {
+    if (pseSyncFun(toks, start) && !inBody) {     // at the Body's "{"
+      inBody = 1;
+      pseBody(toks);
+    }
+    return NULL;
+  }
+  return pseFun(toks);
+}
+
+// ============================================================================
+// If => "if" "(" Exp ")" Block
+// ============================================================================
+AstIf* pseIf(Toks* toks) {
+  AstExp* exp = pseCond(toks, TOKIF);
+  AstBlock* block = pseBlock(toks);
+  return astNewIf(exp, block);
+}
+
+// ============================================================================
+// Check whether the current name token (TOKNAM) is the start of an
+// assignment: Asg => Nam "=" Exp ";"
 // (It might equally well be the start of a function call)
 // ============================================================================
-int pseIsAsg(Toks* toks) {
-  Tok* tok = toksPeek(toks);
-  return tok->kind == TOKEQ;
+int pseIsAsg(Toks* toks) {
+  Tok* tok = toksPeek(toks);
+  return tok->kind == TOKEQ;
 }
 
-// ============================================================================
+// ============================================================================
 // Check whether the Token kind specified by 'k' is legal binary operator
 // ============================================================================
 int pseIsBop(TokKind k) {
@@ -185,130 +282,141 @@ int pseIsBop(TokKind k) {
           k == TOKLE  || k == TOKLT  || k == TOKNE  || k == TOKEEQ ||
           k == TOKGE  || k == TOKGT  || k == TOKLE  || k == TOKLT  ||
           k == TOKNE  || k == TOKEEQ || k == TOKGE  || k == TOKGT);
-}
-
+}
+
 // ============================================================================
-// Check whether the current name token (TOKNAM) is the start of a function
-// call, such as "cmp(3, 4)"
+// Check whether the current name token (TOKNAM) is the start of a function
+// call, such as "cmp(3, 4)"
 // ============================================================================
-int pseIsCall(Toks* toks) {
-  Tok* tok = toksPeek(toks);
-  return tok->kind == TOKLPAREN;
-}
+int pseIsCall(Toks* toks) {
+  Tok* tok = toksPeek(toks);
+  return tok->kind == TOKLPAREN;
+}
 
-// ============================================================================
-// Check that the current Token within 'toks' matches any of the 'numk'
-// kinds in the varargs list.  If yes, advance to the next Token in 'toks'.
-// If not, abort the program
+// ============================================================================
+// Check that the kind of the current Token within 'toks' is a member of the
+// TokSet 'set'.  If yes, advance to the next Token in 'toks'.  If not, abort
+// the program
 //
-// eg: pseMust(toks, 2, TOKNAM, TOKNUM)
+// eg: pseMust(toks, TOKSET(TOKNAM) | TOKSET(TOKNUM))
 // In this example, if the current Token does not match TOKNAM or TOKNUM,
 // we build a diagnostic text in 'msg' and call dieStrTokStr to print a
 // message like:
 //    "ERROR: pseFun: Found TOKLET but expecting {TOKNAM, TOKNUM}"
+//
+// Every token the parser consumes passes through here, so the success path
+// is just one AND: the diagnostic is only built once we know we have failed
 // ============================================================================
-Tok* pseMust(Toks* toks, int numk, ...) {
-
-  // Prepare a failure message, just in case
-
-  va_list argp;
-  va_start(argp, numk);
-  char msg[300] = "{";
-  TokKind k;
-
-  for (int i = 1; i <= numk - 1; ++i) {
-    k = va_arg(argp, TokKind);
-    strcat(msg, tokStr(k));   strcat(msg, ", ");
-  }
-  k = va_arg(argp, TokKind);
-  strcat(msg, tokStr(k));     strcat(msg, "}");
-  va_end(argp);
-
-  // Now process the actual request
-
-  if (toksAtEnd(toks)) {
-    Tok* tok = tokNew(TOKBAD, "No more tokens", 0, NULL, 999, 999);
-    utDieStrTokStr("pseMust", tok, msg);
-  }
-
-  Tok* tok = toksCurr(toks);
-
-  va_start(argp, numk);                   // number of TokKind's
-  for (int i = 1; i <= numk; ++i) {
-    k = va_arg(argp, TokKind);
-    if (tok->kind == k) {
+Tok* pseMust(Toks* toks, TokSet set) {
+  if (!toksAtEnd(toks)) {
+    Tok* tok = &toks->tok[toks->tokNum & toks->mask];
+    if (set & TOKSET(tok->kind)) {
       toksNext(toks);
       return tok;
     }
   }
-  va_end(argp);
+  pseMustFail(toks, set);
+  return NULL;
+}
 
-  // Failed to find a match.  So emit the diagnostic
+// ============================================================================
+// Report that the current Token within 'toks' is not a member of 'set', and
+// abort.  (The failure path for pseMust)
+// ============================================================================
+void pseMustFail(Toks* toks, TokSet set) {
+  char msg[300];
+  tokSetStr(set, msg);
 
-  utDieStrTokStr("pseMust", tok, msg);
-  return NULL;
+  Tok* tok = toksAtEnd(toks)
+    ? tokNew(TOKBAD, "No more tokens", 0, NULL, 999, 999)
+    : toksCurr(toks);
+  if (g_pseErrs == NULL) utDieStrTokStr("pseMust", tok, msg);
+  pseErr(tok, "pseMust", msg, 1);
 }
-
-// ============================================================================
-// Nam => Alpha AlphaNum*
-// ============================================================================
-AstNam* pseNam(Toks* toks) {
-  Tok* tok = pseMust(toks, 1, TOKNAM);
-  return astNewNam(tok->lex);
+
+// ============================================================================
+// Nam => Alpha AlphaNum*
+// ============================================================================
+AstNam* pseNam(Toks* toks) {
+  Tok* tok = pseMust(toks, TOKSET(TOKNAM));
+  return astNewNam(tok->lex);
 }
-
-// ============================================================================
+
+// ============================================================================
 // Num => [0-9]+
 // ============================================================================
 AstNum* pseNum(Toks* toks) {
-  Tok* tok = pseMust(toks, 1, TOKNUM);
+  Tok* tok = pseMust(toks, TOKSET(TOKNUM));
   return astNewNum(tok->num);
-}
-
-// ============================================================================
-// Par => "int" Nam
-// ============================================================================
-AstPar* psePar(Toks* toks) {
-  Tok* tok = toksCurr(toks);
-  if (tok->kind == TOKRPAREN) return NULL;     // no parameters
-
-  pseMust(toks, 1, TOKINT);
-  AstNam* astnam = pseNam(toks);
-
-  return  astNewPar(astnam);
-}
-
-// ============================================================================
+}
+
+// ============================================================================
+// Par => "int" Nam
+// ============================================================================
+AstPar* psePar(Toks* toks) {
+  Tok* tok = toksCurr(toks);
+  if (tok->kind == TOKRPAREN) return NULL;     // no parameters
+
+  pseMust(toks, TOKSET(TOKINT));
+  AstNam* astnam = pseNam(toks);
+
+  return  astNewPar(astnam);
+}
+
+// ============================================================================
 // Pars => ( Par ( "," Par )* ) ?
 // eg: ( int i , int j )
 // ============================================================================
-AstPar* psePars(Toks* toks) {
-  AstPar* pars = psePar(toks);
-  Tok* tok = toksCurr(toks);
-  while (tok->kind == TOKCOMMA) {
-    tok = toksNext(toks);                     // eat TOKCOMMA
-    AstPar* par = psePar(toks);
-    pseAppend((Ast*) pars, (Ast*) par);
-    tok = toksCurr(toks);
-  }
-  return pars;
-}
-
-// ============================================================================
-// Prog => Fun+
-// ============================================================================
-AstProg* pseProg(Toks* toks) {
-  AstFun* fun = pseFun(toks);                 // first function
-  AstProg* prog = astNewProg(fun);
-  while (toks->tokNum <= toks->hiTokNum) {
-    AstFun* funNext = pseFun(toks);           // next function
-    pseAppend((Ast*) fun, (Ast*) funNext);    // append onto funs chain
-    fun = funNext;                            // move along chain
-  }
-  return prog;
-}
-
-// ============================================================================
+AstPar* psePars(Toks* toks) {
+  AstPar* pars = psePar(toks);
+  Ast* tail = (Ast*) pars;
+  Tok* tok = toksCurr(toks);
+  while (tok->kind == TOKCOMMA) {
+    tok = toksNext(toks);                     // eat TOKCOMMA
+    AstPar* par = psePar(toks);
+    pseAppend(&tail, (Ast*) par);
+    tok = toksCurr(toks);
+  }
+  return pars;
+}
+
+// ============================================================================
+// Prog => Fun+
+// ============================================================================
+AstProg* pseProg(Toks* toks) {
+  if (g_pseErrs) return pseProgRecover(toks);
+
+  AstFun* fun = pseFun(toks);                 // first function
+  AstProg* prog = astNewProg(fun);
+  Ast* tail = (Ast*) fun;
+  while (!toksAtEnd(toks)) {
+    AstFun* funNext = pseFun(toks);           // next function
+    pseAppend(&tail, (Ast*) funNext);         // append onto funs chain
+  }
+  return prog;
+}
+
+// ============================================================================
+// pseProg, for a parse that recovers from errors.  A function that had an
+// error outside any Stm is left out
+// ============================================================================
+AstProg* pseProgRecover(Toks* toks) {
+  AstProg* prog = astNewProg(NULL);
+  Ast* tail = NULL;
+  do {
+    AstFun* fun = pseFunRecover(toks);
+    if (fun == NULL) continue;
+    if (tail == NULL) {
+      prog->funs = fun;
+      tail = (Ast*) fun;
+    } else {
+      pseAppend(&tail, (Ast*) fun);
+    }
+  } while (!toksAtEnd(toks));
+  return prog;
+}
+
+// ============================================================================
 // Reporter function for debugging
 // ============================================================================
 void pseRep(Toks* toks, char* s) {
@@ -317,117 +425,237 @@ void pseRep(Toks* toks, char* s) {
   printf("%s %s \n", tokStr(tok->kind), tok->lex);
 }
 
-// ============================================================================
+// ============================================================================
 // Ret => "return" Exp ";"
 // ============================================================================
 AstRet* pseRet(Toks* toks) {
-  pseMust(toks, 1, TOKRET);
-  AstExp* exp = pseExp(toks);
-  pseMust(toks, 1, TOKSEMI);
+  pseMust(toks, TOKSET(TOKRET));
+  AstExp* exp = pseExp(toks);
+  pseMust(toks, TOKSET(TOKSEMI));
   return astNewRet(exp);
 }
 
-// ============================================================================
-// Stm => If | Asg | Ret | While
-// ============================================================================
-AstStm* pseStm(Toks* toks) {
-  Tok* tok = toksCurr(toks);
-  TokKind k = tok->kind;
-  if (k == TOKIF) {
-    return (AstStm*) pseIf(toks);
-  } else if (k == TOKNAM) {
-    return (AstStm*) pseAsg(toks);
-  } else if (k == TOKRET) {
-    return (AstStm*) pseRet(toks);
-  } else if (k == TOKWHILE) {
-    return (AstStm*) pseWhile(toks);
-  }
-  utDieStrTokStr("pseStm", tok, "a statement");
-  return NULL;
-}
-
-// ============================================================================
+// ============================================================================
+// Stm => If | Asg | Ret | While
+// ============================================================================
+AstStm* pseStm(Toks* toks) {
+  Tok* tok = toksCurr(toks);
+  TokKind k = tok->kind;
+  if (k == TOKIF) {
+    return (AstStm*) pseIf(toks);
+  } else if (k == TOKNAM) {
+    return (AstStm*) pseAsg(toks);
+  } else if (k == TOKRET) {
+    return (AstStm*) pseRet(toks);
+  } else if (k == TOKWHILE) {
+    return (AstStm*) pseWhile(toks);
+  }
+  if (g_pseErrs == NULL) utDieStrTokStr("pseStm", tok, "a statement");
+  pseErr(tok, "pseStm", "a statement", 1);
+  return NULL;
+}
+
+// ============================================================================
 // Stms => Stm+
+//
+// An If or While holds a Block, which holds more Stms.  So plain recursive
+// descent (pseStms -> pseStm -> pseIf -> pseBlock -> pseStms) would use C
+// stack in proportion to how deeply the source nests its blocks, and overflow
+// on machine-generated SubC.  Instead we keep an explicit, heap-allocated,
+// stack of the Blocks currently open.  An If or While head pushes a frame;
+// its closing "}" pops that frame, builds the If or While, and appends it to
+// the enclosing frame.  frame[0] collects the Stms we were called to parse,
+// up to (but not including) the "}" that ends them
+//
+// When recovering from errors, this is where we resume after an error in a
+// Stm (see PseErrs).  The stack survives the longjmp, but only if 'frame',
+// 'maxFrame' and 'hi' are volatile: they change after the setjmp
 // ============================================================================
 AstStm* pseStms(Toks* toks) {
-  AstStm* stms = pseStm(toks);
+  volatile int maxFrame = 16;
+  PseFrame* volatile frame = malloc(maxFrame * sizeof(PseFrame));
+  if (frame == NULL) utDie2Str("pseStms", "malloc failed");
 
-  Tok* tok = toksCurr(toks);
-  while (tok->kind != TOKRBRACE) {
-    AstStm* stm = pseStm(toks);
-    pseAppend((Ast*)stms, (Ast*)stm);
-    tok = toksCurr(toks);
+  volatile int hi = 0;                            // top of stack
+  frame[0] = (PseFrame) { TOKBAD, NULL, NULL, NULL };
+  volatile int errHi = -1;                        // frame with a bad Stm
+
+  PseErrs* errs = g_pseErrs;
+  jmp_buf outer;                                  // caller's 'stm'
+  int outerIn = 0;
+  if (errs) {
+    memcpy(outer, errs->stm, sizeof(jmp_buf));
+    outerIn = errs->inStms;
+    if (setjmp(errs->stm)) {                      // back from an error
+      errHi = hi;                                 // so it is not "empty"
+      if (toksAtEnd(toks)) {                      // nothing to resume: give
+        memcpy(errs->stm, outer, sizeof(jmp_buf));  // up on this function
+        errs->inStms = outerIn;
+        longjmp(errs->fun, 1);
+      }
+      if (pseSyncStm(toks)) {                     // ate a "{": open a Block
+        if (++hi == maxFrame) {
+          maxFrame *= 2;
+          frame = realloc(frame, maxFrame * sizeof(PseFrame));
+          if (frame == NULL) utDie2Str("pseStms", "realloc failed");
+        }
+        frame[hi] = (PseFrame) { TOKIF, NULL, NULL, NULL };
+      }
+    }
+    errs->inStms = 1;
   }
+
+  for (;;) {
+    Tok* tok = toksCurr(toks);
+    TokKind k = tok->kind;
+    if (k == TOKRBRACE) {
+      if (frame[hi].stms == NULL && hi != errHi) {
+        if (errs == NULL) utDieStrTokStr("pseStm", tok, "a statement");
+        pseErr(tok, "pseStm", "a statement", 0);
+      }
+      if (hi == errHi) errHi = -1;
+      if (hi == 0) break;
+      toksNext(toks);                             // eat "}"
+      PseFrame* top = &frame[hi--];
+      AstBlock* block = astNewBlock(top->stms);
+      AstStm* stm = top->kind == TOKIF
+        ? (AstStm*) astNewIf(top->exp, block)
+        : (AstStm*) astNewWhile(top->exp, block);
+      pseFrameAdd(&frame[hi], stm);
+    } else if (k == TOKIF || k == TOKWHILE) {
+      AstExp* exp = pseCond(toks, k);
+      pseMust(toks, TOKSET(TOKLBRACE));
+      if (++hi == maxFrame) {
+        maxFrame *= 2;
+        frame = realloc(frame, maxFrame * sizeof(PseFrame));
+        if (frame == NULL) utDie2Str("pseStms", "realloc failed");
+      }
+      frame[hi] = (PseFrame) { k, exp, NULL, NULL };
+    } else {
+      pseFrameAdd(&frame[hi], pseStm(toks));
+    }
+  }
+
+  if (errs) {
+    memcpy(errs->stm, outer, sizeof(jmp_buf));
+    errs->inStms = outerIn;
+  }
+
+  AstStm* stms = frame[0].stms;
+  free(frame);
   return stms;
 }
 
-// ============================================================================
-// Parse a string literal, such as "hello world"
-// ============================================================================
-AstStr* pseStr(Toks* toks) {
-  Tok* tok = pseMust(toks, 1, TOKSTR);
-  return astNewStr(tok->lex);
-}
-
-// ============================================================================
-// Var => "int" Nam ";"
-// ============================================================================
-AstVar* pseVar(Toks* toks) {
-  Tok* tok = toksCurr(toks);
-  if (tok->kind != TOKINT) return NULL;
-
-  pseMust(toks, 1, TOKINT);
-  Tok* tokNam = pseMust(toks, 1, TOKNAM);           // eg: count
-  pseMust(toks, 1, TOKSEMI);                        // ";"
-  AstNam* astnam = astNewNam(tokNam->lex);
-  return astNewVar(astnam);                         // eg: count, int
-}
-
-
-// ============================================================================
+// ============================================================================
+// Parse a string literal, such as "hello world"
+// ============================================================================
+AstStr* pseStr(Toks* toks) {
+  Tok* tok = pseMust(toks, TOKSET(TOKSTR));
+  return astNewStr(tok->lex);
+}
+
+// ============================================================================
+// Recover from an error outside any Stm of the function that starts at Tok
+// number 'start'.  If we are still in its head, skip up to the "{" of its
+// Body, and return 1.  Otherwise skip past the "}" that ends it, and return
+// 0.  Count the braces from 'start' to find how deep we are.  (So this needs
+// a Toks array, not a stream, which may have dropped those Toks)
+// ============================================================================
+int pseSyncFun(Toks* toks, int start) {
+  int depth = 0;
+  for (int t = start; t < toks->tokNum && t <= toks->hiTokNum; ++t) {
+    if (toks->tok[t].kind == TOKLBRACE) ++depth;
+    if (toks->tok[t].kind == TOKRBRACE) --depth;
+  }
+
+  if (depth == 0) {                               // in the head
+    while (!toksAtEnd(toks) && toksCurr(toks)->kind != TOKLBRACE) toksNext(toks);
+    return !toksAtEnd(toks);
+  }
+
+  while (!toksAtEnd(toks)) {
+    TokKind k = toksCurr(toks)->kind;
+    toksNext(toks);
+    if (k == TOKLBRACE) ++depth;
+    if (k == TOKRBRACE && --depth == 0) break;
+  }
+  return 0;
+}
+
+// ============================================================================
+// Recover from an error in a Stm: skip to just past the next ";", or up to
+// the next "}", whichever comes first.  But if we meet a "{" first, skip past
+// it, and return 1, so that the caller opens a Block for it (as it most
+// likely is, after a bad If or While head).  Else return 0
+// ============================================================================
+int pseSyncStm(Toks* toks) {
+  while (!toksAtEnd(toks)) {
+    TokKind k = toksCurr(toks)->kind;
+    if (k == TOKRBRACE) return 0;
+    toksNext(toks);
+    if (k == TOKSEMI) return 0;
+    if (k == TOKLBRACE) return 1;
+  }
+  return 0;
+}
+
+// ============================================================================
+// Var => "int" Nam ";"
+// ============================================================================
+AstVar* pseVar(Toks* toks) {
+  Tok* tok = toksCurr(toks);
+  if (tok->kind != TOKINT) return NULL;
+
+  pseMust(toks, TOKSET(TOKINT));
+  Tok* tokNam = pseMust(toks, TOKSET(TOKNAM));      // eg: count
+  pseMust(toks, TOKSET(TOKSEMI));                   // ";"
+  AstNam* astnam = astNewNam(tokNam->lex);
+  return astNewVar(astnam);                         // eg: count, int
+}
+
+
+// ============================================================================
 // Vars => Var*
 // ============================================================================
-AstVar* pseVars(Toks* toks) {
-  AstVar* vars = pseVar(toks);
-  if (vars == NULL) return NULL;
-
-  AstVar* var = pseVar(toks);
-  while (var != NULL) {
-    pseAppend((Ast*) vars, (Ast*) var);
-    var = pseVar(toks);
-  }
-  return vars;
+AstVar* pseVars(Toks* toks) {
+  AstVar* vars = pseVar(toks);
+  if (vars == NULL) return NULL;
+
+  Ast* tail = (Ast*) vars;
+  AstVar* var = pseVar(toks);
+  while (var != NULL) {
+    pseAppend(&tail, (Ast*) var);
+    var = pseVar(toks);
+  }
+  return vars;
 }
 
-// ============================================================================
-// While => "while" "(" Exp ")" Block
+// ============================================================================
+// While => "while" "(" Exp ")" Block
 //
 // eg: while (n < 10) { n = n + 1 ; }
 // ============================================================================
-AstWhile* pseWhile(Toks* toks) {
-  pseMust(toks, 1, TOKWHILE);
-  pseMust(toks, 1, TOKLPAREN);
-  AstExp* exp = pseExp(toks);
-  pseMust(toks, 1, TOKRPAREN);
-  AstBlock* block = pseBlock(toks);
+AstWhile* pseWhile(Toks* toks) {
+  AstExp* exp = pseCond(toks, TOKWHILE);
+  AstBlock* block = pseBlock(toks);
   return astNewWhile(exp, block);
 }
 
-// ============================================================================
-// Convert TOK* to corresponding BOP*
-// ============================================================================
-BOP pseTOKtoBOP(TokKind k) {
-  switch(k) {
-    case TOKADD: return BOPADD;
-    case TOKSUB: return BOPSUB;
-    case TOKMUL: return BOPMUL;
-    case TOKLE:  return BOPLE;
-    case TOKLT:  return BOPLT;
-    case TOKNE:  return BOPNE;
-    case TOKEEQ: return BOPEEQ;
-    case TOKGE:  return BOPGE;
-    case TOKGT:  return BOPGT;
-    default:     utDie2Str("TOKtoBOP", "Invalid input token");
-  }
-  return BOPBAD;               // pacify the compiler
+// ============================================================================
+// Convert TOK* to corresponding BOP*
+// ============================================================================
+BOP pseTOKtoBOP(TokKind k) {
+  switch(k) {
+    case TOKADD: return BOPADD;
+    case TOKSUB: return BOPSUB;
+    case TOKMUL: return BOPMUL;
+    case TOKLE:  return BOPLE;
+    case TOKLT:  return BOPLT;
+    case TOKNE:  return BOPNE;
+    case TOKEEQ: return BOPEEQ;
+    case TOKGE:  return BOPGE;
+    case TOKGT:  return BOPGT;
+    default:     utDie2Str("TOKtoBOP", "Invalid input token");
+  }
+  return BOPBAD;               // pacify the compiler
 }
\ No newline at end of file
@@ -2,39 +2,85 @@
 
 #pragma once
 
-#include <stdarg.h>
+#include <setjmp.h>     // jmp_buf
 
 #include "ast.h"        // AstBody, etc
 #include "toks.h"       // Toks
 
-AstArg*    pseArg    (Toks* toks);
-AstArg*    pseArgs   (Toks* toks);
+// A Block, opened by an If or While, whose Stms are still being parsed.
+// pseStms keeps a stack of these, in place of recursion
+
+typedef struct {
+  TokKind  kind;        // TOKIF or TOKWHILE
+  AstExp*  exp;         // its condition
+  AstStm*  stms;        // Stms parsed so far ...
+  Ast*     tail;        // ... and the last of them
+} PseFrame;
+
+// Panic-mode error recovery (the -maxerr option).  Normally, the parser dies
+// at the first syntax error.  But if g_pseErrs is set, each error is added to
+// its list instead, and the parser longjmps back to the last point from which
+// it can resume:
+//
+//    'stm' : set by pseStms.  Skip to just past the next ";", or up to the
+//            next "}", and carry on with the next Stm of the same Block
+//            (see pseSyncStm)
+//    'fun' : set by pseFunRecover, for errors outside any Stm.  Skip past the
+//            "}" that ends the function, and carry on with the next.  But
+//            after an error in its head, skip just to its Body, and parse that
+//
+// Once 'maxErr' errors are listed, report them all, and stop.  So the path
+// that finds no errors costs no more than one setjmp per function
+
+typedef struct {
+  int      maxErr;      // stop once this many are found
+  int      numErr;      // errors found so far ...
+  char**   msg;         // ... and their diagnostics
+  int      inStms;      // 1 => resume at 'stm', else at 'fun'
+  jmp_buf  stm;
+  jmp_buf  fun;
+} PseErrs;
+
+extern PseErrs* g_pseErrs;  // NULL => die at the first error
+
+AstArg*    pseArg    (Toks* toks);
+AstArg*    pseArgs   (Toks* toks);
 AstAsg*    pseAsg    (Toks* toks);
-AstBlock*  pseBlock  (Toks* toks);
+AstBlock*  pseBlock  (Toks* toks);
 AstBody*   pseBody   (Toks* toks);
 AstCall*   pseCall   (Toks* toks);
+AstExp*    pseCond   (Toks* toks, TokKind kind);
+void       pseErr    (Tok* tok, char* func, char* msg, int jump);
+PseErrs*   pseErrsNew(int maxErr);
+void       pseErrsReport();
 AstExp*    pseExp    (Toks* toks);
+void       pseFrameAdd(PseFrame* frame, AstStm* stm);
 AstFun*    pseFun    (Toks* toks);
-AstIf*     pseIf     (Toks* toks);
-int        pseIsAsg  (Toks* toks);
-int        pseIsBop  (TokKind k);
-int        pseIsCall (Toks* toks);
-Tok*       pseMust   (Toks* toks, int numk, ...);
-AstNam*    pseNam    (Toks* toks);
+AstFun*    pseFunRecover(Toks* toks);
+AstIf*     pseIf     (Toks* toks);
+int        pseIsAsg  (Toks* toks);
+int        pseIsBop  (TokKind k);
+int        pseIsCall (Toks* toks);
+Tok*       pseMust   (Toks* toks, TokSet set);
+void       pseMustFail(Toks* toks, TokSet set);
+AstNam*    pseNam    (Toks* toks);
 AstNum*    pseNum    (Toks* toks);
-AstPar*    psePar    (Toks* toks);
+AstPar*    psePar    (Toks* toks);
 AstPar*    psePars   (Toks* toks);
-AstProg*   pseProg   (Toks* toks);
+AstProg*   pseProg   (Toks* toks);
+AstProg*   pseProgRecover(Toks* toks);
 void       pseRep    (Toks* toks, char* s);
 AstRet*    pseRet    (Toks* toks);
 AstStm*    pseStm    (Toks* toks);
 AstStm*    pseStms   (Toks* toks);
-AstStr*    pseStr    (Toks* toks);
+AstStr*    pseStr    (Toks* toks);
+int        pseSyncFun(Toks* toks, int start);
+int        pseSyncStm(Toks* toks);
 AstVar*    pseVar    (Toks* toks);
 AstVar*    pseVars   (Toks* toks);
 AstWhile*  pseWhile  (Toks* toks);
 
-BOP pseTOKtoBOP(TokKind k);
-
-void pseAppend(Ast* as, Ast* a);
+BOP pseTOKtoBOP(TokKind k);
+
+void pseAppend(Ast** tail, Ast* a);
 
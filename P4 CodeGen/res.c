@@ -0,0 +1,71 @@
+// res.c - Name Resolution
+//
+// See res.h
+
+#include "res.h"
+
+// ============================================================================
+// Pre hook for Fun: find the start of its Layout
+// ============================================================================
+WALK resFun(Walk* walk, Ast* ast) {
+  Res* res = walk->ctx;
+  res->fun = (AstFun*) ast;
+  res->funIdx = layFindFunIdx(res->lay, res->fun->nam->lex);
+  return WALKGO;
+}
+
+// ============================================================================
+// Pre hook for Nam.  Bind it to the Par or Var that it names, in the current
+// function.  If it names a function - its parent is a Fun or a Call - check
+// just that the function exists.  Report a name that is neither.
+// ============================================================================
+WALK resNam(Walk* walk, Ast* ast) {
+  Res* res = walk->ctx;
+  AstNam* nam = (AstNam*) ast;
+
+  char* kind = "variable";
+  AST parent = walkParent(walk)->kind;
+  if (parent == ASTFUN) return WALKGO;            // the function's own name
+  if (parent == ASTCALL) {
+    if (layFunIdx(res->lay, nam->lex) >= 0) return WALKGO;
+    kind = "function";
+  } else if (nam->fun == res->fun) {              // bound already: shared Nam
+    return WALKGO;
+  } else {
+    int idx = layVarParIdx(res->lay, res->funIdx, nam->lex);
+    if (idx >= 0) {
+      nam->fun  = res->fun;
+      nam->slot = idx - res->funIdx - 1;
+      nam->off  = res->lay->row[idx].off;
+      return WALKGO;
+    }
+  }
+
+  printf("ERROR: resNam: Cannot find %s %s in function %s \n",
+    kind, nam->lex, res->fun->nam->lex);
+  ++res->numErr;
+  return WALKGO;
+}
+
+// ============================================================================
+// Lay out every function of 'prog' into 'lay', after the intrinsics says,
+// sayn and sayl.  Then resolve every name.  Stop if any cannot be.
+// ============================================================================
+void resProg(Lay* lay, AstProg* prog) {
+  layBuildIntrinsics(lay);
+  for (AstFun* fun = prog->funs; fun; fun = (AstFun*) fun->next) {
+    layBuild(lay, fun);
+  }
+
+  Res res = { lay, NULL, 0, 0 };
+  Walk* walk = walkNew(&res);
+  walkOn(walk, ASTFUN, resFun, NULL);
+  walkOn(walk, ASTNAM, resNam, NULL);
+  walkRun(walk, (Ast*) prog);
+  walkFree(walk);
+
+  if (res.numErr) {
+    printf("\n%d names not found \n\n", res.numErr);
+    utPause();
+  }
+}
@@ -0,0 +1,28 @@
+// res.h - Name Resolution
+
+#pragma once
+
+#include "ast.h"            // Ast*
+#include "lay.h"            // Lay, layBuild
+#include "walk.h"           // walkRun
+
+// resProg runs between parsing and codegen.  It lays out the frame of every
+// function (layBuild), then walks each function, and binds each Nam that
+// names a Par or Var to that Par or Var: the Fun that declares it, its slot
+// (Pars first, then Vars, from 0) and its offset from FP.  Codegen then
+// reads the offset straight from the Nam.  The name of a called function is
+// checked, but not bound.
+//
+// Every name that cannot be resolved is reported, here, before any code is
+// generated.  If there are any, resProg stops the compile.
+
+typedef struct {
+  Lay*     lay;
+  AstFun*  fun;             // function being resolved
+  int      funIdx;          // index of its ROLEFUN row in 'lay'
+  int      numErr;          // names not found, so far
+} Res;
+
+WALK resFun (Walk* walk, Ast* ast);
+WALK resNam (Walk* walk, Ast* ast);
+void resProg(Lay* lay, AstProg* prog);
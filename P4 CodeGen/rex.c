@@ -0,0 +1,392 @@
+// rex.c - Syntax-check-only Recognizer for SubC - see rex.h
+//
+// Each rex* function below that checks a part of the grammar returns 1 if it
+// found no error, or else reports the first error it found, and returns 0,
+// leaving its caller to recover (see rexRecover).  The Stms of a function are
+// checked in a loop, with a count of the Blocks open, rather than by
+// recursion: since we build nothing, no more is needed.
+
+#include "rex.h"
+
+// ============================================================================
+// Args => ( Arg ( "," Arg )* ","? ) ?
+// Arg  => Nam | Num | Str
+//
+// As in pseArgs, the last Arg may be followed by a ",": eg: f(a, b, )
+// ============================================================================
+int rexArgs(Rex* rex) {
+  TokSet arg = TOKSET(TOKNAM) | TOKSET(TOKNUM) | TOKSET(TOKSTR);
+  if (rex->kind == TOKRPAREN) return 1;           // eg: sayl()
+  if (!rexMust(rex, arg)) return 0;
+  while (rex->kind == TOKCOMMA) {
+    rexNext(rex);                                 // eat ","
+    if (rex->kind == TOKRPAREN) return 1;         // eg: f(a, )
+    if (!rexMust(rex, arg)) return 0;
+  }
+  return 1;
+}
+
+// ============================================================================
+// Asg => Nam "=" (Exp | Call) ";"
+// Call => Nam "(" Args ")"
+//
+// After the "=", any Token followed by "(" starts a Call, as in pseIsCall;
+// otherwise an Exp
+// ============================================================================
+int rexAsg(Rex* rex) {
+  rexNext(rex);                                   // eat Nam
+  if (!rexMust(rex, TOKSET(TOKEQ))) return 0;
+  if (rexPeek(rex) == TOKLPAREN) {                // Call
+    if (!rexMust(rex, TOKSET(TOKNAM))
+      || !rexMust(rex, TOKSET(TOKLPAREN))
+      || !rexArgs(rex)
+      || !rexMust(rex, TOKSET(TOKRPAREN))) return 0;
+  } else if (!rexExp(rex)) {                      // Exp
+    return 0;
+  }
+  return rexMust(rex, TOKSET(TOKSEMI));
+}
+
+// ============================================================================
+// Body  => "{" Var* Stm+ "}"
+// Var   => "int" Nam ";"
+// Block => "{" Stm+ "}"
+//
+// 'depth' counts the Blocks open, including the Body itself.  'empty' is 1
+// until a Stm is found in the innermost, since Stm+ needs at least one.  A
+// Tok that can only start a new function ("int") means this one has lost its
+// closing "}": report it, and return, so that rexProg can carry on from there
+// ============================================================================
+void rexBody(Rex* rex) {
+  if (!rexMust(rex, TOKSET(TOKLBRACE))) return;
+
+  while (rex->kind == TOKINT) {                   // Var*
+    rexNext(rex);
+    if (!rexMust(rex, TOKSET(TOKNAM)) || !rexMust(rex, TOKSET(TOKSEMI))) {
+      rexRecover(rex);
+    }
+  }
+
+  int depth = 1;
+  int empty = 1;
+  for (;;) {
+    TokKind k = rex->kind;
+    if (k == TOKRBRACE) {
+      if (empty) rexError(rex, "Found TOKRBRACE but expecting a statement");
+      rexNext(rex);
+      if (--depth == 0) return;
+      empty = 0;
+      continue;
+    } else if (k == TOKEOF || k == TOKINT) {
+      rexError(rex, k == TOKEOF
+        ? "Found TOKEOF but expecting a statement"
+        : "Found TOKINT but expecting a statement");
+      return;
+    }
+
+    empty = 0;
+    int ok = 0;
+    if (k == TOKIF || k == TOKWHILE) {
+      ok = rexCond(rex);
+      if (ok) { ++depth; empty = 1; continue; }
+    } else if (k == TOKNAM) {
+      ok = rexAsg(rex);
+    } else if (k == TOKRET) {
+      ok = rexRet(rex);
+    } else {
+      char msg[100];
+      sprintf(msg, "Found %s but expecting a statement", tokStr(k));
+      rexError(rex, msg);
+    }
+    if (!ok && rexRecover(rex)) { ++depth; empty = 1; }
+  }
+}
+
+// ============================================================================
+// Check the SubC file at 'path', and report every syntax error in it.
+// Return the number of errors
+// ============================================================================
+int rexCheck(char* path) {
+  Rex rex;
+  rex.path = path;
+  rex.text = utMapFile(path, &rex.size);
+  rex.pos = 0;
+  rex.linNum = rex.colNum = 1;
+  rex.tokLin = rex.tokCol = 0;
+  rex.numErr = 0;
+  rex.quiet = 0;
+
+  if (rex.text == NULL) {
+    printf("%s: ERROR: Cannot read the file, or it is empty \n", path);
+    return 1;
+  }
+
+  rexProg(&rex);
+  utUnmapFile(rex.text, rex.size);
+  return rex.numErr;
+}
+
+// ============================================================================
+// The head of an If or While, with the "{" that opens its Block:
+// ( "if" | "while" ) "(" Exp ")" "{"
+// ============================================================================
+int rexCond(Rex* rex) {
+  rexNext(rex);                                   // eat "if" or "while"
+  return rexMust(rex, TOKSET(TOKLPAREN))
+    && rexExp(rex)
+    && rexMust(rex, TOKSET(TOKRPAREN))
+    && rexMust(rex, TOKSET(TOKLBRACE));
+}
+
+// ============================================================================
+// Report a syntax error, 'msg', at the current Token
+// ============================================================================
+void rexError(Rex* rex, char* msg) {
+  if (rex->quiet) return;                         // see rexPeek
+  printf("%s (%d, %d): ERROR: %s \n", rex->path, rex->tokLin, rex->tokCol, msg);
+  ++rex->numErr;
+}
+
+// ============================================================================
+// Exp => NamNum | NamNum Bop NamNum
+// ============================================================================
+int rexExp(Rex* rex) {
+  return rexNamNum(rex) && rexExpRest(rex);
+}
+
+// ============================================================================
+// What may follow the first NamNum of an Exp:  ( Bop NamNum ) ?
+// ============================================================================
+int rexExpRest(Rex* rex) {
+  if ((REXBOP & TOKSET(rex->kind)) == 0) return 1;
+  rexNext(rex);                                   // eat Bop
+  return rexNamNum(rex);
+}
+
+// ============================================================================
+// Fun  => "int" Nam "(" Pars ")" Body
+//
+// If the head is wrong, skip to the "{" of the Body, and check that
+// ============================================================================
+void rexFun(Rex* rex) {
+  int ok = rexMust(rex, TOKSET(TOKINT))
+    && rexMust(rex, TOKSET(TOKNAM))
+    && rexMust(rex, TOKSET(TOKLPAREN))
+    && rexPars(rex)
+    && rexMust(rex, TOKSET(TOKRPAREN));
+  if (!ok) {
+    while (rex->kind != TOKLBRACE && rex->kind != TOKEOF) rexNext(rex);
+    if (rex->kind == TOKEOF) return;
+  }
+  rexBody(rex);
+}
+
+// ============================================================================
+// Check that the current Token is a member of 'set'.  If yes, move on to the
+// next Token, and return 1.  If not, report the error, and return 0
+// ============================================================================
+int rexMust(Rex* rex, TokSet set) {
+  if (set & TOKSET(rex->kind)) {
+    rexNext(rex);
+    return 1;
+  }
+  char buf[300];
+  char msg[400];
+  sprintf(msg, "Found %s but expecting %s", tokStr(rex->kind), tokSetStr(set, buf));
+  rexError(rex, msg);
+  return 0;
+}
+
+// ============================================================================
+// As rexMust, for the NamNum that starts or ends an Exp - but worded as
+// pseExp words the error
+// ============================================================================
+int rexNamNum(Rex* rex) {
+  if (rex->kind == TOKNAM || rex->kind == TOKNUM) {
+    rexNext(rex);
+    return 1;
+  }
+  char msg[100];
+  sprintf(msg, "Found %s but expecting an expression", tokStr(rex->kind));
+  rexError(rex, msg);
+  return 0;
+}
+
+// ============================================================================
+// Scan the next Token, from rex->text[rex->pos], into rex->kind.  At the end
+// of the text, that's TOKEOF.  The rules are those of lexNext, in lex.c -
+// including its rule that a comment starts at the char *before* a "/" - so
+// that Rex sees just the Tokens that the compiler does.  An unrecognized
+// char is reported, and skipped.
+//
+// The line and column of each Token are counted as lex.c counts them, so
+// that an error is reported at the same (line, col) as the compiler gives:
+//    - a Nam, Num or Str is placed at the column just after its last char;
+//      punctuation at the column where it starts, and it takes up none
+//    - a newline, or a comment, leaves the next line at column 2
+//    - a newline within a run of whitespace that does not start with it,
+//      or within a Str, does not count as a line
+//    - the end of the text is at (0, 0)
+// ============================================================================
+void rexNext(Rex* rex) {
+  char* t = rex->text;
+  int size = rex->size;
+
+  for (;;) {
+    char c = rex->pos < size ? t[rex->pos] : '\0';
+    char c1 = rex->pos + 1 < size ? t[rex->pos + 1] : '\0';
+
+    if (c == '\n') {                              // newline
+      ++rex->pos;  ++rex->linNum;  rex->colNum = 2;
+      continue;
+    } else if (c >= 0x01 && c <= 0x20) {          // whitespace, as in lexSkip
+      while (rex->pos < size && t[rex->pos] >= 0x01 && t[rex->pos] <= 0x20) {
+        ++rex->pos;  ++rex->colNum;
+      }
+      continue;
+    } else if (c != '\0' && c1 == '/') {          // comment, as in lexSkipComment
+      while (rex->pos < size && t[rex->pos] != '\n') ++rex->pos;
+      continue;
+    }
+
+    rex->tokLin = rex->linNum;
+    int start = rex->pos;
+
+    if (c == '\0') {                              // end of text: placed at
+      rex->kind = TOKEOF;                         // (0, 0), as toksCurr does
+      rex->tokLin = rex->tokCol = 0;
+      return;
+    } else if (isdigit(c)) {                      // [0-9]+
+      while (rex->pos < size && isdigit(t[rex->pos])) ++rex->pos;
+      rex->kind = TOKNUM;
+    } else if (isalpha(c)) {                      // [a-zA-Z][a-zA-Z0-9]*
+      while (rex->pos < size && isalnum(t[rex->pos])) ++rex->pos;
+      char* s = &t[start];
+      int len = rex->pos - start;
+      rex->kind = TOKNAM;
+      if (len == 2 && memcmp(s, "if",     2) == 0) rex->kind = TOKIF;
+      if (len == 3 && memcmp(s, "int",    3) == 0) rex->kind = TOKINT;
+      if (len == 6 && memcmp(s, "return", 6) == 0) rex->kind = TOKRET;
+      if (len == 5 && memcmp(s, "while",  5) == 0) rex->kind = TOKWHILE;
+    } else if (c == '"') {                        // "NonQuotes"
+      ++rex->pos;
+      while (rex->pos < size && t[rex->pos] != '"') ++rex->pos;
+      rex->kind = TOKSTR;
+      if (rex->pos == size) {
+        rex->tokCol = rex->colNum;
+        rexError(rex, "Found a string with no closing \"");
+      } else {
+        ++rex->pos;                               // eat closing "
+      }
+    } else {
+      rex->tokCol = rex->colNum;
+      TokKind k = 0;
+      if      (c == '<' && c1 == '=') k = TOKLE;
+      else if (c == '=' && c1 == '=') k = TOKEEQ;
+      else if (c == '!' && c1 == '=') k = TOKNE;
+      else if (c == '>' && c1 == '=') k = TOKGE;
+      if (k) {
+        rex->pos += 2;
+      } else {
+        switch (c) {
+          case '+': k = TOKADD;    break;
+          case '-': k = TOKSUB;    break;
+          case '*': k = TOKMUL;    break;
+          case '=': k = TOKEQ;     break;
+          case '<': k = TOKLT;     break;
+          case '>': k = TOKGT;     break;
+          case '(': k = TOKLPAREN; break;
+          case ')': k = TOKRPAREN; break;
+          case '{': k = TOKLBRACE; break;
+          case '}': k = TOKRBRACE; break;
+          case ';': k = TOKSEMI;   break;
+          case ',': k = TOKCOMMA;  break;
+        }
+        ++rex->pos;
+        if (k == 0) {
+          char msg[100];
+          sprintf(msg, "Found unrecognized char '%c'", c);
+          rexError(rex, msg);
+          continue;
+        }
+      }
+      rex->kind = k;
+      return;                                     // punctuation: no columns
+    }
+
+    rex->colNum += rex->pos - start;
+    rex->tokCol = rex->colNum;
+    return;
+  }
+}
+
+// ============================================================================
+// Pars => ( Par ( "," Par )* ) ?
+// Par  => "int" Nam
+// ============================================================================
+int rexPars(Rex* rex) {
+  if (rex->kind == TOKRPAREN) return 1;           // no parameters
+  if (!rexMust(rex, TOKSET(TOKINT)) || !rexMust(rex, TOKSET(TOKNAM))) return 0;
+  while (rex->kind == TOKCOMMA) {
+    rexNext(rex);                                 // eat ","
+    if (!rexMust(rex, TOKSET(TOKINT)) || !rexMust(rex, TOKSET(TOKNAM))) return 0;
+  }
+  return 1;
+}
+
+// ============================================================================
+// Return the kind of the Token after the current one, without moving on to
+// it, as toksPeek does for pseIsCall.  Any error in scanning it is left for
+// rexNext to report, once we get there
+// ============================================================================
+TokKind rexPeek(Rex* rex) {
+  Rex ahead = *rex;
+  ahead.quiet = 1;
+  rexNext(&ahead);
+  return ahead.kind;
+}
+
+// ============================================================================
+// Prog => Fun+
+//
+// Between functions, skip anything that cannot start one
+// ============================================================================
+void rexProg(Rex* rex) {
+  rexNext(rex);                                   // first Token
+  if (rex->kind == TOKEOF) rexMust(rex, TOKSET(TOKINT));
+  while (rex->kind != TOKEOF) {
+    if (rex->kind == TOKINT) {
+      rexFun(rex);
+    } else {
+      rexMust(rex, TOKSET(TOKINT));
+      while (rex->kind != TOKINT && rex->kind != TOKEOF) rexNext(rex);
+    }
+  }
+}
+
+// ============================================================================
+// Recover from an error within a function.  Skip Tokens up to the end of the
+// bad Stm or Var - a ";", which we eat - or up to a Token that starts, or
+// ends, one: "if", "while", "return", "int" or "}".  But if we meet a "{"
+// first, eat it, and return 1, so that the caller counts it as opening a
+// Block (as it most likely does, after a bad If or While head); else return 0
+// ============================================================================
+int rexRecover(Rex* rex) {
+  TokSet stop = TOKSET(TOKIF) | TOKSET(TOKWHILE) | TOKSET(TOKRET)
+    | TOKSET(TOKINT) | TOKSET(TOKRBRACE) | TOKSET(TOKEOF);
+  for (;;) {
+    TokKind k = rex->kind;
+    if (stop & TOKSET(k)) return 0;
+    rexNext(rex);
+    if (k == TOKSEMI) return 0;
+    if (k == TOKLBRACE) return 1;
+  }
+}
+
+// ============================================================================
+// Ret => "return" Exp ";"
+// ============================================================================
+int rexRet(Rex* rex) {
+  rexNext(rex);                                   // eat "return"
+  return rexExp(rex) && rexMust(rex, TOKSET(TOKSEMI));
+}
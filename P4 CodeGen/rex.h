@@ -0,0 +1,67 @@
+// rex.h - Syntax-check-only Recognizer
+
+#pragma once
+
+#include <ctype.h>      // isalpha
+#include <string.h>     // memcmp
+
+#include "tok.h"        // TokKind, TokSet
+#include "ut.h"         // utMapFile
+
+// The recognizer of "P2 Recognizer/rex.c", re-worked for --syntax-only (see
+// main.c).  It checks that a SubC file obeys the grammar, and builds nothing:
+// no Toks array, no AST, and no heap allocations at all.  The source file is
+// mapped into memory (utMapFile), and the Rex scanner lexes it, one Token at
+// a time, straight from that buffer.  A Token is just its kind and position:
+// a name's lexeme is only looked at to spot keywords.
+//
+// Rather than stop at the first error, as the compiler does, Rex reports it,
+// then skips ahead to a point from which it can carry on - the end of the
+// statement, or the start of the next function - and so reports every error
+// in the file.  Expect 0 errors from a file that the compiler accepts.
+//
+// The first error reported is the one the compiler stops at (or, with
+// -maxerr, reports first), in the same words, at the same (line, col) - see
+// rexNext for how those are counted.  Apart from that:
+//    - the compiler lexes the whole file before it parses, and so reports an
+//      unrecognized char ahead of any syntax error; Rex reports errors in the
+//      order they appear in the file
+//    - a string with no closing " is an error here, where the compiler just
+//      reads on past the end of the file
+//    - after the first error, Rex recovers at other points than pse does
+//      with -maxerr, and so may report other errors
+
+#define REXBOP (TOKSET(TOKADD) | TOKSET(TOKSUB) | TOKSET(TOKMUL) | TOKSET(TOKLT) \
+  | TOKSET(TOKLE) | TOKSET(TOKNE) | TOKSET(TOKEEQ) | TOKSET(TOKGE) | TOKSET(TOKGT))
+
+typedef struct {
+  char*    path;        // file being checked
+  char*    text;        // its contents - not zero-terminated
+  int      size;        // chars in 'text'
+  int      pos;         // scan position in 'text'
+  int      linNum;      // line number at 'pos' (starts at 1)
+  int      colNum;      // column number at 'pos' (starts at 1)
+  TokKind  kind;        // current Token
+  int      tokLin;      // ... and where it starts
+  int      tokCol;
+  int      numErr;      // errors reported so far
+  int      quiet;       // 1 => report no errors (see rexPeek)
+} Rex;
+
+int  rexArgs   (Rex* rex);
+int  rexAsg    (Rex* rex);
+void rexBody   (Rex* rex);
+int  rexCheck  (char* path);
+int  rexCond   (Rex* rex);
+void rexError  (Rex* rex, char* msg);
+int  rexExp    (Rex* rex);
+int  rexExpRest(Rex* rex);
+void rexFun    (Rex* rex);
+int  rexMust   (Rex* rex, TokSet set);
+int  rexNamNum (Rex* rex);
+void rexNext   (Rex* rex);
+int  rexPars   (Rex* rex);
+TokKind rexPeek(Rex* rex);
+void rexProg   (Rex* rex);
+int  rexRecover(Rex* rex);
+int  rexRet    (Rex* rex);
@@ -0,0 +1,670 @@
+// ssa.c - Static Single Assignment Form
+//
+// See ssa.h
+
+#include "ssa.h"
+
+int g_ssa = 0;                                  // -ssa : see ssaProg
+
+// ============================================================================
+// Put 'fun' into SSA form (see ssa.h), adding the phis it keeps to 'stats'.
+// A function with no Pars or Vars, or whose entry block is branched to, is
+// left as it is.
+// ============================================================================
+void ssaBuild(IrFun* fun, SsaStats* stats) {
+  Ssa* ssa = ssaNew(fun);
+  if (ssa == NULL) return;
+  ssaDom(ssa);
+  ssaDf(ssa);
+  ssaPlace(ssa);
+  ssaRename(ssa);
+  ssaFree(ssa);
+
+  char* reach = malloc(fun->numBlk + 1);        // all blocks are reached
+  if (reach == NULL) utDie2Str("ssaBuild", "malloc failed");
+  memset(reach, 1, fun->numBlk + 1);
+  CfgStats junk = { 0, 0, 0 };
+  cfgDead(fun, reach);                          // phis, and inits, not used
+  cfgCompact(fun, reach, &junk);
+  free(reach);
+
+  for (int i = 0; i < fun->numIns; ++i) stats->numPhi += fun->ins[i].op == IRPHI;
+}
+
+// ============================================================================
+// Take 'fun' out of SSA form (see ssa.h), adding the copies it makes, and the
+// edges it splits, to 'stats'
+// ============================================================================
+void ssaDestroy(IrFun* fun, SsaStats* stats) {
+  int numBlk = fun->numBlk;
+  int* numPhi = calloc(numBlk + 1, sizeof(int));              // at top of each block
+  if (numPhi == NULL) utDie2Str("ssaDestroy", "calloc failed");
+  int anyPhi = 0;
+  for (int b = 0; b < numBlk; ++b) {
+    int lo = fun->blk[b].lo;
+    while (numPhi[b] < fun->blk[b].num && fun->ins[lo + numPhi[b]].op == IRPHI) ++numPhi[b];
+    anyPhi |= numPhi[b];
+  }
+  if (!anyPhi) { free(numPhi); return; }
+
+  // An edge from a cbr, into a block with phis, gets a block of its own to
+  // hold its copies.  split[2 * p + t] is that block, for target t of p.
+
+  int* split     = malloc((2 * numBlk + 1) * sizeof(int));
+  int* splitFrom = malloc((2 * numBlk + 1) * sizeof(int));
+  int* splitTo   = malloc((2 * numBlk + 1) * sizeof(int));
+  if (!split || !splitFrom || !splitTo) utDie2Str("ssaDestroy", "malloc failed");
+  int numSplit = 0;
+  for (int p = 0; p < numBlk; ++p) {
+    IrIns* term = &fun->ins[fun->blk[p].lo + fun->blk[p].num - 1];
+    split[2 * p] = split[2 * p + 1] = -1;
+    if (term->op != IRCBR) continue;
+    for (int t = 0; t < 2; ++t) {
+      int s = term->blk[t];
+      if (numPhi[s] == 0) continue;
+      if (t == 1 && s == term->blk[0]) { split[2 * p + 1] = split[2 * p]; continue; }
+      splitFrom[numSplit] = p;
+      splitTo[numSplit] = s;
+      split[2 * p + t] = numBlk + numSplit++;
+    }
+  }
+
+  // Lay out the new blocks: one that the cbr's block falls into, right after
+  // it, so that it falls through too; the rest at the end of the function.
+
+  int numNew = numBlk + numSplit;
+  int* order  = malloc((numNew + 1) * sizeof(int));
+  int* newNum = malloc((numNew + 1) * sizeof(int));
+  if (!order || !newNum) utDie2Str("ssaDestroy", "malloc failed");
+  for (int x = 0; x < numNew; ++x) newNum[x] = -1;
+  int numOrder = 0;
+  for (int b = 0; b < numBlk; ++b) {
+    IrIns* term = &fun->ins[fun->blk[b].lo + fun->blk[b].num - 1];
+    newNum[b] = numOrder;
+    order[numOrder++] = b;
+    for (int t = 0; t < 2; ++t) {
+      int x = split[2 * b + t];
+      if (x < 0 || newNum[x] >= 0 || term->blk[t] != b + 1) continue;
+      newNum[x] = numOrder;
+      order[numOrder++] = x;
+    }
+  }
+  for (int x = numBlk; x < numNew; ++x) {
+    if (newNum[x] >= 0) continue;
+    newNum[x] = numOrder;
+    order[numOrder++] = x;
+  }
+
+  // Rebuild the instructions, with the copies that leave each block put just
+  // before its br, and without the phis
+
+  int numVreg = fun->numVreg;
+  int* loc  = malloc((numVreg + 1) * sizeof(int));            // see ssaSeq
+  int* pred = malloc((numVreg + 1) * sizeof(int));
+  int* dst  = malloc((numVreg + 1) * sizeof(int));
+  int* src  = malloc((numVreg + 1) * sizeof(int));
+  IrBlk* blk = malloc((numNew + 1) * sizeof(IrBlk));
+  if (!loc || !pred || !dst || !src || !blk) utDie2Str("ssaDestroy", "malloc failed");
+  for (int v = 0; v < numVreg; ++v) loc[v] = pred[v] = -1;
+
+  IrIns* ins = NULL;
+  int numIns = 0, maxIns = 0;
+  int tmp = -1;                                 // breaks cycles of copies
+  for (int k = 0; k < numOrder; ++k) {
+    int x = order[k];
+    int p = x < numBlk ? x : splitFrom[x - numBlk];
+    IrIns* term = &fun->ins[fun->blk[p].lo + fun->blk[p].num - 1];
+    int s = x < numBlk ? (term->op == IRBR ? term->blk[0] : -1) : splitTo[x - numBlk];
+    blk[k].lo = numIns;
+
+    if (x < numBlk) {                           // all but the terminator
+      for (int i = fun->blk[x].lo + numPhi[x]; i < fun->blk[x].lo + fun->blk[x].num - 1; ++i) {
+        if (numIns == maxIns) ins = irGrow(ins, &maxIns, sizeof(IrIns));
+        ins[numIns++] = fun->ins[i];
+      }
+    }
+
+    if (s >= 0 && numPhi[s]) {                  // copies for edge p -> s
+      int num = 0;
+      for (int i = fun->blk[s].lo; i < fun->blk[s].lo + numPhi[s]; ++i) {
+        IrIns* phi = &fun->ins[i];
+        int g = phi->num;
+        while (g < phi->num + phi->numArg && fun->arg[g].blk != p) ++g;
+        if (g == phi->num + phi->numArg) utDie2Str("ssaDestroy", "phi has no arg for a predecessor");
+        dst[num] = phi->dst;
+        src[num++] = fun->arg[g].v;
+      }
+      int before = numIns;
+      ssaSeq(fun, dst, src, num, &tmp, loc, pred, &ins, &numIns, &maxIns);
+      stats->numCopy += numIns - before;
+    }
+
+    if (numIns == maxIns) ins = irGrow(ins, &maxIns, sizeof(IrIns));
+    if (x < numBlk) {                           // the terminator, re-targeted
+      ins[numIns] = *term;
+      for (int t = 0; t < 2; ++t) {
+        int target = term->blk[t];
+        if (target < 0) continue;
+        ins[numIns].blk[t] = newNum[split[2 * x + t] >= 0 ? split[2 * x + t] : target];
+      }
+      ++numIns;
+    } else {
+      ssaEmit(&ins, &numIns, &maxIns, IRBR, -1, -1);
+      ins[numIns - 1].blk[0] = newNum[s];
+    }
+    blk[k].num = numIns - blk[k].lo;
+  }
+
+  free(fun->ins);
+  fun->ins = ins;
+  fun->numIns = numIns;
+  fun->maxIns = maxIns;
+  free(fun->blk);
+  fun->blk = blk;
+  fun->numBlk = fun->maxBlk = numOrder;
+  fun->numArg = 0;
+  stats->numSplit += numSplit;
+
+  free(src);
+  free(dst);
+  free(pred);
+  free(loc);
+  free(newNum);
+  free(order);
+  free(splitTo);
+  free(splitFrom);
+  free(split);
+  free(numPhi);
+}
+
+// ============================================================================
+// Find the dominance frontier of each block: where its dominance ends.  For
+// each join block b, walk up the dominator tree from each predecessor, to
+// the idom of b: b is in the frontier of each block passed on the way.  Walk
+// twice: once to count, once to fill (see cfgNew).  A walk that meets a
+// block already given b stops: the rest of its way was walked before.
+// ============================================================================
+void ssaDf(Ssa* ssa) {
+  Cfg* cfg = ssa->cfg;
+  int numBlk = cfg->numBlk;
+  ssa->dfLo = calloc(numBlk + 2, sizeof(int));
+  int* stamp = malloc((numBlk + 1) * sizeof(int));            // last b given
+  if (!ssa->dfLo || !stamp) utDie2Str("ssaDf", "alloc failed");
+
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int b = 0; b < numBlk; ++b) stamp[b] = -1;
+    for (int b = 0; b < numBlk; ++b) {
+      if (cfg->predLo[b + 1] - cfg->predLo[b] < 2) continue;
+      for (int e = cfg->predLo[b]; e < cfg->predLo[b + 1]; ++e) {
+        for (int r = cfg->pred[e]; r != ssa->idom[b] && stamp[r] != b; r = ssa->idom[r]) {
+          stamp[r] = b;
+          if (pass == 0) ++ssa->dfLo[r + 2];
+          else ssa->df[ssa->dfLo[r + 1]++] = b;
+        }
+      }
+    }
+    if (pass == 0) {
+      for (int b = 0; b < numBlk; ++b) ssa->dfLo[b + 2] += ssa->dfLo[b + 1];
+      ssa->df = malloc((ssa->dfLo[numBlk + 1] + 1) * sizeof(int));
+      if (ssa->df == NULL) utDie2Str("ssaDf", "malloc failed");
+    }
+  }
+
+  free(stamp);
+}
+
+// ============================================================================
+// Find the immediate dominator of each block, by the algorithm of Cooper,
+// Harvey and Kennedy: visit the blocks in reverse postorder, making the idom
+// of each the nearest common dominator of its predecessors seen so far.
+// Repeat until nothing changes - for SubC's structured code, twice.
+// ============================================================================
+void ssaDom(Ssa* ssa) {
+  Cfg* cfg = ssa->cfg;
+  int numBlk = cfg->numBlk;
+  ssa->idom = malloc((numBlk + 1) * sizeof(int));
+  if (ssa->idom == NULL) utDie2Str("ssaDom", "malloc failed");
+  for (int b = 0; b < numBlk; ++b) ssa->idom[b] = -1;
+  ssa->idom[0] = 0;
+
+  int changed = 1;
+  while (changed) {
+    changed = 0;
+    for (int k = 1; k < numBlk; ++k) {
+      int b = ssa->rpo[k];
+      int idom = -1;
+      for (int e = cfg->predLo[b]; e < cfg->predLo[b + 1]; ++e) {
+        int p = cfg->pred[e];
+        if (ssa->idom[p] < 0) continue;         // not yet seen
+        idom = idom < 0 ? p : ssaIntersect(ssa, p, idom);
+      }
+      if (ssa->idom[b] == idom) continue;
+      ssa->idom[b] = idom;
+      changed = 1;
+    }
+  }
+}
+
+// ============================================================================
+// Append instruction 'op' to '*ins', which holds '*numIns' of '*maxIns', with
+// vregs 'dst' and 'a' (or -1), and no targets
+// ============================================================================
+void ssaEmit(IrIns** ins, int* numIns, int* maxIns, IROP op, int dst, int a) {
+  if (*numIns == *maxIns) *ins = irGrow(*ins, maxIns, sizeof(IrIns));
+  IrIns* in = &(*ins)[(*numIns)++];
+  memset(in, 0, sizeof(IrIns));
+  in->op = op;
+  in->dst = dst;
+  in->a = a;
+  in->b = -1;
+  in->blk[0] = in->blk[1] = -1;
+}
+
+// ============================================================================
+// Free 'ssa', but not the IrFun it describes
+// ============================================================================
+void ssaFree(Ssa* ssa) {
+  if (ssa->cfg) cfgFree(ssa->cfg);
+  free(ssa->rpo);
+  free(ssa->rpoNum);
+  free(ssa->idom);
+  free(ssa->dfLo);
+  free(ssa->df);
+  free(ssa->varOf);
+  free(ssa->varOff);
+  free(ssa->varNam);
+  free(ssa->phiLo);
+  free(ssa->phiVar);
+  free(ssa);
+}
+
+// ============================================================================
+// Return the nearest block that dominates both 'b1' and 'b2': walk up the
+// dominator tree from whichever comes later in reverse postorder, until the
+// two meet
+// ============================================================================
+int ssaIntersect(Ssa* ssa, int b1, int b2) {
+  while (b1 != b2) {
+    while (ssa->rpoNum[b1] > ssa->rpoNum[b2]) b1 = ssa->idom[b1];
+    while (ssa->rpoNum[b2] > ssa->rpoNum[b1]) b2 = ssa->idom[b2];
+  }
+  return b1;
+}
+
+// ============================================================================
+// Start an Ssa for 'fun': number its Pars and Vars, build its Cfg, and order
+// its blocks in reverse postorder.  Return NULL, to leave 'fun' as it is, if
+// it has no Pars or Vars, if its entry block is branched to, or if any block
+// cannot be reached (cfgProg removes those).
+// ============================================================================
+Ssa* ssaNew(IrFun* fun) {
+  int minOff = 0, maxOff = 0, any = 0;
+  for (int i = 0; i < fun->numIns; ++i) {
+    IrIns* ins = &fun->ins[i];
+    if (ins->op != IRLOAD && ins->op != IRSTORE) continue;
+    if (!any || ins->num < minOff) minOff = ins->num;
+    if (!any || ins->num > maxOff) maxOff = ins->num;
+    any = 1;
+  }
+  if (!any || fun->numBlk == 0) return NULL;
+
+  Ssa* ssa = calloc(1, sizeof(Ssa));
+  if (ssa == NULL) utDie2Str("ssaNew", "calloc failed");
+  ssa->fun = fun;
+  ssa->minOff = minOff;
+  int numSlot = (maxOff - minOff) / BYTESPERINT + 1;
+  ssa->varOf  = malloc((numSlot + 1) * sizeof(int));
+  ssa->varOff = malloc((numSlot + 1) * sizeof(int));
+  ssa->varNam = malloc((numSlot + 1) * sizeof(char*));
+  if (!ssa->varOf || !ssa->varOff || !ssa->varNam) utDie2Str("ssaNew", "malloc failed");
+  for (int s = 0; s < numSlot; ++s) ssa->varOf[s] = -1;
+  for (int i = 0; i < fun->numIns; ++i) {
+    IrIns* ins = &fun->ins[i];
+    if (ins->op != IRLOAD && ins->op != IRSTORE) continue;
+    if ((ins->num - minOff) % BYTESPERINT) utDie2Str("ssaNew", "frame slot not aligned");
+    int s = (ins->num - minOff) / BYTESPERINT;
+    if (ssa->varOf[s] >= 0) continue;
+    ssa->varOf[s] = ssa->numVar;
+    ssa->varOff[ssa->numVar] = ins->num;
+    ssa->varNam[ssa->numVar++] = ins->sym;
+  }
+
+  Cfg* cfg = ssa->cfg = cfgNew(fun);
+  int numBlk = cfg->numBlk;
+  if (cfg->predLo[1] > cfg->predLo[0]) { ssaFree(ssa); return NULL; }
+
+  // Depth-first, keeping our own stack, and, in 'next', the next successor
+  // of each block to visit.  A block is finished once all are visited.
+
+  ssa->rpo    = malloc((numBlk + 1) * sizeof(int));
+  ssa->rpoNum = malloc((numBlk + 1) * sizeof(int));
+  int* next   = calloc(numBlk + 1, sizeof(int));
+  int* stack  = malloc((numBlk + 1) * sizeof(int));
+  char* seen  = calloc(numBlk + 1, 1);
+  if (!ssa->rpo || !ssa->rpoNum || !next || !stack || !seen) utDie2Str("ssaNew", "alloc failed");
+
+  int numLeft = numBlk;                         // fill 'rpo' from its end
+  int numStack = 0;
+  stack[numStack++] = 0;
+  seen[0] = 1;
+  while (numStack) {
+    int b = stack[numStack - 1];
+    int e = cfg->succLo[b] + next[b];
+    if (e < cfg->succLo[b + 1]) {
+      ++next[b];
+      int s = cfg->succ[e];
+      if (!seen[s]) { seen[s] = 1; stack[numStack++] = s; }
+    } else {
+      --numStack;
+      ssa->rpo[--numLeft] = b;
+    }
+  }
+  for (int k = 0; k < numBlk; ++k) ssa->rpoNum[ssa->rpo[k]] = k;
+
+  free(seen);
+  free(stack);
+  free(next);
+  if (numLeft) { ssaFree(ssa); return NULL; }  // some block unreached
+  return ssa;
+}
+
+// ============================================================================
+// Choose where phis go.  A var needs them only if it is 'global': loaded in
+// some block before it is stored there.  Its phis go on the iterated
+// dominance frontier of the blocks that store it, found by a worklist.  (Its
+// value on entry, set in the entry block, adds none: the entry block
+// dominates every other.)  Phis are kept by block, in 'phiLo' and 'phiVar'.
+// ============================================================================
+void ssaPlace(Ssa* ssa) {
+  IrFun* fun = ssa->fun;
+  int numBlk = fun->numBlk, numVar = ssa->numVar;
+  char* global = calloc(numVar + 1, 1);
+  int* stored  = malloc((numVar + 1) * sizeof(int));          // last block storing var
+  int* defLo   = calloc(numVar + 2, sizeof(int));             // blocks that store var v
+  int* def     = malloc((fun->numIns + 1) * sizeof(int));     // are def[defLo[v]] ...
+  if (!global || !stored || !defLo || !def) utDie2Str("ssaPlace", "alloc failed");
+
+  for (int pass = 0; pass < 2; ++pass) {        // count, then fill (see cfgNew)
+    for (int v = 0; v < numVar; ++v) stored[v] = -1;
+    for (int b = 0; b < numBlk; ++b) {
+      for (int i = fun->blk[b].lo; i < fun->blk[b].lo + fun->blk[b].num; ++i) {
+        IrIns* ins = &fun->ins[i];
+        if (ins->op != IRLOAD && ins->op != IRSTORE) continue;
+        int v = ssa->varOf[(ins->num - ssa->minOff) / BYTESPERINT];
+        if (ins->op == IRLOAD) {
+          if (stored[v] != b) global[v] = 1;
+        } else if (stored[v] != b) {
+          stored[v] = b;
+          if (pass == 0) ++defLo[v + 2];
+          else def[defLo[v + 1]++] = b;
+        }
+      }
+    }
+    if (pass == 0) for (int v = 0; v < numVar; ++v) defLo[v + 2] += defLo[v + 1];
+  }
+
+  int* hasPhi = malloc((numBlk + 1) * sizeof(int));           // var of last phi placed
+  int* inWork = malloc((numBlk + 1) * sizeof(int));           // var last pushed for
+  int* work   = malloc((numBlk + 1) * sizeof(int));
+  int* phiBlk = NULL;
+  int* phiVar = NULL;
+  int numPhi = 0, maxPhi = 0, maxPhiVar = 0;
+  if (!hasPhi || !inWork || !work) utDie2Str("ssaPlace", "malloc failed");
+  for (int b = 0; b < numBlk; ++b) hasPhi[b] = inWork[b] = -1;
+
+  for (int v = 0; v < numVar; ++v) {
+    if (!global[v]) continue;
+    int numWork = 0;
+    for (int d = defLo[v]; d < defLo[v + 1]; ++d) {
+      inWork[def[d]] = v;
+      work[numWork++] = def[d];
+    }
+    while (numWork) {
+      int x = work[--numWork];
+      for (int f = ssa->dfLo[x]; f < ssa->dfLo[x + 1]; ++f) {
+        int y = ssa->df[f];
+        if (hasPhi[y] == v) continue;
+        hasPhi[y] = v;
+        if (numPhi == maxPhi) phiBlk = irGrow(phiBlk, &maxPhi, sizeof(int));
+        if (numPhi == maxPhiVar) phiVar = irGrow(phiVar, &maxPhiVar, sizeof(int));
+        phiBlk[numPhi] = y;
+        phiVar[numPhi++] = v;
+        if (inWork[y] == v) continue;
+        inWork[y] = v;
+        work[numWork++] = y;
+      }
+    }
+  }
+
+  ssa->numPhi = numPhi;                         // by block, vars in order
+  ssa->phiLo  = calloc(numBlk + 2, sizeof(int));
+  ssa->phiVar = malloc((numPhi + 1) * sizeof(int));
+  if (!ssa->phiLo || !ssa->phiVar) utDie2Str("ssaPlace", "alloc failed");
+  for (int k = 0; k < numPhi; ++k) ++ssa->phiLo[phiBlk[k] + 2];
+  for (int b = 0; b < numBlk; ++b) ssa->phiLo[b + 2] += ssa->phiLo[b + 1];
+  for (int k = 0; k < numPhi; ++k) ssa->phiVar[ssa->phiLo[phiBlk[k] + 1]++] = phiVar[k];
+
+  free(phiVar);
+  free(phiBlk);
+  free(work);
+  free(inWork);
+  free(hasPhi);
+  free(def);
+  free(defLo);
+  free(stored);
+  free(global);
+}
+
+// ============================================================================
+// Take every function of 'ir' into SSA form, and back out (see ssa.h)
+// ============================================================================
+void ssaProg(Ir* ir) {
+  SsaStats stats = { 0, 0, 0 };
+  FILE* f = NULL;
+  if (g_irDump) {
+    f = fopen("SsaDump.txt", "w");
+    if (f == NULL) utDie2Str("ssaProg", "Cannot create SsaDump.txt");
+  }
+
+  for (int n = 0; n < ir->numFun; ++n) {
+    IrFun* fun = ir->fun[n];
+    ssaBuild(fun, &stats);
+    irVerifyFun(fun);
+    if (f) irDumpFun(f, fun);
+    ssaDestroy(fun, &stats);
+  }
+
+  if (f) fclose(f);
+  if (g_irStats) {
+    printf("INFO: ssa: %d phis, %d copies, %d edges split \n",
+      stats.numPhi, stats.numCopy, stats.numSplit);
+  }
+}
+
+// ============================================================================
+// Rename: rebuild the instructions of the function, with the value of each
+// var on entry set at the top of the entry block (a Par is loaded, a Var is
+// 0), and the phis chosen by ssaPlace at the top of theirs.  Then walk the
+// dominator tree, depth-first, keeping in 'cur' the vreg holding each var.
+// A phi, or store, sets it; a load is removed, its uses given 'cur' instead.
+// Leaving a block undoes what it set.  On the way, fill in the phi args for
+// each edge out of the block.
+// ============================================================================
+void ssaRename(Ssa* ssa) {
+  IrFun* fun = ssa->fun;
+  Cfg* cfg = ssa->cfg;
+  int numBlk = fun->numBlk, numVar = ssa->numVar;
+
+  int maxIns = fun->numIns + numVar + ssa->numPhi + 1;
+  IrIns* ins = malloc(maxIns * sizeof(IrIns));
+  if (ins == NULL) utDie2Str("ssaRename", "malloc failed");
+  int numIns = 0;
+  for (int b = 0; b < numBlk; ++b) {
+    int lo = numIns;
+    if (b == 0) {
+      for (int v = 0; v < numVar; ++v) {
+        int par = ssa->varOff[v] > 0;           // Pars lie above FP
+        ssaEmit(&ins, &numIns, &maxIns, par ? IRLOAD : IRCONST, irNewVreg(fun, TYPINT), -1);
+        ins[numIns - 1].num = par ? ssa->varOff[v] : 0;
+        ins[numIns - 1].sym = par ? ssa->varNam[v] : NULL;
+      }
+    }
+    int numPred = cfg->predLo[b + 1] - cfg->predLo[b];
+    for (int k = ssa->phiLo[b]; k < ssa->phiLo[b + 1]; ++k) {
+      ssaEmit(&ins, &numIns, &maxIns, IRPHI, irNewVreg(fun, TYPINT), -1);
+      ins[numIns - 1].num = fun->numArg;
+      ins[numIns - 1].numArg = numPred;
+      ins[numIns - 1].sym = ssa->varNam[ssa->phiVar[k]];
+      for (int e = cfg->predLo[b]; e < cfg->predLo[b + 1]; ++e) {
+        if (fun->numArg == fun->maxArg) fun->arg = irGrow(fun->arg, &fun->maxArg, sizeof(IrArg));
+        fun->arg[fun->numArg].blk = cfg->pred[e];
+        fun->arg[fun->numArg++].v = -1;         // see below
+      }
+    }
+    memcpy(&ins[numIns], &fun->ins[fun->blk[b].lo], fun->blk[b].num * sizeof(IrIns));
+    numIns += fun->blk[b].num;
+    fun->blk[b].lo = lo;
+    fun->blk[b].num = numIns - lo;
+  }
+  free(fun->ins);
+  fun->ins = ins;
+  fun->numIns = numIns;
+  fun->maxIns = maxIns;
+
+  // Where each edge ends in the predecessors of its successor, which is
+  // where its arg goes, in each phi there
+
+  int numVreg = fun->numVreg;
+  int* pos    = malloc((cfg->succLo[numBlk] + 1) * sizeof(int));
+  int* fill   = calloc(numBlk + 1, sizeof(int));
+  int* kidLo  = calloc(numBlk + 2, sizeof(int));              // dominator tree
+  int* kid    = malloc((numBlk + 1) * sizeof(int));
+  int* repl   = malloc((numVreg + 1) * sizeof(int));          // what replaces each vreg
+  int* cur    = malloc((numVar + 1) * sizeof(int));
+  int* logVar = malloc((numIns + 1) * sizeof(int));           // undo log: var ...
+  int* logOld = malloc((numIns + 1) * sizeof(int));           // ... and its old value
+  int* mark   = malloc((numBlk + 1) * sizeof(int));           // log size on entry
+  int* stack  = malloc((2 * numBlk + 1) * sizeof(int));
+  if (!pos || !fill || !kidLo || !kid || !repl || !cur || !logVar || !logOld || !mark ||
+    !stack) {
+    utDie2Str("ssaRename", "alloc failed");
+  }
+  for (int b = 0; b < numBlk; ++b) {            // in the order cfgNew filled 'pred'
+    for (int e = cfg->succLo[b]; e < cfg->succLo[b + 1]; ++e) pos[e] = fill[cfg->succ[e]]++;
+  }
+  for (int b = 1; b < numBlk; ++b) ++kidLo[ssa->idom[b] + 2];
+  for (int b = 0; b < numBlk; ++b) kidLo[b + 2] += kidLo[b + 1];
+  for (int b = 1; b < numBlk; ++b) kid[kidLo[ssa->idom[b] + 1]++] = b;
+  for (int v = 0; v < numVreg; ++v) repl[v] = v;
+  for (int v = 0; v < numVar; ++v) cur[v] = -1;
+
+  int numLog = 0;
+  int numStack = 0;
+  stack[numStack++] = 0;
+  while (numStack) {
+    int x = stack[--numStack];
+    if (x < 0) {                                // leaving block ~x
+      while (numLog > mark[~x]) { --numLog; cur[logVar[numLog]] = logOld[numLog]; }
+      continue;
+    }
+    mark[x] = numLog;
+    stack[numStack++] = ~x;
+
+    int lo = fun->blk[x].lo;
+    for (int i = lo; i < lo + fun->blk[x].num; ++i) {
+      IrIns* in = &ins[i];
+      if (in->a >= 0) in->a = repl[in->a];
+      if (in->b >= 0) in->b = repl[in->b];
+      int v;
+      if (x == 0 && i < lo + numVar) {
+        v = i - lo;                             // value on entry
+      } else if (in->op == IRPHI) {
+        v = ssa->phiVar[ssa->phiLo[x] + i - lo];
+      } else if (in->op == IRLOAD || in->op == IRSTORE) {
+        v = ssa->varOf[(in->num - ssa->minOff) / BYTESPERINT];
+      } else {
+        continue;
+      }
+      if (in->op == IRLOAD && !(x == 0 && i < lo + numVar)) {
+        repl[in->dst] = cur[v];
+        in->op = 0;                             // removed (see cfgCompact)
+        continue;
+      }
+      logVar[numLog] = v;
+      logOld[numLog++] = cur[v];
+      cur[v] = in->op == IRSTORE ? in->a : in->dst;
+      if (in->op == IRSTORE) in->op = 0;
+    }
+
+    for (int e = cfg->succLo[x]; e < cfg->succLo[x + 1]; ++e) {
+      int s = cfg->succ[e];
+      for (int k = ssa->phiLo[s]; k < ssa->phiLo[s + 1]; ++k) {
+        IrIns* phi = &ins[fun->blk[s].lo + k - ssa->phiLo[s]];
+        fun->arg[phi->num + pos[e]].v = cur[ssa->phiVar[k]];
+      }
+    }
+    for (int c = kidLo[x]; c < kidLo[x + 1]; ++c) stack[numStack++] = kid[c];
+  }
+
+  free(stack);
+  free(mark);
+  free(logOld);
+  free(logVar);
+  free(cur);
+  free(repl);
+  free(kid);
+  free(kidLo);
+  free(fill);
+  free(pos);
+}
+
+// ============================================================================
+// Emit copies that do what the parallel copy dst[k] = src[k], for k = 0 thru
+// num - 1, does: each reads its source before any is written.  'loc' and
+// 'pred', indexed by vreg, are -1 on entry, and left so.
+//
+// After Boissinot et al: a copy may go once its destination is no longer
+// needed as the source of another.  pred[d] is the source of d, and loc[s]
+// where the value of source s now lies.  When no copy may go, the rest form
+// cycles: copy one destination aside, into '*tmp', made when first needed,
+// and carry on.
+// ============================================================================
+void ssaSeq(IrFun* fun, int* dst, int* src, int num, int* tmp, int* loc, int* pred,
+  IrIns** ins, int* numIns, int* maxIns) {
+  int* ready = malloc((2 * num + 1) * sizeof(int));
+  int* todo  = malloc((num + 1) * sizeof(int));
+  if (!ready || !todo) utDie2Str("ssaSeq", "malloc failed");
+
+  int numReady = 0, numTodo = 0;
+  for (int k = 0; k < num; ++k) {
+    if (dst[k] == src[k]) continue;             // nothing to do
+    loc[src[k]] = src[k];
+    pred[dst[k]] = src[k];
+    todo[numTodo++] = dst[k];
+  }
+  for (int k = 0; k < numTodo; ++k) {
+    if (loc[todo[k]] < 0) ready[numReady++] = todo[k];      // not a source
+  }
+
+  while (numTodo) {
+    while (numReady) {
+      int b = ready[--numReady];
+      int a = pred[b];
+      int c = loc[a];
+      ssaEmit(ins, numIns, maxIns, IRCOPY, b, c);
+      loc[a] = b;
+      if (a == c && pred[a] >= 0) ready[numReady++] = a;     // a is free now
+    }
+    int b = todo[--numTodo];
+    if (b != loc[pred[b]]) {                    // not yet copied: a cycle
+      if (*tmp < 0) *tmp = irNewVreg(fun, TYPINT);
+      ssaEmit(ins, numIns, maxIns, IRCOPY, *tmp, b);
+      loc[b] = *tmp;
+      ready[numReady++] = b;
+    }
+  }
+
+  for (int k = 0; k < num; ++k) loc[src[k]] = loc[dst[k]] = pred[dst[k]] = -1;
+  free(todo);
+  free(ready);
+}
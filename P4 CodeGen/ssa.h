@@ -0,0 +1,94 @@
+// ssa.h - Static Single Assignment Form
+
+#pragma once
+
+#include "cfg.h"            // Cfg, cfgNew
+#include "ir.h"             // IrFun
+
+// ssaBuild puts a function into SSA form: each Par and Var moves out of its
+// frame slot, and into vregs, one per store, so that loads and stores go.
+// Where control flow merges two values of a Par or Var, a phi picks the one
+// that arrives.  For example:
+//
+//    B0:  v0 = const 0                     B0:  v0 = const 0
+//         store x [FP, #-4], v0                 br B1
+//         br B1                            B1:  v9 = phi [B0: v0], [B2: v6]
+//    B1:  v1 = load x [FP, #-4]                 v2 = const 9
+//         v2 = const 9               =>         v3 = v9 < v2
+//         v3 = v1 < v2                          cbr v3, B2, B3
+//         cbr v3, B2, B3                   B2:  v5 = const 1
+//    B2:  v4 = load x [FP, #-4]                 v6 = v9 + v5
+//         v5 = const 1                          br B1
+//         v6 = v4 + v5
+//         store x [FP, #-4], v6
+//         br B1
+//
+// In SubC no Par or Var can have its address taken, so all of them move.
+// The steps are the classic ones (Cytron et al), each near linear in the
+// size of the function, so as to cope with the 50,000-block functions that
+// generators give us:
+//
+//    - dominators, by the iterative algorithm of Cooper, Harvey and Kennedy,
+//      over the blocks in reverse postorder
+//    - dominance frontiers, by their 'runner' walk up the dominator tree
+//    - phis, semi-pruned: only for a Par or Var loaded in some block before
+//      it is stored there; others never live across blocks.  Each goes on
+//      the iterated dominance frontier of the blocks that store it.
+//    - renaming, by a walk of the dominator tree, which keeps its own stack
+//    - phis and values left unused are then removed (see cfgDead)
+//
+// ssaDestroy takes a function out of SSA form.  Each phi becomes a copy at
+// the end of each predecessor.  Where a predecessor ends with a cbr, the
+// copies go in a new block, on that edge, so they run only when it is
+// taken.  The copies into a block happen in parallel - each reads its value
+// before any writes - so they are ordered, and a cycle, such as a swap,
+// broken with a temporary, after Boissinot et al.
+//
+// On entry, a Par holds the value its caller pushed, and a Var holds 0.
+//
+// ssaProg, run with -ssa, takes every function into SSA form and back out.
+// Passes that want SSA form go between the two.  With -ir, it dumps the SSA
+// form to SsaDump.txt; with --stats, it reports what it made.
+//
+// tests/ssacheck.c runs each program in tests, compiled with and without
+// -ssa, in a simulator, and checks that both print the same.
+
+typedef struct {
+  IrFun*  fun;
+  Cfg*    cfg;
+  int*    rpo;              // blocks, in reverse postorder
+  int*    rpoNum;           // position of each block in 'rpo'
+  int*    idom;             // immediate dominator of each block; entry's is itself
+  int*    dfLo;             // dominance frontier of block b is df[dfLo[b]] ...
+  int*    df;               // ... thru df[dfLo[b + 1] - 1]
+  int     numVar;           // Pars and Vars: one per frame slot
+  int     minOff;           // lowest offset of a frame slot
+  int*    varOf;            // var number of offset 'off' is varOf[(off - minOff) / 4]
+  int*    varOff;           // offset of each var
+  char**  varNam;           // name of each var
+  int*    phiLo;            // phis of block b are for vars phiVar[phiLo[b]] ...
+  int*    phiVar;           // ... thru phiVar[phiLo[b + 1] - 1], in order
+  int     numPhi;
+} Ssa;
+
+typedef struct {            // what ssaProg did, summed over all functions
+  int   numPhi;             // phis left, once unused ones are removed
+  int   numCopy;            // copies made from them
+  int   numSplit;           // edges split to hold copies
+} SsaStats;
+
+extern int g_ssa;           // -ssa : run ssaProg
+
+void  ssaBuild    (IrFun* fun, SsaStats* stats);
+void  ssaDestroy  (IrFun* fun, SsaStats* stats);
+void  ssaDf       (Ssa* ssa);
+void  ssaDom      (Ssa* ssa);
+void  ssaEmit     (IrIns** ins, int* numIns, int* maxIns, IROP op, int dst, int a);
+void  ssaFree     (Ssa* ssa);
+int   ssaIntersect(Ssa* ssa, int b1, int b2);
+Ssa*  ssaNew      (IrFun* fun);
+void  ssaPlace    (Ssa* ssa);
+void  ssaProg     (Ir* ir);
+void  ssaRename   (Ssa* ssa);
+void  ssaSeq      (IrFun* fun, int* dst, int* src, int num, int* tmp, int* loc, int* pred,
+                   IrIns** ins, int* numIns, int* maxIns);
@@ -1,28 +1,36 @@
-// tok.h - Tokens - Jim Hogg, 2020
-
-#pragma once
-
-#include <stdio.h>      // printf
-#include <stdlib.h>     // malloc
-#include <string.h>     // strlen
-
-typedef enum {
-  TOKADD = 1, TOKBAD, TOKCOMMA, TOKEEQ, TOKEOF, TOKEQ, TOKGE, TOKGT,
-  TOKIF, TOKINT, TOKLBRACE, TOKLE, TOKLPAREN, TOKLT, TOKMUL,
-  TOKNAM, TOKNE, TOKNUM, TOKRBRACE, TOKRET, TOKRPAREN, TOKSEMI, TOKSTR,
-  TOKSUB, TOKWHILE
-} TokKind;
-
-char* tokStr(TokKind kind);
-
-typedef struct _Tok {
-  TokKind kind;       // eg: TOKNUM
-  char*   lex;        // eg: "123" for TOKNUM, "abc" for TOKNAM
-  int     num;        // eg: 123 for TOKNUM
-  char*   str;        // eg: "Abort, retry of fail" for TOKSTR
-  int     linNum;     // eg: 14
-  int     colNum;     // eg: 8
-} Tok;
-
-Tok*  tokNew(int kind, char* lex, int num, char* str, int linNum, int colNum);
-char* tokStr(TokKind kind);
\ No newline at end of file
+// tok.h - Tokens - Jim Hogg, 2020
+
+#pragma once
+
+#include <stdio.h>      // printf
+#include <stdlib.h>     // malloc
+#include <string.h>     // strlen
+
+typedef enum {
+  TOKADD = 1, TOKBAD, TOKCOMMA, TOKEEQ, TOKEOF, TOKEQ, TOKGE, TOKGT,
+  TOKIF, TOKINT, TOKLBRACE, TOKLE, TOKLPAREN, TOKLT, TOKMUL,
+  TOKNAM, TOKNE, TOKNUM, TOKRBRACE, TOKRET, TOKRPAREN, TOKSEMI, TOKSTR,
+  TOKSUB, TOKWHILE
+} TokKind;
+
+char* tokStr(TokKind kind);
+
+// A TokSet is a set of TokKinds, held as a bitset: TokKind 'k' is a member
+// if bit 'k' is 1.  So a test for membership costs just one AND.  Build sets
+// at compile time, as in:  TOKSET(TOKNAM) | TOKSET(TOKNUM)
+
+typedef unsigned TokSet;
+#define TOKSET(k) (1u << (k))
+
+typedef struct _Tok {
+  TokKind kind;       // eg: TOKNUM
+  char*   lex;        // eg: "123" for TOKNUM, "abc" for TOKNAM
+  int     num;        // eg: 123 for TOKNUM
+  char*   str;        // eg: "Abort, retry of fail" for TOKSTR
+  int     linNum;     // eg: 14
+  int     colNum;     // eg: 8
+} Tok;
+
+Tok*  tokNew(int kind, char* lex, int num, char* str, int linNum, int colNum);
+char* tokSetStr(TokSet set, char* buf);
+char* tokStr(TokKind kind);
@@ -1,88 +1,198 @@
 // toks.c - container of Tokens - Jim Hogg, 2020
 
-#include <stddef.h>       // varparoffof
+#include <limits.h>       // INT_MAX
+#include <stdint.h>       // uint64_t
 #include <stdlib.h>       // malloc
 #include "toks.h"
 
 // ============================================================================
-// Append 'tok' to the 'toks' array, checking for overflow
+// Append a copy of 'tok' to the 'toks' array, doubling the array if it is
+// full.  (A stream never fills: its oldest Toks are overwritten instead)
 // ============================================================================
 void toksAdd(Toks* toks, Tok* tok) {
-  if (toks->tokNum < MAXTOKNUM) {
-    ++toks->tokNum;
-    ++toks->hiTokNum;
-    toks->tok[toks->tokNum] = *tok;
-  } else {
-    utDie2Str("toksAdd", "Too many tokens!");
-  }
+  if (toks->hiTokNum == toks->maxTokNum) toksGrow(toks, 2 * toks->maxTokNum + 2);
+  ++toks->hiTokNum;
+  toks->tok[toks->hiTokNum & toks->mask] = *tok;
 }
-
+
 // ============================================================================
 // Check whether we are "at the end" of the Toks array.  That's to say, we
-// have already processed all the Toks
+// have already processed all the Toks.  For a stream, first try to add more.
 // ============================================================================
 int toksAtEnd(Toks* toks) {
+  if (toks->tokNum <= toks->hiTokNum) return 0;
+  if (toks->fill) toks->fill(toks);
   return toks->tokNum > toks->hiTokNum;
-}
-
-// ============================================================================
-// Return the current Tok (ie, the one at the toks->tokNum 'cursor')
-// ============================================================================
-Tok* toksCurr(Toks* toks) {
-  if (toksAtEnd(toks)) {
-    return tokNew(TOKEOF, NULL, 0, NULL, 0, 0);
-  } else {
-    return &toks->tok[toks->tokNum];
-  }
-  return NULL;            // unreachable; pacify compiler
 }
 
-// ============================================================================
-// Dump all of the tokens in 'toks' to the screen.  Only used for debugging
-// ============================================================================
-void toksDump(Toks* toks) {
-  FILE* f = fopen("ToksDump.txt", "w");
-  for (int t = 0; t <= toks->hiTokNum; ++t) {
-    Tok* tok = &toks->tok[t];
-    fprintf(f,"[%3d] %3d  %10s %10s  %d (%d, %d) \n",
-      t, tok->kind, tokStr(tok->kind), tok->lex, tok->num,
-      tok->linNum, tok->colNum);
-  }
-  fclose(f);
-}
-
-// ============================================================================
-// Create a new Toks container
-// ============================================================================
+// ============================================================================
+// Devise the name for the binary cache file that holds the Toks lexed from
+// 'sourcePath', so "c:\Tests\test01.subc" is cached as "test01.tok"
+// ============================================================================
+char* toksCacheName(char* sourcePath) { return utCacheName(sourcePath, ".tok"); }
+
+// ============================================================================
+// Return the current Tok (ie, the one at the toks->tokNum 'cursor')
+// ============================================================================
+Tok* toksCurr(Toks* toks) {
+  if (toksAtEnd(toks)) {
+    return tokNew(TOKEOF, NULL, 0, NULL, 0, 0);
+  } else {
+    return &toks->tok[toks->tokNum & toks->mask];
+  }
+  return NULL;            // unreachable; pacify compiler
+}
+
+// ============================================================================
+// Dump all of the tokens in 'toks' to ToksDump.txt.  Only used for debugging,
+// and only on request (see the -toks option in main.c)
+// ============================================================================
+void toksDump(Toks* toks) {
+  FILE* f = fopen("ToksDump.txt", "w");
+  for (int t = 0; t <= toks->hiTokNum; ++t) {
+    Tok* tok = &toks->tok[t];
+    fprintf(f,"[%3d] %3d  %10s %10s  %d (%d, %d) \n",
+      t, tok->kind, tokStr(tok->kind), tok->lex, tok->num,
+      tok->linNum, tok->colNum);
+  }
+  fclose(f);
+}
+
+// ============================================================================
+// Make room, in the 'toks' array, for at least 'numTok' Toks
+// ============================================================================
+void toksGrow(Toks* toks, int numTok) {
+  if (numTok <= toks->maxTokNum + 1) return;
+  toks->tok = realloc(toks->tok, numTok * sizeof(Tok));
+  if (toks->tok == NULL) utDie2Str("toksGrow", "Too many tokens!");
+  toks->maxTokNum = numTok - 1;
+}
+
+// ============================================================================
+// Re-load the Toks previously saved, by toksSave, into the binary cache file
+// 'filePath'.  We map the file into memory, and point each Tok's lexeme
+// directly into the mapped lexeme pool, so nothing is copied but the fixed-
+// size fields.  If the file is missing, damaged, from another version, or
+// was built from a source text other than 'src', return NULL: the caller
+// should then lex 'src' afresh.  So each Tok is checked before use: its kind
+// must be a TokKind, and its lexeme must start, and end, within the pool.
+// ============================================================================
+Toks* toksLoad(char* filePath, char* src) {
+  int size = 0;
+  char* buf = utMapFile(filePath, &size);
+  if (buf == NULL) return NULL;
+
+  ToksHdr* hdr = (ToksHdr*) buf;
+  int srcLen = strlen(src);
+  if (size < (int) sizeof(ToksHdr) || hdr->magic != TOKSMAGIC
+    || hdr->version != TOKSVERSION || hdr->srcLen != (unsigned) srcLen
+    || hdr->srcHash != utHash(src, srcLen)) {
+    utUnmapFile(buf, size);
+    return NULL;
+  }
+
+  unsigned numTok = hdr->numTok;
+  uint64_t want = sizeof(ToksHdr) + (uint64_t) 5 * 4 * numTok + hdr->poolSize;
+  if (want != (uint64_t) size || numTok == 0) {
+    utUnmapFile(buf, size);
+    return NULL;
+  }
+
+  int*      kind   = (int*) (buf + sizeof(ToksHdr));
+  int*      num    = kind   + numTok;
+  int*      linNum = num    + numTok;
+  int*      colNum = linNum + numTok;
+  unsigned* lexOff = (unsigned*) (colNum + numTok);
+  char*     pool   = (char*) (lexOff + numTok);
+
+  unsigned poolSize = hdr->poolSize;           // its last lexeme ends the pool
+  if (poolSize > 0 && pool[poolSize - 1] != 0) {
+    utUnmapFile(buf, size);
+    return NULL;
+  }
+
+  Toks* toks = toksNew();
+  toksGrow(toks, numTok);
+  for (unsigned t = 0; t < numTok; ++t) {
+    int needLex = kind[t] == TOKNAM || kind[t] == TOKNUM || kind[t] == TOKSTR;
+    if (kind[t] < TOKADD || kind[t] > TOKWHILE
+      || (lexOff[t] == TOKSNOLEX ? needLex : lexOff[t] >= poolSize)) {
+      free(toks->tok);
+      free(toks);
+      utUnmapFile(buf, size);
+      return NULL;
+    }
+    Tok* tok = &toks->tok[t];
+    tok->kind   = kind[t];
+    tok->lex    = lexOff[t] == TOKSNOLEX ? NULL : pool + lexOff[t];
+    tok->num    = num[t];
+    tok->str    = NULL;
+    tok->linNum = linNum[t];
+    tok->colNum = colNum[t];
+  }
+  toks->tokNum = toks->hiTokNum = numTok - 1;
+  return toks;
+}
+
+// ============================================================================
+// Create a new Toks container
+// ============================================================================
 Toks* toksNew() {
   Toks* toks = malloc(sizeof(Toks));
   toks->tokNum = toks->hiTokNum = -1;
+  toks->maxTokNum = -1;
+  toks->mask = ~0;                          // tok[n & mask] is just tok[n]
+  toks->tok = NULL;
+  toks->fill = NULL;
+  toks->src = NULL;
+  toksGrow(toks, 256);
+  return toks;
+}
+
+// ============================================================================
+// Create a new Toks container that is a stream (see toks.h): a ring of
+// 'numTok' Toks (a power of 2), kept topped up by calling 'fill', which
+// reads its Toks from 'src'.  The cursor starts on the first Tok.
+// ============================================================================
+Toks* toksNewStream(int numTok, void (*fill)(Toks* toks), void* src) {
+  if (numTok < 2 || (numTok & (numTok - 1)) != 0) {
+    utDie2Str("toksNewStream", "Ring size must be a power of 2");
+  }
+  Toks* toks = malloc(sizeof(Toks));
+  toks->tokNum = 0;
+  toks->hiTokNum = -1;
+  toks->maxTokNum = INT_MAX;                // never grows
+  toks->mask = numTok - 1;
+  toks->tok = malloc(numTok * sizeof(Tok));
+  if (toks->tok == NULL) utDie2Str("toksNewStream", "malloc failed");
+  toks->fill = fill;
+  toks->src = src;
   return toks;
 }
 
-// ============================================================================
-// Move the toks->tokNum 'cursor' forward one step.  But do not access the
-// entry: at the end of the program, the cursor will point just beyond the end
-// of the Toks array (ie, at entry toks->hiTokNum + 1)
-// ============================================================================
-Tok* toksNext(Toks* toks) {
-  ++toks->tokNum;
-  if (toksAtEnd(toks)) {
-    return tokNew(TOKEOF, NULL, 0, NULL, 0, 0);
-  } else {
-    return toksCurr(toks);
-  }
+// ============================================================================
+// Move the toks->tokNum 'cursor' forward one step.  But do not access the
+// entry: at the end of the program, the cursor will point just beyond the end
+// of the Toks array (ie, at entry toks->hiTokNum + 1)
+// ============================================================================
+Tok* toksNext(Toks* toks) {
+  ++toks->tokNum;
+  if (toksAtEnd(toks)) {
+    return tokNew(TOKEOF, NULL, 0, NULL, 0, 0);
+  } else {
+    return toksCurr(toks);
+  }
 }
-
+
 // ============================================================================
-// Return the next Tok (ie, the one just after the toks->tokNum 'cursor'), but
+// Return the next Tok (ie, the one just after the toks->tokNum 'cursor'), but
 // avoid making any permanent change to that cursor.
 // ============================================================================
 Tok* toksPeek(Toks* toks) {
-  Tok* tok = toksNext(toks);
-  toksPrev(toks);
+  Tok* tok = toksNext(toks);
+  toksPrev(toks);
   return tok;
-}
+}
 
 // ============================================================================
 // Return the previous Tok (ie, the one just before the toks->tokNum 'cursor')
@@ -91,8 +201,68 @@ Tok* toksPrev(Toks* toks) {
   --toks->tokNum;
   return toksCurr(toks);
 }
-
-// ============================================================================
-// Rewind the Toks container so that 'toksCurr' will retrieve the first Tok
+
+// ============================================================================
+// Rewind the Toks container so that 'toksCurr' will retrieve the first Tok
 // ============================================================================
 void toksRewind(Toks* toks) { toks->tokNum = 0; }
+
+// ============================================================================
+// Save 'toks', lexed from the source text 'src', to the binary cache file
+// 'filePath'.  (See toks.h for the layout).  We gather each field into its
+// own array, so the whole file goes out in a handful of fwrite calls, rather
+// than one formatted write per Tok.  Failure to save is not fatal - we just
+// lose the cache.
+// ============================================================================
+void toksSave(Toks* toks, char* filePath, char* src) {
+  int numTok = toks->hiTokNum + 1;
+
+  unsigned poolSize = 0;
+  for (int t = 0; t < numTok; ++t) {
+    if (toks->tok[t].lex) poolSize += strlen(toks->tok[t].lex) + 1;
+  }
+
+  int*      fields = malloc(5 * 4 * (numTok + 1));
+  int*      kind   = fields;
+  int*      num    = kind   + numTok;
+  int*      linNum = num    + numTok;
+  int*      colNum = linNum + numTok;
+  unsigned* lexOff = (unsigned*) (colNum + numTok);
+  char*     pool   = malloc(poolSize + 1);
+
+  unsigned off = 0;
+  for (int t = 0; t < numTok; ++t) {
+    Tok* tok = &toks->tok[t];
+    kind[t]   = tok->kind;
+    num[t]    = tok->num;
+    linNum[t] = tok->linNum;
+    colNum[t] = tok->colNum;
+    if (tok->lex) {
+      int len = strlen(tok->lex) + 1;
+      memcpy(pool + off, tok->lex, len);
+      lexOff[t] = off;
+      off += len;
+    } else {
+      lexOff[t] = TOKSNOLEX;
+    }
+  }
+
+  ToksHdr hdr;
+  hdr.magic    = TOKSMAGIC;
+  hdr.version  = TOKSVERSION;
+  hdr.srcLen   = strlen(src);
+  hdr.srcHash  = utHash(src, hdr.srcLen);
+  hdr.numTok   = numTok;
+  hdr.poolSize = poolSize;
+
+  FILE* file = fopen(filePath, "wb");
+  if (file) {
+    fwrite(&hdr, sizeof(hdr), 1, file);
+    fwrite(fields, 4, 5 * numTok, file);
+    fwrite(pool, 1, poolSize, file);
+    fclose(file);
+  }
+
+  free(fields);
+  free(pool);
+}
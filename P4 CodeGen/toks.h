@@ -6,19 +6,56 @@
 #include "ut.h"             // ut*
 
 typedef struct _Toks {
-  #define MAXTOKNUM 999
-  int tokNum;               // current Tok number (iterator)
-  int hiTokNum;             // hightest Tok number in current Toks object
-  Tok tok[MAXTOKNUM + 1];
+  int   tokNum;             // current Tok number (iterator)
+  int   hiTokNum;           // hightest Tok number in current Toks object
+  int   maxTokNum;          // highest Tok number that 'tok' has room for
+  int   mask;               // Tok number 'n' is held in tok[n & mask]
+  Tok*  tok;                // grows, by doubling, as Toks are added
+  void  (*fill)(struct _Toks* toks);  // stream: adds more Toks; else NULL
+  void* src;                // stream: where 'fill' gets its Toks from
 } Toks;
 
+// A Toks container is normally an array of every Tok in the program, lexed up
+// front.  Instead, a "stream" of Toks (see toksNewStream) holds just a ring
+// of TOKSRING Toks: whenever the parser moves past the last Tok in the ring,
+// toksAtEnd calls 'fill' to add more, overwriting the oldest.  'fill' keeps
+// no more than TOKSRING / 2 Toks ahead of the parser, so a Tok returned by
+// toksCurr, toksNext, etc, stays valid until the parser has moved on by at
+// least TOKSRING / 2 - 1 more Toks.  A parser should therefore copy out what
+// it needs from a Tok, rather than hold on to the pointer.
 
-void  toksAdd(Toks* toks, Tok* tok);
+#define TOKSRING 256        // must be a power of 2
+
+// A Toks container can be saved to, and re-loaded from, a binary cache file.
+// The file holds a fixed header, followed by one array per Tok field
+// (kind[], num[], linNum[], colNum[], lexOff[]), followed by a pool of the
+// lexemes, each terminated by a zero byte.  'lexOff' is the offset of a
+// lexeme within that pool, or TOKSNOLEX if the Tok has no lexeme.
+
+#define TOKSMAGIC   0x4B4F5453        // "STOK"
+#define TOKSVERSION 1
+#define TOKSNOLEX   0xFFFFFFFF
+
+typedef struct {
+  unsigned magic;           // TOKSMAGIC
+  unsigned version;         // TOKSVERSION
+  unsigned srcLen;          // length of the source text that was lexed
+  unsigned srcHash;         // utHash of that source text
+  unsigned numTok;          // number of Toks in each array
+  unsigned poolSize;        // bytes in the lexeme pool
+} ToksHdr;
+
+void  toksAdd(Toks* toks, Tok* tok);
 int   toksAtEnd(Toks* toks);
+char* toksCacheName(char* sourcePath);
 Tok*  toksCurr(Toks* toks);
 void  toksDump(Toks* toks);
-Toks* toksNew();
+void  toksGrow(Toks* toks, int numTok);
+Toks* toksLoad(char* filePath, char* src);
+Toks* toksNew();
+Toks* toksNewStream(int numTok, void (*fill)(Toks* toks), void* src);
 Tok*  toksNext(Toks* toks);
 Tok*  toksPeek(Toks* toks);
-Tok*  toksPrev(Toks* toks);
-void  toksRewind(Toks* toks);
\ No newline at end of file
+Tok*  toksPrev(Toks* toks);
+void  toksRewind(Toks* toks);
+void  toksSave(Toks* toks, char* filePath, char* src);
\ No newline at end of file
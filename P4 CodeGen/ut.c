@@ -2,30 +2,59 @@
 
 #include "ut.h"
 
+#ifdef _WIN32
+#include <windows.h>    // Sleep
+#else
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap
+#include <sys/stat.h>   // fstat
+#include <time.h>       // nanosleep
+#include <unistd.h>     // close
+#endif
+
+// ============================================================================
+// Devise the name for a binary cache file, built from 'sourcePath', whose
+// extension is 'ext'.  Like emitNewName, we keep just the filename and swap
+// its extension, so "c:\Tests\test01.subc" with ".tok" gives "test01.tok"
+// ============================================================================
+char* utCacheName(char* sourcePath, char* ext) {
+  char* wack = strrchr(sourcePath, '\\');   // find last wack ("\")
+  char* name = wack ? wack + 1 : sourcePath;
+
+  char* path = calloc(strlen(name) + strlen(ext) + 1, 1);
+  if (path == NULL) utDie2Str("utCacheName", "calloc failed");
+
+  strcpy(path, name);                       // eg: "test01.subc"
+  char* dot = strrchr(path, '.');           // find last dot (".")
+  if (dot == NULL) dot = path + strlen(path);
+  strcpy(dot, ext);                         // eg: "test01.tok"
+  return path;
+}
+
 void utDie2Str(char* func, char* msg) {
   printf("\n\nERROR: %s: %s \n\n", func, msg);
   utPause();
 }
-
-void utDie2StrInt(char* func, char* msg, int num) {
-  printf("\n\nERROR: %s: %s %d \n\n", func, msg, num);
-  utPause();
-}
+
+void utDie2StrInt(char* func, char* msg, int num) {
+  printf("\n\nERROR: %s: %s %d \n\n", func, msg, num);
+  utPause();
+}
 
 void utDie3Str(char* func, char* msg1, char*msg2) {
   printf("\n\nERROR: %s: %s %s \n\n", func, msg1, msg2);
   utPause();
 }
-
+
 void utDie4Str(char* func, char* msg1, char* msg2, char* msg3) {
   printf("\n\nERROR: %s: %s %s %s \n\n", func, msg1, msg2, msg3);
   utPause();
-}
-
+}
+
 void utDie5Str(char* func, char* msg1, char* msg2, char* msg3, char* msg4) {
   printf("\n\nERROR: %s: %s %s %s %s \n\n", func, msg1, msg2, msg3, msg4);
   utPause();
-}
+}
 
 void utDie2StrCharLC(char* func, char* msg, char c, int linNum, int colNum) {
   printf("\n\nERROR: %s %s %c at (%d, %d) \n\n",
@@ -38,7 +67,56 @@ void utDieStrTokStr(char* func, Tok* tok, char* msg) {
     func, tokStr(tok->kind), msg, tok->linNum, tok->colNum);
   utPause();
 }
-
+
+// ============================================================================
+// Hash the 'len' chars starting at 's', using 32-bit FNV-1a.  Used to check
+// whether a cached file still matches the source it was built from
+// ============================================================================
+unsigned utHash(char* s, int len) {
+  unsigned h = 2166136261u;
+  for (int i = 0; i < len; ++i) {
+    h ^= (unsigned char) s[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// ============================================================================
+// Map the file at 'filePath' read-only into memory, and return a pointer to
+// its first byte, with its size in '*size'.  Unlike utReadFile, a missing
+// file is not an error: we return NULL, and leave the caller to decide.
+// On Windows, we fall back to reading the file into a malloc'd buffer.
+// ============================================================================
+char* utMapFile(char* filePath, int* size) {
+  *size = 0;
+#ifdef _WIN32
+  FILE* file = fopen(filePath, "rb");
+  if (!file) return NULL;
+  fseek(file, 0L, SEEK_END);
+  int fileSize = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  char* buf = malloc(fileSize + 1);
+  int got = fread(buf, 1, fileSize, file);
+  fclose(file);
+  if (got != fileSize) { free(buf); return NULL; }
+  *size = fileSize;
+  return buf;
+#else
+  int fd = open(filePath, O_RDONLY);
+  if (fd < 0) return NULL;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return NULL; }
+
+  char* buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);                            // the mapping survives the close
+  if (buf == MAP_FAILED) return NULL;
+
+  *size = (int) st.st_size;
+  return buf;
+#endif
+}
+
 void utPause() {
   printf("Hit any key to finish");
   getchar();
@@ -67,14 +145,38 @@ char* utReadFile(char* filePath) {
   // Read the entire file
 
   fread(prog, 1, fileSize, file);
+  fclose(file);
 
   return prog;
 
 }
 
+// ============================================================================
+// Sleep for 'ms' milliseconds
+// ============================================================================
+void utSleep(int ms) {
+#ifdef _WIN32
+  Sleep(ms);
+#else
+  struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+  nanosleep(&ts, NULL);
+#endif
+}
+
 char* utStrndup(char* s, int len) {
   char* copy = malloc(len + 1);
   strncpy(copy, s, len);
   copy[len] = '\0';
   return copy;
 }
+
+// ============================================================================
+// Release a buffer returned by utMapFile
+// ============================================================================
+void utUnmapFile(char* buf, int size) {
+#ifdef _WIN32
+  free(buf);
+#else
+  munmap(buf, size);
+#endif
+}
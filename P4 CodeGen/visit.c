@@ -1,258 +1,222 @@
-// visit.c - walk a SubC AST, vising every Node - Jim Hogg, 2020
-
-#include "pin.h"
-#include "visit.h"
-
-// ========================================================
-// Arg => Nam | Num | Str
-// ========================================================
-AstArg* visitArg(AstArg* ast) {
-  pin(); printf("Arg \n"); pinMore();
-
-  if (ast == NULL) {
-    pin(); printf("str = NULL \n"); pinLess();
-    return NULL;
-  }
-
-  if (ast->nns->kind == ASTNAM) {
-    AstNam* nam = (AstNam*) ast->nns;
-    pin(); printf("nam = %s \n", nam->lex);
-  } else if (ast->nns->kind == ASTNUM) {
-    AstNum* num = (AstNum*) ast->nns;
-    pin(); printf("num = %d \n", num->val);
-  } else {
-    AstStr* str = (AstStr*) ast->nns;
-    pin(); printf("str = \"%s\" \n", str->txt);
-  }
-  pinLess();
-
-  return (AstArg*) ast->next;
-}
-
-// ========================================================
-// Args => ( Arg ( "," Arg )* ) ?
-// ========================================================
-void visitArgs(AstArg* ast) {
-  pin(); printf("Args \n"); pinMore();
-  ast = visitArg(ast);
-  while (ast != NULL) {
-    ast = visitArg(ast);
-  }
-  pinLess();
-}
-
-// ========================================================
-// Asg => Nam "=" (Exp | Call) ";"
-// ========================================================
-void visitAsg(AstAsg* ast) {
-  pin(); printf("Asg \n"); pinMore();
-  pin(); printf("nam = %s \n", ast->nam->lex);
-  if (ast->eoc->kind == ASTEXP) {
-    visitExp((AstExp*) ast->eoc);
-  } else {
-    visitCall((AstCall*) ast->eoc);
-  }
-  pinLess();
-}
-
-// ========================================================
-// Block => "{" Stm+ "}"
-// ========================================================
-void visitBlock(AstBlock* ast) {
-  pin(); printf("Block \n"); pinMore();
-  visitStms((Ast*) ast->stms);
-  pinLess();
-}
-
-// ========================================================
-// Body => Var* Stm+
-// ========================================================
-void visitBody(AstBody* ast) {
-  pin(); printf("Body \n"); pinMore();
-  visitVars(ast->vars);
-  visitStms((Ast*)(ast->stms));
-  pinLess();
-}
-
-// ========================================================
-// Call => Nam "(" Args ")"
-// ========================================================
-void visitCall(AstCall* ast) {
-  pin(); printf("Call \n"); pinMore();
-  pin(); printf("%s \n", ast->nam->lex);
-  visitArgs((AstArg*) ast->args);
-  pinLess();
-}
-
-// ========================================================
-// Exp => NamNum | NamNum Bop NamNum
-// ========================================================
-void visitExp(AstExp* ast) {
-  pin(); printf("Exp \n"); pinMore();
-
-  AST lhsKind = ast->lhs->kind;
-
-  if (lhsKind == ASTNAM) {
-    visitNam((AstNam*) ast->lhs);
-  } else if (lhsKind == ASTNUM) {
-    visitNum((AstNum*) ast->lhs);
-  }
-
-  if (ast->bop == BOPNONE) {
-    pinLess();
-    return;
-  }
-
-  pin(); printf("Bop = %s \n", astBOPtoStr(ast->bop));
-
-  AST rhsKind = ast->rhs->kind;
-  if (ast->bop != BOPNONE) {                 // NamLit Bop NamLit
-    if (rhsKind == ASTNUM) {
-      visitNum((AstNum*) ast->rhs);
-    } else if (rhsKind == ASTNAM) {
-      visitNam((AstNam*) ast->rhs);
-    }
-  }
-
-  pinLess();
-}
-
-// ========================================================
-// Fun => "int" Nam "(" Pars ")" Body
-// ========================================================
-void visitFun(AstFun* ast) {
-  pin(); printf("Fun \n"); pinMore();
-  pin(); printf("nam = %s \n", ast->nam->lex);
-  pin(); printf("typ = int \n");
-  AstPar* par = ast->pars;
-  while (par != NULL) {
-    visitPar(par);
-    par = (AstPar*) par->next;
-  }
-  visitBody(ast->body);
-  pinLess();
-}
-
-// ========================================================
-// Funs => Fun+
-// ========================================================
-void visitFuns(AstFun* ast) {
-  while (ast != NULL) {
-    visitFun(ast);
-    ast = (AstFun*) ast->next;
-  }
-}
-
-// ========================================================
-// If => "if" "(" Exp ")" Block
-// ========================================================
-void visitIf(AstIf* ast) {
-  pin(); printf("If \n"); pinMore();
-  visitExp(ast->exp);
-  visitBlock(ast->block);
-  pinLess();
-}
-
-// ========================================================
-// Nam => Alpha AlphaNum*
-// ========================================================
-void visitNam(AstNam* ast) {
-  pin(); printf("nam = %s \n", ast->lex);
-}
-
-// ========================================================
-// Num => [0-9]+
-// ========================================================
-void visitNum(AstNum* ast) {
-  pin(); printf("num = %d \n", ast->val);
-}
-
-// ========================================================
-// Par => "int" Nam
-// ========================================================
-void visitPar(AstPar* ast) {
-  pin(); printf("Par \n"); pinMore();
-  pin(); printf("nam = %s \n", ast->nam->lex);
-  pin(); printf("typ = int\n");
-  pinLess();
-}
-
-// ========================================================
-// Prog => Fun+
-// ========================================================
-void visitProg(AstProg* astProg) {
-  pin(); printf("Prog \n"); pinMore();
-  AstFun* ast = astProg->funs;
-  while (ast != NULL) {
-    visitFun(ast);
-    ast = (AstFun*) ast->next;
-  }
-
-  pinLess();
-  printf("\n\n");
-}
-
-// ========================================================
-// Ret => "return" Exp ";"
-// ========================================================
-void visitRet(AstRet* ast) {
-  pin(); printf("Ret \n"); pinMore();
-  visitExp(ast->exp);
-  pinLess();
-}
-
-// ========================================================
-// Stm => If | Asg | Ret | While
-// ========================================================
-void visitStms(Ast* ast) {
-  while (ast != NULL) {
-    switch(ast->kind) {
-      case ASTASG:   visitAsg  ((AstAsg*)   ast);   break;
-      case ASTIF:    visitIf   ((AstIf*)    ast);   break;
-      case ASTRET:   visitRet  ((AstRet*)   ast);   break;
-      case ASTWHILE: visitWhile((AstWhile*) ast);   break;
-      default:                                      break;
-    }
-    ast = ast->next;
-  }
-}
-
-// ========================================================
-void visitStr(AstStr* ast) {
-  pin(); printf("Str = %s", ast->txt);
-}
-
-// ========================================================
-// Var => "int" Nam ";"
-// ========================================================
-void visitVar(AstVar* ast) {
-  pin(); printf("Var \n"); pinMore();
-  pin(); printf("nam = %s \n", ast->nam->lex);
-  pin(); printf("typ = int \n");
-  pinLess();
-}
-
-// ========================================================
-// Vars => Var*
-// ========================================================
-void visitVars(AstVar* ast) {
-  if (ast == NULL) return;      // function has no vars
-  pin(); printf("Vars \n"); pinMore();
-  visitVar(ast);
-  ast = (AstVar*) ast->next;
-  while (ast != NULL) {
-    visitVar((AstVar*) ast);
-    ast = (AstVar*) ast->next;
-  }
-  pinLess();
-}
-
-// ========================================================
-// While => "while" "(" Exp ")" Block
-// ========================================================
-void visitWhile(AstWhile* ast) {
-  pin(); printf("While \n"); pinMore();
-  visitExp(ast->exp);
-  visitBlock(ast->block);
-  pinLess();
-}
\ No newline at end of file
+// visit.c - walk a SubC AST, vising every Node - Jim Hogg, 2020
+//
+// Each visit* function below is a hook, for walkRun (see walk.h), that
+// prints one kind of node.  Most print their own line, and indent the lines
+// of their children, which walkRun then visits; visitLess un-indents, once
+// they are done.  A few print their children themselves, and skip them.
+
+#include "pin.h"
+#include "visit.h"
+
+// ========================================================
+// Arg => Nam | Num | Str
+// ========================================================
+WALK visitArg(Walk* walk, Ast* ast) {
+  pin(); printf("Arg \n"); pinMore();
+  return WALKGO;
+}
+
+// ========================================================
+// Asg => Nam "=" (Exp | Call) ";"
+// ========================================================
+WALK visitAsg(Walk* walk, Ast* ast) {
+  pin(); printf("Asg \n"); pinMore();
+  return WALKGO;
+}
+
+// ========================================================
+// Block => "{" Stm+ "}"
+// ========================================================
+WALK visitBlock(Walk* walk, Ast* ast) {
+  pin(); printf("Block \n"); pinMore();
+  return WALKGO;
+}
+
+// ========================================================
+// Body => Var* Stm+
+// ========================================================
+WALK visitBody(Walk* walk, Ast* ast) {
+  pin(); printf("Body \n"); pinMore();
+  return WALKGO;
+}
+
+// ========================================================
+// Call => Nam "(" Args ")"
+//
+// A Call prints its own name.  A Call with no Args still
+// shows one, empty, Arg.  visitCallEnd closes the Args
+// ========================================================
+WALK visitCall(Walk* walk, Ast* ast) {
+  AstCall* call = (AstCall*) ast;
+  pin(); printf("Call \n"); pinMore();
+  pin(); printf("%s \n", call->nam->lex);
+  pin(); printf("Args \n"); pinMore();
+  if (call->args == NULL) {
+    pin(); printf("Arg \n"); pinMore();
+    pin(); printf("str = NULL \n"); pinLess();
+  }
+  return WALKGO;
+}
+
+// ========================================================
+WALK visitCallEnd(Walk* walk, Ast* ast) {
+  pinLess();                                  // Args
+  pinLess();                                  // Call
+  return WALKGO;
+}
+
+// ========================================================
+// Exp => NamNum | NamNum Bop NamNum
+//
+// The Bop comes between the operands, so print them here
+// ========================================================
+WALK visitExp(Walk* walk, Ast* ast) {
+  AstExp* exp = (AstExp*) ast;
+  pin(); printf("Exp \n"); pinMore();
+  visitNamNum(exp->lhs);
+  if (exp->bop != BOPNONE) {
+    pin(); printf("Bop = %s \n", astBOPtoStr(exp->bop));
+    visitNamNum(exp->rhs);
+  }
+  pinLess();
+  return WALKSKIP;
+}
+
+// ========================================================
+// Fun => "int" Nam "(" Pars ")" Body
+//
+// A Fun prints its own name
+// ========================================================
+WALK visitFun(Walk* walk, Ast* ast) {
+  pin(); printf("Fun \n"); pinMore();
+  pin(); printf("nam = %s \n", ((AstFun*) ast)->nam->lex);
+  pin(); printf("typ = int \n");
+  return WALKGO;
+}
+
+// ========================================================
+// If => "if" "(" Exp ")" Block
+// ========================================================
+WALK visitIf(Walk* walk, Ast* ast) {
+  pin(); printf("If \n"); pinMore();
+  return WALKGO;
+}
+
+// ========================================================
+// Un-indent, at the end of a node whose pre hook indented
+// ========================================================
+WALK visitLess(Walk* walk, Ast* ast) {
+  pinLess();
+  return WALKGO;
+}
+
+// ========================================================
+// Nam => Alpha AlphaNum*
+// ========================================================
+WALK visitNam(Walk* walk, Ast* ast) {
+  AST parent = walkParent(walk)->kind;
+  if (parent == ASTFUN || parent == ASTCALL) return WALKGO;   // printed already
+  pin(); printf("nam = %s \n", ((AstNam*) ast)->lex);
+  return WALKGO;
+}
+
+// ========================================================
+// NamNum => Nam | Num
+// ========================================================
+void visitNamNum(Ast* ast) {
+  if (ast->kind == ASTNAM) {
+    pin(); printf("nam = %s \n", ((AstNam*) ast)->lex);
+  } else if (ast->kind == ASTNUM) {
+    pin(); printf("num = %d \n", ((AstNum*) ast)->val);
+  }
+}
+
+// ========================================================
+// Num => [0-9]+
+// ========================================================
+WALK visitNum(Walk* walk, Ast* ast) {
+  visitNamNum(ast);
+  return WALKGO;
+}
+
+// ========================================================
+// Par => "int" Nam
+// ========================================================
+WALK visitPar(Walk* walk, Ast* ast) {
+  pin(); printf("Par \n"); pinMore();
+  pin(); printf("nam = %s \n", ((AstPar*) ast)->nam->lex);
+  pin(); printf("typ = int\n");
+  pinLess();
+  return WALKSKIP;
+}
+
+// ========================================================
+// Prog => Fun+
+// ========================================================
+void visitProg(AstProg* astProg) {
+  Walk* walk = walkNew(NULL);
+  walkOn(walk, ASTARG,   visitArg,   visitLess);
+  walkOn(walk, ASTASG,   visitAsg,   visitLess);
+  walkOn(walk, ASTBLOCK, visitBlock, visitLess);
+  walkOn(walk, ASTBODY,  visitBody,  visitLess);
+  walkOn(walk, ASTCALL,  visitCall,  visitCallEnd);
+  walkOn(walk, ASTEXP,   visitExp,   NULL);
+  walkOn(walk, ASTFUN,   visitFun,   visitLess);
+  walkOn(walk, ASTIF,    visitIf,    visitLess);
+  walkOn(walk, ASTNAM,   visitNam,   NULL);
+  walkOn(walk, ASTNUM,   visitNum,   NULL);
+  walkOn(walk, ASTPAR,   visitPar,   NULL);
+  walkOn(walk, ASTRET,   visitRet,   visitLess);
+  walkOn(walk, ASTSTR,   visitStr,   NULL);
+  walkOn(walk, ASTVAR,   visitVar,   NULL);
+  walkOn(walk, ASTWHILE, visitWhile, visitLess);
+
+  pin(); printf("Prog \n"); pinMore();
+  walkRun(walk, (Ast*) astProg);
+  walkFree(walk);
+  pinLess();
+  printf("\n\n");
+}
+
+// ========================================================
+// Ret => "return" Exp ";"
+// ========================================================
+WALK visitRet(Walk* walk, Ast* ast) {
+  pin(); printf("Ret \n"); pinMore();
+  return WALKGO;
+}
+
+// ========================================================
+// Str => "\"" NonQuotes "\""
+// ========================================================
+WALK visitStr(Walk* walk, Ast* ast) {
+  pin(); printf("str = \"%s\" \n", ((AstStr*) ast)->txt);
+  return WALKGO;
+}
+
+// ========================================================
+// Var => "int" Nam ";"
+//
+// The first Var of a Body opens "Vars", and the last one
+// closes it
+// ========================================================
+WALK visitVar(Walk* walk, Ast* ast) {
+  AstBody* body = (AstBody*) walkParent(walk);
+  if (ast == (Ast*) body->vars) {
+    pin(); printf("Vars \n"); pinMore();
+  }
+  pin(); printf("Var \n"); pinMore();
+  pin(); printf("nam = %s \n", ((AstVar*) ast)->nam->lex);
+  pin(); printf("typ = int \n");
+  pinLess();
+  if (ast->next == NULL) pinLess();
+  return WALKSKIP;
+}
+
+// ========================================================
+// While => "while" "(" Exp ")" Block
+// ========================================================
+WALK visitWhile(Walk* walk, Ast* ast) {
+  pin(); printf("While \n"); pinMore();
+  return WALKGO;
+}
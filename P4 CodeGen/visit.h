@@ -1,28 +1,29 @@
-// visit.h - Visit every node of the AST - Jim Hogg, 2020
-
-#pragma once
-
-#include "ast.h"
-#include "pin.h"
-
-#define INDENT 3
-
-AstArg* visitArg(AstArg* astarg);
-void visitArgs(AstArg* astarg);
-void visitAsg(AstAsg* astasg);
-void visitBlock(AstBlock* astblock);
-void visitCall(AstCall* astcall);
-void visitExp(AstExp* astexp);
-void visitFun(AstFun* astfun);
-void visitFuns(AstFun* astfun);
-void visitIf(AstIf* astif);
-void visitNam(AstNam* astnam);
-void visitNum(AstNum* astnum);
-void visitPar(AstPar* astpar);
-void visitProg(AstProg* astprog);
-void visitRet(AstRet* astret);
-void visitStms(Ast* aststm);
-void visitStr(AstStr* aststr);
-void visitVar(AstVar* astvar);
-void visitVars(AstVar* astvar);
-void visitWhile(AstWhile* astwhile);
+// visit.h - Visit every node of the AST - Jim Hogg, 2020
+
+#pragma once
+
+#include "ast.h"
+#include "pin.h"
+#include "walk.h"
+
+#define INDENT 3
+
+WALK visitArg    (Walk* walk, Ast* ast);
+WALK visitAsg    (Walk* walk, Ast* ast);
+WALK visitBlock  (Walk* walk, Ast* ast);
+WALK visitBody   (Walk* walk, Ast* ast);
+WALK visitCall   (Walk* walk, Ast* ast);
+WALK visitCallEnd(Walk* walk, Ast* ast);
+WALK visitExp    (Walk* walk, Ast* ast);
+WALK visitFun    (Walk* walk, Ast* ast);
+WALK visitIf     (Walk* walk, Ast* ast);
+WALK visitLess   (Walk* walk, Ast* ast);
+WALK visitNam    (Walk* walk, Ast* ast);
+void visitNamNum (Ast* ast);
+WALK visitNum    (Walk* walk, Ast* ast);
+WALK visitPar    (Walk* walk, Ast* ast);
+void visitProg   (AstProg* astprog);
+WALK visitRet    (Walk* walk, Ast* ast);
+WALK visitStr    (Walk* walk, Ast* ast);
+WALK visitVar    (Walk* walk, Ast* ast);
+WALK visitWhile  (Walk* walk, Ast* ast);
@@ -0,0 +1,110 @@
+// walk.c - Generic, non-recursive AST traversal
+//
+// See walk.h
+
+#include "walk.h"
+
+#define KID(type, field)  { offsetof(type, field), 0 }
+#define KIDS(type, field) { offsetof(type, field), 1 }
+
+const WalkKids g_walkKids[WALKNUMKIND] = {
+  [ASTARG]   = { 1, { KID (AstArg,   nns) } },
+  [ASTASG]   = { 2, { KID (AstAsg,   nam),  KID (AstAsg,   eoc)   } },
+  [ASTBLOCK] = { 1, { KIDS(AstBlock, stms) } },
+  [ASTBODY]  = { 2, { KIDS(AstBody,  vars), KIDS(AstBody,  stms)  } },
+  [ASTCALL]  = { 2, { KID (AstCall,  nam),  KIDS(AstCall,  args)  } },
+  [ASTEXP]   = { 2, { KID (AstExp,   lhs),  KID (AstExp,   rhs)   } },
+  [ASTFUN]   = { 3, { KID (AstFun,   nam),  KIDS(AstFun,   pars), KID(AstFun, body) } },
+  [ASTIF]    = { 2, { KID (AstIf,    exp),  KID (AstIf,    block) } },
+  [ASTPAR]   = { 1, { KID (AstPar,   nam) } },
+  [ASTPROG]  = { 1, { KIDS(AstProg,  funs) } },
+  [ASTRET]   = { 1, { KID (AstRet,   exp) } },
+  [ASTVAR]   = { 1, { KID (AstVar,   nam) } },
+  [ASTWHILE] = { 2, { KID (AstWhile, exp),  KID (AstWhile, block) } },
+};
+
+// ============================================================================
+// Push a frame for 'ast' and call its pre hook.  'list' says whether 'ast'
+// is in a list, whose remaining members follow it
+// ============================================================================
+void walkEnter(Walk* walk, Ast* ast, int list) {
+  if (++walk->hi == walk->max) {
+    walk->max *= 2;
+    walk->frame = realloc(walk->frame, walk->max * sizeof(WalkFrame));
+    if (walk->frame == NULL) utDie2Str("walkEnter", "realloc failed");
+  }
+  walk->frame[walk->hi] = (WalkFrame) { ast, 0, list };
+
+  WalkFn pre = walk->pre[ast->kind];
+  if (pre && pre(walk, ast) == WALKSKIP) {
+    walk->frame[walk->hi].kid = g_walkKids[ast->kind].num;
+  }
+}
+
+// ============================================================================
+void walkFree(Walk* walk) {
+  free(walk->frame);
+  free(walk);
+}
+
+// ============================================================================
+// Create a Walk, with no hooks.  'ctx' is passed on to them, in walk->ctx
+// ============================================================================
+Walk* walkNew(void* ctx) {
+  Walk* walk = calloc(1, sizeof(Walk));
+  if (walk == NULL) utDie2Str("walkNew", "calloc failed");
+  walk->ctx = ctx;
+  walk->max = 64;
+  walk->frame = malloc(walk->max * sizeof(WalkFrame));
+  if (walk->frame == NULL) utDie2Str("walkNew", "malloc failed");
+  walk->hi = -1;
+  return walk;
+}
+
+// ============================================================================
+// Register the hooks 'pre' and 'post', either of which may be NULL, for
+// nodes of kind 'kind'
+// ============================================================================
+void walkOn(Walk* walk, AST kind, WalkFn pre, WalkFn post) {
+  walk->pre[kind]  = pre;
+  walk->post[kind] = post;
+}
+
+// ============================================================================
+// Return the parent of the current node - the one whose hook is running -
+// or NULL if it is the root
+// ============================================================================
+Ast* walkParent(Walk* walk) {
+  return walk->hi > 0 ? walk->frame[walk->hi - 1].ast : NULL;
+}
+
+// ============================================================================
+// Walk the tree rooted at 'root', calling the hooks registered for each node
+// ============================================================================
+void walkRun(Walk* walk, Ast* root) {
+  walk->hi = -1;
+  walkEnter(walk, root, 0);
+
+  while (walk->hi >= 0) {
+    WalkFrame* frame = &walk->frame[walk->hi];
+    Ast* ast = frame->ast;
+    const WalkKids* kids = &g_walkKids[ast->kind];
+
+    if (frame->kid < kids->num) {                   // walk the next child
+      WalkKid k = kids->kid[frame->kid++];
+      Ast* kid = *(Ast**) ((char*) ast + k.off);
+      if (kid) walkEnter(walk, kid, k.list);
+      continue;
+    }
+
+    WalkFn post = walk->post[ast->kind];            // all children done
+    if (post) post(walk, ast);
+    int list = walk->frame[walk->hi--].list;
+    if (list && ast->next) walkEnter(walk, ast->next, 1);
+  }
+}
+
+// ============================================================================
+// A pre hook that skips the children of the nodes it is registered for
+// ============================================================================
+WALK walkSkip(Walk* walk, Ast* ast) { return WALKSKIP; }
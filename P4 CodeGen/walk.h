@@ -0,0 +1,76 @@
+// walk.h - Generic, non-recursive AST traversal
+
+#pragma once
+
+#include <stddef.h>         // offsetof
+
+#include "ast.h"            // Ast, AST*
+
+// A pass over the AST - printing it (visit.c), generating code for it
+// (cg.c), or some analysis - plugs into walkRun, rather than hand-writing its
+// own walk.  The pass registers, by AST kind, a 'pre' hook, called as the
+// walk enters a node of that kind, and a 'post' hook, called as it leaves,
+// once all the node's children are done.  Either may be NULL.  A pre hook
+// returns WALKSKIP to have the walk pass over the node's children (though its
+// post hook is still called), or WALKGO to walk them.
+//
+// walkRun keeps the path from the root to the current node as an explicit,
+// heap-allocated stack of WalkFrames, so deep nesting costs heap, not C
+// stack.  Each node's children, and their order, come from one table
+// (g_walkKids): a child is a field of the node, and may be a single node, or
+// the head of a list, linked via 'next'.  The children of each kind are
+// walked in source order:
+//
+//    Prog  : Funs                Body  : Vars, Stms
+//    Fun   : Nam, Pars, Body     Block : Stms
+//    Par   : Nam                 If    : Exp, Block
+//    Var   : Nam                 While : Exp, Block
+//    Asg   : Nam, Exp | Call     Ret   : Exp
+//    Call  : Nam, Args           Arg   : Nam | Num | Str
+//    Exp   : lhs, rhs            Nam, Num, Str : none
+//
+// A hook may look up the stack (walkParent) but must not change the tree.
+
+#define WALKNUMKIND (ASTWHILE + 1)          // hooks are indexed by AST kind
+#define WALKMAXKID  3                       // most children of any kind
+
+typedef enum { WALKGO = 0, WALKSKIP } WALK; // returned by a pre hook
+
+struct Walk_;  typedef struct Walk_ Walk;   // forward declaration
+
+typedef WALK (*WalkFn)(Walk* walk, Ast* ast);
+
+typedef struct {            // one child field of a kind of node
+  short     off;            // its offset, in bytes, within the node
+  short     list;           // is it the head of a list, linked via 'next'?
+} WalkKid;
+
+typedef struct {            // the children of one kind of node
+  int       num;
+  WalkKid   kid[WALKMAXKID];
+} WalkKids;
+
+typedef struct {            // a node that the walk is inside
+  Ast*      ast;
+  int       kid;            // index, in g_walkKids, of its next child to walk
+  int       list;           // is 'ast' in a list?  If so, walk its 'next' after it
+} WalkFrame;
+
+struct Walk_ {
+  WalkFn     pre [WALKNUMKIND];   // called on entering a node of each kind
+  WalkFn     post[WALKNUMKIND];   // called on leaving it
+  void*      ctx;                 // state of the pass, for its hooks
+  WalkFrame* frame;               // path from the root: frame[hi] is current
+  int        hi;
+  int        max;                 // frames allocated
+};
+
+extern const WalkKids g_walkKids[WALKNUMKIND];
+
+void  walkEnter (Walk* walk, Ast* ast, int list);
+void  walkFree  (Walk* walk);
+Walk* walkNew   (void* ctx);
+void  walkOn    (Walk* walk, AST kind, WalkFn pre, WalkFn post);
+Ast*  walkParent(Walk* walk);
+void  walkRun   (Walk* walk, Ast* root);
+WALK  walkSkip  (Walk* walk, Ast* ast);
@@ -0,0 +1,98 @@
+// flacheck.c - Check that the AST cache gives back the AST it was given
+//
+// For each SubC file named on the command line, parse it, as main.c's
+// compile does, and dump its AST with visitProg.  Then flatten that AST
+// (flaNew), save it (flaSave), load it back (flaLoad) and re-build the AST
+// from it (flaAst), just as a second compile of the same file does (see the
+// .ast cache in main.c).  Dump that AST too, and check that the two dumps
+// are the same.
+//
+// For each file, print PASS or FAIL.  Exit with 1 if any file fails, else 0.
+//
+// Usage: flacheck <file.subc> ...        eg: flacheck *.subc
+//
+// Build (from this directory):
+//    clang -O2 -o flacheck flacheck.c
+
+#include "../P4 CodeGen/ast.c"
+#include "../P4 CodeGen/fla.c"
+#include "../P4 CodeGen/lex.c"
+#include "../P4 CodeGen/pin.c"
+#include "../P4 CodeGen/pse.c"
+#include "../P4 CodeGen/tok.c"
+#include "../P4 CodeGen/toks.c"
+#include "../P4 CodeGen/ut.c"
+#include "../P4 CodeGen/visit.c"
+#include "../P4 CodeGen/walk.c"
+
+#define CHECKPATH "flacheck.ast"        // scratch cache file
+
+// ============================================================================
+// Return, in a malloc'd string, all that visitProg prints for 'astProg'.  We
+// point stdout at a scratch file for the duration, then read that file back
+// ============================================================================
+char* checkDump(AstProg* astProg) {
+  fflush(stdout);
+  int saved = dup(fileno(stdout));
+  FILE* tmp = tmpfile();
+  if (saved < 0 || tmp == NULL) utDie2Str("checkDump", "cannot capture stdout");
+  dup2(fileno(tmp), fileno(stdout));
+
+  visitProg(astProg);
+
+  fflush(stdout);
+  dup2(saved, fileno(stdout));
+  close(saved);
+
+  long size = ftell(tmp);
+  char* text = malloc(size + 1);
+  if (text == NULL) utDie2Str("checkDump", "malloc failed");
+  rewind(tmp);
+  text[fread(text, 1, size, tmp)] = '\0';
+  fclose(tmp);
+  return text;
+}
+
+// ============================================================================
+// Check the SubC file at 'srcPath' (see top of file).  Return 1 if it
+// passes, else 0
+// ============================================================================
+int checkFile(char* srcPath) {
+  char* prog = utReadFile(srcPath);
+  Toks* toks = lexAll(lexNew(prog));
+  toksRewind(toks);
+  AstProg* astProg = pseProg(toks);
+  char* before = checkDump(astProg);
+
+  remove(CHECKPATH);
+  flaSave(flaNew(astProg), CHECKPATH, prog);
+  Fla* fla = flaLoad(CHECKPATH, prog);
+  char* after = fla ? checkDump(flaAst(fla)) : NULL;
+  remove(CHECKPATH);
+
+  char* why = fla == NULL ? "flaLoad rejected what flaSave wrote"
+    : strcmp(before, after) != 0 ? "re-built AST differs"
+    : NULL;
+
+  if (why) {
+    printf("FAIL %s: %s \n", srcPath, why);
+    if (after) printf("  parsed: \n%s\n  re-built: \n%s\n", before, after);
+  } else {
+    printf("PASS %s \n", srcPath);
+  }
+  return why == NULL;
+}
+
+// ============================================================================
+// Usage: flacheck <file.subc> ...
+// ============================================================================
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    printf("Usage: flacheck <file.subc> ... \n");
+    return 1;
+  }
+  int numFail = 0;
+  for (int a = 1; a < argc; ++a) numFail += !checkFile(argv[a]);
+  printf("INFO: %d files, %d failed \n", argc - 1, numFail);
+  return numFail != 0;
+}
@@ -0,0 +1,473 @@
+// ssacheck.c - Check that -ssa leaves what each SubC test prints unchanged
+//
+// Compile each SubC file named on the command line twice, as main.c's
+// compile does: once as usual, and once with -ssa (see ssa.h).  Run each
+// result in a simulator for the subset of ARM that cg emits, and check that
+// the two print the same text, and that main returns the same value.
+//
+// The intrinsics says, sayn and sayl are simulated in C, doing what io.s
+// does: says prints a string, sayn an 8-digit hex number, sayl a newline.
+// Like io.s, they take their argument from R0, not from the stack - so the
+// simulator also checks that R0 holds the value pushed last (see cgArg).  A
+// run fails if it breaks that rule, strays out of its stack, or runs for
+// more than SIMSTEPS instructions.
+//
+// For each file, print PASS or FAIL, then what the -ssa run printed, so that
+// its "Expect = ... : Actual = ..." can be read off.  Exit with 1 if any
+// file fails, else 0.
+//
+// Usage: ssacheck <file.subc> ...        eg: ssacheck *.subc
+//
+// Build (from this directory):
+//    clang -O2 -o ssacheck ssacheck.c
+
+#include "../P4 CodeGen/ast.c"
+#include "../P4 CodeGen/cfg.c"
+#include "../P4 CodeGen/cg.c"
+#include "../P4 CodeGen/cgr.c"
+#include "../P4 CodeGen/emit.c"
+#include "../P4 CodeGen/ir.c"
+#include "../P4 CodeGen/lay.c"
+#include "../P4 CodeGen/lex.c"
+#include "../P4 CodeGen/live.c"
+#include "../P4 CodeGen/pin.c"
+#include "../P4 CodeGen/pse.c"
+#include "../P4 CodeGen/res.c"
+#include "../P4 CodeGen/ssa.c"
+#include "../P4 CodeGen/tok.c"
+#include "../P4 CodeGen/toks.c"
+#include "../P4 CodeGen/ut.c"
+#include "../P4 CodeGen/walk.c"
+
+#define SIMSTEPS  100000000     // instructions run, before we give up
+#define SIMWORDS  (1 << 20)     // words of stack
+#define SIMSTR    0x40000000    // address of string n is SIMSTR + n
+#define SIMSP     13            // register numbers: R0 - R12, then SP
+#define SIMLR     14            // ... and LR.  FP is R11
+
+typedef enum { ARMADD = 1, ARMB, ARMBL, ARMBX, ARMCMP, ARMLDR, ARMMOV,
+  ARMMUL, ARMPOP, ARMPUSH, ARMSTR, ARMSUB } ARMOP;      // as cg emits them
+
+typedef enum { OPNREG = 1, OPNIMM, OPNMEM, OPNLIST, OPNLAB } OPN;
+
+typedef struct {
+  OPN    kind;
+  int    reg;           // OPNREG, OPNMEM: the register
+  int    imm;           // OPNIMM: the value; OPNMEM: the offset
+  int    regs[4];       // OPNLIST: the registers, in order
+  int    numReg;
+  char*  lab;           // OPNLAB: the label
+} Opnd;
+
+typedef struct {
+  ARMOP  op;
+  char   cond[3];       // B only: "", "EQ", "NE", "LT", "LE", "GT" or "GE"
+  Opnd   opnd[3];
+  int    numOpnd;
+  int    target;        // B, BL: instruction branched to; or -1 for an intrinsic
+} SimIns;
+
+typedef struct {
+  SimIns* ins;          // one per line of .TEXT
+  int     numIns;
+  char**  labNam;       // code labels, in order ...
+  int*    labAt;        // ... and the instruction each is at
+  int     numLab;
+  char**  str;          // strings of the .DATA section ...
+  char**  strNam;       // ... and their labels
+  int     numStr;
+  char*   err;          // first error found, or NULL
+} Sim;
+
+typedef struct {
+  char* buf;
+  int   size;
+  int   cap;
+} Text;
+
+// ============================================================================
+// Append 's' onto 'text'
+// ============================================================================
+void textPut(Text* text, char* s) {
+  int len = strlen(s);
+  if (text->size + len + 1 > text->cap) {
+    text->cap = 2 * text->cap + len + 4096;
+    text->buf = realloc(text->buf, text->cap);
+  }
+  memcpy(text->buf + text->size, s, len + 1);
+  text->size += len;
+}
+
+// ============================================================================
+// Record the first error found in 'sim'
+// ============================================================================
+void simError(Sim* sim, char* msg, char* detail) {
+  if (sim->err) return;
+  sim->err = calloc(strlen(msg) + strlen(detail) + 4, 1);
+  sprintf(sim->err, "%s: %s", msg, detail);
+}
+
+// ============================================================================
+// Return the number of register 's' (eg: "R3", "FP"), or -1 if it is not one
+// ============================================================================
+int simReg(char* s) {
+  while (isspace(*s)) ++s;
+  char* end = s + strlen(s);
+  while (end > s && isspace(end[-1])) --end;
+  int len = end - s;
+  if (len == 2 && strncmp(s, "FP", 2) == 0) return 11;
+  if (len == 2 && strncmp(s, "SP", 2) == 0) return SIMSP;
+  if (len == 2 && strncmp(s, "LR", 2) == 0) return SIMLR;
+  if (len < 2 || len > 3 || s[0] != 'R' || !isdigit(s[1])) return -1;
+  int r = atoi(s + 1);
+  return r <= 12 && (len == 2 || isdigit(s[2])) ? r : -1;
+}
+
+// ============================================================================
+// Parse operand 's' into 'opnd'.  Return 0 if it is not one we know
+// ============================================================================
+int simOpnd(Sim* sim, char* s, Opnd* opnd) {
+  while (isspace(*s)) ++s;
+  char* end = s + strlen(s);
+  while (end > s && isspace(end[-1])) *--end = '\0';
+
+  if (*s == '#') {                                // eg: #8
+    opnd->kind = OPNIMM;
+    opnd->imm = atoi(s + 1);
+  } else if (*s == '=') {                         // eg: =42 or =L20
+    opnd->kind = OPNIMM;
+    if (isdigit(s[1]) || s[1] == '-') {
+      opnd->imm = atoi(s + 1);
+      return 1;
+    }
+    for (int n = 0; n < sim->numStr; ++n) {
+      if (strcmp(sim->strNam[n], s + 1) == 0) { opnd->imm = SIMSTR + n; return 1; }
+    }
+    return 0;
+  } else if (*s == '[') {                         // eg: [FP, #-8]
+    opnd->kind = OPNMEM;
+    char* close = strchr(s, ']');
+    if (close == NULL) return 0;
+    *close = '\0';
+    char* comma = strchr(s, ',');
+    if (comma) *comma = '\0';
+    char* hash = comma ? strchr(comma + 1, '#') : NULL;
+    if (comma && hash == NULL) return 0;
+    opnd->reg = simReg(s + 1);
+    opnd->imm = hash ? atoi(hash + 1) : 0;
+    return opnd->reg >= 0;
+  } else if (*s == '{') {                         // eg: {FP, LR}
+    opnd->kind = OPNLIST;
+    char* close = strchr(s, '}');
+    if (close == NULL) return 0;
+    *close = '\0';
+    for (char* r = strtok_r(s + 1, ",", &end); r; r = strtok_r(NULL, ",", &end)) {
+      if (opnd->numReg == 4) return 0;
+      int reg = simReg(r);
+      if (reg < 0) return 0;
+      opnd->regs[opnd->numReg++] = reg;
+    }
+  } else if ((opnd->reg = simReg(s)) >= 0) {      // eg: R3
+    opnd->kind = OPNREG;
+  } else {                                        // eg: L20, or add2
+    opnd->kind = OPNLAB;
+    opnd->lab = s;
+  }
+  return 1;
+}
+
+// ============================================================================
+// Parse the instruction in 'line' (eg: "ADD SP, SP, #8") into 'ins'
+// ============================================================================
+void simParse(Sim* sim, char* line, SimIns* ins) {
+  static struct { char* nam; ARMOP op; } ops[] = {
+    { "ADD", ARMADD }, { "BL", ARMBL }, { "BX", ARMBX }, { "CMP", ARMCMP },
+    { "LDR", ARMLDR }, { "MOV", ARMMOV }, { "MUL", ARMMUL }, { "POP", ARMPOP },
+    { "PUSH", ARMPUSH }, { "STR", ARMSTR }, { "SUB", ARMSUB } };
+
+  memset(ins, 0, sizeof(SimIns));
+  char* rest = line;
+  while (*rest && !isspace(*rest)) ++rest;
+  if (*rest) *rest++ = '\0';
+
+  for (int o = 0; o < (int) (sizeof(ops) / sizeof(ops[0])); ++o) {
+    if (strcmp(line, ops[o].nam) == 0) ins->op = ops[o].op;
+  }
+  if (ins->op == 0 && line[0] == 'B' && strlen(line) <= 3) {     // eg: BLT
+    char* c = line + 1;
+    if (*c == '\0' || strcmp(c, "EQ") == 0 || strcmp(c, "NE") == 0 || strcmp(c, "LT") == 0
+      || strcmp(c, "LE") == 0 || strcmp(c, "GT") == 0 || strcmp(c, "GE") == 0) {
+      ins->op = ARMB;
+      strcpy(ins->cond, c);
+    }
+  }
+  if (ins->op == 0) { simError(sim, "unknown instruction", line); return; }
+
+  int depth = 0;                                  // split at top-level commas
+  char* start = rest;
+  for (char* p = rest; ; ++p) {
+    if (*p == '[' || *p == '{') ++depth;
+    if (*p == ']' || *p == '}') --depth;
+    if (*p == '\0' || (*p == ',' && depth == 0)) {
+      int last = *p == '\0';
+      *p = '\0';
+      if (ins->numOpnd == 3 || !simOpnd(sim, start, &ins->opnd[ins->numOpnd++])) {
+        simError(sim, "bad operand", start);
+        return;
+      }
+      if (last) break;
+      start = p + 1;
+    }
+  }
+}
+
+// ============================================================================
+// Create a Sim, for the ARM code and data held in 'emit'.  Parse each line
+// once, up front, and resolve each branch to the instruction it targets
+// ============================================================================
+Sim* simNew(Emit* emit) {
+  char* bufs[2] = { emit->dataBuf, emit->codeBuf };
+  int numLine = 0;                                // bounds every array below
+  for (int b = 0; b < 2; ++b) {
+    for (char* p = bufs[b]; *p; ++p) numLine += *p == '\n';
+  }
+
+  Sim* sim = calloc(1, sizeof(Sim));
+  sim->ins = calloc(numLine, sizeof(SimIns));
+  sim->labNam = calloc(numLine, sizeof(char*));
+  sim->labAt = calloc(numLine, sizeof(int));
+  sim->str = calloc(numLine, sizeof(char*));
+  sim->strNam = calloc(numLine, sizeof(char*));
+  for (int b = 0; b < 2; ++b) {
+    char* lab = NULL;                             // last .DATA label
+    for (char* line = strtok(bufs[b], "\n"); line; line = strtok(NULL, "\n")) {
+      while (isspace(*line)) ++line;
+      if (*line == '\0' || (*line == '.' && strncmp(line, ".ASCIZ", 6) != 0)) continue;
+      char* colon = strchr(line, ':');
+      if (colon && strchr(line, '"') == NULL) {   // eg: "L20:"
+        *colon = '\0';
+        if (b == 0) {
+          lab = line;
+        } else {
+          sim->labNam[sim->numLab] = line;
+          sim->labAt[sim->numLab++] = sim->numIns;
+        }
+      } else if (b == 0) {                        // eg: .ASCIZ "hello"
+        char* open = strchr(line, '"');
+        char* close = open ? strrchr(line, '"') : NULL;
+        if (lab == NULL || close == open) { simError(sim, "bad data", line); continue; }
+        *close = '\0';
+        sim->strNam[sim->numStr] = lab;
+        sim->str[sim->numStr++] = open + 1;
+      } else {
+        simParse(sim, line, &sim->ins[sim->numIns++]);
+      }
+    }
+  }
+
+  for (int i = 0; i < sim->numIns; ++i) {
+    SimIns* ins = &sim->ins[i];
+    if (ins->op != ARMB && ins->op != ARMBL) continue;
+    char* lab = ins->opnd[0].lab;
+    if (ins->opnd[0].kind != OPNLAB) { simError(sim, "bad branch", "no label"); continue; }
+    ins->target = -2;
+    if (ins->op == ARMBL && (strcmp(lab, "says") == 0 || strcmp(lab, "sayn") == 0
+      || strcmp(lab, "sayl") == 0)) ins->target = -1;
+    for (int l = 0; l < sim->numLab && ins->target == -2; ++l) {
+      if (strcmp(sim->labNam[l], lab) == 0) ins->target = sim->labAt[l];
+    }
+    if (ins->target == -2) simError(sim, "undefined label", lab);
+  }
+  return sim;
+}
+
+// ============================================================================
+// Return the index into the stack of the word at byte address 'a'.  If 'a'
+// is not in the stack, or not word-aligned, set sim->err, and return 0
+// ============================================================================
+int simWord(Sim* sim, int a) {
+  if (a < 0 || a >= 4 * SIMWORDS || a % 4 != 0) {
+    char buf[20];
+    sprintf(buf, "%d", a);
+    simError(sim, "bad address", buf);
+    return 0;
+  }
+  return a / 4;
+}
+
+// ============================================================================
+// Simulate intrinsic 'nam' (says, sayn or sayl), as io.s does it, with 'r0'
+// in R0, and 'top' on top of the stack.  Append what it prints to 'out'
+// ============================================================================
+void simSay(Sim* sim, char* nam, int r0, int top, Text* out) {
+  if (strcmp(nam, "sayl") == 0) { textPut(out, "\n"); return; }
+  if (r0 != top) {
+    simError(sim, nam, "R0 does not hold the argument pushed last");
+    return;
+  }
+  if (strcmp(nam, "sayn") == 0) {
+    char buf[12];
+    sprintf(buf, "%08X", (unsigned) r0);
+    textPut(out, buf);
+  } else if (r0 >= SIMSTR && r0 < SIMSTR + sim->numStr) {
+    textPut(out, sim->str[r0 - SIMSTR]);
+  } else {
+    simError(sim, nam, "R0 does not hold a string");
+  }
+}
+
+// ============================================================================
+// Run 'sim' from main, until main returns.  Append what it prints to 'out',
+// and leave the value main returns in '*result'.  On error, set sim->err
+// ============================================================================
+void simRun(Sim* sim, Text* out, int* result) {
+  int* mem = calloc(SIMWORDS, sizeof(int));
+  int r[15] = { 0 };
+  r[SIMSP] = 4 * SIMWORDS;
+  r[SIMLR] = -1;                                  // main returns to here
+  int flagA = 0, flagB = 0;                       // operands of the last CMP
+  textPut(out, "");
+
+  int pc = -1;
+  for (int l = 0; l < sim->numLab; ++l) {
+    if (strcmp(sim->labNam[l], "main") == 0) { pc = sim->labAt[l]; break; }
+  }
+  if (pc < 0) { simError(sim, "no main", ""); return; }
+
+  #define SIMWORD(a) mem[simWord(sim, a)]
+  for (long long step = 0; pc != -1 && sim->err == NULL; ++step) {
+    if (step == SIMSTEPS) { simError(sim, "too many steps", "infinite loop?"); break; }
+    if (pc < 0 || pc >= sim->numIns) { simError(sim, "ran off the code", ""); break; }
+    SimIns* ins = &sim->ins[pc++];
+    Opnd* o = ins->opnd;
+    #define SIMVAL(n) (o[n].kind == OPNREG ? r[o[n].reg] : o[n].imm)
+    switch (ins->op) {
+      case ARMADD: r[o[0].reg] = (int) ((unsigned) SIMVAL(1) + (unsigned) SIMVAL(2)); break;
+      case ARMSUB: r[o[0].reg] = (int) ((unsigned) SIMVAL(1) - (unsigned) SIMVAL(2)); break;
+      case ARMMUL: r[o[0].reg] = (int) ((unsigned) SIMVAL(1) * (unsigned) SIMVAL(2)); break;
+      case ARMMOV: r[o[0].reg] = SIMVAL(1); break;
+      case ARMCMP: flagA = SIMVAL(0); flagB = SIMVAL(1); break;
+      case ARMLDR: r[o[0].reg] = o[1].kind == OPNMEM
+                     ? SIMWORD(r[o[1].reg] + o[1].imm) : o[1].imm;
+                   break;
+      case ARMSTR: SIMWORD(r[o[1].reg] + o[1].imm) = r[o[0].reg]; break;
+      case ARMPUSH: for (int i = o[0].numReg - 1; i >= 0; --i) {
+                      r[SIMSP] -= 4;
+                      SIMWORD(r[SIMSP]) = r[o[0].regs[i]];
+                    }
+                    break;
+      case ARMPOP:  for (int i = 0; i < o[0].numReg; ++i) {
+                      r[o[0].regs[i]] = SIMWORD(r[SIMSP]);
+                      r[SIMSP] += 4;
+                    }
+                    break;
+      case ARMB: {
+        char* c = ins->cond;
+        int take = c[0] == '\0'
+          || (strcmp(c, "EQ") == 0 && flagA == flagB) || (strcmp(c, "NE") == 0 && flagA != flagB)
+          || (strcmp(c, "LT") == 0 && flagA <  flagB) || (strcmp(c, "LE") == 0 && flagA <= flagB)
+          || (strcmp(c, "GT") == 0 && flagA >  flagB) || (strcmp(c, "GE") == 0 && flagA >= flagB);
+        if (take) pc = ins->target;
+        break;
+      }
+      case ARMBL:
+        if (ins->target >= 0) {
+          r[SIMLR] = pc;
+          pc = ins->target;
+        } else {
+          simSay(sim, o[0].lab, r[0], SIMWORD(r[SIMSP]), out);
+          r[0] = 0;                               // each returns 0 ...
+          r[1] = r[2] = r[3] = r[12] = 0xBAD;     // ... and trashes these
+        }
+        break;
+      case ARMBX:  pc = r[o[0].reg]; break;
+    }
+  }
+  #undef SIMVAL
+  #undef SIMWORD
+  *result = r[0];
+  free(mem);
+}
+
+// ============================================================================
+// Compile 'srcPath', as main.c's compile does - with -ssa, if 'ssa' - but
+// leave the ARM code in the Emit buffer, without io.s, rather than save it
+// ============================================================================
+Emit* checkCompile(char* srcPath, int ssa) {
+  char* prog = utReadFile(srcPath);
+  Toks* toks = lexAll(lexNew(prog));
+  toksRewind(toks);
+  AstProg* astProg = pseProg(toks);
+
+  Cg* cg = cgNew();
+  resProg(cg->lay, astProg);
+  cg->cgr = cgrProg(cg->lay, astProg);
+  cgrPrune(cg->cgr, astProg);
+  liveProg(cg->lay, astProg);
+
+  emitCodeDirective(cg->emit);
+  emitDataDirective(cg->emit);
+
+  Ir* ir = irProg(cg->lay, astProg);
+  irVerify(ir);
+  cfgProg(ir);
+  irVerify(ir);
+  g_ssa = ssa;
+  if (g_ssa) {
+    ssaProg(ir);
+    irVerify(ir);
+  }
+  cgProg(cg, ir);
+  return cg->emit;
+}
+
+// ============================================================================
+// Check the SubC file at 'srcPath' (see top of file).  Return 1 if it
+// passes, else 0
+// ============================================================================
+int checkFile(char* srcPath) {
+  Text out[2] = { { NULL, 0, 0 }, { NULL, 0, 0 } };
+  int result[2];
+  char* err[2];
+  for (int ssa = 0; ssa <= 1; ++ssa) {
+    Emit* emit = checkCompile(srcPath, ssa);
+    Sim* sim = simNew(emit);
+    if (sim->err == NULL) simRun(sim, &out[ssa], &result[ssa]);
+    err[ssa] = sim->err;
+  }
+
+  char* why = err[0] ? "default run failed"
+    : err[1] ? "-ssa run failed"
+    : strcmp(out[0].buf, out[1].buf) != 0 ? "-ssa printed something else"
+    : result[0] != result[1] ? "-ssa returned something else"
+    : NULL;
+
+  if (why) {
+    printf("FAIL %s: %s \n", srcPath, why);
+    for (int ssa = 0; ssa <= 1; ++ssa) {
+      printf("  %s: ", ssa ? "-ssa" : "default");
+      if (err[ssa]) {
+        printf("ERROR: %s \n", err[ssa]);
+      } else {
+        printf("returned %d, printed: \n%s\n", result[ssa], out[ssa].buf);
+      }
+    }
+  } else {
+    printf("PASS %s: returned %d, printed: \n%s\n", srcPath, result[1], out[1].buf);
+  }
+  return why == NULL;
+}
+
+// ============================================================================
+// Usage: ssacheck <file.subc> ...
+// ============================================================================
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    printf("Usage: ssacheck <file.subc> ... \n");
+    return 1;
+  }
+  int numFail = 0;
+  for (int a = 1; a < argc; ++a) numFail += !checkFile(argv[a]);
+  printf("INFO: %d files, %d failed \n", argc - 1, numFail);
+  return numFail != 0;
+}